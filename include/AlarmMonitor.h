@@ -0,0 +1,277 @@
+#ifndef ALARM_MONITOR_H
+#define ALARM_MONITOR_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "SampleRing.h"
+#include "config.h"
+
+/**
+ * @brief Alarm rule for one channel
+ *
+ * Set low/high to NAN and ratePerMin to 0 to disable that check.
+ */
+struct AlarmRule {
+    const char* channel;    // SensorChannel deviceType, e.g. "pH"
+    float low;              // Raise below this value
+    float high;             // Raise above this value
+    float ratePerMin;       // Raise when |slope| over the window exceeds this (units per minute)
+    uint16_t rateWindowS;   // Window the slope is fitted over (seconds)
+    float hysteresis;       // Value must come back this far inside a threshold to clear
+};
+
+enum AlarmKind {
+    ALARM_LOW = 0,
+    ALARM_HIGH,
+    ALARM_RATE,
+    ALARM_KIND_COUNT
+};
+
+/**
+ * @brief A raised or cleared alarm waiting to be published
+ */
+struct AlarmEvent {
+    uint8_t rule;
+    AlarmKind kind;
+    bool raised;
+    float value;            // Sample that triggered the change
+    float rate;             // Slope at that sample (units per minute)
+    int64_t timestampUs;
+};
+
+typedef SampleRing<RAW_SAMPLE_RING_SIZE> AlarmSampleRing;
+
+/**
+ * @brief Evaluates threshold and rate-of-change rules on every accepted sample
+ *
+ * Each rule is bound to a channel's accepted sample ring (after the range
+ * check and despike stages) and keeps its own cursor, so evaluate() sees
+ * every sample exactly once right after it was read. An alarm is raised
+ * only after ALARM_CONSECUTIVE_SAMPLES samples in a row are past its limit;
+ * it clears on the first sample back inside the hysteresis band. State
+ * changes are queued as AlarmEvents for the caller to publish ahead of
+ * routine traffic; if the queue overflows the oldest event is dropped and
+ * counted.
+ */
+class AlarmMonitor {
+public:
+    static const size_t MAX_RULES = 8;
+    static const size_t QUEUE_SIZE = 8;
+
+private:
+    struct RuleState {
+        const AlarmSampleRing* ring;
+        uint32_t cursor;
+        bool active[ALARM_KIND_COUNT];
+        uint16_t streak[ALARM_KIND_COUNT];  // Consecutive samples past the limit while inactive
+    };
+
+    const AlarmRule* rules;
+    size_t ruleCount;
+    RuleState states[MAX_RULES];
+    AlarmEvent queue[QUEUE_SIZE];
+    size_t queueHead;
+    size_t queueCount;
+    uint32_t droppedEvents;
+
+    void enqueue(uint8_t rule, AlarmKind kind, bool raised, const TimedSample& sample, float rate) {
+        if (queueCount == QUEUE_SIZE) {
+            queueHead = (queueHead + 1) % QUEUE_SIZE;
+            queueCount--;
+            droppedEvents++;
+        }
+        AlarmEvent& e = queue[(queueHead + queueCount) % QUEUE_SIZE];
+        e.rule = rule;
+        e.kind = kind;
+        e.raised = raised;
+        e.value = sample.value;
+        e.rate = rate;
+        e.timestampUs = sample.timestampUs;
+        queueCount++;
+    }
+
+    void update(uint8_t rule, AlarmKind kind, bool raise, bool clear, const TimedSample& sample, float rate) {
+        bool& active = states[rule].active[kind];
+        uint16_t& streak = states[rule].streak[kind];
+        if (active) {
+            if (!clear) {
+                return;
+            }
+        } else {
+            streak = raise ? streak + 1 : 0;
+            if (streak < ALARM_CONSECUTIVE_SAMPLES) {
+                return;
+            }
+        }
+        streak = 0;
+        active = !active;
+        Serial.printf("[ALARM] %s %s %s: %.2f (rate %.2f/min)\n", active ? "⚠ raised" : "✓ cleared",
+                      rules[rule].channel, kindName(kind), sample.value, rate);
+        enqueue(rule, kind, active, sample, rate);
+    }
+
+    /**
+     * @brief Least-squares slope of the samples up to seq within the window
+     * @return true if the window held enough samples to fit a slope
+     */
+    bool slopeAt(const AlarmSampleRing& ring, uint32_t seq, uint16_t windowS, float& perMin) const {
+        const int64_t end = ring.get(seq).timestampUs;
+        const int64_t start = end - (int64_t)windowS * 1000000LL;
+        double sumT = 0, sumV = 0, sumTT = 0, sumTV = 0;
+        size_t n = 0;
+        int64_t earliest = end;
+        for (uint32_t s = seq + 1; s-- > ring.oldest();) {
+            const TimedSample& sample = ring.get(s);
+            if (sample.timestampUs < start) {
+                break;
+            }
+            double t = (sample.timestampUs - end) / 60e6;  // minutes, relative to avoid precision loss
+            sumT += t;
+            sumV += sample.value;
+            sumTT += t * t;
+            sumTV += t * sample.value;
+            earliest = sample.timestampUs;
+            n++;
+        }
+        // Need a few points spread over at least half the window
+        if (n < 3 || (end - earliest) < (int64_t)windowS * 500000LL) {
+            return false;
+        }
+        double denom = n * sumTT - sumT * sumT;
+        if (denom <= 0) {
+            return false;
+        }
+        perMin = (float)((n * sumTV - sumT * sumV) / denom);
+        return true;
+    }
+
+    void evaluateSample(uint8_t r, uint32_t seq) {
+        const AlarmRule& rule = rules[r];
+        const AlarmSampleRing& ring = *states[r].ring;
+        const TimedSample& sample = ring.get(seq);
+        float v = sample.value;
+
+        float rate = 0.0f;
+        bool haveRate = rule.ratePerMin > 0 && slopeAt(ring, seq, rule.rateWindowS, rate);
+
+        if (!isnan(rule.low)) {
+            update(r, ALARM_LOW, v < rule.low, v >= rule.low + rule.hysteresis, sample, rate);
+        }
+        if (!isnan(rule.high)) {
+            update(r, ALARM_HIGH, v > rule.high, v <= rule.high - rule.hysteresis, sample, rate);
+        }
+        if (haveRate) {
+            float magnitude = fabsf(rate);
+            update(r, ALARM_RATE, magnitude > rule.ratePerMin,
+                   magnitude <= rule.ratePerMin * ALARM_RATE_CLEAR_FRACTION, sample, rate);
+        }
+    }
+
+public:
+    AlarmMonitor() : rules(nullptr), ruleCount(0), queueHead(0), queueCount(0), droppedEvents(0) {}
+
+    /**
+     * @brief Set the rule table (kept by pointer)
+     * @param table Rules
+     * @param count Number of rules (extra rules beyond MAX_RULES are ignored)
+     */
+    void begin(const AlarmRule* table, size_t count) {
+        rules = table;
+        ruleCount = count > MAX_RULES ? MAX_RULES : count;
+        for (size_t i = 0; i < ruleCount; i++) {
+            states[i].ring = nullptr;
+            states[i].cursor = 0;
+            for (size_t k = 0; k < ALARM_KIND_COUNT; k++) {
+                states[i].active[k] = false;
+                states[i].streak[k] = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Attach a rule to its channel's accepted samples
+     * @param rule Rule index
+     * @param ring Accepted sample ring of the channel named by the rule
+     */
+    void bind(size_t rule, const AlarmSampleRing* ring) {
+        if (rule < ruleCount) {
+            states[rule].ring = ring;
+            states[rule].cursor = ring->head();
+        }
+    }
+
+    /**
+     * @brief Evaluate every rule against samples read since the last call
+     */
+    void evaluate() {
+        for (size_t r = 0; r < ruleCount; r++) {
+            RuleState& state = states[r];
+            if (state.ring == nullptr) {
+                continue;
+            }
+            if (state.cursor < state.ring->oldest()) {
+                state.cursor = state.ring->oldest();
+            }
+            while (state.cursor != state.ring->head()) {
+                evaluateSample((uint8_t)r, state.cursor++);
+            }
+        }
+    }
+
+    /**
+     * @brief Oldest queued event, or nullptr if none
+     */
+    const AlarmEvent* peek() const {
+        return queueCount == 0 ? nullptr : &queue[queueHead];
+    }
+
+    /**
+     * @brief Remove the event returned by peek() once it was published
+     */
+    void pop() {
+        if (queueCount > 0) {
+            queueHead = (queueHead + 1) % QUEUE_SIZE;
+            queueCount--;
+        }
+    }
+
+    const AlarmRule& getRule(size_t index) const {
+        return rules[index];
+    }
+
+    size_t getRuleCount() const {
+        return ruleCount;
+    }
+
+    bool isActive(size_t rule, AlarmKind kind) const {
+        return states[rule].active[kind];
+    }
+
+    /**
+     * @brief Number of alarms currently raised across all rules
+     */
+    size_t getActiveCount() const {
+        size_t n = 0;
+        for (size_t r = 0; r < ruleCount; r++) {
+            for (size_t k = 0; k < ALARM_KIND_COUNT; k++) {
+                n += states[r].active[k] ? 1 : 0;
+            }
+        }
+        return n;
+    }
+
+    uint32_t getDroppedEvents() const {
+        return droppedEvents;
+    }
+
+    static const char* kindName(AlarmKind kind) {
+        switch (kind) {
+            case ALARM_LOW:  return "low";
+            case ALARM_HIGH: return "high";
+            case ALARM_RATE: return "rate";
+            default:         return "unknown";
+        }
+    }
+};
+
+#endif // ALARM_MONITOR_H
@@ -0,0 +1,334 @@
+#ifndef BROKER_POOL_H
+#define BROKER_POOL_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+
+/**
+ * @brief A single MQTT broker endpoint as listed in MQTT_BROKER_LIST
+ */
+struct BrokerEndpoint {
+    const char* host;
+    uint16_t port;
+};
+
+/**
+ * @brief Ranked list of MQTT broker endpoints with cached DNS resolution
+ *
+ * Resolves each endpoint once and reuses the address until MQTT_DNS_CACHE_TTL
+ * expires, so PubSubClient is always handed an IPAddress instead of a hostname.
+ * A failed connect or DNS lookup keeps the address but shortens its lifetime
+ * to MQTT_DNS_FAILURE_TTL.
+ * Endpoints are ranked by measured TCP connect RTT; a failed connect moves the
+ * caller straight on to the next endpoint, and only a full round of failures
+ * should feed the exponential reconnect backoff.
+ */
+class BrokerPool {
+public:
+    static const size_t MAX_ENDPOINTS = 4;
+    static const unsigned long RTT_UNREACHABLE = 0xFFFFFFFFUL;
+
+private:
+    struct EndpointState {
+        const char* host;
+        uint16_t port;
+        IPAddress address;
+        bool resolved;
+        bool literal;                // host is a dotted IP, never needs DNS
+        unsigned long resolvedAt;    // millis() of last successful lookup
+        unsigned long ttlMs;         // how long the cached address is trusted from resolvedAt
+        unsigned long rttMs;         // smoothed connect RTT, 0 = not measured yet
+        uint16_t failures;           // consecutive connect failures
+    };
+
+    EndpointState endpoints[MAX_ENDPOINTS];
+    uint8_t ranking[MAX_ENDPOINTS];  // endpoint indices, best first
+    size_t endpointCount;
+    size_t cursor;                   // position in ranking for the current round
+    int activeIndex;                 // endpoint we are connected to, -1 if none
+    unsigned long lastProbe;
+    bool probedOnce;
+    bool probing;                    // A probe round is under way
+    size_t probeCursor;              // Next endpoint the round measures
+
+    /**
+     * @brief Resolve an endpoint, reusing the cached address while within TTL
+     * @param ep Endpoint to resolve
+     * @return true if a usable address is available
+     */
+    bool resolve(EndpointState& ep) {
+        if (ep.literal) {
+            return true;
+        }
+
+        unsigned long now = millis();
+        if (ep.resolved && now - ep.resolvedAt < ep.ttlMs) {
+            return true;
+        }
+
+        IPAddress address;
+        unsigned long start = millis();
+        if (WiFi.hostByName(ep.host, address) != 1 || address == IPAddress(0, 0, 0, 0)) {
+            Serial.printf("[MQTT] DNS lookup failed for %s\n", ep.host);
+            // Keep a stale address rather than nothing - the broker may still be there.
+            // Try DNS again only after MQTT_DNS_FAILURE_TTL, not on every retry.
+            if (ep.resolved) {
+                ep.resolvedAt = now;
+                ep.ttlMs = MQTT_DNS_FAILURE_TTL;
+            }
+            return ep.resolved;
+        }
+
+        ep.address = address;
+        ep.resolved = true;
+        ep.resolvedAt = now;
+        ep.ttlMs = MQTT_DNS_CACHE_TTL;
+
+        #ifdef DEBUG_VERBOSE
+        Serial.printf("[MQTT] Resolved %s -> %s (%lu ms)\n",
+                      ep.host, address.toString().c_str(), millis() - start);
+        #else
+        (void)start;
+        #endif
+        return true;
+    }
+
+    /**
+     * @brief Re-sort the ranking: reachable endpoints by RTT, then unreachable ones
+     *
+     * Insertion sort keeps the configured order for ties, so with no measurements
+     * the list is tried exactly as written in MQTT_BROKER_LIST.
+     */
+    void rank() {
+        for (size_t i = 0; i < endpointCount; i++) {
+            ranking[i] = i;
+        }
+        for (size_t i = 1; i < endpointCount; i++) {
+            uint8_t current = ranking[i];
+            size_t j = i;
+            while (j > 0 && rankKey(ranking[j - 1]) > rankKey(current)) {
+                ranking[j] = ranking[j - 1];
+                j--;
+            }
+            ranking[j] = current;
+        }
+    }
+
+    unsigned long rankKey(uint8_t index) const {
+        const EndpointState& ep = endpoints[index];
+        if (ep.failures > 0 || ep.rttMs == RTT_UNREACHABLE) {
+            return RTT_UNREACHABLE;
+        }
+        return ep.rttMs;
+    }
+
+    void recordRtt(EndpointState& ep, unsigned long sampleMs) {
+        if (sampleMs == 0) {
+            sampleMs = 1;  // 0 means "not measured"
+        }
+        if (ep.rttMs == 0 || ep.rttMs == RTT_UNREACHABLE) {
+            ep.rttMs = sampleMs;
+        } else {
+            ep.rttMs = (ep.rttMs * 3 + sampleMs) / 4;  // EWMA, alpha = 1/4
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param list Broker endpoints in preferred order
+     */
+    template <size_t N>
+    BrokerPool(const BrokerEndpoint (&list)[N])
+        : endpointCount(N < MAX_ENDPOINTS ? N : (size_t)MAX_ENDPOINTS), cursor(0), activeIndex(-1),
+          lastProbe(0), probedOnce(false), probing(false), probeCursor(0) {
+        for (size_t i = 0; i < endpointCount; i++) {
+            endpoints[i].host = list[i].host;
+            endpoints[i].port = list[i].port;
+            endpoints[i].resolved = false;
+            endpoints[i].literal = false;
+            endpoints[i].resolvedAt = 0;
+            endpoints[i].ttlMs = MQTT_DNS_CACHE_TTL;
+            endpoints[i].rttMs = 0;
+            endpoints[i].failures = 0;
+            ranking[i] = i;
+        }
+    }
+
+    /**
+     * @brief Parse literal IP endpoints; call once before first use
+     */
+    void begin() {
+        for (size_t i = 0; i < endpointCount; i++) {
+            IPAddress address;
+            if (address.fromString(endpoints[i].host)) {
+                endpoints[i].address = address;
+                endpoints[i].resolved = true;
+                endpoints[i].literal = true;
+            }
+        }
+        rank();
+    }
+
+    /**
+     * @brief Check if a new probe round should start
+     * @return true if never probed or MQTT_BROKER_PROBE_INTERVAL has elapsed,
+     *         and no connect round is half done (re-ranking would restart it)
+     */
+    bool isProbeDue() const {
+        return endpointCount > 1 && !probing && cursor == 0 &&
+               (!probedOnce || millis() - lastProbe >= MQTT_BROKER_PROBE_INTERVAL);
+    }
+
+    /**
+     * @brief Check if a probe round has started and not measured every endpoint yet
+     */
+    bool isProbing() const {
+        return probing;
+    }
+
+    /**
+     * @brief Measure the TCP connect RTT of the next endpoint in the probe round
+     * @return true once every endpoint was measured and the list re-ranked
+     *
+     * Blocks for at most MQTT_BROKER_PROBE_TIMEOUT, so call it once per loop()
+     * pass until it returns true. Only worth calling while disconnected and
+     * with more than one endpoint configured.
+     */
+    bool probeNext() {
+        if (!probing) {
+            Serial.printf("[MQTT] Probing %u broker endpoints...\n", (unsigned)endpointCount);
+            probing = true;
+            probeCursor = 0;
+        }
+
+        EndpointState& ep = endpoints[probeCursor];
+        if (!resolve(ep)) {
+            ep.rttMs = RTT_UNREACHABLE;
+        } else {
+            WiFiClient probeClient;
+            unsigned long start = millis();
+            bool reachable = probeClient.connect(ep.address, ep.port, MQTT_BROKER_PROBE_TIMEOUT);
+            unsigned long elapsed = millis() - start;
+            probeClient.stop();
+
+            if (reachable) {
+                ep.failures = 0;
+                recordRtt(ep, elapsed);
+            } else {
+                ep.rttMs = RTT_UNREACHABLE;
+            }
+
+            Serial.printf("[MQTT]   %s:%u -> %s (%lu ms)\n", ep.host, ep.port,
+                          reachable ? "reachable" : "unreachable", elapsed);
+        }
+
+        if (++probeCursor < endpointCount) {
+            return false;
+        }
+        probing = false;
+        lastProbe = millis();
+        probedOnce = true;
+        cursor = 0;
+        rank();
+        return true;
+    }
+
+    /**
+     * @brief Pick the next endpoint to try in this round
+     * @param index Receives the endpoint index (pass back to report*)
+     * @param address Receives the resolved address
+     * @param port Receives the broker port
+     * @return false if no endpoint in the round could be resolved
+     */
+    bool selectEndpoint(size_t& index, IPAddress& address, uint16_t& port) {
+        for (size_t tried = 0; tried < endpointCount; tried++) {
+            if (cursor >= endpointCount) {
+                cursor = 0;
+            }
+            EndpointState& ep = endpoints[ranking[cursor]];
+            if (resolve(ep)) {
+                index = ranking[cursor];
+                address = ep.address;
+                port = ep.port;
+                return true;
+            }
+            ep.failures++;
+            cursor++;
+        }
+        cursor = 0;
+        return false;
+    }
+
+    /**
+     * @brief Record a successful connection and its RTT
+     * @param index Endpoint index returned by selectEndpoint()
+     * @param connectMs Time taken by the MQTT connect call
+     */
+    void reportSuccess(size_t index, unsigned long connectMs) {
+        EndpointState& ep = endpoints[index];
+        ep.failures = 0;
+        recordRtt(ep, connectMs);
+        activeIndex = index;
+        cursor = 0;
+        rank();
+    }
+
+    /**
+     * @brief Record a failed connection and advance to the next endpoint
+     * @param index Endpoint index returned by selectEndpoint()
+     * @return true if every endpoint has now been tried in this round
+     */
+    bool reportFailure(size_t index) {
+        EndpointState& ep = endpoints[index];
+        ep.failures++;
+        // The address may have moved: keep it, but look it up again within
+        // MQTT_DNS_FAILURE_TTL instead of waiting out the full cache TTL
+        unsigned long age = millis() - ep.resolvedAt;
+        if (!ep.literal && ep.ttlMs > age + MQTT_DNS_FAILURE_TTL) {
+            ep.ttlMs = age + MQTT_DNS_FAILURE_TTL;
+        }
+        activeIndex = -1;
+        cursor++;
+        if (cursor >= endpointCount) {
+            cursor = 0;
+            rank();
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Forget the active endpoint after the connection drops
+     */
+    void markDisconnected() {
+        activeIndex = -1;
+    }
+
+    /**
+     * @brief Get the host of the endpoint currently in use
+     * @return Hostname, or "none" if not connected
+     */
+    const char* getActiveHost() const {
+        return activeIndex >= 0 ? endpoints[activeIndex].host : "none";
+    }
+
+    /**
+     * @brief Get the smoothed connect RTT of the endpoint currently in use
+     * @return RTT in milliseconds, or 0 if not connected
+     */
+    unsigned long getActiveRtt() const {
+        return activeIndex >= 0 ? endpoints[activeIndex].rttMs : 0;
+    }
+
+    /**
+     * @brief Get the number of configured endpoints
+     * @return Endpoint count
+     */
+    size_t getEndpointCount() const {
+        return endpointCount;
+    }
+};
+
+#endif // BROKER_POOL_H
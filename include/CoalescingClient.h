@@ -0,0 +1,172 @@
+#ifndef COALESCING_CLIENT_H
+#define COALESCING_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "config.h"
+
+/**
+ * @brief Client wrapper that merges small writes into one TCP write
+ *
+ * PubSubClient writes every MQTT packet with its own write() call, which the
+ * TCP stack turns into its own segment (and WiFi TX wakeup). Under the MQTT
+ * client this wrapper appends packets to a TRANSPORT_COALESCE_BYTES buffer
+ * and hands it to the socket in one write when:
+ * - the caller ends its scheduling tick (flush()),
+ * - the oldest buffered byte is TRANSPORT_FLUSH_DEADLINE_MS old (tick()),
+ * - the next packet would not fit, or
+ * - the MQTT client is about to read (so CONNECT / PINGREQ are never held
+ *   back while it waits for the broker's reply).
+ * Packets are not altered; the broker sees the same byte stream.
+ *
+ * A failed socket write is latched and reported through connected(), which
+ * makes PubSubClient reconnect as it would for a direct write failure.
+ */
+class CoalescingClient : public Client {
+public:
+    struct Stats {
+        uint32_t frames;    // write() calls from the MQTT client (= segments without coalescing)
+        uint32_t segments;  // write() calls passed to the socket
+        uint32_t bytes;
+    };
+
+private:
+    Client& inner;
+    uint8_t buffer[TRANSPORT_COALESCE_BYTES];
+    size_t pending;
+    unsigned long pendingSince;
+    bool writeError;
+    Stats stats;
+
+    bool drain() {
+        if (pending == 0) {
+            return !writeError;
+        }
+        size_t written = inner.write(buffer, pending);
+        stats.segments++;
+        stats.bytes += written;
+        if (written != pending) {
+            writeError = true;
+        }
+        pending = 0;
+        return !writeError;
+    }
+
+public:
+    CoalescingClient(Client& client)
+        : inner(client), pending(0), pendingSince(0), writeError(false) {
+        resetStats();
+    }
+
+    int connect(IPAddress ip, uint16_t port) override {
+        pending = 0;
+        writeError = false;
+        return inner.connect(ip, port);
+    }
+
+    int connect(const char* host, uint16_t port) override {
+        pending = 0;
+        writeError = false;
+        return inner.connect(host, port);
+    }
+
+    size_t write(uint8_t b) override {
+        return write(&b, 1);
+    }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (writeError) {
+            return 0;
+        }
+        stats.frames++;
+        if (pending + size > sizeof(buffer)) {
+            if (!drain()) {
+                return 0;
+            }
+        }
+        if (size > sizeof(buffer)) {
+            // Larger than the buffer: send as is
+            size_t written = inner.write(buf, size);
+            stats.segments++;
+            stats.bytes += written;
+            if (written != size) {
+                writeError = true;
+            }
+            return written;
+        }
+        if (pending == 0) {
+            pendingSince = millis();
+        }
+        memcpy(buffer + pending, buf, size);
+        pending += size;
+        return size;
+    }
+
+    int available() override {
+        drain();
+        return inner.available();
+    }
+
+    int read() override {
+        drain();
+        return inner.read();
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        drain();
+        return inner.read(buf, size);
+    }
+
+    int peek() override {
+        return inner.peek();
+    }
+
+    /**
+     * @brief Send everything buffered now (end of a scheduling tick)
+     *
+     * Does not forward to the wrapped client: WiFiClient::flush() discards
+     * received data on ESP32.
+     */
+    void flush() override {
+        drain();
+    }
+
+    void stop() override {
+        drain();
+        pending = 0;
+        inner.stop();
+    }
+
+    uint8_t connected() override {
+        return writeError ? 0 : inner.connected();
+    }
+
+    operator bool() override {
+        return !writeError && (bool)inner;
+    }
+
+    /**
+     * @brief Flush if the oldest buffered byte has waited out the deadline (call from loop)
+     */
+    void tick() {
+        if (pending > 0 && millis() - pendingSince >= TRANSPORT_FLUSH_DEADLINE_MS) {
+            drain();
+        }
+    }
+
+    size_t getPending() const {
+        return pending;
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+
+    void resetStats() {
+        stats.frames = 0;
+        stats.segments = 0;
+        stats.bytes = 0;
+    }
+};
+
+#endif // COALESCING_CLIENT_H
@@ -0,0 +1,319 @@
+#ifndef FILTER_PIPELINE_H
+#define FILTER_PIPELINE_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "Hal.h"
+#include "MovingAverage.h"
+#include "HampelFilter.h"
+#include "SampleRing.h"
+#include "HistoryArchive.h"
+#include "RuntimeSettings.h"
+
+/**
+ * @brief Outcome of pushing a sample through a filter stage
+ */
+enum StageResult {
+    STAGE_PASS,     // Continue to the next stage with the (possibly modified) value
+    STAGE_REJECT,   // Sample is invalid; downstream stages record a failure
+    STAGE_HOLD      // Sample consumed, no new output this time (e.g. decimation)
+};
+
+/*
+ * Stages are plain classes with three non-virtual members:
+ *
+ *   StageResult process(float& value);  // transform / validate one sample
+ *   void onReject();                    // an upstream stage rejected a sample
+ *   void reset();                       // drop all state
+ *
+ * A FilterPipeline inherits from every stage and walks them in declaration
+ * order through a recursive template, so the whole chain inlines into the
+ * driver's read() with no virtual dispatch and no heap allocation.
+ */
+
+/**
+ * @brief Keep every raw sample with its esp_timer timestamp
+ * @tparam SIZE Ring capacity in samples
+ *
+ * Place first so the ring holds what the sensor reported, before any
+ * validation or smoothing.
+ */
+template <size_t SIZE>
+class RecordStage : public SampleRing<SIZE> {
+public:
+    StageResult process(float& value) {
+        this->push(hal::now(), value);
+        return STAGE_PASS;
+    }
+    void onReject() {}
+    void reset() {
+        SampleRing<SIZE>::reset();
+    }
+};
+
+/**
+ * @brief Keep every sample that survived validation, with its timestamp
+ * @tparam SIZE Ring capacity in samples
+ *
+ * Place after the range and despike stages. Alarms are evaluated on this
+ * ring, so an out-of-range reading or a spike the Hampel stage replaced
+ * never trips a threshold or skews a rate.
+ */
+template <size_t SIZE>
+class AcceptStage : public SampleRing<SIZE> {
+public:
+    StageResult process(float& value) {
+        this->push(hal::now(), value);
+        return STAGE_PASS;
+    }
+    void onReject() {}
+    void reset() {
+        SampleRing<SIZE>::reset();
+    }
+};
+
+/**
+ * @brief Reject NaN and values outside a RuntimeSettings range
+ * @tparam MinField Pointer to the lower-bound member of RuntimeSettings
+ * @tparam MaxField Pointer to the upper-bound member of RuntimeSettings
+ */
+template <float RuntimeSettings::*MinField, float RuntimeSettings::*MaxField>
+class RangeStage {
+public:
+    StageResult process(float& value) {
+        if (isnan(value) || value < runtimeSettings.*MinField || value > runtimeSettings.*MaxField) {
+            return STAGE_REJECT;
+        }
+        return STAGE_PASS;
+    }
+    void onReject() {}
+    void reset() {}
+};
+
+/**
+ * @brief Replace outliers with the window median (Hampel filter)
+ * @tparam SIZE Raw window size
+ * @tparam Params Struct with static threshold() and minDeviation()
+ */
+template <size_t SIZE, typename Params>
+class DespikeStage : public HampelFilter<float, SIZE> {
+public:
+    DespikeStage() : HampelFilter<float, SIZE>(Params::threshold(), Params::minDeviation()) {}
+
+    StageResult process(float& value) {
+        this->filter(value);
+        return STAGE_PASS;
+    }
+    void onReject() {}
+    void reset() {
+        HampelFilter<float, SIZE>::reset();
+    }
+};
+
+/**
+ * @brief Fold validated samples into the channel's multi-resolution history
+ *
+ * Archives are allocated by ChannelHistory::begin(); until then (or without
+ * PSRAM) the stage only passes samples through.
+ */
+class HistoryStage : public ChannelHistory {
+public:
+    StageResult process(float& value) {
+        // Clock read even while disabled, so a replay without archives takes the same reads
+        uint32_t nowS = (uint32_t)(hal::now() / 1000000);
+        if (isEnabled()) {
+            add(nowS, value);
+        }
+        return STAGE_PASS;
+    }
+    void onReject() {}
+    void reset() {}
+};
+
+/**
+ * @brief Exponential moving average
+ * @tparam Params Struct with static alpha() in (0, 1]
+ */
+template <typename Params>
+class EmaStage {
+private:
+    float state;
+    bool primed;
+
+public:
+    EmaStage() : state(0), primed(false) {}
+
+    StageResult process(float& value) {
+        if (!primed) {
+            state = value;
+            primed = true;
+        } else {
+            state += Params::alpha() * (value - state);
+        }
+        value = state;
+        return STAGE_PASS;
+    }
+    void onReject() {}
+    void reset() {
+        primed = false;
+    }
+};
+
+/**
+ * @brief Windowed mean with success tracking (wraps MovingAverage)
+ * @tparam SIZE Buffer capacity; the active window is set at runtime
+ */
+template <size_t SIZE>
+class WindowedMeanStage : public MovingAverage<float, SIZE> {
+public:
+    StageResult process(float& value) {
+        this->add(value);
+        value = this->getAverage();
+        return STAGE_PASS;
+    }
+    void onReject() {
+        this->addFailure();
+    }
+    void reset() {
+        MovingAverage<float, SIZE>::reset();
+    }
+};
+
+/**
+ * @brief Emit only every N-th sample
+ * @tparam N Decimation factor
+ */
+template <size_t N>
+class DecimateStage {
+private:
+    size_t phase;
+
+public:
+    DecimateStage() : phase(0) {}
+
+    StageResult process(float&) {
+        phase = (phase + 1) % N;
+        return phase == 0 ? STAGE_PASS : STAGE_HOLD;
+    }
+    void onReject() {}
+    void reset() {
+        phase = 0;
+    }
+};
+
+/**
+ * @brief Recursive walker over the stage list (implementation detail)
+ */
+template <typename... Stages>
+struct PipelineWalker;
+
+template <>
+struct PipelineWalker<> {
+    template <typename P> static StageResult process(P&, float&) { return STAGE_PASS; }
+    template <typename P> static void reject(P&) {}
+    template <typename P> static void reset(P&) {}
+};
+
+template <typename Head, typename... Tail>
+struct PipelineWalker<Head, Tail...> {
+    template <typename P>
+    static StageResult process(P& pipeline, float& value) {
+        StageResult result = static_cast<Head&>(pipeline).process(value);
+        if (result == STAGE_PASS) {
+            return PipelineWalker<Tail...>::process(pipeline, value);
+        }
+        if (result == STAGE_REJECT) {
+            PipelineWalker<Tail...>::reject(pipeline);
+        }
+        return result;
+    }
+
+    template <typename P>
+    static void reject(P& pipeline) {
+        static_cast<Head&>(pipeline).onReject();
+        PipelineWalker<Tail...>::reject(pipeline);
+    }
+
+    template <typename P>
+    static void reset(P& pipeline) {
+        static_cast<Head&>(pipeline).reset();
+        PipelineWalker<Tail...>::reset(pipeline);
+    }
+};
+
+/**
+ * @brief A channel's processing chain, declared as a type
+ * @tparam Stages Stage classes in processing order (each type at most once)
+ *
+ * Example:
+ *   typedef FilterPipeline<
+ *       RecordStage<RAW_SAMPLE_RING_SIZE>,
+ *       RangeStage<&RuntimeSettings::phMin, &RuntimeSettings::phMax>,
+ *       AcceptStage<RAW_SAMPLE_RING_SIZE>,
+ *       WindowedMeanStage<MAX_AVERAGE_WINDOW>
+ *   > PHPipeline;
+ */
+template <typename... Stages>
+class FilterPipeline : public Stages... {
+private:
+    float lastOutput;
+
+    template <typename S>
+    S* findImpl(std::true_type) { return static_cast<S*>(this); }
+
+    template <typename S>
+    S* findImpl(std::false_type) { return nullptr; }
+
+public:
+    FilterPipeline() : lastOutput(0) {}
+
+    /**
+     * @brief Push one raw sample through every stage
+     * @param value Raw sample
+     * @return Result of the first stage that did not pass, or STAGE_PASS
+     */
+    StageResult push(float value) {
+        StageResult result = PipelineWalker<Stages...>::process(*this, value);
+        if (result == STAGE_PASS) {
+            lastOutput = value;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Record a failed read (the sensor produced no value at all)
+     */
+    void reject() {
+        PipelineWalker<Stages...>::reject(*this);
+    }
+
+    /**
+     * @brief Reset every stage
+     */
+    void reset() {
+        PipelineWalker<Stages...>::reset(*this);
+    }
+
+    /**
+     * @brief Get the output of the last sample that passed every stage
+     * @return Filtered value
+     */
+    float output() const {
+        return lastOutput;
+    }
+
+    /**
+     * @brief Access a stage (or a stage's base class) by type
+     * @tparam S Stage type, e.g. MovingAverage<float, MAX_AVERAGE_WINDOW>
+     *
+     * RecordStage and AcceptStage share SampleRing as a base, so look them
+     * up by stage type rather than by SampleRing.
+     * @return Pointer to the stage, or nullptr if the pipeline has none
+     */
+    template <typename S>
+    S* find() {
+        return findImpl<S>(std::integral_constant<bool, std::is_base_of<S, FilterPipeline>::value>());
+    }
+};
+
+#endif // FILTER_PIPELINE_H
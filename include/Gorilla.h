@@ -0,0 +1,414 @@
+#ifndef GORILLA_H
+#define GORILLA_H
+
+// Deliberately free of Arduino dependencies: the host decoder (tools/) includes
+// this header unchanged.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Gorilla-style block of (timestamp, float) samples
+ *
+ * Layout (little endian):
+ *   [0]      'G'
+ *   [1]      version (1)
+ *   [2..3]   sample count
+ *   [4..7]   sequence number of the first sample
+ *   [8..15]  timestamp of the first sample, microseconds
+ *   [16..]   bitstream, MSB first
+ *
+ * Timestamps are carried at millisecond resolution as delta-of-delta:
+ *   '0'                      dod == 0
+ *   '10'   + 7 bits          dod in [-63, 64]
+ *   '110'  + 9 bits          dod in [-255, 256]
+ *   '1110' + 12 bits         dod in [-2047, 2048]
+ *   '1111' + 32 bits         anything else
+ * The first sample's time is the header timestamp; its delta is 0.
+ *
+ * Values are XORed with the previous value's IEEE-754 bits:
+ *   '0'                      identical
+ *   '10'  + meaningful bits  same leading/trailing zero window as before
+ *   '11'  + 5 bits leading zeros + 5 bits (length - 1) + meaningful bits
+ * The first value is stored as 32 raw bits.
+ */
+
+#define GORILLA_HEADER_BYTES 16
+#define GORILLA_VERSION 1
+#define GORILLA_MAX_SAMPLE_BITS 80   // Worst case: 4 + 32 timestamp bits, 2 + 10 + 32 value bits
+
+/**
+ * @brief Append-only bit buffer (MSB first)
+ */
+class GorillaBitWriter {
+private:
+    uint8_t* buffer;
+    size_t capacityBits;
+    size_t bitPos;
+
+public:
+    GorillaBitWriter() : buffer(nullptr), capacityBits(0), bitPos(0) {}
+
+    void begin(uint8_t* buf, size_t capacityBytes) {
+        buffer = buf;
+        capacityBits = capacityBytes * 8;
+        bitPos = 0;
+        memset(buf, 0, capacityBytes);
+    }
+
+    void write(uint32_t value, uint8_t bits) {
+        while (bits > 0) {
+            bits--;
+            if ((value >> bits) & 1u) {
+                buffer[bitPos >> 3] |= (uint8_t)(0x80u >> (bitPos & 7));
+            }
+            bitPos++;
+        }
+    }
+
+    size_t remainingBits() const {
+        return capacityBits - bitPos;
+    }
+
+    size_t sizeBytes() const {
+        return (bitPos + 7) / 8;
+    }
+};
+
+/**
+ * @brief Bit reader matching GorillaBitWriter
+ */
+class GorillaBitReader {
+private:
+    const uint8_t* buffer;
+    size_t lengthBits;
+    size_t bitPos;
+
+public:
+    GorillaBitReader() : buffer(nullptr), lengthBits(0), bitPos(0) {}
+
+    void begin(const uint8_t* buf, size_t lengthBytes) {
+        buffer = buf;
+        lengthBits = lengthBytes * 8;
+        bitPos = 0;
+    }
+
+    /**
+     * @brief Read bits into value
+     * @return false if the stream is exhausted
+     */
+    bool read(uint32_t& value, uint8_t bits) {
+        if (bitPos + bits > lengthBits) {
+            return false;
+        }
+        value = 0;
+        while (bits > 0) {
+            value = (value << 1) | ((buffer[bitPos >> 3] >> (7 - (bitPos & 7))) & 1u);
+            bitPos++;
+            bits--;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Bytes touched so far (partial last byte included)
+     */
+    size_t consumedBytes() const {
+        return (bitPos + 7) / 8;
+    }
+};
+
+/**
+ * @brief Streaming encoder into a caller-provided block buffer
+ *
+ * append() refuses a sample once fewer than GORILLA_MAX_SAMPLE_BITS remain,
+ * so a block never ends with a partial sample; finish() fills in the header.
+ */
+class GorillaEncoder {
+private:
+    uint8_t* block;
+    GorillaBitWriter bits;
+    uint16_t count;
+    uint32_t firstSeq;
+    int64_t t0Us;
+    int64_t prevMs;
+    int64_t prevDeltaMs;
+    uint32_t prevValue;
+    uint8_t prevLeading;
+    uint8_t prevTrailing;
+
+    static uint8_t leadingZeros(uint32_t x) {
+        uint8_t n = 0;
+        for (uint32_t mask = 0x80000000u; mask != 0 && (x & mask) == 0; mask >>= 1) n++;
+        return n;
+    }
+
+    static uint8_t trailingZeros(uint32_t x) {
+        uint8_t n = 0;
+        for (uint32_t mask = 1u; mask != 0 && (x & mask) == 0; mask <<= 1) n++;
+        return n;
+    }
+
+    void writeTimestamp(int64_t ms) {
+        int64_t delta = ms - prevMs;
+        int64_t dod = delta - prevDeltaMs;
+        prevMs = ms;
+        prevDeltaMs = delta;
+
+        if (dod == 0) {
+            bits.write(0x0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            bits.write(0x2, 2);
+            bits.write((uint32_t)(dod + 63), 7);
+        } else if (dod >= -255 && dod <= 256) {
+            bits.write(0x6, 3);
+            bits.write((uint32_t)(dod + 255), 9);
+        } else if (dod >= -2047 && dod <= 2048) {
+            bits.write(0xE, 4);
+            bits.write((uint32_t)(dod + 2047), 12);
+        } else {
+            bits.write(0xF, 4);
+            bits.write((uint32_t)(int32_t)dod, 32);
+        }
+    }
+
+    void writeValue(uint32_t value) {
+        uint32_t x = value ^ prevValue;
+        prevValue = value;
+        if (x == 0) {
+            bits.write(0x0, 1);
+            return;
+        }
+        uint8_t leading = leadingZeros(x);
+        uint8_t trailing = trailingZeros(x);
+        if (leading > 31) leading = 31;
+
+        if (prevLeading + prevTrailing < 32 && leading >= prevLeading && trailing >= prevTrailing) {
+            bits.write(0x2, 2);
+            bits.write(x >> prevTrailing, 32 - prevLeading - prevTrailing);
+        } else {
+            uint8_t length = 32 - leading - trailing;
+            bits.write(0x3, 2);
+            bits.write(leading, 5);
+            bits.write(length - 1, 5);
+            bits.write(x >> trailing, length);
+            prevLeading = leading;
+            prevTrailing = trailing;
+        }
+    }
+
+public:
+    GorillaEncoder() : block(nullptr), count(0), firstSeq(0), t0Us(0), prevMs(0), prevDeltaMs(0),
+                       prevValue(0), prevLeading(0), prevTrailing(32) {}
+
+    /**
+     * @brief Start a block
+     * @param buf Block buffer (header + bitstream)
+     * @param capacity Buffer size in bytes (> GORILLA_HEADER_BYTES)
+     * @param seq Sequence number of the first sample
+     */
+    void begin(uint8_t* buf, size_t capacity, uint32_t seq) {
+        block = buf;
+        bits.begin(buf + GORILLA_HEADER_BYTES, capacity - GORILLA_HEADER_BYTES);
+        count = 0;
+        firstSeq = seq;
+        prevMs = 0;
+        prevDeltaMs = 0;
+        prevLeading = 0;
+        prevTrailing = 32;
+    }
+
+    /**
+     * @brief Add a sample
+     * @param timestampUs Sample time, microseconds
+     * @param value Sample value
+     * @return false if the block is full (sample not added)
+     */
+    bool append(int64_t timestampUs, float value) {
+        if (bits.remainingBits() < GORILLA_MAX_SAMPLE_BITS || count == 0xFFFF) {
+            return false;
+        }
+        uint32_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+
+        if (count == 0) {
+            t0Us = timestampUs;
+            prevValue = raw;
+            bits.write(raw, 32);
+        } else {
+            writeTimestamp((timestampUs - t0Us) / 1000);
+            writeValue(raw);
+        }
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Write the header
+     * @return Total block length in bytes
+     */
+    size_t finish() {
+        block[0] = 'G';
+        block[1] = GORILLA_VERSION;
+        block[2] = (uint8_t)(count & 0xFF);
+        block[3] = (uint8_t)(count >> 8);
+        for (int i = 0; i < 4; i++) {
+            block[4 + i] = (uint8_t)(firstSeq >> (8 * i));
+        }
+        for (int i = 0; i < 8; i++) {
+            block[8 + i] = (uint8_t)((uint64_t)t0Us >> (8 * i));
+        }
+        return GORILLA_HEADER_BYTES + bits.sizeBytes();
+    }
+
+    uint16_t getCount() const {
+        return count;
+    }
+};
+
+/**
+ * @brief Decoder for one block produced by GorillaEncoder
+ */
+class GorillaDecoder {
+private:
+    GorillaBitReader bits;
+    uint16_t count;
+    uint16_t decoded;
+    uint32_t firstSeq;
+    int64_t t0Us;
+    int64_t prevMs;
+    int64_t prevDeltaMs;
+    uint32_t prevValue;
+    uint8_t prevLeading;
+    uint8_t prevTrailing;
+
+    bool readTimestamp(int64_t& ms) {
+        uint32_t bit;
+        int64_t dod;
+        if (!bits.read(bit, 1)) return false;
+        if (bit == 0) {
+            dod = 0;
+        } else {
+            uint32_t v;
+            if (!bits.read(bit, 1)) return false;
+            if (bit == 0) {
+                if (!bits.read(v, 7)) return false;
+                dod = (int64_t)v - 63;
+            } else {
+                if (!bits.read(bit, 1)) return false;
+                if (bit == 0) {
+                    if (!bits.read(v, 9)) return false;
+                    dod = (int64_t)v - 255;
+                } else {
+                    if (!bits.read(bit, 1)) return false;
+                    if (bit == 0) {
+                        if (!bits.read(v, 12)) return false;
+                        dod = (int64_t)v - 2047;
+                    } else {
+                        if (!bits.read(v, 32)) return false;
+                        dod = (int32_t)v;
+                    }
+                }
+            }
+        }
+        prevDeltaMs += dod;
+        prevMs += prevDeltaMs;
+        ms = prevMs;
+        return true;
+    }
+
+    bool readValue(uint32_t& value) {
+        uint32_t bit;
+        if (!bits.read(bit, 1)) return false;
+        if (bit == 0) {
+            value = prevValue;
+            return true;
+        }
+        if (!bits.read(bit, 1)) return false;
+        if (bit == 1) {
+            uint32_t leading, lengthMinus1;
+            if (!bits.read(leading, 5) || !bits.read(lengthMinus1, 5)) return false;
+            prevLeading = (uint8_t)leading;
+            prevTrailing = (uint8_t)(32 - leading - (lengthMinus1 + 1));
+        }
+        uint32_t meaningful;
+        if (!bits.read(meaningful, 32 - prevLeading - prevTrailing)) return false;
+        prevValue ^= meaningful << prevTrailing;
+        value = prevValue;
+        return true;
+    }
+
+public:
+    GorillaDecoder() : count(0), decoded(0), firstSeq(0), t0Us(0), prevMs(0), prevDeltaMs(0),
+                       prevValue(0), prevLeading(0), prevTrailing(0) {}
+
+    /**
+     * @brief Parse the header of a block
+     * @param block Block bytes
+     * @param length Block length
+     * @return false if this is not a supported block
+     */
+    bool begin(const uint8_t* block, size_t length) {
+        if (length < GORILLA_HEADER_BYTES || block[0] != 'G' || block[1] != GORILLA_VERSION) {
+            return false;
+        }
+        count = (uint16_t)(block[2] | (block[3] << 8));
+        firstSeq = 0;
+        for (int i = 0; i < 4; i++) {
+            firstSeq |= (uint32_t)block[4 + i] << (8 * i);
+        }
+        uint64_t t0 = 0;
+        for (int i = 0; i < 8; i++) {
+            t0 |= (uint64_t)block[8 + i] << (8 * i);
+        }
+        t0Us = (int64_t)t0;
+        bits.begin(block + GORILLA_HEADER_BYTES, length - GORILLA_HEADER_BYTES);
+        decoded = 0;
+        prevMs = 0;
+        prevDeltaMs = 0;
+        return true;
+    }
+
+    /**
+     * @brief Decode the next sample
+     * @param timestampUs Receives the sample time (millisecond resolution after the first)
+     * @param value Receives the value
+     * @return false when all samples have been read or the block is truncated
+     */
+    bool next(int64_t& timestampUs, float& value) {
+        if (decoded >= count) {
+            return false;
+        }
+        uint32_t raw;
+        int64_t ms = 0;
+        if (decoded == 0) {
+            if (!bits.read(raw, 32)) return false;
+            prevValue = raw;
+        } else if (!readTimestamp(ms) || !readValue(raw)) {
+            return false;
+        }
+        timestampUs = t0Us + ms * 1000;
+        memcpy(&value, &raw, sizeof(value));
+        decoded++;
+        return true;
+    }
+
+    uint16_t getCount() const {
+        return count;
+    }
+
+    uint32_t getFirstSeq() const {
+        return firstSeq;
+    }
+
+    /**
+     * @brief Length of the block once every sample has been read
+     *
+     * Lets a reader walk a stream of concatenated blocks.
+     */
+    size_t blockLength() const {
+        return GORILLA_HEADER_BYTES + bits.consumedBytes();
+    }
+};
+
+#endif // GORILLA_H
@@ -0,0 +1,472 @@
+#ifndef GZIP_INFLATER_H
+#define GZIP_INFLATER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Streaming gzip (RFC 1952 / DEFLATE RFC 1951) decoder
+ *
+ * Pulls compressed bytes from a read callback and hands decompressed data to
+ * a write callback in chunks of up to WINDOW_SIZE bytes, so an image far
+ * larger than RAM can be inflated straight into flash. The only large buffer
+ * is the 32 KB history window supplied by the caller (PSRAM is fine).
+ * The trailer CRC-32 and length are checked before inflate() reports success.
+ *
+ * Plain C++ with no Arduino dependencies, so the host tools use the same
+ * decoder (tools/ota_pull.cpp).
+ */
+class GzipInflater {
+public:
+    static const size_t WINDOW_SIZE = 32768;
+
+    /** @brief Next input byte, or -1 at end of input / on error */
+    typedef int (*ReadFn)(void* context);
+    /** @brief Consume decompressed bytes; return false to abort */
+    typedef bool (*WriteFn)(void* context, const uint8_t* data, size_t length);
+
+    enum Result {
+        GZIP_OK = 0,
+        GZIP_BAD_HEADER,        // Not gzip / unsupported method or flags
+        GZIP_BAD_DATA,          // Invalid DEFLATE stream
+        GZIP_TRUNCATED,         // Input ended early
+        GZIP_BAD_CHECKSUM,      // CRC-32 or length in the trailer does not match
+        GZIP_WRITE_FAILED       // WriteFn returned false
+    };
+
+private:
+    struct Huffman {
+        uint16_t count[16];     // Codes per length
+        uint16_t symbol[288];   // Symbols ordered by code
+    };
+
+    uint8_t* window;
+    size_t windowPos;
+    size_t flushedPos;          // Window bytes up to here were written out
+    uint32_t outputBytes;
+    uint32_t inputBytes;
+    uint32_t crc;
+
+    ReadFn readFn;
+    void* readContext;
+    WriteFn writeFn;
+    void* writeContext;
+    uint32_t bitBuffer;
+    int bitCount;
+    bool truncated;
+    bool writeFailed;
+
+    Huffman lengthCode;
+    Huffman distanceCode;
+
+    static uint32_t crcUpdate(uint32_t crc, const uint8_t* data, size_t length) {
+        static const uint32_t table[16] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= data[i];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+        }
+        return ~crc;
+    }
+
+    int nextByte() {
+        int b = readFn(readContext);
+        if (b < 0) {
+            truncated = true;
+            return 0;
+        }
+        inputBytes++;
+        return b;
+    }
+
+    uint32_t bits(int need) {
+        uint32_t value = bitBuffer;
+        while (bitCount < need) {
+            value |= (uint32_t)nextByte() << bitCount;
+            bitCount += 8;
+        }
+        bitBuffer = value >> need;
+        bitCount -= need;
+        return value & ((1UL << need) - 1);
+    }
+
+    bool flush() {
+        if (windowPos > flushedPos && !writeFailed) {
+            if (!writeFn(writeContext, window + flushedPos, windowPos - flushedPos)) {
+                writeFailed = true;
+            }
+        }
+        crc = crcUpdate(crc, window + flushedPos, windowPos - flushedPos);
+        flushedPos = windowPos;
+        if (windowPos == WINDOW_SIZE) {
+            windowPos = flushedPos = 0;
+        }
+        return !writeFailed;
+    }
+
+    bool put(uint8_t b) {
+        window[windowPos++] = b;
+        outputBytes++;
+        return windowPos < WINDOW_SIZE || flush();
+    }
+
+    /**
+     * @brief Build a canonical Huffman table from code lengths
+     * @return 0 if complete, > 0 if incomplete, < 0 if over-subscribed
+     */
+    static int construct(Huffman& h, const uint8_t* lengths, size_t n) {
+        for (size_t len = 0; len < 16; len++) {
+            h.count[len] = 0;
+        }
+        for (size_t s = 0; s < n; s++) {
+            h.count[lengths[s]]++;
+        }
+        if (h.count[0] == (uint16_t)n) {
+            return 0;   // No codes: complete, but decoding will fail
+        }
+        int left = 1;
+        for (size_t len = 1; len < 16; len++) {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) {
+                return left;
+            }
+        }
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (size_t len = 1; len < 15; len++) {
+            offsets[len + 1] = offsets[len] + h.count[len];
+        }
+        for (size_t s = 0; s < n; s++) {
+            if (lengths[s] != 0) {
+                h.symbol[offsets[lengths[s]]++] = (uint16_t)s;
+            }
+        }
+        return left;
+    }
+
+    int decode(const Huffman& h) {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; len++) {
+            code |= (int)bits(1);
+            int count = h.count[len];
+            if (code - count < first) {
+                return h.symbol[index + (code - first)];
+            }
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+            if (truncated) {
+                return -1;
+            }
+        }
+        return -1;
+    }
+
+    Result stored() {
+        bitBuffer = 0;
+        bitCount = 0;
+        uint32_t length = bits(16);
+        uint32_t check = bits(16);
+        if (truncated) {
+            return GZIP_TRUNCATED;
+        }
+        if (length != (~check & 0xFFFF)) {
+            return GZIP_BAD_DATA;
+        }
+        while (length-- > 0) {
+            uint8_t b = (uint8_t)nextByte();
+            if (truncated) {
+                return GZIP_TRUNCATED;
+            }
+            if (!put(b)) {
+                return GZIP_WRITE_FAILED;
+            }
+        }
+        return GZIP_OK;
+    }
+
+    Result codes() {
+        static const uint16_t lengthBase[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t lengthExtra[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t distanceBase[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t distanceExtra[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        for (;;) {
+            int symbol = decode(lengthCode);
+            if (truncated) {
+                return GZIP_TRUNCATED;
+            }
+            if (symbol < 0) {
+                return GZIP_BAD_DATA;
+            }
+            if (symbol < 256) {
+                if (!put((uint8_t)symbol)) {
+                    return GZIP_WRITE_FAILED;
+                }
+                continue;
+            }
+            if (symbol == 256) {
+                return GZIP_OK;
+            }
+
+            symbol -= 257;
+            if (symbol >= 29) {
+                return GZIP_BAD_DATA;
+            }
+            uint32_t length = lengthBase[symbol] + bits(lengthExtra[symbol]);
+            symbol = decode(distanceCode);
+            if (truncated) {
+                return GZIP_TRUNCATED;
+            }
+            if (symbol < 0 || symbol >= 30) {
+                return GZIP_BAD_DATA;
+            }
+            uint32_t distance = distanceBase[symbol] + bits(distanceExtra[symbol]);
+            if (truncated) {
+                return GZIP_TRUNCATED;
+            }
+            if (distance > outputBytes) {
+                return GZIP_BAD_DATA;   // Refers back before the start of the output
+            }
+            while (length-- > 0) {
+                if (!put(window[(windowPos + WINDOW_SIZE - distance) % WINDOW_SIZE])) {
+                    return GZIP_WRITE_FAILED;
+                }
+            }
+        }
+    }
+
+    Result fixed() {
+        uint8_t lengths[288];
+        size_t s = 0;
+        for (; s < 144; s++) lengths[s] = 8;
+        for (; s < 256; s++) lengths[s] = 9;
+        for (; s < 280; s++) lengths[s] = 7;
+        for (; s < 288; s++) lengths[s] = 8;
+        construct(lengthCode, lengths, 288);
+        for (s = 0; s < 30; s++) lengths[s] = 5;
+        construct(distanceCode, lengths, 30);
+        return codes();
+    }
+
+    Result dynamic() {
+        static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        uint8_t lengths[286 + 30];
+
+        size_t literalCount = bits(5) + 257;
+        size_t distanceCount = bits(5) + 1;
+        size_t codeCount = bits(4) + 4;
+        if (truncated) {
+            return GZIP_TRUNCATED;
+        }
+        if (literalCount > 286 || distanceCount > 30) {
+            return GZIP_BAD_DATA;
+        }
+
+        size_t index = 0;
+        for (; index < codeCount; index++) {
+            lengths[order[index]] = (uint8_t)bits(3);
+        }
+        for (; index < 19; index++) {
+            lengths[order[index]] = 0;
+        }
+        if (truncated) {
+            return GZIP_TRUNCATED;
+        }
+        if (construct(lengthCode, lengths, 19) != 0) {
+            return GZIP_BAD_DATA;   // Code length code must be complete
+        }
+
+        index = 0;
+        while (index < literalCount + distanceCount) {
+            int symbol = decode(lengthCode);
+            if (truncated) {
+                return GZIP_TRUNCATED;
+            }
+            if (symbol < 0) {
+                return GZIP_BAD_DATA;
+            }
+            if (symbol < 16) {
+                lengths[index++] = (uint8_t)symbol;
+                continue;
+            }
+            uint8_t repeated = 0;
+            size_t repeat;
+            if (symbol == 16) {
+                if (index == 0) {
+                    return GZIP_BAD_DATA;
+                }
+                repeated = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (index + repeat > literalCount + distanceCount) {
+                return GZIP_BAD_DATA;
+            }
+            while (repeat-- > 0) {
+                lengths[index++] = repeated;
+            }
+        }
+        if (lengths[256] == 0) {
+            return GZIP_BAD_DATA;   // No end-of-block code
+        }
+
+        // Incomplete codes are only allowed for a single code of length 1
+        int err = construct(lengthCode, lengths, literalCount);
+        if (err < 0 || (err > 0 && literalCount != (size_t)lengthCode.count[0] + lengthCode.count[1])) {
+            return GZIP_BAD_DATA;
+        }
+        err = construct(distanceCode, lengths + literalCount, distanceCount);
+        if (err < 0 || (err > 0 && distanceCount != (size_t)distanceCode.count[0] + distanceCode.count[1])) {
+            return GZIP_BAD_DATA;
+        }
+        return codes();
+    }
+
+    Result header() {
+        enum { FHCRC = 0x02, FEXTRA = 0x04, FNAME = 0x08, FCOMMENT = 0x10 };
+        uint8_t fixedPart[10];
+        for (size_t i = 0; i < sizeof(fixedPart); i++) {
+            fixedPart[i] = (uint8_t)nextByte();
+        }
+        if (truncated) {
+            return GZIP_TRUNCATED;
+        }
+        if (fixedPart[0] != 0x1F || fixedPart[1] != 0x8B || fixedPart[2] != 8 || (fixedPart[3] & 0xE0) != 0) {
+            return GZIP_BAD_HEADER;
+        }
+        uint8_t flags = fixedPart[3];
+        if (flags & FEXTRA) {
+            size_t length = nextByte();
+            length |= (size_t)nextByte() << 8;
+            while (length-- > 0 && !truncated) {
+                nextByte();
+            }
+        }
+        if (flags & FNAME) {
+            while (nextByte() != 0 && !truncated) {}
+        }
+        if (flags & FCOMMENT) {
+            while (nextByte() != 0 && !truncated) {}
+        }
+        if (flags & FHCRC) {
+            nextByte();
+            nextByte();
+        }
+        return truncated ? GZIP_TRUNCATED : GZIP_OK;
+    }
+
+public:
+    /**
+     * @param historyWindow WINDOW_SIZE bytes owned by the caller
+     */
+    GzipInflater(uint8_t* historyWindow)
+        : window(historyWindow), windowPos(0), flushedPos(0), outputBytes(0), inputBytes(0), crc(0),
+          readFn(nullptr), readContext(nullptr), writeFn(nullptr), writeContext(nullptr),
+          bitBuffer(0), bitCount(0), truncated(false), writeFailed(false) {}
+
+    /**
+     * @brief Check for the gzip magic bytes
+     */
+    static bool isGzip(const uint8_t* data, size_t length) {
+        return length >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+    }
+
+    /**
+     * @brief Decompress one gzip member
+     * @param read Source of compressed bytes
+     * @param readCtx Passed to read
+     * @param write Sink for decompressed bytes
+     * @param writeCtx Passed to write
+     */
+    Result inflate(ReadFn read, void* readCtx, WriteFn write, void* writeCtx) {
+        readFn = read;
+        readContext = readCtx;
+        writeFn = write;
+        writeContext = writeCtx;
+        windowPos = flushedPos = 0;
+        outputBytes = inputBytes = 0;
+        crc = 0;
+        bitBuffer = 0;
+        bitCount = 0;
+        truncated = writeFailed = false;
+
+        Result result = header();
+        bool last = false;
+        while (result == GZIP_OK && !last) {
+            last = bits(1) != 0;
+            uint32_t type = bits(2);
+            if (truncated) {
+                result = GZIP_TRUNCATED;
+            } else if (type == 0) {
+                result = stored();
+            } else if (type == 1) {
+                result = fixed();
+            } else if (type == 2) {
+                result = dynamic();
+            } else {
+                result = GZIP_BAD_DATA;
+            }
+        }
+        if (result != GZIP_OK) {
+            return result;
+        }
+        if (!flush()) {
+            return GZIP_WRITE_FAILED;
+        }
+
+        // Trailer: CRC-32 and length (mod 2^32) of the uncompressed data, little endian
+        bitBuffer = 0;
+        bitCount = 0;
+        uint32_t trailer[2] = {0, 0};
+        for (size_t i = 0; i < 8; i++) {
+            trailer[i / 4] |= (uint32_t)nextByte() << (8 * (i % 4));
+        }
+        if (truncated) {
+            return GZIP_TRUNCATED;
+        }
+        if (trailer[0] != crc || trailer[1] != outputBytes) {
+            return GZIP_BAD_CHECKSUM;
+        }
+        return GZIP_OK;
+    }
+
+    uint32_t getOutputBytes() const {
+        return outputBytes;
+    }
+
+    uint32_t getInputBytes() const {
+        return inputBytes;
+    }
+
+    static const char* resultName(Result result) {
+        switch (result) {
+            case GZIP_OK:           return "ok";
+            case GZIP_BAD_HEADER:   return "bad header";
+            case GZIP_BAD_DATA:     return "bad data";
+            case GZIP_TRUNCATED:    return "truncated";
+            case GZIP_BAD_CHECKSUM: return "checksum mismatch";
+            case GZIP_WRITE_FAILED: return "write failed";
+            default:                return "unknown";
+        }
+    }
+};
+
+#endif // GZIP_INFLATER_H
@@ -3,6 +3,36 @@
 
 #include "SensorBase.h"
 #include "config.h"
+#include "RuntimeSettings.h"
+#include "FilterPipeline.h"
+#include "TraceRecorder.h"
+
+#ifdef ENABLE_WATER_LEVEL_HAMPEL
+/**
+ * @brief Hampel parameters for the water level channel
+ */
+struct WaterLevelDespikeParams {
+    static float threshold() { return HAMPEL_THRESHOLD; }
+    static float minDeviation() { return HAMPEL_WATER_LEVEL_MIN_DEVIATION; }
+};
+#endif
+
+/**
+ * @brief Water level processing: record raw -> range check -> despike -> record accepted -> history -> windowed mean
+ * 
+ * Multipath echoes land inside the valid range, so the despike stage rejects
+ * them before they reach the average.
+ */
+typedef FilterPipeline<
+    RecordStage<RAW_SAMPLE_RING_SIZE>,
+    RangeStage<&RuntimeSettings::waterLevelMin, &RuntimeSettings::waterLevelMax>,
+#ifdef ENABLE_WATER_LEVEL_HAMPEL
+    DespikeStage<HAMPEL_WINDOW, WaterLevelDespikeParams>,
+#endif
+    AcceptStage<RAW_SAMPLE_RING_SIZE>,
+    HistoryStage,
+    WindowedMeanStage<MAX_AVERAGE_WINDOW>
+> WaterLevelPipeline;
 
 /**
  * @brief HC-SR04 Ultrasonic Water Level Sensor
@@ -19,21 +49,48 @@ private:
     uint8_t echoPin;
     float currentWaterLevel;
     float lastRawDistance;
+    WaterLevelPipeline pipeline;
+    
+    // Two-phase acquisition: the echo pulse is timed by a pin-change interrupt
+    volatile int64_t echoRiseUs;
+    volatile int64_t echoFallUs;
+    volatile bool echoDone;
+    int64_t triggeredAtUs;
+    
+    /**
+     * @brief Echo pin change: timestamp both edges of the pulse
+     */
+    static void IRAM_ATTR onEcho(void* arg) {
+        HC_SR04Sensor* self = static_cast<HC_SR04Sensor*>(arg);
+        int64_t now = hal::now();
+        if (hal::digitalRead(self->echoPin)) {
+            self->echoRiseUs = now;
+        } else if (self->echoRiseUs != 0 && !self->echoDone) {
+            self->echoFallUs = now;
+            self->echoDone = true;
+        }
+    }
+    
+    /**
+     * @brief Send the 10us trigger pulse
+     */
+    void sendTriggerPulse() {
+        hal::digitalWrite(trigPin, LOW);
+        hal::delayMicroseconds(2);
+        hal::digitalWrite(trigPin, HIGH);
+        hal::delayMicroseconds(10);
+        hal::digitalWrite(trigPin, LOW);
+    }
     
     /**
      * @brief Measure raw distance using ultrasonic sensor
      * @return Distance in millimeters, or -1 on error
      */
     float measureRawDistance() {
-        // Send 10us pulse to trigger
-        digitalWrite(trigPin, LOW);
-        delayMicroseconds(2);
-        digitalWrite(trigPin, HIGH);
-        delayMicroseconds(10);
-        digitalWrite(trigPin, LOW);
+        sendTriggerPulse();
         
         // Read echo pulse duration (in microseconds)
-        long duration = pulseIn(echoPin, HIGH, HC_SR04_TIMEOUT);
+        long duration = hal::pulseIn(echoPin, HIGH, HC_SR04_TIMEOUT);
         
         // Check for timeout or invalid reading
         if (duration == 0) {
@@ -74,7 +131,11 @@ public:
      * @param echo Echo pin number
      */
     HC_SR04Sensor(uint8_t trig, uint8_t echo) 
-        : SensorBase("HC-SR04", true), trigPin(trig), echoPin(echo), currentWaterLevel(0.0), lastRawDistance(0.0) {}
+        : SensorBase("HC-SR04"), trigPin(trig), echoPin(echo), currentWaterLevel(0.0), lastRawDistance(0.0),
+          echoRiseUs(0), echoFallUs(0), echoDone(false), triggeredAtUs(0) {
+        attachPipeline(pipeline);
+        setAverageWindow(WATER_LEVEL_WINDOW);
+    }
     
     /**
      * @brief Initialize the HC-SR04 sensor
@@ -83,13 +144,13 @@ public:
     bool begin() override {
         Serial.println("[HC-SR04] Initializing sensor...");
         
-        pinMode(trigPin, OUTPUT);
-        pinMode(echoPin, INPUT);
+        hal::pinMode(trigPin, OUTPUT);
+        hal::pinMode(echoPin, INPUT);
         
-        digitalWrite(trigPin, LOW);
+        hal::digitalWrite(trigPin, LOW);
         
         // Test reading
-        delay(100);
+        hal::delay(100);
         float testDistance = measureRawDistance();
         
         if (testDistance < 0) {
@@ -100,65 +161,106 @@ public:
                          testDistance, testWaterLevel);
         }
         
+        // From here on echoes are timed by interrupt instead of pulseIn()
+        hal::attachInterruptArg(echoPin, onEcho, this, CHANGE);
+        
         Serial.println("[HC-SR04] Sensor initialized successfully");
         initialized = true;
         return true;
     }
     
+    /**
+     * @brief Re-initialize the sensor
+     * @return true if initialization successful
+     *
+     * The echo interrupt is detached first so begin()'s pulseIn() test read
+     * is not disturbed.
+     */
+    bool recover() override {
+        initialized = false;
+        hal::detachInterrupt(echoPin);
+        return begin();
+    }
+    
     /**
      * @brief Read distance from sensor
      * @return true if read successful, false otherwise
      */
     bool read() override {
+        return acquireBlocking();
+    }
+    
+    /**
+     * @brief Fire the trigger pulse; the echo is timed in the background
+     * @return true if a measurement is in progress
+     */
+    bool trigger() override {
+        if (!initialized) {
+            return false;
+        }
+        echoDone = false;
+        echoRiseUs = 0;
+        echoFallUs = 0;
+        traceRecorder.begin(TRACE_HCSR04_TRIGGER);
+        sendTriggerPulse();
+        triggeredAtUs = hal::now();
+        traceRecorder.end(TRACE_HCSR04_TRIGGER);
+        return true;
+    }
+    
+    bool isReady() const override {
+        return echoDone || hal::now() - triggeredAtUs >= HC_SR04_TIMEOUT;
+    }
+    
+    /**
+     * @brief Convert the timed echo into a water level
+     * @return true if read successful, false otherwise
+     */
+    bool collect() override {
         if (!initialized) {
             Serial.println("[HC-SR04] ERROR: Sensor not initialized");
             markFailedRead();
             return false;
         }
         
-        // Measure raw distance
-        float rawDistance = measureRawDistance();
+        // The echo was timed by the interrupt; mark whether it came back
+        traceRecorder.instant(TRACE_HCSR04_COLLECT, echoDone);
+        
+        // Same formula as measureRawDistance(): 0.343 mm/us, out and back
+        float rawDistance = -1.0;
+        if (echoDone) {
+            rawDistance = ((echoFallUs - echoRiseUs) * 0.343) / 2.0;
+        }
         lastRawDistance = rawDistance;
         
         // Check for sensor error
         if (rawDistance < 0) {
             Serial.println("[HC-SR04] ERROR: Timeout or invalid reading");
-            addFailureToAverage();  // Record failure in moving average
-            lastReadSuccess = false;
+            rejectSample(pipeline);  // Record failure in moving average
             return false;
         }
         
         // Convert to water level
         float waterLevel = convertToWaterLevel(rawDistance);
         
-        // Validate water level range - only add valid readings to moving average
-        if (waterLevel < MIN_WATER_LEVEL_CM || waterLevel > MAX_WATER_LEVEL_CM) {
+        // Range check -> despike -> average; out-of-range readings count as failures
+        if (!acceptSample(pipeline, waterLevel, currentWaterLevel)) {
             Serial.printf("[HC-SR04] WARNING: Water level out of range: %.1f cm (distance: %.1f mm) - NOT added to average\n", 
                          waterLevel, rawDistance);
             
             // Check if this might be a raised lid condition
-            if (waterLevel < MIN_WATER_LEVEL_CM) {
+            if (waterLevel < runtimeSettings.waterLevelMin) {
                 Serial.println("[HC-SR04] Possible raised lid or empty container detected");
             }
-            
-            addFailureToAverage();  // Record failure in moving average
-            lastReadSuccess = false;
             return false;  // Don't contaminate moving average with bad readings
         }
         
-        // Only add valid readings to moving average
-        addToAverage(waterLevel);
-        
-        // Update current value with averaged reading
-        currentWaterLevel = getAverage(waterLevel);
-        
         #ifdef DEBUG_VERBOSE
         Serial.printf("[HC-SR04] Raw: %.1fmm -> WaterLevel: %.1fcm | Avg: %.1fcm | Success: %.1f%% (%zu valid)\n", 
                       rawDistance, waterLevel, currentWaterLevel, 
                       getSuccessRate(), getValidReadingCount());
         #endif
         
-        lastReadSuccess = true;
         return true;
     }
     
@@ -170,6 +272,12 @@ public:
         return currentWaterLevel;
     }
     
+    void refreshFromAverage() override {
+        if (movingAverage && movingAverage->getValidCount() > 0) {
+            currentWaterLevel = movingAverage->getAverage();
+        }
+    }
+    
     /**
      * @brief Get water level as formatted string
      * @param buffer Character buffer to store result
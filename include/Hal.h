@@ -0,0 +1,193 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <esp_timer.h>
+#include "HalTrace.h"
+
+/*
+ * Hardware access of the sensor drivers
+ *
+ * Every value a driver takes from the outside world (clock, pin levels, ADC
+ * codes, pulse widths, I2C bytes) goes through these functions, so the same
+ * drivers run in three builds:
+ *   firmware (ESP_PLATFORM)   Arduino calls; results are recorded while a halRecord capture runs
+ *   host simulation           Arduino calls into the tools/sim shim (fleet_sim)
+ *   replay (HAL_REPLAY)       results come from a capture (tools/sim/HalReplay.h, tools/hal_replay)
+ * Outputs (pin writes, delays) are not recorded: they do not change what the
+ * driver computes, only when the hardware answers, and that is in the capture.
+ */
+
+#ifdef HAL_REPLAY
+#include "HalReplay.h"
+#else
+
+#ifdef ESP_PLATFORM
+#include "HalRecorder.h"
+#endif
+
+namespace hal {
+
+#ifdef ESP_PLATFORM
+inline __attribute__((always_inline)) void record(uint8_t type, uint8_t aux, int64_t value) {
+    halRecorder.record(type, aux, value);
+}
+
+/**
+ * @brief Handler attached through attachInterruptArg(), called via a recording trampoline
+ */
+struct IsrSlot {
+    void (*isr)(void*);
+    void* arg;
+    uint8_t pin;
+};
+
+inline IsrSlot* isrSlots() {
+    static IsrSlot slots[4];
+    return slots;
+}
+
+static void IRAM_ATTR isrTrampoline(void* arg) {
+    IsrSlot* slot = static_cast<IsrSlot*>(arg);
+    halRecorder.isrEnter(slot->pin);
+    slot->isr(slot->arg);
+}
+#else
+inline void record(uint8_t, uint8_t, int64_t) {}
+#endif
+
+/**
+ * @brief Monotonic time in microseconds (esp_timer)
+ */
+inline __attribute__((always_inline)) int64_t now() {
+    int64_t t = esp_timer_get_time();
+    record(HAL_REC_TIME, 0, t);
+    return t;
+}
+
+inline __attribute__((always_inline)) int digitalRead(uint8_t pin) {
+    int level = ::digitalRead(pin);
+    record(HAL_REC_DIGITAL, (uint8_t)level, 0);
+    return level;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+    ::digitalWrite(pin, level);
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    ::pinMode(pin, mode);
+}
+
+inline uint16_t analogRead(uint8_t pin) {
+    uint16_t code = ::analogRead(pin);
+    record(HAL_REC_ADC, 0, code);
+    return code;
+}
+
+inline unsigned long pulseIn(uint8_t pin, uint8_t level, unsigned long timeoutUs) {
+    unsigned long duration = ::pulseIn(pin, level, timeoutUs);
+    record(HAL_REC_PULSE, 0, (int64_t)duration);
+    return duration;
+}
+
+inline void delay(uint32_t ms) {
+    ::delay(ms);
+}
+
+inline void delayMicroseconds(uint32_t us) {
+    ::delayMicroseconds(us);
+}
+
+/**
+ * @brief Write transaction
+ * @return Wire status: 0 = acknowledged
+ */
+inline uint8_t i2cWrite(uint8_t address, const uint8_t* data, size_t length) {
+    Wire.beginTransmission(address);
+    for (size_t i = 0; i < length; i++) {
+        Wire.write(data[i]);
+    }
+    uint8_t status = Wire.endTransmission();
+    record(HAL_REC_I2C_WRITE, status, 0);
+    return status;
+}
+
+/**
+ * @brief Read transaction
+ * @return Bytes received (less than length on NACK or a short read)
+ */
+inline size_t i2cRead(uint8_t address, uint8_t* data, size_t length) {
+    size_t received = Wire.requestFrom(address, (uint8_t)length);
+    if (received > length) {
+        received = length;
+    }
+    for (size_t i = 0; i < received; i++) {
+        data[i] = (uint8_t)Wire.read();
+    }
+    #ifdef ESP_PLATFORM
+    halRecorder.recordI2cRead(data, received);
+    #endif
+    return received;
+}
+
+/**
+ * @brief Pass through the result of a library call that does its own I/O (e.g. Adafruit_SHT31::begin())
+ */
+inline int32_t outcome(int32_t result) {
+    record(HAL_REC_OUTCOME, 0, result);
+    return result;
+}
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    #ifdef ESP_PLATFORM
+    for (size_t i = 0; i < 4; i++) {
+        IsrSlot& slot = isrSlots()[i];
+        if (slot.isr == nullptr || slot.pin == pin) {
+            slot.isr = isr;
+            slot.arg = arg;
+            slot.pin = pin;
+            ::attachInterruptArg(digitalPinToInterrupt(pin), isrTrampoline, &slot, mode);
+            return;
+        }
+    }
+    #endif
+    ::attachInterruptArg(digitalPinToInterrupt(pin), isr, arg, mode);
+}
+
+inline void detachInterrupt(uint8_t pin) {
+    ::detachInterrupt(digitalPinToInterrupt(pin));
+}
+
+}  // namespace hal
+
+#endif // HAL_REPLAY
+
+/**
+ * @brief Marks the reads of one driver method as belonging to it in a capture
+ *
+ * Wrap every trigger(), poll(), collect(), begin() and recover() call made by
+ * the firmware; the replay calls the same methods in the same order. poll()
+ * is marked lazily (only if it touches the hardware), so a poll() that does
+ * no I/O must not change the driver's state.
+ */
+class HalCall {
+public:
+    HalCall(HalCallKind kind, const void* sensor) {
+        #if defined(ESP_PLATFORM) && !defined(HAL_REPLAY)
+        halRecorder.beginCall(kind, sensor, kind == HAL_CALL_POLL);
+        #else
+        (void)kind;
+        (void)sensor;
+        #endif
+    }
+
+    ~HalCall() {
+        #if defined(ESP_PLATFORM) && !defined(HAL_REPLAY)
+        halRecorder.endCall();
+        #endif
+    }
+};
+
+#endif // HAL_H
@@ -0,0 +1,435 @@
+#ifndef HAL_RECORDER_H
+#define HAL_RECORDER_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include "HalTrace.h"
+#include "config.h"
+
+static_assert(HAL_CHUNK_HEADER_BYTES + HAL_TRACE_CHUNK_BYTES <= OUTBOUND_SLOT_BYTES,
+              "A hardware capture chunk must fit one outbound slot");
+
+/**
+ * @brief Capture requested to start at the next boot (kept in RTC memory)
+ */
+struct HalBootRequest {
+    uint32_t magic;
+    uint32_t durationMs;
+};
+
+/**
+ * @brief Records every value the sensor drivers read from the hardware
+ *
+ * The drivers do their I/O through hal:: (Hal.h), which hands each result
+ * to record(); that costs one branch on a bool while no capture runs. A
+ * capture (prepare() + start()) allocates HAL_TRACE_BYTES (PSRAM if
+ * available) and appends records in the HalTrace.h format until its time is
+ * up or the buffer is full; nextChunk() then hands it out in
+ * HAL_TRACE_CHUNK_BYTES pieces and the buffer is freed after the last one.
+ *
+ * Reads are kept only inside a HalCall (a driver method called by
+ * readSensors(), initializeSensors() or the supervisor) or an interrupt
+ * handler. Interrupt-side records are queued under a spinlock and encoded by
+ * the next loop-side record, so the stream stays in the order the drivers
+ * observed the values.
+ */
+class HalRecorder {
+private:
+    static const uint32_t BOOT_MAGIC = 0x48414C42;  // "HALB"
+
+    struct IsrRecord {
+        uint8_t type;
+        uint8_t aux;
+        int64_t value;
+    };
+
+    HalTraceWriter writer;
+    uint8_t* buffer;
+    const void* sensors[HAL_TRACE_MAX_SENSORS];
+    uint8_t sensorCount;
+
+    IsrRecord isrQueue[HAL_ISR_QUEUE];
+    volatile uint8_t isrCount;
+    volatile bool isrOverflow;
+    portMUX_TYPE lock;
+
+    uint32_t captureId;
+    int64_t stopAtUs;
+    size_t sendOffset;
+    uint8_t callDepth;
+    int16_t pendingSensor;      // Lazy CALL marker not written yet (-1 = none)
+    uint8_t pendingKind;
+    volatile bool active;
+    bool dumping;
+    bool fromBoot;
+    uint8_t endReason;
+
+    uint8_t indexOf(const void* sensor) const {
+        for (uint8_t i = 0; i < sensorCount; i++) {
+            if (sensors[i] == sensor) {
+                return i;
+            }
+        }
+        return 0xFF;
+    }
+
+    void IRAM_ATTR stage(uint8_t type, uint8_t aux, int64_t value) {
+        portENTER_CRITICAL_ISR(&lock);
+        if (isrCount < HAL_ISR_QUEUE) {
+            IsrRecord& r = isrQueue[isrCount++];
+            r.type = type;
+            r.aux = aux;
+            r.value = value;
+        } else {
+            isrOverflow = true;
+        }
+        portEXIT_CRITICAL_ISR(&lock);
+    }
+
+    // Encode what interrupt handlers queued since the last loop-side record
+    void flushIsr() {
+        if (isrCount == 0 && !isrOverflow) {
+            return;
+        }
+        IsrRecord pending[HAL_ISR_QUEUE];
+        portENTER_CRITICAL(&lock);
+        uint8_t n = isrCount;
+        memcpy(pending, isrQueue, n * sizeof(IsrRecord));
+        isrCount = 0;
+        bool overflow = isrOverflow;
+        portEXIT_CRITICAL(&lock);
+        for (uint8_t i = 0; i < n; i++) {
+            write(pending[i].type, pending[i].aux, pending[i].value);
+        }
+        if (overflow) {
+            finish(HAL_END_ISR_OVERFLOW);
+        }
+    }
+
+    void write(uint8_t type, uint8_t aux, int64_t value) {
+        if (active && !writer.record(type, aux, value)) {
+            finish(HAL_END_FULL);
+        }
+    }
+
+    // Loop-side record: queued interrupt records and a lazy CALL marker go first
+    bool prepareRecord() {
+        if (xPortInIsrContext() || callDepth == 0) {
+            return false;
+        }
+        flushIsr();
+        if (pendingSensor >= 0) {
+            write(HAL_REC_CALL, pendingKind, pendingSensor);
+            pendingSensor = -1;
+        }
+        return active;
+    }
+
+    void __attribute__((noinline)) IRAM_ATTR append(uint8_t type, uint8_t aux, int64_t value) {
+        if (xPortInIsrContext()) {
+            stage(type, aux, value);
+        } else if (prepareRecord()) {
+            write(type, aux, value);
+        }
+    }
+
+    void finish(uint8_t reason) {
+        if (!active) {
+            return;
+        }
+        active = false;
+        endReason = reason;
+        writer.finish(reason);
+        dumping = true;
+        sendOffset = 0;
+        Serial.printf("[HAL] Capture %08lx done (%s): %u bytes\n", (unsigned long)captureId,
+                      halEndReasonName(reason), (unsigned)writer.getLength());
+    }
+
+    void release() {
+        if (buffer != nullptr) {
+            heap_caps_free(buffer);
+            buffer = nullptr;
+        }
+        dumping = false;
+    }
+
+public:
+    HalRecorder()
+        : buffer(nullptr), sensorCount(0), isrCount(0), isrOverflow(false), captureId(0), stopAtUs(0),
+          sendOffset(0), callDepth(0), pendingSensor(-1), pendingKind(0), active(false), dumping(false),
+          fromBoot(false), endReason(HAL_END_STOPPED) {
+        portMUX_INITIALIZE(&lock);
+    }
+
+    /**
+     * @brief Register a driver; CALL markers name it by registration order
+     */
+    void addSensor(const void* sensor) {
+        if (sensorCount < HAL_TRACE_MAX_SENSORS) {
+            sensors[sensorCount++] = sensor;
+        }
+    }
+
+    /**
+     * @brief Allocate the buffer and write the fixed header
+     * @param boot true if the drivers have not been initialized yet
+     * @return Writer for the rest of the header (sensors, channels, settings), nullptr if busy or out of memory
+     */
+    HalTraceWriter* prepare(bool boot) {
+        if (active || dumping || buffer != nullptr) {
+            return nullptr;
+        }
+        buffer = (uint8_t*)heap_caps_malloc(HAL_TRACE_BYTES, MALLOC_CAP_SPIRAM);
+        if (buffer == nullptr) {
+            buffer = (uint8_t*)heap_caps_malloc(HAL_TRACE_BYTES, MALLOC_CAP_8BIT);
+        }
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+        int64_t now = esp_timer_get_time();
+        captureId = (uint32_t)now;
+        fromBoot = boot;
+        writer.reset(buffer, HAL_TRACE_BYTES, now);
+        writer.beginCapture(captureId, now, boot ? HAL_FLAG_FROM_BOOT : 0);
+        return &writer;
+    }
+
+    /**
+     * @brief Start recording once the header is complete
+     * @param durationMs Recording time (capped at HAL_TRACE_MAX_DURATION_MS)
+     * @return false if the header did not fit (the buffer is freed)
+     */
+    bool start(uint32_t durationMs) {
+        if (buffer == nullptr || active || dumping) {
+            return false;
+        }
+        if (writer.isFull()) {
+            release();
+            return false;
+        }
+        if (durationMs > HAL_TRACE_MAX_DURATION_MS) {
+            durationMs = HAL_TRACE_MAX_DURATION_MS;
+        }
+        stopAtUs = esp_timer_get_time() + (int64_t)durationMs * 1000;
+        portENTER_CRITICAL(&lock);
+        isrCount = 0;
+        isrOverflow = false;
+        portEXIT_CRITICAL(&lock);
+        callDepth = 0;
+        pendingSensor = -1;
+        active = true;
+        return true;
+    }
+
+    /**
+     * @brief End the capture early (it also ends by itself after its duration)
+     */
+    void stop() {
+        if (active) {
+            flushIsr();
+            finish(HAL_END_STOPPED);
+        }
+    }
+
+    /**
+     * @brief Encode queued interrupt records and end a capture whose time is up (call from loop)
+     */
+    void service() {
+        if (!active) {
+            return;
+        }
+        if (esp_timer_get_time() >= stopAtUs) {
+            stop();
+        } else {
+            flushIsr();  // Echo edges between read cycles: keep the queue short
+        }
+    }
+
+    /**
+     * @brief Copy the next chunk of a finished capture
+     * @param out At least HAL_CHUNK_HEADER_BYTES + HAL_TRACE_CHUNK_BYTES bytes
+     * @return Bytes written, 0 when there is nothing (left) to send
+     */
+    size_t nextChunk(uint8_t* out) {
+        if (!dumping) {
+            return 0;
+        }
+        size_t total = writer.getLength();
+        size_t n = total - sendOffset;
+        if (n > HAL_TRACE_CHUNK_BYTES) {
+            n = HAL_TRACE_CHUNK_BYTES;
+        }
+        HalChunkHeader header;
+        header.length = (uint16_t)n;
+        header.captureId = captureId;
+        header.offset = (uint32_t)sendOffset;
+        halEncodeChunkHeader(out, header);
+        memcpy(out + HAL_CHUNK_HEADER_BYTES, buffer + sendOffset, n);
+        sendOffset += n;
+        if (sendOffset >= total) {
+            release();
+        }
+        return n > 0 ? HAL_CHUNK_HEADER_BYTES + n : 0;
+    }
+
+    /**
+     * @brief Abandon a capture or the rest of its dump
+     */
+    void discard() {
+        active = false;
+        release();
+    }
+
+    inline void record(uint8_t type, uint8_t aux, int64_t value) {
+        if (active) {
+            append(type, aux, value);
+        }
+    }
+
+    void recordI2cRead(const uint8_t* data, size_t count) {
+        if (active && prepareRecord() && !writer.recordI2cRead(data, count)) {
+            finish(HAL_END_FULL);
+        }
+    }
+
+    /**
+     * @brief An interrupt handler attached through hal::attachInterruptArg() is running
+     */
+    inline void IRAM_ATTR isrEnter(uint8_t pin) {
+        if (active) {
+            stage(HAL_REC_ISR, 0, pin);
+        }
+    }
+
+    /**
+     * @brief A driver method is about to run (see HalCall)
+     * @param lazy Write the marker only if the method touches the hardware (poll())
+     */
+    inline void beginCall(HalCallKind kind, const void* sensor, bool lazy) {
+        if (!active) {
+            return;
+        }
+        callDepth++;
+        pendingKind = (uint8_t)kind;
+        pendingSensor = indexOf(sensor);
+        if (!lazy) {
+            prepareRecord();
+        }
+    }
+
+    inline void endCall() {
+        if (callDepth > 0) {
+            callDepth--;
+        }
+        pendingSensor = -1;
+    }
+
+    /**
+     * @brief What collect() returned, for the replay to compare
+     */
+    void recordResult(const void* sensor, bool ok) {
+        if (active) {
+            flushIsr();
+            write(HAL_REC_RESULT, ok ? 1 : 0, indexOf(sensor));
+        }
+    }
+
+    /**
+     * @brief A channel average after a collect, for the replay to compare
+     */
+    void recordOutput(uint8_t channel, float value) {
+        if (active) {
+            flushIsr();
+            if (active && !writer.recordOutput(channel, value)) {
+                finish(HAL_END_FULL);
+            }
+        }
+    }
+
+    /**
+     * @brief The pH conversion table in use (at start and whenever it is rebuilt)
+     */
+    void recordPHTable(float calMid, float calLow, float calHigh, const int16_t* milliPH, size_t count) {
+        if (active) {
+            flushIsr();
+            if (active && !writer.recordPHTable(calMid, calLow, calHigh, milliPH, count)) {
+                finish(HAL_END_FULL);
+            }
+        }
+    }
+
+    /**
+     * @brief Runtime settings changed (new ranges and window sizes)
+     */
+    void recordSettings(const void* settings, size_t size) {
+        if (active) {
+            flushIsr();
+            if (active && !writer.recordSettings(settings, size)) {
+                finish(HAL_END_FULL);
+            }
+        }
+    }
+
+    /**
+     * @brief A sensor's averaging window was cleared from outside the driver
+     */
+    void recordReset(const void* sensor) {
+        if (active) {
+            flushIsr();
+            write(HAL_REC_RESET, 0, indexOf(sensor));
+        }
+    }
+
+    /**
+     * @brief Ask for a capture from the next boot on (call, then restart)
+     */
+    static void requestBootCapture(HalBootRequest& request, uint32_t durationMs) {
+        request.magic = BOOT_MAGIC;
+        request.durationMs = durationMs;
+    }
+
+    /**
+     * @brief Take a boot capture request left before a software restart (call once at boot)
+     * @return true if a capture should start now
+     */
+    static bool takeBootRequest(HalBootRequest& request, uint32_t& durationMs) {
+        // RTC memory holds garbage after power-on: only trust it across a software restart
+        bool requested = request.magic == BOOT_MAGIC && esp_reset_reason() == ESP_RST_SW;
+        durationMs = request.durationMs;
+        request.magic = 0;
+        return requested;
+    }
+
+    bool isActive() const {
+        return active;
+    }
+
+    bool isDumping() const {
+        return dumping;
+    }
+
+    bool isFromBoot() const {
+        return fromBoot;
+    }
+
+    uint32_t getCaptureId() const {
+        return captureId;
+    }
+
+    size_t getLength() const {
+        return writer.getLength();
+    }
+
+    uint8_t getEndReason() const {
+        return endReason;
+    }
+};
+
+// Defined in main.cpp; the drivers record through Hal.h
+extern HalRecorder halRecorder;
+
+#endif // HAL_RECORDER_H
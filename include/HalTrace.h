@@ -0,0 +1,556 @@
+#ifndef HAL_TRACE_H
+#define HAL_TRACE_H
+
+// Deliberately free of Arduino dependencies: the host replay tool (tools/)
+// includes this header unchanged.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "TraceFormat.h"
+
+/*
+ * Hardware capture recorded under the sensor drivers (halRecord command)
+ *
+ * A capture is one byte stream, sent to MQTT_TOPIC_HALTRACE in chunks:
+ *   [0]      'H'
+ *   [1]      version (1)
+ *   [2..3]   payload length
+ *   [4..7]   capture id
+ *   [8..11]  offset of the payload in the capture
+ *   [12..]   payload
+ *
+ * The stream starts with a header (little endian, varints are LEB128):
+ *   "HALT", version (1), flags (HAL_FLAG_*), capture id (4), start time (8, esp_timer us)
+ *   sensor count, then per sensor: name (length byte + chars), initialized flag
+ *   channel count, then per channel: name, sensor index, averaging window
+ *     (count byte, varint validity mask, count floats oldest first, running sum float)
+ *   varint RuntimeSettings size, RuntimeSettings bytes (same firmware build only)
+ *
+ * followed by records. Each record starts with a tag byte, type << 4 | aux:
+ *   TIME       zigzag varint delta to the previous TIME (the first: to the start time)
+ *   ADC        varint code
+ *   DIGITAL    aux = level
+ *   PULSE      varint microseconds
+ *   I2C_WRITE  aux = Wire status (0 = acknowledged)
+ *   I2C_READ   varint count, count bytes
+ *   OUTCOME    zigzag varint result of a library call that talks to the hardware itself
+ *   CALL       aux = HalCallKind, sensor index: the driver method the following reads belong to
+ *   ISR        pin: an interrupt handler ran; the reads up to the next marker are its own
+ *   RESULT     aux = collect() return value, sensor index
+ *   OUTPUT     channel index, float: the channel average after the collect
+ *   PH_TABLE   3 floats (calibration mid/low/high mV), 4096 zigzag varint deltas of the
+ *              milli-pH table (the eFuse ADC characterization differs per chip)
+ *   SETTINGS   varint size, RuntimeSettings bytes: new settings were applied
+ *   RESET      sensor index: the sensor's averaging window was cleared (pH calibration)
+ *   END        aux = HalEndReason
+ *
+ * Only reads made inside a CALL or an ISR are recorded; replaying the CALLs in
+ * order through the same drivers feeds every read the value the hardware gave.
+ * PH_TABLE, SETTINGS and RESET carry the few changes made to the drivers from
+ * outside them while recording.
+ */
+
+#define HAL_CHUNK_HEADER_BYTES 12
+#define HAL_TRACE_VERSION 1
+#define HAL_TRACE_MAGIC "HALT"
+#define HAL_TRACE_MAX_SENSORS 8
+#define HAL_TRACE_NAME_BYTES 24
+
+#define HAL_FLAG_FROM_BOOT 0x01     // Recording began before the drivers' begin()
+
+/**
+ * @brief Record types (part of the wire format: append only)
+ */
+enum HalRecordType {
+    HAL_REC_TIME = 1,
+    HAL_REC_ADC,
+    HAL_REC_DIGITAL,
+    HAL_REC_PULSE,
+    HAL_REC_I2C_WRITE,
+    HAL_REC_I2C_READ,
+    HAL_REC_OUTCOME,
+    HAL_REC_CALL,
+    HAL_REC_ISR,
+    HAL_REC_RESULT,
+    HAL_REC_OUTPUT,
+    HAL_REC_PH_TABLE,
+    HAL_REC_SETTINGS,
+    HAL_REC_RESET,
+    HAL_REC_END         // = 15, the last type a tag can hold
+};
+
+/**
+ * @brief Driver methods a CALL marker can name
+ */
+enum HalCallKind {
+    HAL_CALL_BEGIN = 0,
+    HAL_CALL_RECOVER,
+    HAL_CALL_TRIGGER,
+    HAL_CALL_POLL,
+    HAL_CALL_COLLECT,
+    HAL_CALL_KIND_COUNT
+};
+
+enum HalEndReason {
+    HAL_END_STOPPED = 0,        // Time up or halStop
+    HAL_END_FULL,               // Capture buffer full
+    HAL_END_ISR_OVERFLOW        // Interrupts came faster than loop() could encode them
+};
+
+inline const char* halRecordName(uint8_t type) {
+    static const char* const names[16] = {
+        "?", "time", "adc", "digital", "pulse", "i2cWrite", "i2cRead", "outcome",
+        "call", "isr", "result", "output", "phTable", "settings", "reset", "end"
+    };
+    return names[type & 0x0F];
+}
+
+inline const char* halCallName(uint8_t kind) {
+    static const char* const names[HAL_CALL_KIND_COUNT] = { "begin", "recover", "trigger", "poll", "collect" };
+    return kind < HAL_CALL_KIND_COUNT ? names[kind] : "unknown";
+}
+
+inline const char* halEndReasonName(uint8_t reason) {
+    switch (reason) {
+        case HAL_END_STOPPED:      return "stopped";
+        case HAL_END_FULL:         return "buffer full";
+        case HAL_END_ISR_OVERFLOW: return "interrupt queue overflow";
+        default:                   return "unknown";
+    }
+}
+
+/**
+ * @brief Chunk header fields
+ */
+struct HalChunkHeader {
+    uint16_t length;
+    uint32_t captureId;
+    uint32_t offset;
+};
+
+inline void halEncodeChunkHeader(uint8_t* out, const HalChunkHeader& header) {
+    out[0] = 'H';
+    out[1] = HAL_TRACE_VERSION;
+    traceWrite16(out + 2, header.length);
+    traceWrite32(out + 4, header.captureId);
+    traceWrite32(out + 8, header.offset);
+}
+
+/**
+ * @brief Parse the chunk at the start of data
+ * @return Bytes taken by the chunk, 0 if data does not start with a complete chunk
+ */
+inline size_t halDecodeChunkHeader(const uint8_t* data, size_t length, HalChunkHeader& header) {
+    if (length < HAL_CHUNK_HEADER_BYTES || data[0] != 'H' || data[1] != HAL_TRACE_VERSION) {
+        return 0;
+    }
+    header.length = traceRead16(data + 2);
+    header.captureId = traceRead32(data + 4);
+    header.offset = traceRead32(data + 8);
+    size_t size = HAL_CHUNK_HEADER_BYTES + (size_t)header.length;
+    return size <= length ? size : 0;
+}
+
+/**
+ * @brief Appends header fields and records to a fixed buffer
+ *
+ * A record that does not fit is dropped whole and the writer is marked
+ * full; the last byte is kept back so finish() can always close the stream.
+ */
+class HalTraceWriter {
+private:
+    uint8_t* buffer;
+    size_t limit;               // capacity - 1: room for the END record
+    size_t length;
+    int64_t lastTimeUs;
+    bool full;
+
+    void put(uint8_t value) {
+        if (length < limit) {
+            buffer[length] = value;
+        }
+        length++;
+    }
+
+    void putRawVarint(uint64_t value) {
+        while (value >= 0x80) {
+            put((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        put((uint8_t)value);
+    }
+
+    static uint64_t zigzag(int64_t value) {
+        return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    }
+
+    // Roll back a record that ran past the limit
+    bool commit(size_t start) {
+        if (length > limit) {
+            length = start;
+            full = true;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    HalTraceWriter() : buffer(nullptr), limit(0), length(0), lastTimeUs(0), full(true) {}
+
+    void reset(uint8_t* buf, size_t capacity, int64_t originUs) {
+        buffer = buf;
+        limit = capacity > 0 ? capacity - 1 : 0;
+        length = 0;
+        lastTimeUs = originUs;
+        full = capacity == 0;
+    }
+
+    void putByte(uint8_t value) {
+        size_t start = length;
+        put(value);
+        commit(start);
+    }
+
+    void putVarint(uint64_t value) {
+        size_t start = length;
+        putRawVarint(value);
+        commit(start);
+    }
+
+    void putZigzag(int64_t value) {
+        putVarint(zigzag(value));
+    }
+
+    void putBytes(const void* data, size_t count) {
+        size_t start = length;
+        for (size_t i = 0; i < count; i++) {
+            put(((const uint8_t*)data)[i]);
+        }
+        commit(start);
+    }
+
+    void putFloat(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint8_t raw[4];
+        traceWrite32(raw, bits);
+        putBytes(raw, sizeof(raw));
+    }
+
+    void putString(const char* text) {
+        size_t n = strlen(text);
+        if (n > HAL_TRACE_NAME_BYTES - 1) {
+            n = HAL_TRACE_NAME_BYTES - 1;
+        }
+        size_t start = length;
+        put((uint8_t)n);
+        for (size_t i = 0; i < n; i++) {
+            put((uint8_t)text[i]);
+        }
+        commit(start);
+    }
+
+    /**
+     * @brief Fixed part of the capture header
+     */
+    void beginCapture(uint32_t captureId, int64_t startUs, uint8_t flags) {
+        uint8_t raw[8];
+        putBytes(HAL_TRACE_MAGIC, 4);
+        putByte(HAL_TRACE_VERSION);
+        putByte(flags);
+        traceWrite32(raw, captureId);
+        putBytes(raw, 4);
+        traceWrite32(raw, (uint32_t)startUs);
+        traceWrite32(raw + 4, (uint32_t)((uint64_t)startUs >> 32));
+        putBytes(raw, 8);
+        lastTimeUs = startUs;
+    }
+
+    /**
+     * @brief Append one record
+     * @param value Record payload (absolute time for TIME; pin, sensor or channel for markers)
+     * @return false if the record did not fit
+     */
+    bool record(uint8_t type, uint8_t aux, int64_t value) {
+        size_t start = length;
+        put((uint8_t)(type << 4 | (aux & 0x0F)));
+        switch (type) {
+            case HAL_REC_TIME:
+                putRawVarint(zigzag(value - lastTimeUs));
+                break;
+            case HAL_REC_ADC:
+            case HAL_REC_PULSE:
+                putRawVarint((uint64_t)value);
+                break;
+            case HAL_REC_OUTCOME:
+                putRawVarint(zigzag(value));
+                break;
+            case HAL_REC_CALL:
+            case HAL_REC_ISR:
+            case HAL_REC_RESULT:
+            case HAL_REC_RESET:
+                put((uint8_t)value);
+                break;
+            default:
+                break;  // DIGITAL, I2C_WRITE: all in aux
+        }
+        if (!commit(start)) {
+            return false;
+        }
+        if (type == HAL_REC_TIME) {
+            lastTimeUs = value;
+        }
+        return true;
+    }
+
+    bool recordI2cRead(const uint8_t* data, size_t count) {
+        size_t start = length;
+        put((uint8_t)(HAL_REC_I2C_READ << 4));
+        putRawVarint(count);
+        for (size_t i = 0; i < count; i++) {
+            put(data[i]);
+        }
+        return commit(start);
+    }
+
+    bool recordOutput(uint8_t channel, float value) {
+        size_t start = length;
+        put((uint8_t)(HAL_REC_OUTPUT << 4));
+        put(channel);
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 4; i++) {
+            put((uint8_t)(bits >> (8 * i)));
+        }
+        return commit(start);
+    }
+
+    /**
+     * @brief Append a PH_TABLE record
+     * @param milliPH 4096-entry table as built by PHLookupTable
+     */
+    bool recordPHTable(float calMid, float calLow, float calHigh, const int16_t* milliPH, size_t count) {
+        size_t start = length;
+        putByte((uint8_t)(HAL_REC_PH_TABLE << 4));
+        putFloat(calMid);
+        putFloat(calLow);
+        putFloat(calHigh);
+        int16_t previous = 0;
+        for (size_t i = 0; i < count && !full; i++) {
+            putZigzag((int64_t)milliPH[i] - previous);
+            previous = milliPH[i];
+        }
+        if (full) {
+            length = start;
+            return false;
+        }
+        return true;
+    }
+
+    bool recordSettings(const void* settings, size_t size) {
+        size_t start = length;
+        put((uint8_t)(HAL_REC_SETTINGS << 4));
+        putRawVarint(size);
+        for (size_t i = 0; i < size; i++) {
+            put(((const uint8_t*)settings)[i]);
+        }
+        return commit(start);
+    }
+
+    /**
+     * @brief Close the stream (uses the byte kept back)
+     */
+    void finish(uint8_t reason) {
+        if (length <= limit) {
+            buffer[length++] = (uint8_t)(HAL_REC_END << 4 | (reason & 0x0F));
+        }
+    }
+
+    size_t getLength() const {
+        return length;
+    }
+
+    bool isFull() const {
+        return full;
+    }
+};
+
+/**
+ * @brief One decoded record
+ */
+struct HalRecord {
+    uint8_t type;
+    uint8_t aux;
+    int64_t value;              // Absolute time for TIME; code, level, status, pin, sensor or channel
+    float output;               // OUTPUT value
+    const uint8_t* bytes;       // I2C_READ data, PH_TABLE deltas
+    size_t count;
+};
+
+/**
+ * @brief Walks a capture: header fields first, then next() for every record
+ */
+class HalTraceReader {
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t position;
+    int64_t timeUs;
+    bool failed;
+
+public:
+    HalTraceReader(const uint8_t* d, size_t len)
+        : data(d), length(len), position(0), timeUs(0), failed(false) {}
+
+    uint8_t getByte() {
+        if (position >= length) {
+            failed = true;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    uint64_t getVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = getByte();
+            value |= (uint64_t)(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        failed = true;
+        return value;
+    }
+
+    int64_t getZigzag() {
+        uint64_t z = getVarint();
+        return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+    }
+
+    float getFloat() {
+        uint8_t raw[4];
+        for (int i = 0; i < 4; i++) {
+            raw[i] = getByte();
+        }
+        uint32_t bits = traceRead32(raw);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    const uint8_t* getBytes(size_t count) {
+        if (count > length - position) {
+            failed = true;
+            position = length;
+            return nullptr;
+        }
+        const uint8_t* p = data + position;
+        position += count;
+        return p;
+    }
+
+    void getString(char* out, size_t size) {
+        size_t n = getByte();
+        const uint8_t* text = getBytes(n);
+        size_t copy = text != nullptr ? (n < size - 1 ? n : size - 1) : 0;
+        if (copy > 0) {
+            memcpy(out, text, copy);
+        }
+        out[copy] = '\0';
+    }
+
+    /**
+     * @brief Parse the fixed part of the capture header
+     * @return false if this is not a capture of this version
+     */
+    bool beginCapture(uint32_t& captureId, int64_t& startUs, uint8_t& flags) {
+        const uint8_t* magic = getBytes(4);
+        if (magic == nullptr || memcmp(magic, HAL_TRACE_MAGIC, 4) != 0 || getByte() != HAL_TRACE_VERSION) {
+            return false;
+        }
+        flags = getByte();
+        const uint8_t* raw = getBytes(12);
+        if (raw == nullptr) {
+            return false;
+        }
+        captureId = traceRead32(raw);
+        startUs = (int64_t)((uint64_t)traceRead32(raw + 4) | (uint64_t)traceRead32(raw + 8) << 32);
+        timeUs = startUs;
+        return true;
+    }
+
+    /**
+     * @brief Decode the next record
+     * @return false at the end of the data or on a malformed record
+     */
+    bool next(HalRecord& r) {
+        if (position >= length) {
+            return false;
+        }
+        uint8_t tag = getByte();
+        r.type = tag >> 4;
+        r.aux = tag & 0x0F;
+        r.value = 0;
+        r.output = 0;
+        r.bytes = nullptr;
+        r.count = 0;
+        switch (r.type) {
+            case HAL_REC_TIME:
+                timeUs += getZigzag();
+                r.value = timeUs;
+                break;
+            case HAL_REC_ADC:
+            case HAL_REC_PULSE:
+                r.value = (int64_t)getVarint();
+                break;
+            case HAL_REC_DIGITAL:
+            case HAL_REC_I2C_WRITE:
+            case HAL_REC_END:
+                r.value = r.aux;
+                break;
+            case HAL_REC_I2C_READ:
+                r.count = (size_t)getVarint();
+                r.bytes = getBytes(r.count);
+                break;
+            case HAL_REC_OUTCOME:
+                r.value = getZigzag();
+                break;
+            case HAL_REC_CALL:
+            case HAL_REC_ISR:
+            case HAL_REC_RESULT:
+            case HAL_REC_RESET:
+                r.value = getByte();
+                break;
+            case HAL_REC_OUTPUT:
+                r.value = getByte();
+                r.output = getFloat();
+                break;
+            case HAL_REC_PH_TABLE:
+                // Caller decodes calibration + table with getFloat() / getZigzag()
+                break;
+            case HAL_REC_SETTINGS:
+                r.count = (size_t)getVarint();
+                r.bytes = getBytes(r.count);
+                break;
+            default:
+                failed = true;
+                break;
+        }
+        return !failed;
+    }
+
+    size_t getPosition() const {
+        return position;
+    }
+
+    int64_t getTime() const {
+        return timeUs;
+    }
+
+    bool isFailed() const {
+        return failed;
+    }
+};
+
+#endif // HAL_TRACE_H
@@ -0,0 +1,193 @@
+#ifndef HAMPEL_FILTER_H
+#define HAMPEL_FILTER_H
+
+#include <Arduino.h>
+#include <string.h>
+
+/**
+ * @brief Sliding-window Hampel outlier filter
+ * @tparam T Data type (float, int, etc.)
+ * @tparam SIZE Window size (number of raw samples the median is taken over)
+ *
+ * Keeps the last SIZE raw samples both in arrival order (to know which one
+ * to evict) and in sorted order (the order statistics). Each update finds the
+ * evicted and inserted positions by binary search; the median is then a direct
+ * index and the MAD is the k-th smallest of two sorted deviation runs, found
+ * by a further O(log N) selection. The contiguous shift on insert is bounded
+ * by the small window and stays in cache.
+ *
+ * A sample is an outlier when |x - median| > threshold * 1.4826 * MAD, with
+ * the scale never allowed below minDeviation so a perfectly flat window does
+ * not reject every small change. Outliers are replaced by the window median;
+ * the raw value still enters the window so genuine level steps are accepted
+ * once they make up half of it.
+ */
+template <typename T, size_t SIZE>
+class HampelFilter {
+private:
+    T ring[SIZE];       // Raw samples in arrival order
+    T sorted[SIZE];     // Same samples, ascending
+    size_t head;        // Next ring slot to overwrite
+    size_t count;
+    float threshold;
+    T minDeviation;
+    uint32_t processedCount;
+    uint32_t rejectedCount;
+
+    /**
+     * @brief First index in sorted[0..count) not less than value
+     */
+    size_t lowerBound(T value) const {
+        size_t lo = 0;
+        size_t hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (sorted[mid] < value) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    void removeSorted(T value) {
+        size_t pos = lowerBound(value);
+        memmove(&sorted[pos], &sorted[pos + 1], (count - pos - 1) * sizeof(T));
+        count--;
+    }
+
+    void insertSorted(T value) {
+        size_t pos = lowerBound(value);
+        memmove(&sorted[pos + 1], &sorted[pos], (count - pos) * sizeof(T));
+        sorted[pos] = value;
+        count++;
+    }
+
+    /**
+     * @brief k-th smallest (0-based) absolute deviation from sorted[m]
+     *
+     * Deviations left of the median (m - i) and right of it (i - m) are both
+     * ascending runs, so this is a k-th-of-two-sorted-arrays selection.
+     */
+    T kthDeviation(size_t m, size_t k) const {
+        const T median = sorted[m];
+        size_t leftLen = m + 1;           // sorted[m], sorted[m-1], ... sorted[0]
+        size_t rightLen = count - m - 1;  // sorted[m+1] ... sorted[count-1]
+        size_t leftStart = 0;
+        size_t rightStart = 0;
+
+        while (true) {
+            if (leftStart == leftLen) {
+                return sorted[m + 1 + rightStart + k] - median;
+            }
+            if (rightStart == rightLen) {
+                return median - sorted[m - (leftStart + k)];
+            }
+            if (k == 0) {
+                T l = median - sorted[m - leftStart];
+                T r = sorted[m + 1 + rightStart] - median;
+                return l < r ? l : r;
+            }
+
+            size_t half = (k + 1) / 2;
+            size_t li = leftStart + (half < leftLen - leftStart ? half : leftLen - leftStart) - 1;
+            size_t ri = rightStart + (half < rightLen - rightStart ? half : rightLen - rightStart) - 1;
+            T l = median - sorted[m - li];
+            T r = sorted[m + 1 + ri] - median;
+            if (l <= r) {
+                k -= li - leftStart + 1;
+                leftStart = li + 1;
+            } else {
+                k -= ri - rightStart + 1;
+                rightStart = ri + 1;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param k Rejection threshold in scaled MADs (3.0 is the usual choice)
+     * @param minDev Smallest deviation scale, in sensor units
+     */
+    HampelFilter(float k = 3.0f, T minDev = T(0))
+        : head(0), count(0), threshold(k), minDeviation(minDev), processedCount(0), rejectedCount(0) {}
+
+    /**
+     * @brief Feed a raw sample and replace it with the median if it is an outlier
+     * @param value In: raw sample; out: sample to pass on to the averaging stage
+     * @param minSamples Samples required in the window before anything is rejected
+     * @return true if the sample was rejected and replaced
+     */
+    bool filter(T& value, size_t minSamples = (SIZE + 1) / 2) {
+        processedCount++;
+
+        bool rejected = false;
+        T replacement = value;
+        if (count >= minSamples) {
+            T med = getMedian();
+            T deviation = value > med ? value - med : med - value;
+            float scale = 1.4826f * getMAD();
+            if (scale < minDeviation) {
+                scale = minDeviation;
+            }
+            if (deviation > threshold * scale) {
+                rejected = true;
+                replacement = med;
+                rejectedCount++;
+            }
+        }
+
+        // The raw value always enters the window
+        if (count == SIZE) {
+            removeSorted(ring[head]);
+        }
+        insertSorted(value);
+        ring[head] = value;
+        head = (head + 1) % SIZE;
+
+        value = replacement;
+        return rejected;
+    }
+
+    /**
+     * @brief Get the median of the window
+     * @return Median, or 0 if empty
+     */
+    T getMedian() const {
+        if (count == 0) return T(0);
+        return sorted[(count - 1) / 2];
+    }
+
+    /**
+     * @brief Get the median absolute deviation of the window
+     * @return MAD, or 0 if empty
+     */
+    T getMAD() const {
+        if (count == 0) return T(0);
+        return kthDeviation((count - 1) / 2, (count - 1) / 2);
+    }
+
+    /**
+     * @brief Clear the window (counters are kept)
+     */
+    void reset() {
+        head = 0;
+        count = 0;
+    }
+
+    size_t getCount() const {
+        return count;
+    }
+
+    uint32_t getProcessedCount() const {
+        return processedCount;
+    }
+
+    uint32_t getRejectedCount() const {
+        return rejectedCount;
+    }
+};
+
+#endif // HAMPEL_FILTER_H
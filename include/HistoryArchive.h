@@ -0,0 +1,239 @@
+#ifndef HISTORY_ARCHIVE_H
+#define HISTORY_ARCHIVE_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "config.h"
+
+/**
+ * @brief Resolution and length of one round-robin archive
+ */
+struct ArchiveSpec {
+    uint32_t resolutionS;   // Bucket width in seconds
+    uint32_t buckets;       // Number of buckets kept
+};
+
+/**
+ * @brief Aggregate of all samples that fell into one time slot
+ */
+struct RollupBucket {
+    uint32_t slot;      // Seconds since boot / resolution
+    float min;
+    float max;
+    float sum;
+    uint32_t count;     // 0 = empty
+};
+
+/**
+ * @brief Round-robin archive of fixed-width buckets
+ *
+ * Slot s lives at index s % buckets; a bucket whose stored slot differs from
+ * the one being written has aged out and is restarted. Updating is O(1) per
+ * sample, and there is no separate consolidation pass.
+ */
+class RollupArchive {
+private:
+    RollupBucket* buckets;
+    uint32_t length;
+    uint32_t resolutionS;
+    uint32_t newestSlot;
+    bool hasData;
+
+public:
+    RollupArchive() : buckets(nullptr), length(0), resolutionS(1), newestSlot(0), hasData(false) {}
+
+    /**
+     * @brief Attach bucket storage
+     * @param storage Zeroed array of spec.buckets entries
+     * @param spec Resolution and length
+     */
+    void attach(RollupBucket* storage, const ArchiveSpec& spec) {
+        buckets = storage;
+        length = spec.buckets;
+        resolutionS = spec.resolutionS;
+        hasData = false;
+    }
+
+    /**
+     * @brief Fold one sample into its bucket
+     * @param seconds Sample time in seconds since boot
+     * @param value Sample value
+     */
+    void add(uint32_t seconds, float value) {
+        if (buckets == nullptr) {
+            return;
+        }
+        uint32_t slot = seconds / resolutionS;
+        RollupBucket& b = buckets[slot % length];
+        if (b.count == 0 || b.slot != slot) {
+            b.slot = slot;
+            b.min = value;
+            b.max = value;
+            b.sum = value;
+            b.count = 1;
+        } else {
+            if (value < b.min) b.min = value;
+            if (value > b.max) b.max = value;
+            b.sum += value;
+            b.count++;
+        }
+        if (!hasData || slot > newestSlot) {
+            newestSlot = slot;
+            hasData = true;
+        }
+    }
+
+    /**
+     * @brief Get the bucket for a slot if it is still held
+     * @param slot Slot number
+     * @return Bucket, or nullptr if empty or overwritten
+     */
+    const RollupBucket* find(uint32_t slot) const {
+        if (buckets == nullptr) {
+            return nullptr;
+        }
+        const RollupBucket& b = buckets[slot % length];
+        return (b.count > 0 && b.slot == slot) ? &b : nullptr;
+    }
+
+    /**
+     * @brief Oldest slot this archive can still hold given the newest write
+     */
+    uint32_t oldestSlot() const {
+        return newestSlot >= length ? newestSlot - length + 1 : 0;
+    }
+
+    uint32_t getNewestSlot() const {
+        return newestSlot;
+    }
+
+    uint32_t getResolution() const {
+        return resolutionS;
+    }
+
+    uint32_t getLength() const {
+        return length;
+    }
+
+    bool isAllocated() const {
+        return buckets != nullptr;
+    }
+};
+
+/**
+ * @brief Multi-resolution history of one channel (RRD-style)
+ *
+ * Archives are laid out by HISTORY_ARCHIVES (finest first) and live in PSRAM;
+ * on boards without it the history stays disabled and add() is a no-op.
+ */
+class ChannelHistory {
+public:
+    static const size_t MAX_ARCHIVES = 4;
+
+private:
+    RollupArchive archives[MAX_ARCHIVES];
+    size_t archiveCount;
+
+    static const ArchiveSpec* layout(size_t& count) {
+        static const ArchiveSpec specs[] = HISTORY_ARCHIVES;
+        count = sizeof(specs) / sizeof(specs[0]);
+        if (count > MAX_ARCHIVES) {
+            count = MAX_ARCHIVES;
+        }
+        return specs;
+    }
+
+public:
+    ChannelHistory() : archiveCount(0) {}
+
+    /**
+     * @brief Bytes of PSRAM one channel needs
+     */
+    static size_t storageSize() {
+        size_t count;
+        const ArchiveSpec* specs = layout(count);
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            total += specs[i].buckets * sizeof(RollupBucket);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Allocate the archives in PSRAM
+     * @return true if allocated (or already allocated)
+     */
+    bool begin() {
+        if (archiveCount > 0) {
+            return true;
+        }
+        size_t count;
+        const ArchiveSpec* specs = layout(count);
+        RollupBucket* storage = (RollupBucket*)heap_caps_calloc(1, storageSize(), MALLOC_CAP_SPIRAM);
+        if (storage == nullptr) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            archives[i].attach(storage, specs[i]);
+            storage += specs[i].buckets;
+        }
+        archiveCount = count;
+        return true;
+    }
+
+    /**
+     * @brief Fold a sample into every archive
+     * @param seconds Sample time in seconds since boot
+     * @param value Sample value
+     */
+    void add(uint32_t seconds, float value) {
+        for (size_t i = 0; i < archiveCount; i++) {
+            archives[i].add(seconds, value);
+        }
+    }
+
+    /**
+     * @brief Pick the finest archive that still reaches back to a given time
+     * @param seconds Start of the requested range, seconds since boot
+     * @return Archive index (the coarsest one if none reaches that far)
+     */
+    size_t selectArchive(uint32_t seconds) const {
+        for (size_t i = 0; i < archiveCount; i++) {
+            const RollupArchive& a = archives[i];
+            if (seconds / a.getResolution() >= a.oldestSlot()) {
+                return i;
+            }
+        }
+        return archiveCount > 0 ? archiveCount - 1 : 0;
+    }
+
+    /**
+     * @brief Find the archive with a given resolution
+     * @param resolutionS Bucket width in seconds
+     * @param index Receives the archive index
+     * @return true if found
+     */
+    bool findArchive(uint32_t resolutionS, size_t& index) const {
+        for (size_t i = 0; i < archiveCount; i++) {
+            if (archives[i].getResolution() == resolutionS) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const RollupArchive& getArchive(size_t index) const {
+        return archives[index];
+    }
+
+    size_t getArchiveCount() const {
+        return archiveCount;
+    }
+
+    bool isEnabled() const {
+        return archiveCount > 0;
+    }
+};
+
+#endif // HISTORY_ARCHIVE_H
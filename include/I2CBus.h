@@ -0,0 +1,56 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "Hal.h"
+
+/**
+ * @brief I2C bus maintenance helpers
+ */
+class I2CBus {
+public:
+    /**
+     * @brief Free a bus held low by a slave stuck mid-transfer
+     *
+     * A slave that lost clock edges (brown-out, loose connector) can keep
+     * driving SDA low, waiting for the rest of a byte. Clocking SCL up to nine
+     * times lets it finish; a STOP condition then resets every slave's state
+     * machine. The Wire driver is restarted afterwards.
+     * @param sda SDA pin
+     * @param scl SCL pin
+     * @return true if SDA is released (bus idle) afterwards
+     */
+    static bool recover(uint8_t sda, uint8_t scl) {
+        Wire.end();
+
+        hal::pinMode(sda, INPUT_PULLUP);
+        hal::pinMode(scl, OUTPUT_OPEN_DRAIN);
+        hal::digitalWrite(scl, HIGH);
+        hal::delayMicroseconds(5);
+
+        for (int i = 0; i < 9 && hal::digitalRead(sda) == LOW; i++) {
+            hal::digitalWrite(scl, LOW);
+            hal::delayMicroseconds(5);
+            hal::digitalWrite(scl, HIGH);
+            hal::delayMicroseconds(5);
+        }
+
+        // STOP: SDA rises while SCL is high
+        hal::pinMode(sda, OUTPUT_OPEN_DRAIN);
+        hal::digitalWrite(sda, LOW);
+        hal::delayMicroseconds(5);
+        hal::digitalWrite(scl, HIGH);
+        hal::delayMicroseconds(5);
+        hal::digitalWrite(sda, HIGH);
+        hal::delayMicroseconds(5);
+
+        hal::pinMode(sda, INPUT_PULLUP);
+        bool released = hal::digitalRead(sda) == HIGH;
+
+        Wire.begin(sda, scl);
+        return released;
+    }
+};
+
+#endif // I2C_BUS_H
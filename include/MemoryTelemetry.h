@@ -0,0 +1,178 @@
+#ifndef MEMORY_TELEMETRY_H
+#define MEMORY_TELEMETRY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+#ifdef MEMORY_COUNT_ALLOCATIONS
+// Maintained by the malloc/calloc/realloc wrappers in main.cpp (-Wl,--wrap=...)
+extern volatile uint32_t memoryAllocCalls;
+extern volatile uint32_t memoryAllocBytes;
+#endif
+
+/**
+ * @brief Heap, PSRAM and task stack telemetry for the health message
+ *
+ * Free heap alone hides the two ways a long-running node runs out of memory:
+ * fragmentation (plenty free, but no block large enough) and slow leaks.
+ * report() adds, for internal RAM:
+ * - free / min-ever free / largest free block and its lowest sampled value
+ * - fragmentation: 100 - largest block as a percentage of free memory
+ * - net change of allocated bytes and blocks since the previous report
+ *   (a steady positive drift is a leak)
+ * - allocation calls and bytes per minute when MEMORY_COUNT_ALLOCATIONS is set
+ * plus PSRAM free / min-ever free and the stack high-water mark of each task
+ * in MEMORY_WATCHED_TASKS.
+ */
+class MemoryTelemetry {
+public:
+    static const size_t MAX_TASKS = 8;
+
+private:
+    struct WatchedTask {
+        const char* name;
+        TaskHandle_t handle;    // Resolved by name when first reported (tasks may start later)
+    };
+
+    WatchedTask tasks[MAX_TASKS];
+    size_t taskCount;
+    size_t minLargestBlock;
+    size_t lastAllocatedBytes;
+    size_t lastAllocatedBlocks;
+    unsigned long lastReportAt;
+    unsigned long lastSampleAt;
+    uint32_t lastAllocCalls;
+    uint32_t lastAllocBytes;
+
+    static uint8_t fragmentationOf(const multi_heap_info_t& info) {
+        if (info.total_free_bytes == 0) {
+            return 0;
+        }
+        return (uint8_t)(100 - (uint64_t)info.largest_free_block * 100 / info.total_free_bytes);
+    }
+
+public:
+    MemoryTelemetry()
+        : taskCount(0), minLargestBlock(0), lastAllocatedBytes(0), lastAllocatedBlocks(0),
+          lastReportAt(0), lastSampleAt(0), lastAllocCalls(0), lastAllocBytes(0) {}
+
+    /**
+     * @brief Take the baseline and register MEMORY_WATCHED_TASKS
+     */
+    void begin() {
+        static const char* const watched[] = MEMORY_WATCHED_TASKS;
+        for (size_t i = 0; i < sizeof(watched) / sizeof(watched[0]); i++) {
+            watchTask(watched[i]);
+        }
+
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, MALLOC_CAP_INTERNAL);
+        minLargestBlock = info.largest_free_block;
+        lastAllocatedBytes = info.total_allocated_bytes;
+        lastAllocatedBlocks = info.allocated_blocks;
+        lastReportAt = lastSampleAt = millis();
+        #ifdef MEMORY_COUNT_ALLOCATIONS
+        lastAllocCalls = memoryAllocCalls;
+        lastAllocBytes = memoryAllocBytes;
+        #endif
+    }
+
+    /**
+     * @brief Report a task's stack high-water mark
+     * @param name FreeRTOS task name
+     * @param handle Task handle, or nullptr to look the name up when reporting
+     */
+    bool watchTask(const char* name, TaskHandle_t handle = nullptr) {
+        if (taskCount >= MAX_TASKS) {
+            return false;
+        }
+        tasks[taskCount].name = name;
+        tasks[taskCount].handle = handle;
+        taskCount++;
+        return true;
+    }
+
+    /**
+     * @brief Track the largest free block between reports (call from loop)
+     *
+     * The largest block can dip during bursts (TLS handshakes, MQTT
+     * reconnects) and recover before a health message; sampling every
+     * MEMORY_SAMPLE_INTERVAL_MS keeps the dip visible.
+     */
+    void sample() {
+        unsigned long now = millis();
+        if (now - lastSampleAt < MEMORY_SAMPLE_INTERVAL_MS) {
+            return;
+        }
+        lastSampleAt = now;
+        size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+        if (largest < minLargestBlock) {
+            minLargestBlock = largest;
+        }
+    }
+
+    /**
+     * @brief Add the "memory" object to a health message and start a new interval
+     */
+    void report(JsonObject memory) {
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, MALLOC_CAP_INTERNAL);
+        if (info.largest_free_block < minLargestBlock) {
+            minLargestBlock = info.largest_free_block;
+        }
+
+        unsigned long now = millis();
+
+        memory["free"] = info.total_free_bytes;
+        memory["minFree"] = info.minimum_free_bytes;
+        memory["largest"] = info.largest_free_block;
+        memory["minLargest"] = minLargestBlock;
+        memory["frag"] = fragmentationOf(info);
+        memory["allocDelta"] = (long)info.total_allocated_bytes - (long)lastAllocatedBytes;
+        memory["blocksDelta"] = (long)info.allocated_blocks - (long)lastAllocatedBlocks;
+        #ifdef MEMORY_COUNT_ALLOCATIONS
+        float minutes = (now - lastReportAt) / 60000.0f;
+        uint32_t calls = memoryAllocCalls;
+        uint32_t bytes = memoryAllocBytes;
+        if (minutes > 0) {
+            memory["allocsPerMin"] = (uint32_t)((calls - lastAllocCalls) / minutes);
+            memory["allocKBPerMin"] = (uint32_t)((bytes - lastAllocBytes) / 1024.0f / minutes);
+        }
+        lastAllocCalls = calls;
+        lastAllocBytes = bytes;
+        #endif
+
+        if (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0) {
+            memory["psramFree"] = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+            memory["psramMinFree"] = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+        }
+
+        // Unused stack bytes per task: the margin left before a stack overflow
+        JsonObject stacks = memory.createNestedObject("stacks");
+        for (size_t i = 0; i < taskCount; i++) {
+            WatchedTask& task = tasks[i];
+            if (task.handle == nullptr) {
+                task.handle = xTaskGetHandle(task.name);
+            }
+            if (task.handle != nullptr) {
+                stacks[task.name] = uxTaskGetStackHighWaterMark(task.handle);
+            }
+        }
+
+        Serial.printf("[MEMORY] Heap %u free (min %u), largest block %u (min %u), %u%% fragmented, %+ld bytes since last report\n",
+                      (unsigned)info.total_free_bytes, (unsigned)info.minimum_free_bytes,
+                      (unsigned)info.largest_free_block, (unsigned)minLargestBlock, (unsigned)fragmentationOf(info),
+                      (long)info.total_allocated_bytes - (long)lastAllocatedBytes);
+
+        lastAllocatedBytes = info.total_allocated_bytes;
+        lastAllocatedBlocks = info.allocated_blocks;
+        lastReportAt = now;
+        minLargestBlock = info.largest_free_block;
+    }
+};
+
+#endif // MEMORY_TELEMETRY_H
@@ -0,0 +1,144 @@
+#ifndef METRICS_PAGE_H
+#define METRICS_PAGE_H
+
+// Deliberately free of Arduino dependencies so the page and the request
+// classification can be exercised on the host.
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @brief Prometheus text exposition (format 0.0.4) written into a fixed buffer
+ *
+ * No allocation: every line is formatted straight into the caller's buffer.
+ * Once a line does not fit, the page is marked overflowed and everything
+ * after the last complete line is dropped, so a truncated page still parses.
+ */
+class MetricsPage {
+private:
+    char* buffer;
+    size_t capacity;
+    size_t length;
+    bool overflowed;
+
+    __attribute__((format(printf, 2, 3))) void append(const char* format, ...) {
+        if (overflowed) {
+            return;
+        }
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buffer + length, capacity - length, format, args);
+        va_end(args);
+        if (n < 0 || (size_t)n >= capacity - length) {
+            overflowed = true;
+            buffer[length] = '\0';
+            return;
+        }
+        length += (size_t)n;
+    }
+
+    void appendValue(double value) {
+        if (isnan(value)) {
+            append(" NaN\n");
+        } else if (isinf(value)) {
+            append(value > 0 ? " +Inf\n" : " -Inf\n");
+        } else if (value == floor(value) && fabs(value) < 1e15) {
+            append(" %.0f\n", value);  // Counters: every digit
+        } else {
+            append(" %.7g\n", value);  // Float precision: no 6.849999905 for 6.85f
+        }
+    }
+
+public:
+    MetricsPage(char* buf, size_t cap) : buffer(buf), capacity(cap), length(0), overflowed(cap == 0) {
+        if (cap > 0) {
+            buffer[0] = '\0';
+        }
+    }
+
+    /**
+     * @brief Start a metric family: HELP and TYPE lines
+     * @param type "gauge" or "counter"
+     */
+    void family(const char* name, const char* type, const char* help) {
+        append("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void sample(const char* name, double value) {
+        if (overflowed) {
+            return;     // Nothing to roll back (and no room for a terminator if capacity is 0)
+        }
+        size_t start = length;
+        append("%s", name);
+        appendValue(value);
+        if (overflowed) {
+            length = start;
+            buffer[length] = '\0';
+        }
+    }
+
+    /**
+     * @brief Sample with one label, e.g. name{channel="pH"} 6.85
+     */
+    void sample(const char* name, const char* label, const char* labelValue, double value) {
+        if (overflowed) {
+            return;     // Nothing to roll back (and no room for a terminator if capacity is 0)
+        }
+        size_t start = length;
+        append("%s{%s=\"%s\"}", name, label, labelValue);
+        appendValue(value);
+        if (overflowed) {
+            length = start;
+            buffer[length] = '\0';
+        }
+    }
+
+    size_t getLength() const {
+        return length;
+    }
+
+    bool isOverflowed() const {
+        return overflowed;
+    }
+
+    enum Request {
+        REQUEST_INCOMPLETE = 0,     // Request line not complete yet
+        REQUEST_METRICS,            // GET /metrics
+        REQUEST_NOT_FOUND,          // Any other GET
+        REQUEST_BAD                 // Not a GET or request line too long
+    };
+
+    /**
+     * @brief Classify the request held in data (only the request line matters)
+     * @param full true if the receive buffer is full, so an incomplete header is an error
+     */
+    static Request classifyRequest(const char* data, size_t length, bool full) {
+        const char* end = nullptr;
+        for (size_t i = 0; i + 1 < length; i++) {
+            if (data[i] == '\r' && data[i + 1] == '\n') {
+                end = data + i;
+                break;
+            }
+        }
+        if (end == nullptr) {
+            return full ? REQUEST_BAD : REQUEST_INCOMPLETE;
+        }
+        size_t lineLength = end - data;
+        if (lineLength < 4 || memcmp(data, "GET ", 4) != 0) {
+            return REQUEST_BAD;
+        }
+        const char* path = data + 4;
+        const char* pathEnd = (const char*)memchr(path, ' ', end - path);
+        size_t pathLength = pathEnd != nullptr ? (size_t)(pathEnd - path) : (size_t)(end - path);
+        // "/metrics" or "/metrics?..." (Prometheus may add query parameters)
+        if (pathLength >= 8 && memcmp(path, "/metrics", 8) == 0 && (pathLength == 8 || path[8] == '?')) {
+            return REQUEST_METRICS;
+        }
+        return REQUEST_NOT_FOUND;
+    }
+};
+
+#endif // METRICS_PAGE_H
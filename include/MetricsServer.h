@@ -0,0 +1,265 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include "MetricsPage.h"
+#include "config.h"
+
+/**
+ * @brief Prometheus scrape endpoint served from the AsyncTCP task
+ *
+ * Requests are answered entirely in AsyncTCP callbacks (async_tcp task), so a
+ * slow or stalled scraper never blocks loop(). The page is double buffered:
+ * loop() renders into the back page with a MetricsPage and publish()es it;
+ * each response pins the front page and hands it to lwIP without copying
+ * (the pin is dropped once every byte is acknowledged or the connection is
+ * gone). A back page still pinned by a slow reader is simply not rendered
+ * into until it is released.
+ *
+ * loop() only renders while someone is scraping: isRenderDue() asks for a
+ * fresh page every METRICS_REFRESH_MS for METRICS_ACTIVE_MS after the last
+ * request, so an unscraped node pays nothing.
+ */
+class MetricsServer {
+private:
+    struct Page {
+        char* text;
+        size_t length;
+        uint8_t readers;        // Responses still sending from this page
+    };
+
+    struct Connection {
+        AsyncClient* client;
+        Page* page;             // Pinned page, nullptr before the response starts
+        char request[METRICS_REQUEST_BYTES];
+        size_t requestLength;
+        char header[160];
+        size_t headerLength;
+        size_t queued;          // Response bytes handed to lwIP
+        size_t acked;
+        size_t total;
+    };
+
+    AsyncServer server;
+    Page pages[2];
+    uint8_t front;
+    portMUX_TYPE lock;
+    Connection connections[METRICS_MAX_CLIENTS];
+    volatile uint32_t lastRequestMs;
+    volatile uint32_t requests;
+    volatile uint32_t rejected;     // Refused: all connection slots busy
+    uint32_t lastRenderMs;
+    bool started;
+
+    Connection* findConnection(AsyncClient* client) {
+        for (size_t i = 0; i < METRICS_MAX_CLIENTS; i++) {
+            if (connections[i].client == client) {
+                return &connections[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void release(Connection& c) {
+        if (c.page != nullptr) {
+            portENTER_CRITICAL(&lock);
+            c.page->readers--;
+            portEXIT_CRITICAL(&lock);
+            c.page = nullptr;
+        }
+        c.client = nullptr;
+    }
+
+    // Queue as much of header + body as the send buffer takes (no copies)
+    void sendMore(Connection& c) {
+        while (c.queued < c.total) {
+            size_t space = c.client->space();
+            if (space == 0) {
+                break;
+            }
+            const char* data;
+            size_t remaining;
+            if (c.queued < c.headerLength) {
+                data = c.header + c.queued;
+                remaining = c.headerLength - c.queued;
+            } else {
+                size_t offset = c.queued - c.headerLength;
+                data = c.page != nullptr ? c.page->text + offset : "";
+                remaining = c.total - c.queued;
+            }
+            size_t chunk = remaining < space ? remaining : space;
+            size_t added = c.client->add(data, chunk, 0);
+            if (added == 0) {
+                break;
+            }
+            c.queued += added;
+        }
+        c.client->send();
+    }
+
+    void respond(Connection& c, MetricsPage::Request request) {
+        requests++;
+        if (request != MetricsPage::REQUEST_METRICS) {
+            const char* status = request == MetricsPage::REQUEST_NOT_FOUND ? "404 Not Found" : "400 Bad Request";
+            c.headerLength = snprintf(c.header, sizeof(c.header),
+                                      "HTTP/1.0 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+            c.total = c.headerLength;
+        } else {
+            lastRequestMs = millis();
+            portENTER_CRITICAL(&lock);
+            c.page = &pages[front];
+            c.page->readers++;
+            size_t bodyLength = c.page->length;
+            portEXIT_CRITICAL(&lock);
+            c.headerLength = snprintf(c.header, sizeof(c.header),
+                                      "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                      "Content-Length: %u\r\nConnection: close\r\n\r\n", (unsigned)bodyLength);
+            c.total = c.headerLength + bodyLength;
+        }
+        sendMore(c);
+    }
+
+    static void onClient(void* arg, AsyncClient* client) {
+        MetricsServer* self = static_cast<MetricsServer*>(arg);
+        Connection* c = self->findConnection(nullptr);
+        if (c == nullptr) {
+            self->rejected++;
+            client->onDisconnect([](void*, AsyncClient* c) { delete c; }, nullptr);
+            client->close(true);
+            return;
+        }
+        memset(c, 0, sizeof(Connection));
+        c->client = client;
+        client->setRxTimeout(METRICS_TIMEOUT_S);
+        client->onData(onData, self);
+        client->onAck(onAck, self);
+        client->onTimeout(onTimeout, self);
+        client->onDisconnect(onDisconnect, self);
+    }
+
+    static void onData(void* arg, AsyncClient* client, void* data, size_t length) {
+        MetricsServer* self = static_cast<MetricsServer*>(arg);
+        Connection* c = self->findConnection(client);
+        if (c == nullptr || c->total > 0) {
+            return;  // Rest of a request already being answered
+        }
+        size_t room = sizeof(c->request) - c->requestLength;
+        size_t take = length < room ? length : room;
+        memcpy(c->request + c->requestLength, data, take);
+        c->requestLength += take;
+        MetricsPage::Request request = MetricsPage::classifyRequest(c->request, c->requestLength,
+                                                                    c->requestLength == sizeof(c->request));
+        if (request != MetricsPage::REQUEST_INCOMPLETE) {
+            self->respond(*c, request);
+        }
+    }
+
+    static void onAck(void* arg, AsyncClient* client, size_t length, uint32_t) {
+        MetricsServer* self = static_cast<MetricsServer*>(arg);
+        Connection* c = self->findConnection(client);
+        if (c == nullptr) {
+            return;
+        }
+        c->acked += length;
+        if (c->acked >= c->total) {
+            client->close();
+        } else {
+            self->sendMore(*c);
+        }
+    }
+
+    static void onTimeout(void*, AsyncClient* client, uint32_t) {
+        client->close();
+    }
+
+    static void onDisconnect(void* arg, AsyncClient* client) {
+        MetricsServer* self = static_cast<MetricsServer*>(arg);
+        Connection* c = self->findConnection(client);
+        if (c != nullptr) {
+            self->release(*c);
+        }
+        delete client;
+    }
+
+public:
+    MetricsServer()
+        : server(METRICS_HTTP_PORT), front(0), lastRequestMs(0), requests(0), rejected(0), lastRenderMs(0),
+          started(false) {
+        portMUX_INITIALIZE(&lock);
+        memset(pages, 0, sizeof(pages));
+        memset(connections, 0, sizeof(connections));
+    }
+
+    /**
+     * @brief Allocate the pages and start listening (call once the network is up)
+     */
+    bool begin() {
+        if (started) {
+            return true;
+        }
+        for (size_t i = 0; i < 2; i++) {
+            // Internal RAM: lwIP reads the page directly while sending
+            pages[i].text = (char*)heap_caps_malloc(METRICS_PAGE_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (pages[i].text == nullptr) {
+                Serial.println("[METRICS] ✗ No memory for metrics pages");
+                return false;
+            }
+            pages[i].text[0] = '\0';
+        }
+        server.onClient(onClient, this);
+        server.begin();
+        started = true;
+        Serial.printf("[METRICS] ✓ Serving http://%s:%d/metrics\n", WiFi.localIP().toString().c_str(),
+                      METRICS_HTTP_PORT);
+        return true;
+    }
+
+    /**
+     * @brief True if loop() should render a new page now
+     */
+    bool isRenderDue(uint32_t now) const {
+        if (!started) {
+            return false;
+        }
+        bool scraped = lastRequestMs != 0 && now - lastRequestMs < METRICS_ACTIVE_MS;
+        bool empty = pages[front].length == 0;
+        return (scraped || empty) && now - lastRenderMs >= METRICS_REFRESH_MS;
+    }
+
+    /**
+     * @brief Back page to render into, or nullptr while a response still reads it
+     */
+    char* acquireBackPage(size_t& capacity) {
+        Page& back = pages[front ^ 1];
+        portENTER_CRITICAL(&lock);
+        bool busy = back.readers > 0;
+        portEXIT_CRITICAL(&lock);
+        capacity = METRICS_PAGE_BYTES;
+        return busy ? nullptr : back.text;
+    }
+
+    /**
+     * @brief Make the back page rendered with acquireBackPage() the one served
+     */
+    void publish(size_t length, uint32_t now) {
+        portENTER_CRITICAL(&lock);
+        pages[front ^ 1].length = length;
+        front ^= 1;
+        portEXIT_CRITICAL(&lock);
+        lastRenderMs = now;
+    }
+
+    uint32_t getRequestCount() const {
+        return requests;
+    }
+
+    uint32_t getRejectedCount() const {
+        return rejected;
+    }
+};
+
+#endif // METRICS_SERVER_H
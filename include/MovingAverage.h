@@ -6,7 +6,10 @@
 /**
  * @brief Template class for calculating moving average of sensor readings
  * @tparam T Data type (float, int, etc.)
- * @tparam SIZE Window size for moving average
+ * @tparam SIZE Maximum window size (buffer capacity)
+ *
+ * The active window defaults to SIZE and can be shrunk at runtime with
+ * setWindowSize() without reallocating.
  */
 template <typename T, size_t SIZE>
 class MovingAverage {
@@ -17,9 +20,10 @@ private:
     size_t count;
     T sum;
     size_t validCount;  // Count of valid readings in the window
+    size_t window;      // Active window size (<= SIZE)
     
 public:
-    MovingAverage() : index(0), count(0), sum(0), validCount(0) {
+    MovingAverage() : index(0), count(0), sum(0), validCount(0), window(SIZE) {
         for (size_t i = 0; i < SIZE; i++) {
             buffer[i] = 0;
             validBuffer[i] = false;
@@ -64,10 +68,10 @@ public:
         }
         
         // Update index (circular buffer)
-        index = (index + 1) % SIZE;
+        index = (index + 1) % window;
         
         // Track how many values we've received (valid or invalid)
-        if (count < SIZE) {
+        if (count < window) {
             count++;
         }
     }
@@ -84,11 +88,75 @@ public:
     }
     
     /**
-     * @brief Check if the buffer is full (has SIZE samples)
+     * @brief Check if the buffer is full (has a full window of samples)
      * @return true if buffer is full, false otherwise
      */
     bool isFull() const {
-        return count >= SIZE;
+        return count >= window;
+    }
+    
+    /**
+     * @brief Change the active window size, keeping the most recent samples
+     * @param newWindow New window size, clamped to 1..SIZE
+     */
+    void setWindowSize(size_t newWindow) {
+        if (newWindow < 1) newWindow = 1;
+        if (newWindow > SIZE) newWindow = SIZE;
+        if (newWindow == window) return;
+        
+        // Copy out the newest samples in chronological order
+        T keptValues[SIZE];
+        bool keptValid[SIZE];
+        size_t total = copyChronological(keptValues, keptValid);
+        size_t keep = total < newWindow ? total : newWindow;
+        
+        reset();
+        window = newWindow;
+        for (size_t i = total - keep; i < total; i++) {
+            addReading(keptValues[i], keptValid[i]);
+        }
+    }
+    
+    /**
+     * @brief Copy the window out, oldest reading first
+     * @param values Receives getCount() values (failed readings as 0)
+     * @param valid Receives whether each reading was valid
+     * @return Number of readings copied
+     *
+     * Replaying the result through addReading() rebuilds the same state.
+     */
+    size_t copyChronological(T* values, bool* valid) const {
+        for (size_t i = 0; i < count; i++) {
+            size_t src = (index + window - count + i) % window;
+            values[i] = buffer[src];
+            valid[i] = validBuffer[src];
+        }
+        return count;
+    }
+    
+    /**
+     * @brief Get the running sum of the valid readings
+     *
+     * Accumulated incrementally, so its last bits depend on every reading
+     * since the last reset, not only on the ones in the window.
+     */
+    T getSum() const {
+        return sum;
+    }
+    
+    /**
+     * @brief Take over a running sum saved with getSum() after rebuilding the window
+     */
+    void restoreSum(T value) {
+        sum = value;
+    }
+    
+    /**
+     * @brief Get the active window size
+     * @return Window size in samples
+     */
+    size_t getWindowSize() const {
+        return window;
     }
     
     /**
@@ -0,0 +1,379 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <Arduino.h>
+#include <ArduinoOTA.h>
+#include <HTTPClient.h>
+#include <MD5Builder.h>
+#include <Update.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "GzipInflater.h"
+#include "config.h"
+
+enum OtaSource {
+    OTA_SOURCE_PUSH = 0,    // espota / ArduinoOTA upload
+    OTA_SOURCE_PULL         // HTTP download requested over MQTT
+};
+
+/**
+ * @brief Outcome of one update, handed from the OTA task to loop()
+ */
+struct OtaReport {
+    bool ok;
+    OtaSource source;
+    bool compressed;            // Image arrived gzip-compressed
+    uint32_t transferBytes;     // Bytes received over the network
+    uint32_t imageBytes;        // Bytes written to the OTA partition
+    uint32_t transferMs;        // First byte requested to image verified
+    char error[48];
+};
+
+/**
+ * @brief Runs firmware updates in their own task so loop() keeps sampling
+ *
+ * The task (OTA_TASK_PRIORITY, pinned to OTA_TASK_CORE, away from loop())
+ * services ArduinoOTA uploads once enablePush() was called, and downloads
+ * images requested with requestPull() over HTTP. Images whose first bytes are
+ * the gzip magic are inflated on the fly into the OTA partition (32 KB
+ * window, PSRAM if available), so only the compressed size crosses the
+ * network. The image is verified by Update.end() against the MD5 given with
+ * the request, and by the gzip trailer.
+ *
+ * Nothing restarts from the task: ArduinoOTA's own reboot is disabled and
+ * each result is queued as an OtaReport for loop() to publish, save state
+ * and restart at a point of its choosing. Flash erase/write still stalls both
+ * cores briefly (cache disabled); that is what the sampling gap in the
+ * report measures.
+ */
+class OtaUpdater {
+private:
+    struct PullRequest {
+        char url[OTA_URL_BYTES];
+        char md5[33];           // Expected MD5 of the (inflated) image, lowercase hex
+    };
+
+    struct Reader {
+        WiFiClient* stream;
+        int32_t remaining;      // Content-Length still to come, -1 if unknown
+        uint32_t received;
+        size_t length;
+        size_t position;
+        uint8_t buffer[OTA_READ_CHUNK_BYTES];
+    };
+
+    TaskHandle_t task;
+    QueueHandle_t requests;
+    QueueHandle_t reports;
+    volatile bool pushEnabled;
+    volatile bool busy;
+    unsigned long pushStartedAt;
+    uint32_t pushBytes;
+    Reader reader;
+
+    static void taskEntry(void* arg) {
+        static_cast<OtaUpdater*>(arg)->run();
+    }
+
+    void run() {
+        PullRequest request;
+        for (;;) {
+            if (pushEnabled) {
+                ArduinoOTA.handle();
+            }
+            if (xQueueReceive(requests, &request, pdMS_TO_TICKS(OTA_TASK_POLL_MS)) == pdTRUE) {
+                pull(request.url, request.md5);
+            }
+        }
+    }
+
+    void report(OtaReport& r) {
+        busy = false;
+        if (xQueueSend(reports, &r, 0) != pdTRUE) {
+            Serial.println("[OTA] ✗ Report queue full, result dropped");
+        }
+    }
+
+    /**
+     * @brief Refill the read buffer, waiting up to OTA_READ_TIMEOUT_MS for data
+     */
+    bool fill() {
+        if (reader.remaining == 0) {
+            return false;
+        }
+        unsigned long waitStart = millis();
+        while (reader.stream->available() <= 0) {
+            if (!reader.stream->connected() || millis() - waitStart >= OTA_READ_TIMEOUT_MS) {
+                return false;
+            }
+            vTaskDelay(1);
+        }
+        size_t want = sizeof(reader.buffer);
+        if (reader.remaining > 0 && (size_t)reader.remaining < want) {
+            want = (size_t)reader.remaining;
+        }
+        int n = reader.stream->read(reader.buffer, want);
+        if (n <= 0) {
+            return false;
+        }
+        reader.length = (size_t)n;
+        reader.position = 0;
+        reader.received += n;
+        if (reader.remaining > 0) {
+            reader.remaining -= n;
+        }
+        return true;
+    }
+
+    static int readByte(void* context) {
+        OtaUpdater* self = static_cast<OtaUpdater*>(context);
+        if (self->reader.position == self->reader.length && !self->fill()) {
+            return -1;
+        }
+        return self->reader.buffer[self->reader.position++];
+    }
+
+    static bool writeImage(void*, const uint8_t* data, size_t length) {
+        return Update.write(const_cast<uint8_t*>(data), length) == length;
+    }
+
+    bool writeRaw(OtaReport& r) {
+        do {
+            size_t length = reader.length - reader.position;
+            if (length > 0 && !writeImage(nullptr, reader.buffer + reader.position, length)) {
+                strlcpy(r.error, Update.errorString(), sizeof(r.error));
+                return false;
+            }
+            r.imageBytes += length;
+            reader.position = reader.length;
+        } while (fill());
+        if (reader.remaining > 0) {
+            strlcpy(r.error, "connection lost", sizeof(r.error));
+            return false;
+        }
+        return true;
+    }
+
+    bool writeCompressed(OtaReport& r) {
+        uint8_t* window = (uint8_t*)heap_caps_malloc(GzipInflater::WINDOW_SIZE, MALLOC_CAP_SPIRAM);
+        if (window == nullptr) {
+            window = (uint8_t*)heap_caps_malloc(GzipInflater::WINDOW_SIZE, MALLOC_CAP_8BIT);
+        }
+        if (window == nullptr) {
+            strlcpy(r.error, "no memory for inflate window", sizeof(r.error));
+            return false;
+        }
+        GzipInflater inflater(window);
+        GzipInflater::Result result = inflater.inflate(readByte, this, writeImage, nullptr);
+        r.imageBytes = inflater.getOutputBytes();
+        heap_caps_free(window);
+        if (result != GzipInflater::GZIP_OK) {
+            strlcpy(r.error, result == GzipInflater::GZIP_WRITE_FAILED ? Update.errorString() :
+                             GzipInflater::resultName(result), sizeof(r.error));
+            return false;
+        }
+        return true;
+    }
+
+    void pull(const char* url, const char* md5) {
+        OtaReport r = {};
+        r.source = OTA_SOURCE_PULL;
+        unsigned long start = millis();
+        Serial.printf("[OTA] Downloading %s\n", url);
+
+        HTTPClient http;
+        http.useHTTP10(true);   // No chunked encoding: the stream is the image itself
+        http.setTimeout(OTA_READ_TIMEOUT_MS);
+        int status = -1;
+        if (http.begin(url)) {
+            status = http.GET();
+        }
+        if (status != HTTP_CODE_OK) {
+            snprintf(r.error, sizeof(r.error), "HTTP %d", status);
+            http.end();
+            report(r);
+            return;
+        }
+
+        reader.stream = http.getStreamPtr();
+        reader.remaining = http.getSize();
+        reader.received = 0;
+        reader.length = reader.position = 0;
+
+        bool ok = fill();
+        if (!ok) {
+            strlcpy(r.error, "no data", sizeof(r.error));
+        }
+        if (ok) {
+            r.compressed = GzipInflater::isGzip(reader.buffer, reader.length);
+            size_t imageSize = r.compressed || reader.remaining < 0 ?
+                               UPDATE_SIZE_UNKNOWN : reader.received + reader.remaining;
+            ok = Update.begin(imageSize);
+            if (!ok) {
+                strlcpy(r.error, Update.errorString(), sizeof(r.error));
+            }
+        }
+        if (ok) {
+            Update.setMD5(md5);     // Checked by Update.end(); a mismatch leaves the old image bootable
+        }
+        if (ok) {
+            ok = r.compressed ? writeCompressed(r) : writeRaw(r);
+            if (ok && !Update.end(true)) {
+                strlcpy(r.error, Update.errorString(), sizeof(r.error));
+                ok = false;
+            } else if (!ok) {
+                Update.abort();
+            }
+        }
+        http.end();
+
+        r.ok = ok;
+        r.transferBytes = reader.received;
+        r.transferMs = millis() - start;
+        if (ok) {
+            Serial.printf("[OTA] ✓ %lu bytes%s in %lu ms -> %lu byte image\n",
+                          (unsigned long)r.transferBytes, r.compressed ? " (gzip)" : "",
+                          (unsigned long)r.transferMs, (unsigned long)r.imageBytes);
+        } else {
+            Serial.printf("[OTA] ✗ Download failed after %lu bytes: %s\n",
+                          (unsigned long)r.transferBytes, r.error);
+        }
+        report(r);
+    }
+
+public:
+    OtaUpdater()
+        : task(nullptr), requests(nullptr), reports(nullptr), pushEnabled(false), busy(false),
+          pushStartedAt(0), pushBytes(0) {}
+
+    /**
+     * @brief Create the queues and start the OTA task
+     */
+    bool begin() {
+        requests = xQueueCreate(1, sizeof(PullRequest));
+        reports = xQueueCreate(2, sizeof(OtaReport));
+        if (requests == nullptr || reports == nullptr ||
+            xTaskCreatePinnedToCore(taskEntry, "ota", OTA_TASK_STACK, this, OTA_TASK_PRIORITY,
+                                    &task, OTA_TASK_CORE) != pdPASS) {
+            Serial.println("[OTA] ✗ Could not start OTA task");
+            return false;
+        }
+        Serial.printf("[OTA] Task started (priority %d, core %d)\n", OTA_TASK_PRIORITY, OTA_TASK_CORE);
+        return true;
+    }
+
+    /**
+     * @brief Start servicing ArduinoOTA from the task (call after ArduinoOTA.begin())
+     */
+    void enablePush() {
+        ArduinoOTA.setRebootOnSuccess(false);  // loop() restarts after reporting
+        pushEnabled = true;
+    }
+
+    /**
+     * @brief True if text is an MD5 digest: exactly 32 lowercase hex digits
+     */
+    static bool isDigest(const char* text) {
+        size_t n = 0;
+        for (; text[n] != '\0'; n++) {
+            char c = text[n];
+            if (n == 32 || !((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+                return false;
+            }
+        }
+        return n == 32;
+    }
+
+    /**
+     * @brief Check the credentials of an otaUpdate command
+     * @param md5 Expected MD5 of the image (lowercase hex)
+     * @param auth MD5 of "<OTA_PASSWORD>:<md5>" (lowercase hex)
+     * @return true if auth matches, i.e. the sender knows OTA_PASSWORD
+     *
+     * The password itself never crosses MQTT, and an overheard command can
+     * only install the image it names again.
+     */
+    static bool authorize(const char* md5, const char* auth) {
+        if (!isDigest(md5) || !isDigest(auth)) {
+            return false;
+        }
+        MD5Builder builder;
+        builder.begin();
+        builder.add(OTA_PASSWORD ":");
+        builder.add(md5);
+        builder.calculate();
+        char expected[33];
+        builder.getChars(expected);
+        uint8_t diff = 0;       // Compare every digit: no early exit to time
+        for (size_t i = 0; i < 32; i++) {
+            diff |= (uint8_t)(expected[i] ^ auth[i]);
+        }
+        return diff == 0;
+    }
+
+    /**
+     * @brief Queue an HTTP download
+     * @param url http:// URL of a raw or gzip-compressed application image
+     * @param md5 Expected MD5 of the application image (after inflating), lowercase hex
+     * @return false if an update is already running, the URL is too long or md5 is malformed
+     */
+    bool requestPull(const char* url, const char* md5) {
+        PullRequest request;
+        if (busy || requests == nullptr || strlen(url) >= sizeof(request.url) || !isDigest(md5)) {
+            return false;
+        }
+        strlcpy(request.url, url, sizeof(request.url));
+        strlcpy(request.md5, md5, sizeof(request.md5));
+        busy = true;
+        if (xQueueSend(requests, &request, 0) != pdTRUE) {
+            busy = false;
+            return false;
+        }
+        return true;
+    }
+
+    // ArduinoOTA callbacks (run in the OTA task)
+    void pushStarted() {
+        busy = true;
+        pushStartedAt = millis();
+        pushBytes = 0;
+    }
+
+    void pushProgress(unsigned int progress) {
+        pushBytes = progress;
+    }
+
+    void pushFinished(bool ok, const char* error) {
+        OtaReport r = {};
+        r.ok = ok;
+        r.source = OTA_SOURCE_PUSH;
+        r.transferBytes = r.imageBytes = pushBytes;
+        r.transferMs = millis() - pushStartedAt;
+        if (error != nullptr) {
+            strlcpy(r.error, error, sizeof(r.error));
+        }
+        report(r);
+    }
+
+    /**
+     * @brief Fetch the next finished update, if any (call from loop)
+     */
+    bool pollReport(OtaReport& r) {
+        return reports != nullptr && xQueueReceive(reports, &r, 0) == pdTRUE;
+    }
+
+    /**
+     * @brief True while an upload or download is in progress
+     */
+    bool isBusy() const {
+        return busy;
+    }
+
+    static const char* sourceName(OtaSource source) {
+        return source == OTA_SOURCE_PUSH ? "push" : "pull";
+    }
+};
+
+#endif // OTA_UPDATER_H
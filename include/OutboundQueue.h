@@ -0,0 +1,302 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <esp_heap_caps.h>
+#include "config.h"
+
+/**
+ * @brief Priority classes for outbound MQTT messages, most urgent first
+ */
+enum OutboundClass {
+    OUTBOUND_URGENT = 0,    // Alarms, sensor state changes
+    OUTBOUND_STATE,         // Health, config state, calibration events
+    OUTBOUND_ROUTINE,       // Sensor readings, calibration frames
+    OUTBOUND_BULK,          // Time series, history replies
+    OUTBOUND_CLASS_COUNT
+};
+
+/**
+ * @brief Per-class limits as listed in OUTBOUND_CLASSES
+ */
+struct OutboundLimit {
+    uint32_t bytesPerSec;   // Refill rate, 0 = not rate limited
+    uint32_t burstBytes;    // Bucket size
+    uint8_t slots;          // Messages held before the oldest is dropped
+};
+
+/**
+ * @brief Byte-based token bucket
+ *
+ * A message may go out once the bucket holds its size (or is full, for
+ * messages larger than the burst); the bucket then goes negative, so a large
+ * message delays the next one instead of being starved forever.
+ */
+class TokenBucket {
+private:
+    uint32_t rate;
+    uint32_t burst;
+    float tokens;
+    unsigned long lastRefill;
+
+public:
+    TokenBucket() : rate(0), burst(0), tokens(0), lastRefill(0) {}
+
+    void begin(uint32_t bytesPerSec, uint32_t burstBytes) {
+        rate = bytesPerSec;
+        burst = burstBytes;
+        tokens = (float)burstBytes;
+        lastRefill = millis();
+    }
+
+    void refill(unsigned long now) {
+        if (rate == 0) {
+            return;
+        }
+        tokens += rate * ((now - lastRefill) / 1000.0f);
+        if (tokens > burst) {
+            tokens = (float)burst;
+        }
+        lastRefill = now;
+    }
+
+    bool allows(size_t bytes) const {
+        return rate == 0 || tokens >= (bytes < burst ? (float)bytes : (float)burst);
+    }
+
+    void spend(size_t bytes) {
+        if (rate != 0) {
+            tokens -= bytes;
+        }
+    }
+};
+
+/**
+ * @brief Outbound MQTT scheduler with priority classes and rate limits
+ *
+ * Callers enqueue() instead of publishing; service() sends from the most
+ * urgent non-empty class whose bucket (and the global bucket) allows it.
+ * Each class is a fixed ring of slots; when full, the oldest message in that
+ * class is dropped, so a replayed backlog can never push out an alarm.
+ * Urgent messages are charged to the global bucket but never wait for it,
+ * which bounds their latency to the link itself.
+ *
+ * Slots live in PSRAM when available. If they cannot be allocated at all,
+ * enqueue() falls back to publishing directly.
+ */
+class OutboundQueue {
+public:
+    struct ClassStats {
+        uint32_t sent;
+        uint32_t dropped;       // Oldest messages pushed out, oversize payloads
+        uint8_t depth;
+        uint8_t maxDepth;
+        uint32_t lastLatencyMs; // Queue time of the last message sent
+        uint32_t maxLatencyMs;
+    };
+
+private:
+    struct Slot {
+        unsigned long queuedAt;
+        uint16_t length;
+        bool retained;
+        char topic[OUTBOUND_TOPIC_BYTES];
+        uint8_t payload[OUTBOUND_SLOT_BYTES];
+    };
+
+    struct ClassQueue {
+        Slot* slots;
+        uint8_t capacity;
+        uint8_t head;
+        TokenBucket bucket;
+        ClassStats stats;
+    };
+
+    PubSubClient& client;
+    ClassQueue queues[OUTBOUND_CLASS_COUNT];
+    TokenBucket globalBucket;
+    Slot* storage;
+
+public:
+    OutboundQueue(PubSubClient& mqtt) : client(mqtt), storage(nullptr) {
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            queues[c].slots = nullptr;
+            queues[c].capacity = 0;
+            queues[c].head = 0;
+            memset(&queues[c].stats, 0, sizeof(ClassStats));
+        }
+    }
+
+    /**
+     * @brief Allocate slots and set up buckets from OUTBOUND_CLASSES
+     * @return true if queueing is active
+     */
+    bool begin() {
+        static const OutboundLimit limits[OUTBOUND_CLASS_COUNT] = OUTBOUND_CLASSES;
+
+        size_t total = 0;
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            total += limits[c].slots;
+        }
+        storage = (Slot*)heap_caps_calloc(total, sizeof(Slot), MALLOC_CAP_SPIRAM);
+        if (storage == nullptr) {
+            storage = (Slot*)heap_caps_calloc(total, sizeof(Slot), MALLOC_CAP_8BIT);
+        }
+        if (storage == nullptr) {
+            Serial.println("[OUTBOUND] ✗ No memory for queue, publishing directly");
+            return false;
+        }
+
+        Slot* next = storage;
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            queues[c].slots = next;
+            queues[c].capacity = limits[c].slots;
+            queues[c].bucket.begin(limits[c].bytesPerSec, limits[c].burstBytes);
+            next += limits[c].slots;
+        }
+        globalBucket.begin(OUTBOUND_GLOBAL_BYTES_PER_SEC, OUTBOUND_GLOBAL_BURST_BYTES);
+
+        Serial.printf("[OUTBOUND] ✓ %u slots (%u KB)\n", (unsigned)total,
+                      (unsigned)(total * sizeof(Slot) / 1024));
+        return true;
+    }
+
+    /**
+     * @brief Queue a message
+     * @param cls Priority class
+     * @param topic MQTT topic
+     * @param payload Message bytes
+     * @param length Payload length
+     * @param retained MQTT retain flag
+     * @return true if queued (or, without a queue, published)
+     */
+    bool enqueue(OutboundClass cls, const char* topic, const uint8_t* payload, size_t length, bool retained = false) {
+        if (storage == nullptr) {
+            return client.connected() && client.publish(topic, payload, length, retained);
+        }
+
+        ClassQueue& q = queues[cls];
+        // Header (5) + topic length (2) + topic + payload must fit PubSubClient's buffer
+        size_t topicLength = strlen(topic);
+        if (length > OUTBOUND_SLOT_BYTES || topicLength >= OUTBOUND_TOPIC_BYTES || q.capacity == 0 ||
+            7 + topicLength + length > client.getBufferSize()) {
+            Serial.printf("[OUTBOUND] ✗ Message for %s too large (%u bytes)\n", topic, (unsigned)length);
+            q.stats.dropped++;
+            return false;
+        }
+
+        if (q.stats.depth == q.capacity) {
+            // Drop oldest: newer data of the same class supersedes it
+            q.head = (q.head + 1) % q.capacity;
+            q.stats.depth--;
+            q.stats.dropped++;
+        }
+
+        Slot& slot = q.slots[(q.head + q.stats.depth) % q.capacity];
+        slot.queuedAt = millis();
+        slot.length = (uint16_t)length;
+        slot.retained = retained;
+        strlcpy(slot.topic, topic, sizeof(slot.topic));
+        memcpy(slot.payload, payload, length);
+        q.stats.depth++;
+        if (q.stats.depth > q.stats.maxDepth) {
+            q.stats.maxDepth = q.stats.depth;
+        }
+        return true;
+    }
+
+    bool enqueue(OutboundClass cls, const char* topic, const char* payload, bool retained = false) {
+        return enqueue(cls, topic, (const uint8_t*)payload, strlen(payload), retained);
+    }
+
+    /**
+     * @brief Send queued messages the rate limits allow (call from loop)
+     * @return Number of messages sent
+     */
+    size_t service() {
+        if (storage == nullptr || !client.connected()) {
+            return 0;
+        }
+
+        unsigned long now = millis();
+        globalBucket.refill(now);
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            queues[c].bucket.refill(now);
+        }
+
+        size_t sent = 0;
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            ClassQueue& q = queues[c];
+            while (q.stats.depth > 0) {
+                Slot& slot = q.slots[q.head];
+                if (!q.bucket.allows(slot.length)) {
+                    break;  // Lower classes may still have budget
+                }
+                if (c != OUTBOUND_URGENT && !globalBucket.allows(slot.length)) {
+                    return sent;  // Link budget used up; keep lower classes waiting too
+                }
+                if (!client.publish(slot.topic, slot.payload, slot.length, slot.retained)) {
+                    return sent;  // Connection trouble; retry the same message next pass
+                }
+
+                q.bucket.spend(slot.length);
+                globalBucket.spend(slot.length);
+                uint32_t latency = now - slot.queuedAt;
+                q.stats.lastLatencyMs = latency;
+                if (latency > q.stats.maxLatencyMs) {
+                    q.stats.maxLatencyMs = latency;
+                }
+                q.stats.sent++;
+                q.head = (q.head + 1) % q.capacity;
+                q.stats.depth--;
+                sent++;
+            }
+        }
+        return sent;
+    }
+
+    /**
+     * @brief Free slots in a class (for producers that can hold data back)
+     */
+    size_t available(OutboundClass cls) const {
+        if (storage == nullptr) {
+            return client.connected() ? 1 : 0;
+        }
+        return queues[cls].capacity - queues[cls].stats.depth;
+    }
+
+    const ClassStats& getStats(OutboundClass cls) const {
+        return queues[cls].stats;
+    }
+
+    size_t getDepth() const {
+        size_t depth = 0;
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            depth += queues[c].stats.depth;
+        }
+        return depth;
+    }
+
+    /**
+     * @brief Reset the high-water marks (after reporting them)
+     */
+    void resetPeaks() {
+        for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+            queues[c].stats.maxDepth = queues[c].stats.depth;
+            queues[c].stats.maxLatencyMs = 0;
+        }
+    }
+
+    static const char* className(OutboundClass cls) {
+        switch (cls) {
+            case OUTBOUND_URGENT:  return "urgent";
+            case OUTBOUND_STATE:   return "state";
+            case OUTBOUND_ROUTINE: return "routine";
+            case OUTBOUND_BULK:    return "bulk";
+            default:               return "unknown";
+        }
+    }
+};
+
+#endif // OUTBOUND_QUEUE_H
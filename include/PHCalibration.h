@@ -0,0 +1,322 @@
+#ifndef PH_CALIBRATION_H
+#define PH_CALIBRATION_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include "config.h"
+#include "PHLookupTable.h"
+
+/**
+ * @brief Calibration buffer points, in the order of PH_CAL_MID/LOW/HIGH
+ */
+enum PHCalPoint {
+    PH_CAL_POINT_MID = 0,   // pH 7.0
+    PH_CAL_POINT_LOW,       // pH 4.0
+    PH_CAL_POINT_HIGH,      // pH 10.0
+    PH_CAL_POINT_COUNT,
+    PH_CAL_POINT_NONE = PH_CAL_POINT_COUNT
+};
+
+/**
+ * @brief NVS persistence for the pH 3-point calibration
+ *
+ * Points are millivolts as rawToMillivolts() computed them, so each stored
+ * calibration carries the PHLookupTable conversion it was measured with and
+ * is only applied by firmware converting the same way.
+ */
+class PHCalibrationStore {
+private:
+    struct Stored {
+        uint8_t conversion;     // PHLookupTable::Conversion
+        uint8_t reserved[3];
+        float mv[PH_CAL_POINT_COUNT];
+    };
+
+public:
+    /**
+     * @brief Check that points are ordered and far enough apart to convert with
+     * @param mv Mid/low/high voltages (mV)
+     * @param error Receives a reason if they are not
+     * @return true if usable
+     */
+    static bool validate(const float mv[PH_CAL_POINT_COUNT], const char** error) {
+        // Voltage falls as pH rises: low (pH 4) > mid (pH 7) > high (pH 10)
+        if (!(mv[PH_CAL_POINT_LOW] - mv[PH_CAL_POINT_MID] >= PH_CAL_MIN_SPAN_MV) ||
+            !(mv[PH_CAL_POINT_MID] - mv[PH_CAL_POINT_HIGH] >= PH_CAL_MIN_SPAN_MV)) {
+            *error = "points out of order or too close";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Load a committed calibration
+     * @param mv Receives mid/low/high voltages (mV), untouched if none is usable
+     * @param error Receives a reason if a stored calibration was rejected, else nullptr
+     * @return true if a usable calibration was found
+     */
+    static bool load(float mv[PH_CAL_POINT_COUNT], const char** error) {
+        *error = nullptr;
+        Preferences prefs;
+        if (!prefs.begin("phcal", true)) {
+            return false;
+        }
+        Stored stored;
+        size_t len = prefs.getBytes("points", &stored, sizeof(stored));
+        prefs.end();
+        if (len == 0) {
+            return false;
+        }
+        if (len != sizeof(stored)) {
+            *error = "stored without a conversion tag";
+            return false;
+        }
+        if (stored.conversion != PHLookupTable::conversion()) {
+            *error = stored.conversion == PHLookupTable::CONVERSION_EFUSE
+                         ? "measured with the eFuse ADC conversion"
+                         : "measured with the legacy ADC conversion";
+            return false;
+        }
+        if (!validate(stored.mv, error)) {
+            return false;
+        }
+        memcpy(mv, stored.mv, sizeof(stored.mv));
+        return true;
+    }
+
+    /**
+     * @brief Persist a calibration, tagged with the current ADC conversion
+     * @param mv Mid/low/high voltages (mV)
+     * @return true if written successfully
+     */
+    static bool save(const float mv[PH_CAL_POINT_COUNT]) {
+        Preferences prefs;
+        if (!prefs.begin("phcal", false)) {
+            return false;
+        }
+        Stored stored;
+        memset(&stored, 0, sizeof(stored));
+        stored.conversion = PHLookupTable::conversion();
+        memcpy(stored.mv, mv, sizeof(stored.mv));
+        size_t written = prefs.putBytes("points", &stored, sizeof(stored));
+        prefs.end();
+        return written == sizeof(stored);
+    }
+};
+
+/**
+ * @brief Interactive pH calibration driven over MQTT
+ *
+ * While active, the pH ADC is sampled every PH_CAL_SAMPLE_INTERVAL_MS and the
+ * raw millivolt readings are collected into batches of PH_CAL_BATCH_SIZE.
+ * Each full batch becomes one frame on the calibration topic, together with
+ * its mean, standard deviation and whether the reading has settled (low noise
+ * and low drift from the previous batch for PH_CAL_SETTLE_BATCHES batches).
+ * A point armed with arm() is captured automatically once settled.
+ */
+class PHCalibrationSession {
+private:
+    bool active;
+    unsigned long lastActivityAt;    // Start, arm() or the last capture
+    unsigned long lastSampleAt;
+    uint32_t frameSeq;
+
+    int16_t batch[PH_CAL_BATCH_SIZE];
+    size_t batchCount;
+    float batchMean;
+    float batchStdDev;
+    float previousMean;
+    uint8_t stableBatches;
+
+    PHCalPoint armedPoint;
+    PHCalPoint lastCaptured;     // Captured in the most recent batch, for the frame
+    float captured[PH_CAL_POINT_COUNT];
+    bool capturedValid[PH_CAL_POINT_COUNT];
+
+    void finishBatch() {
+        float sum = 0;
+        for (size_t i = 0; i < batchCount; i++) {
+            sum += batch[i];
+        }
+        batchMean = sum / batchCount;
+
+        float sq = 0;
+        for (size_t i = 0; i < batchCount; i++) {
+            float d = batch[i] - batchMean;
+            sq += d * d;
+        }
+        batchStdDev = sqrtf(sq / batchCount);
+
+        bool quiet = batchStdDev <= PH_CAL_SETTLE_STDDEV_MV;
+        bool steady = frameSeq > 0 && fabsf(batchMean - previousMean) <= PH_CAL_SETTLE_DRIFT_MV;
+        stableBatches = (quiet && steady) ? stableBatches + 1 : 0;
+        previousMean = batchMean;
+
+        lastCaptured = PH_CAL_POINT_NONE;
+        if (armedPoint != PH_CAL_POINT_NONE && isSettled()) {
+            captured[armedPoint] = batchMean;
+            capturedValid[armedPoint] = true;
+            lastCaptured = armedPoint;
+            lastActivityAt = lastSampleAt;
+            Serial.printf("[pH-CAL] ✓ Captured %s point: %.1f mV (σ %.2f mV)\n",
+                          pointName(armedPoint), batchMean, batchStdDev);
+            armedPoint = PH_CAL_POINT_NONE;
+        }
+    }
+
+public:
+    PHCalibrationSession()
+        : active(false), lastActivityAt(0), lastSampleAt(0), frameSeq(0), batchCount(0),
+          batchMean(0), batchStdDev(0), previousMean(0), stableBatches(0),
+          armedPoint(PH_CAL_POINT_NONE), lastCaptured(PH_CAL_POINT_NONE) {
+        for (size_t i = 0; i < PH_CAL_POINT_COUNT; i++) {
+            captured[i] = 0;
+            capturedValid[i] = false;
+        }
+    }
+
+    /**
+     * @brief Parse a point name ("mid", "low", "high")
+     * @param name Point name from the command
+     * @return Point, or PH_CAL_POINT_NONE if unknown
+     */
+    static PHCalPoint parsePoint(const char* name) {
+        if (name == nullptr) return PH_CAL_POINT_NONE;
+        if (strcmp(name, "mid") == 0) return PH_CAL_POINT_MID;
+        if (strcmp(name, "low") == 0) return PH_CAL_POINT_LOW;
+        if (strcmp(name, "high") == 0) return PH_CAL_POINT_HIGH;
+        return PH_CAL_POINT_NONE;
+    }
+
+    static const char* pointName(PHCalPoint point) {
+        switch (point) {
+            case PH_CAL_POINT_MID:  return "mid";
+            case PH_CAL_POINT_LOW:  return "low";
+            case PH_CAL_POINT_HIGH: return "high";
+            default:                return "none";
+        }
+    }
+
+    /**
+     * @brief Start a session, discarding any previous captures
+     */
+    void start() {
+        *this = PHCalibrationSession();
+        active = true;
+        lastActivityAt = millis();
+        lastSampleAt = lastActivityAt;
+        Serial.println("[pH-CAL] Calibration session started");
+    }
+
+    /**
+     * @brief End the session without committing
+     */
+    void stop() {
+        active = false;
+        armedPoint = PH_CAL_POINT_NONE;
+    }
+
+    /**
+     * @brief Capture a point as soon as the reading settles
+     * @param point Buffer the probe is sitting in
+     */
+    void arm(PHCalPoint point) {
+        armedPoint = point;
+        lastActivityAt = millis();
+        Serial.printf("[pH-CAL] Waiting for %s point to settle...\n", pointName(point));
+    }
+
+    /**
+     * @brief Check if the next sample is due
+     * @param now Current millis()
+     * @return true if a sample should be taken now
+     */
+    bool isSampleDue(unsigned long now) const {
+        return active && now - lastSampleAt >= PH_CAL_SAMPLE_INTERVAL_MS;
+    }
+
+    /**
+     * @brief Check if the session has been idle for PH_CAL_SESSION_TIMEOUT
+     *
+     * Starting the session, arming a point and capturing one all count as
+     * activity, so a three-point calibration gets the full timeout per point.
+     * @param now Current millis()
+     * @return true if the session should be abandoned
+     */
+    bool isTimedOut(unsigned long now) const {
+        return active && now - lastActivityAt >= PH_CAL_SESSION_TIMEOUT;
+    }
+
+    /**
+     * @brief Add one raw sample
+     * @param now Current millis()
+     * @param millivolts Probe voltage
+     * @return true if a batch completed and a frame is ready
+     */
+    bool addSample(unsigned long now, float millivolts) {
+        lastSampleAt = now;
+        batch[batchCount++] = (int16_t)lroundf(millivolts);
+        if (batchCount < PH_CAL_BATCH_SIZE) {
+            return false;
+        }
+        finishBatch();
+        return true;
+    }
+
+    /**
+     * @brief Fill a JSON frame for the batch that just completed and start a new one
+     * @param doc Document to fill
+     */
+    template <typename TDoc>
+    void buildFrame(TDoc& doc) {
+        doc["seq"] = frameSeq++;
+        doc["intervalMs"] = PH_CAL_SAMPLE_INTERVAL_MS;
+        doc["mean"] = batchMean;
+        doc["std"] = batchStdDev;
+        doc["settled"] = isSettled();
+        doc["armed"] = pointName(armedPoint);
+        if (lastCaptured != PH_CAL_POINT_NONE) {
+            doc["captured"] = pointName(lastCaptured);
+        }
+        JsonArray mv = doc.createNestedArray("mv");
+        for (size_t i = 0; i < batchCount; i++) {
+            mv.add(batch[i]);
+        }
+        batchCount = 0;
+    }
+
+    /**
+     * @brief Merge captured points into a calibration and validate it
+     * @param mv In: current mid/low/high (mV); out: with captured points applied
+     * @param error Receives a reason if the result is unusable
+     * @return true if at least one point was captured and the result is ordered
+     */
+    bool buildCalibration(float mv[PH_CAL_POINT_COUNT], const char** error) const {
+        bool any = false;
+        float result[PH_CAL_POINT_COUNT];
+        for (size_t i = 0; i < PH_CAL_POINT_COUNT; i++) {
+            result[i] = capturedValid[i] ? captured[i] : mv[i];
+            any = any || capturedValid[i];
+        }
+        if (!any) {
+            *error = "no points captured";
+            return false;
+        }
+        if (!PHCalibrationStore::validate(result, error)) {
+            return false;
+        }
+        memcpy(mv, result, sizeof(result));
+        return true;
+    }
+
+    bool isActive() const {
+        return active;
+    }
+
+    bool isSettled() const {
+        return stableBatches >= PH_CAL_SETTLE_BATCHES;
+    }
+};
+
+#endif // PH_CALIBRATION_H
@@ -0,0 +1,159 @@
+#ifndef PH_LOOKUP_TABLE_H
+#define PH_LOOKUP_TABLE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if defined(ESP_PLATFORM) && defined(PH_ADC_USE_EFUSE_CAL)
+#include <esp_adc_cal.h>
+#define PH_LUT_HAS_ADC_CAL 1
+#endif
+
+/**
+ * @brief Precomputed raw ADC code -> pH table in fixed point (milli-pH)
+ *
+ * One int16_t entry per 12-bit ADC code (8 KB). Each entry is the Atlas
+ * Scientific 3-point piecewise conversion applied to the voltage of that code,
+ * where the voltage comes from the chip's eFuse ADC characterization when
+ * PH_ADC_USE_EFUSE_CAL is defined, or the legacy linear formula plus
+ * ESP32_ADC_OFFSET_MV otherwise. Rebuild only when the calibration changes;
+ * converting a sample is then a single table load.
+ */
+class PHLookupTable {
+public:
+    static const size_t ADC_CODES = 4096;
+    static const int32_t MILLI_PH_PER_PH = 1000;
+
+    /**
+     * @brief How rawToMillivolts() converts, so calibrations can be tagged with it
+     */
+    enum Conversion : uint8_t {
+        CONVERSION_LEGACY = 1,   // Linear formula plus ESP32_ADC_OFFSET_MV
+        CONVERSION_EFUSE = 2     // eFuse ADC characterization
+    };
+
+    static Conversion conversion() {
+        #ifdef PH_LUT_HAS_ADC_CAL
+        return CONVERSION_EFUSE;
+        #else
+        return CONVERSION_LEGACY;
+        #endif
+    }
+
+private:
+    int16_t milliPH[ADC_CODES];
+    bool built;
+
+    #ifdef PH_LUT_HAS_ADC_CAL
+    esp_adc_cal_characteristics_t adcChars;
+    esp_adc_cal_value_t adcCalSource;
+    #endif
+
+    /**
+     * @brief Atlas Scientific piecewise linear conversion
+     * @param voltage_mV Probe voltage in millivolts
+     * @param calMid Voltage measured in pH 7.0 buffer (mV)
+     * @param calLow Voltage measured in pH 4.0 buffer (mV)
+     * @param calHigh Voltage measured in pH 10.0 buffer (mV)
+     * @return pH value
+     */
+    static float voltageToPH(float voltage_mV, float calMid, float calLow, float calHigh) {
+        if (voltage_mV > calMid) {
+            // High voltage = low pH (acidic range: pH 4-7)
+            return 7.0f - 3.0f / (calLow - calMid) * (voltage_mV - calMid);
+        } else {
+            // Low voltage = high pH (basic range: pH 7-10)
+            return 7.0f - 3.0f / (calMid - calHigh) * (voltage_mV - calMid);
+        }
+    }
+
+public:
+    PHLookupTable() : built(false) {
+        #ifdef PH_LUT_HAS_ADC_CAL
+        adcCalSource = ESP_ADC_CAL_VAL_DEFAULT_VREF;
+        #endif
+    }
+
+    /**
+     * @brief Read the ADC characterization from eFuse (call after ADC setup)
+     * @return Human readable source of the characterization
+     */
+    const char* characterize() {
+        #ifdef PH_LUT_HAS_ADC_CAL
+        adcCalSource = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                ESP32_ADC_DEFAULT_VREF, &adcChars);
+        switch (adcCalSource) {
+            case ESP_ADC_CAL_VAL_EFUSE_TP:   return "eFuse two-point";
+            case ESP_ADC_CAL_VAL_EFUSE_VREF: return "eFuse Vref";
+            default:                         return "default Vref (no eFuse data)";
+        }
+        #else
+        return "linear + ESP32_ADC_OFFSET_MV";
+        #endif
+    }
+
+    /**
+     * @brief Convert a raw ADC code to millivolts at the ADC pin
+     * @param raw 12-bit ADC code
+     * @return Voltage in millivolts
+     */
+    float rawToMillivolts(uint16_t raw) const {
+        #ifdef PH_LUT_HAS_ADC_CAL
+        return (float)esp_adc_cal_raw_to_voltage(raw, &adcChars);
+        #else
+        return raw / ADC_RESOLUTION * 3300.0f + ESP32_ADC_OFFSET_MV;
+        #endif
+    }
+
+    /**
+     * @brief Rebuild the whole table for a new 3-point calibration
+     * @param calMid Voltage measured in pH 7.0 buffer (mV)
+     * @param calLow Voltage measured in pH 4.0 buffer (mV)
+     * @param calHigh Voltage measured in pH 10.0 buffer (mV)
+     */
+    void build(float calMid, float calLow, float calHigh) {
+        for (size_t code = 0; code < ADC_CODES; code++) {
+            float ph = voltageToPH(rawToMillivolts(code), calMid, calLow, calHigh);
+            long scaled = lroundf(ph * MILLI_PH_PER_PH);
+            if (scaled > INT16_MAX) scaled = INT16_MAX;
+            if (scaled < INT16_MIN) scaled = INT16_MIN;
+            milliPH[code] = (int16_t)scaled;
+        }
+        built = true;
+    }
+
+    /**
+     * @brief Look up the pH of a raw ADC code
+     * @param raw 12-bit ADC code
+     * @return pH in milli-pH (7000 = pH 7.00)
+     */
+    int16_t lookup(uint16_t raw) const {
+        return milliPH[raw & (ADC_CODES - 1)];
+    }
+
+    /**
+     * @brief The table itself (ADC_CODES entries, milli-pH)
+     */
+    const int16_t* getTable() const {
+        return milliPH;
+    }
+
+    /**
+     * @brief Take over a table built elsewhere (e.g. on the device a capture came from)
+     * @param table ADC_CODES entries, milli-pH
+     */
+    void load(const int16_t* table) {
+        memcpy(milliPH, table, sizeof(milliPH));
+        built = true;
+    }
+
+    /**
+     * @brief Check if build() has been called
+     * @return true if the table is populated
+     */
+    bool isBuilt() const {
+        return built;
+    }
+};
+
+#endif // PH_LOOKUP_TABLE_H
@@ -3,12 +3,28 @@
 
 #include "SensorBase.h"
 #include "config.h"
+#include "RuntimeSettings.h"
+#include "PHLookupTable.h"
+#include "FilterPipeline.h"
+#include "TraceRecorder.h"
+
+/**
+ * @brief pH processing: record raw -> range check -> record accepted -> history -> windowed mean
+ */
+typedef FilterPipeline<
+    RecordStage<RAW_SAMPLE_RING_SIZE>,
+    RangeStage<&RuntimeSettings::phMin, &RuntimeSettings::phMax>,
+    AcceptStage<RAW_SAMPLE_RING_SIZE>,
+    HistoryStage,
+    WindowedMeanStage<MAX_AVERAGE_WINDOW>
+> PHPipeline;
 
 /**
  * @brief Atlas Scientific pH Sensor (Analog version)
  * 
  * Reads pH value from analog voltage output.
- * Default calibration: 0V = pH 0, 3.3V = pH 14
+ * Raw ADC codes are converted through a PHLookupTable built from the eFuse ADC
+ * characterization and the Atlas Scientific 3-point calibration.
  * Applies moving average filtering for stable readings.
  */
 class PHSensor : public SensorBase {
@@ -16,22 +32,28 @@ private:
     uint8_t analogPin;
     float currentPH;
     
+    // 3-point calibration (mV) the lookup table was built from
+    float calMid;
+    float calLow;
+    float calHigh;
+    PHLookupTable lut;
+    bool adcCharacterized;
+    PHPipeline pipeline;  // Table can only be built once the ADC is characterized
+    
+    // Two-phase acquisition: ADC samples are taken one per poll() while other sensors convert
+    uint32_t pendingRawSum;
+    uint8_t pendingSamples;
+
     /**
-     * @brief Convert voltage to pH using Atlas Scientific piecewise linear calibration
-     * @param voltage_mV Voltage reading in millivolts
-     * @return pH value using 3-point calibration method
+     * @brief Read the averaged raw ADC code
+     * @return Mean of PH_VOLTAGE_AVERAGING samples, rounded to nearest code
      */
-    float readPHFromVoltage(float voltage_mV) {
-        // Atlas Scientific piecewise linear method
-        if (voltage_mV > PH_CAL_MID) { 
-            // High voltage = low pH (acidic range: pH 4-7)
-            // Uses low_cal and mid_cal calibration points
-            return 7.0 - 3.0 / (PH_CAL_LOW - PH_CAL_MID) * (voltage_mV - PH_CAL_MID);
-        } else {
-            // Low voltage = high pH (basic range: pH 7-10) 
-            // Uses mid_cal and high_cal calibration points
-            return 7.0 - 3.0 / (PH_CAL_MID - PH_CAL_HIGH) * (voltage_mV - PH_CAL_MID);
+    uint16_t readAveragedRaw() {
+        uint32_t totalRawADC = 0;
+        for (int i = 0; i < PH_VOLTAGE_AVERAGING; ++i) {
+            totalRawADC += hal::analogRead(analogPin);
         }
+        return (totalRawADC + PH_VOLTAGE_AVERAGING / 2) / PH_VOLTAGE_AVERAGING;
     }
 
     /**
@@ -39,30 +61,26 @@ private:
      * @return pH value (0-14 scale), or -1 on error
      */
     float readPH() {
-        // Debug: Read raw ADC values first
-        int totalRawADC = 0;
-        float voltage_mV = 0;
-        
-        for (int i = 0; i < PH_VOLTAGE_AVERAGING; ++i) {
-            int rawADC = analogRead(analogPin);
-            totalRawADC += rawADC;
-            // ESP32 ADC with compensation (Atlas Scientific method)
-            voltage_mV += rawADC / 4095.0 * 3300.0 + ESP32_ADC_OFFSET_MV;
-        }
-        voltage_mV /= PH_VOLTAGE_AVERAGING;
-        int avgRawADC = totalRawADC / PH_VOLTAGE_AVERAGING;
-        
-        // Debug output for troubleshooting
-        Serial.printf("[pH] DEBUG: Pin %d, Raw ADC: %d, Voltage: %.1fmV\n", 
-                      analogPin, avgRawADC, voltage_mV);
+        return convertRaw(readAveragedRaw());
+    }
+    
+    /**
+     * @brief Convert an averaged raw ADC code to pH
+     * @param avgRawADC Averaged 12-bit ADC code
+     * @return pH value (0-14 scale)
+     */
+    float convertRaw(uint16_t avgRawADC) {
         
-        // Convert voltage to pH using Atlas Scientific piecewise linear calibration
-        float ph = readPHFromVoltage(voltage_mV);
+        // One table load replaces the float voltage + piecewise conversion
+        float ph = lut.lookup(avgRawADC) / (float)PHLookupTable::MILLI_PH_PER_PH;
         
         #ifdef DEBUG_VERBOSE
+        float voltage_mV = lut.rawToMillivolts(avgRawADC);
+        Serial.printf("[pH] DEBUG: Pin %d, Raw ADC: %u, Voltage: %.1fmV\n", 
+                      analogPin, avgRawADC, voltage_mV);
         Serial.printf("[pH] Voltage: %.1fmV, pH: %.2f, Range: %s\n", 
                       voltage_mV, ph, 
-                      (voltage_mV > PH_CAL_MID) ? "Acidic(4-7)" : "Basic(7-10)");
+                      (voltage_mV > calMid) ? "Acidic(4-7)" : "Basic(7-10)");
         #endif
         
         return ph;
@@ -73,7 +91,13 @@ public:
      * @brief Constructor
      * @param pin Analog input pin number
      */
-    PHSensor(uint8_t pin) : SensorBase("pH", true), analogPin(pin), currentPH(7.0) {}
+    PHSensor(uint8_t pin)
+        : SensorBase("pH"), analogPin(pin), currentPH(7.0),
+          calMid(PH_CAL_MID), calLow(PH_CAL_LOW), calHigh(PH_CAL_HIGH), adcCharacterized(false),
+          pendingRawSum(0), pendingSamples(0) {
+        attachPipeline(pipeline);
+        setAverageWindow(PH_WINDOW);
+    }
     
     /**
      * @brief Initialize the pH sensor
@@ -83,7 +107,7 @@ public:
         Serial.println("[pH] Initializing sensor...");
         
         // Configure ADC
-        pinMode(analogPin, INPUT);
+        hal::pinMode(analogPin, INPUT);
         
         // ESP32 ADC configuration - detailed setup
         Serial.printf("[pH] Configuring ADC on pin %d (ADC1_CH6)\n", analogPin);
@@ -94,9 +118,14 @@ public:
         // Additional ESP32 ADC setup
         analogSetWidth(12);  // 12-bit resolution (0-4095)
         
+        // Characterize the ADC and precompute the code -> pH table
+        Serial.printf("[pH] ADC characterization: %s\n", lut.characterize());
+        adcCharacterized = true;
+        setCalibration(calMid, calLow, calHigh);
+        
         // Test raw ADC reading first
-        delay(100);
-        int rawTest = analogRead(analogPin);
+        hal::delay(100);
+        int rawTest = hal::analogRead(analogPin);
         Serial.printf("[pH] Raw ADC test reading: %d (should be 0-4095)\n", rawTest);
         
         if (rawTest == 0) {
@@ -128,38 +157,118 @@ public:
      * @return true if read successful, false otherwise
      */
     bool read() override {
+        return acquireBlocking();
+    }
+    
+    /**
+     * @brief Start a new PH_VOLTAGE_AVERAGING-sample burst
+     * @return true if sampling is in progress
+     */
+    bool trigger() override {
+        pendingRawSum = 0;
+        pendingSamples = 0;
+        return initialized;
+    }
+    
+    /**
+     * @brief Take one ADC sample of the burst
+     */
+    void poll() override {
+        if (pendingSamples < PH_VOLTAGE_AVERAGING) {
+            traceRecorder.begin(TRACE_PH_ADC);
+            pendingRawSum += hal::analogRead(analogPin);
+            pendingSamples++;
+            traceRecorder.end(TRACE_PH_ADC);
+        }
+    }
+    
+    bool isReady() const override {
+        return pendingSamples >= PH_VOLTAGE_AVERAGING;
+    }
+    
+    /**
+     * @brief Finish the burst and convert it to pH
+     * @return true if read successful, false otherwise
+     */
+    bool collect() override {
         if (!initialized) {
             Serial.println("[pH] ERROR: Sensor not initialized");
-            addFailureToAverage();  // Record failure in moving average
-            lastReadSuccess = false;
+            rejectSample(pipeline);  // Record failure in moving average
             return false;
         }
         
-        float ph = readPH();
+        // Collected before the burst finished: take the rest now
+        traceRecorder.begin(TRACE_PH_COLLECT);
+        while (!isReady()) {
+            poll();
+        }
+        float ph = convertRaw((pendingRawSum + PH_VOLTAGE_AVERAGING / 2) / PH_VOLTAGE_AVERAGING);
         
-        // Validate range
-        if (ph < PH_MIN || ph > PH_MAX) {
+        // Range check -> average
+        bool accepted = acceptSample(pipeline, ph, currentPH);
+        traceRecorder.end(TRACE_PH_COLLECT, accepted);
+        if (!accepted) {
             Serial.printf("[pH] ERROR: pH out of range: %.2f\n", ph);
-            addFailureToAverage();  // Record failure in moving average
-            lastReadSuccess = false;
             return false;
         }
         
-        // Add to moving average
-        addToAverage(ph);
-        
-        // Update current value with averaged reading
-        currentPH = getAverage(ph);
-        
         #ifdef DEBUG_VERBOSE
         Serial.printf("[pH] Raw: %.2f | Avg: %.2f | Success: %.1f%% (%zu valid)\n", 
                       ph, currentPH, getSuccessRate(), getValidReadingCount());
         #endif
         
-        lastReadSuccess = true;
         return true;
     }
     
+    /**
+     * @brief Set the 3-point calibration and rebuild the lookup table
+     * 
+     * Before begin() the values are only stored; begin() builds the table.
+     * @param mid Voltage measured in pH 7.0 buffer (mV)
+     * @param low Voltage measured in pH 4.0 buffer (mV)
+     * @param high Voltage measured in pH 10.0 buffer (mV)
+     */
+    void setCalibration(float mid, float low, float high) {
+        calMid = mid;
+        calLow = low;
+        calHigh = high;
+        if (!adcCharacterized) {
+            return;
+        }
+        
+        unsigned long start = micros();
+        lut.build(calMid, calLow, calHigh);
+        Serial.printf("[pH] Calibration mid=%.1f low=%.1f high=%.1f mV - table built in %lu us\n",
+                      calMid, calLow, calHigh, micros() - start);
+    }
+    
+    /**
+     * @brief Get the calibration currently in use
+     * @param mid Receives pH 7.0 voltage (mV)
+     * @param low Receives pH 4.0 voltage (mV)
+     * @param high Receives pH 10.0 voltage (mV)
+     */
+    void getCalibration(float& mid, float& low, float& high) const {
+        mid = calMid;
+        low = calLow;
+        high = calHigh;
+    }
+    
+    /**
+     * @brief Get the code -> pH table the readings are converted with
+     */
+    PHLookupTable& getLookupTable() {
+        return lut;
+    }
+    
+    /**
+     * @brief Take a single unaveraged ADC sample (used by calibration streaming)
+     * @return Probe voltage in millivolts
+     */
+    float sampleMillivolts() {
+        return lut.rawToMillivolts(hal::analogRead(analogPin));
+    }
+    
     /**
      * @brief Get averaged pH value
      * @return pH value (0-14 scale)
@@ -168,6 +277,12 @@ public:
         return currentPH;
     }
     
+    void refreshFromAverage() override {
+        if (movingAverage && movingAverage->getValidCount() > 0) {
+            currentPH = movingAverage->getAverage();
+        }
+    }
+    
     /**
      * @brief Get pH as formatted string
      * @param buffer Character buffer to store result
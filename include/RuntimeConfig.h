@@ -0,0 +1,185 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include "RuntimeSettings.h"
+
+/**
+ * @brief Loads, validates, applies and persists RuntimeSettings
+ *
+ * Config messages are JSON objects with any subset of the RuntimeSettings
+ * field names, e.g. {"sensorReadInterval": 2000, "phWindow": 30}, or
+ * {"defaults": true} to return to the config.h values. Updates are applied
+ * all-or-nothing: the message is merged into a copy of the live settings,
+ * the whole copy is validated, and only then assigned to runtimeSettings.
+ */
+class RuntimeConfig {
+private:
+    static constexpr const char* NVS_NAMESPACE = "runtime";
+    static constexpr const char* NVS_KEY = "settings";
+
+    static bool checkRange(float minValue, float maxValue, const char* name, const char** error) {
+        if (isnan(minValue) || isnan(maxValue) || minValue >= maxValue) {
+            *error = name;
+            return false;
+        }
+        return true;
+    }
+
+    static bool checkWindow(uint16_t window, const char* name, const char** error) {
+        if (window < 1 || window > MAX_AVERAGE_WINDOW) {
+            *error = name;
+            return false;
+        }
+        return true;
+    }
+
+    // A present member must hold a T: "abc" or 3.7 for an integer field is
+    // rejected instead of becoming 0 or being truncated by as<T>()
+    template <typename T>
+    static bool merge(JsonVariant source, const char* key, T& field, const char** error) {
+        JsonVariant value = source[key];
+        if (value.isNull()) {
+            return true;
+        }
+        if (!value.is<T>()) {
+            *error = key;
+            return false;
+        }
+        field = value.as<T>();
+        return true;
+    }
+
+public:
+    /**
+     * @brief Validate a complete settings candidate
+     * @param s Settings to check
+     * @param error Receives the name of the first invalid setting
+     * @return true if every field is within bounds
+     */
+    static bool validate(const RuntimeSettings& s, const char** error) {
+        if (s.sensorReadInterval < 100 || s.sensorReadInterval > 3600000UL) {
+            *error = "sensorReadInterval";
+            return false;
+        }
+        if (s.sensorPublishInterval < s.sensorReadInterval || s.sensorPublishInterval > 3600000UL) {
+            *error = "sensorPublishInterval";
+            return false;
+        }
+        if (s.healthMsgInterval < 5000 || s.healthMsgInterval > 3600000UL) {
+            *error = "healthMsgInterval";
+            return false;
+        }
+        return checkRange(s.tempMin, s.tempMax, "tempMin/tempMax", error) &&
+               checkRange(s.humidityMin, s.humidityMax, "humidityMin/humidityMax", error) &&
+               checkRange(s.waterLevelMin, s.waterLevelMax, "waterLevelMin/waterLevelMax", error) &&
+               checkRange(s.phMin, s.phMax, "phMin/phMax", error) &&
+               checkWindow(s.tempHumidityWindow, "tempHumidityWindow", error) &&
+               checkWindow(s.waterLevelWindow, "waterLevelWindow", error) &&
+               checkWindow(s.phWindow, "phWindow", error);
+    }
+
+    /**
+     * @brief Load persisted settings from NVS into runtimeSettings
+     * @return true if a valid stored copy was found, false if defaults are in use
+     */
+    static bool load() {
+        runtimeSettings = RuntimeSettings::defaults();
+
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, true)) {
+            return false;
+        }
+
+        RuntimeSettings stored;
+        size_t len = prefs.getBytes(NVS_KEY, &stored, sizeof(stored));
+        prefs.end();
+
+        const char* error = nullptr;
+        if (len != sizeof(stored) || stored.version != RUNTIME_SETTINGS_VERSION) {
+            return false;
+        }
+        if (!validate(stored, &error)) {
+            Serial.printf("[CONFIG] Stored settings invalid (%s), using defaults\n", error);
+            return false;
+        }
+
+        runtimeSettings = stored;
+        return true;
+    }
+
+    /**
+     * @brief Persist the live settings to NVS
+     * @return true if written successfully
+     */
+    static bool save() {
+        Preferences prefs;
+        if (!prefs.begin(NVS_NAMESPACE, false)) {
+            return false;
+        }
+        size_t written = prefs.putBytes(NVS_KEY, &runtimeSettings, sizeof(runtimeSettings));
+        prefs.end();
+        return written == sizeof(runtimeSettings);
+    }
+
+    /**
+     * @brief Merge a JSON config message into the live settings
+     * @param source Parsed config message
+     * @param error Receives a reason if the update was rejected
+     * @return true if the settings were changed (not yet persisted)
+     */
+    static bool apply(JsonVariant source, const char** error) {
+        RuntimeSettings candidate = runtimeSettings;
+
+        if (source["defaults"] | false) {
+            candidate = RuntimeSettings::defaults();
+        }
+
+        bool ok = merge(source, "sensorReadInterval", candidate.sensorReadInterval, error);
+        ok = ok && merge(source, "sensorPublishInterval", candidate.sensorPublishInterval, error);
+        ok = ok && merge(source, "healthMsgInterval", candidate.healthMsgInterval, error);
+        ok = ok && merge(source, "tempMin", candidate.tempMin, error);
+        ok = ok && merge(source, "tempMax", candidate.tempMax, error);
+        ok = ok && merge(source, "humidityMin", candidate.humidityMin, error);
+        ok = ok && merge(source, "humidityMax", candidate.humidityMax, error);
+        ok = ok && merge(source, "waterLevelMin", candidate.waterLevelMin, error);
+        ok = ok && merge(source, "waterLevelMax", candidate.waterLevelMax, error);
+        ok = ok && merge(source, "phMin", candidate.phMin, error);
+        ok = ok && merge(source, "phMax", candidate.phMax, error);
+        ok = ok && merge(source, "tempHumidityWindow", candidate.tempHumidityWindow, error);
+        ok = ok && merge(source, "waterLevelWindow", candidate.waterLevelWindow, error);
+        ok = ok && merge(source, "phWindow", candidate.phWindow, error);
+
+        if (!ok || !validate(candidate, error)) {
+            return false;
+        }
+
+        runtimeSettings = candidate;  // Single assignment - never observed half-applied
+        return true;
+    }
+
+    /**
+     * @brief Serialize the live settings into a JSON object
+     * @param target Object to fill
+     */
+    static void toJson(JsonVariant target) {
+        target["sensorReadInterval"] = runtimeSettings.sensorReadInterval;
+        target["sensorPublishInterval"] = runtimeSettings.sensorPublishInterval;
+        target["healthMsgInterval"] = runtimeSettings.healthMsgInterval;
+        target["tempMin"] = runtimeSettings.tempMin;
+        target["tempMax"] = runtimeSettings.tempMax;
+        target["humidityMin"] = runtimeSettings.humidityMin;
+        target["humidityMax"] = runtimeSettings.humidityMax;
+        target["waterLevelMin"] = runtimeSettings.waterLevelMin;
+        target["waterLevelMax"] = runtimeSettings.waterLevelMax;
+        target["phMin"] = runtimeSettings.phMin;
+        target["phMax"] = runtimeSettings.phMax;
+        target["tempHumidityWindow"] = runtimeSettings.tempHumidityWindow;
+        target["waterLevelWindow"] = runtimeSettings.waterLevelWindow;
+        target["phWindow"] = runtimeSettings.phWindow;
+    }
+};
+
+#endif // RUNTIME_CONFIG_H
@@ -0,0 +1,69 @@
+#ifndef RUNTIME_SETTINGS_H
+#define RUNTIME_SETTINGS_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Bump whenever the RuntimeSettings layout changes so stale NVS blobs are ignored
+#define RUNTIME_SETTINGS_VERSION 1
+
+/**
+ * @brief Settings that can be changed at runtime over the MQTT config topic
+ *
+ * Compile-time defaults come from config.h. The live copy is the global
+ * runtimeSettings; hot paths read its fields directly, which costs the same
+ * single load as the #define constants did. Never modify fields in place -
+ * build a candidate copy, validate it and assign it in one go (see RuntimeConfig).
+ */
+struct RuntimeSettings {
+    uint16_t version;
+
+    // Scheduler intervals (milliseconds)
+    uint32_t sensorReadInterval;
+    uint32_t sensorPublishInterval;
+    uint32_t healthMsgInterval;
+
+    // Validation ranges
+    float tempMin;
+    float tempMax;
+    float humidityMin;
+    float humidityMax;
+    float waterLevelMin;    // cm
+    float waterLevelMax;    // cm
+    float phMin;
+    float phMax;
+
+    // Moving average window sizes (samples, 1..MAX_AVERAGE_WINDOW)
+    uint16_t tempHumidityWindow;
+    uint16_t waterLevelWindow;
+    uint16_t phWindow;
+
+    /**
+     * @brief Build the compile-time defaults from config.h
+     * @return Settings populated from the #define values
+     */
+    static RuntimeSettings defaults() {
+        RuntimeSettings s;
+        s.version = RUNTIME_SETTINGS_VERSION;
+        s.sensorReadInterval = SENSOR_READ_INTERVAL;
+        s.sensorPublishInterval = SENSOR_PUBLISH_INTERVAL;
+        s.healthMsgInterval = HEALTH_MSG_INTERVAL;
+        s.tempMin = TEMP_MIN;
+        s.tempMax = TEMP_MAX;
+        s.humidityMin = HUMIDITY_MIN;
+        s.humidityMax = HUMIDITY_MAX;
+        s.waterLevelMin = MIN_WATER_LEVEL_CM;
+        s.waterLevelMax = MAX_WATER_LEVEL_CM;
+        s.phMin = PH_MIN;
+        s.phMax = PH_MAX;
+        s.tempHumidityWindow = TEMP_HUMIDITY_WINDOW;
+        s.waterLevelWindow = WATER_LEVEL_WINDOW;
+        s.phWindow = PH_WINDOW;
+        return s;
+    }
+};
+
+// Live settings, defined in main.cpp
+extern RuntimeSettings runtimeSettings;
+
+#endif // RUNTIME_SETTINGS_H
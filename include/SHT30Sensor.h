@@ -4,8 +4,35 @@
 #include "SensorBase.h"
 #include "MovingAverage.h"
 #include "config.h"
+#include "RuntimeSettings.h"
+#include "FilterPipeline.h"
+#include "I2CBus.h"
+#include "TraceRecorder.h"
+#include <Wire.h>
 #include <Adafruit_SHT31.h>
 
+/**
+ * @brief Temperature processing: record raw -> range check -> record accepted -> history -> windowed mean
+ */
+typedef FilterPipeline<
+    RecordStage<RAW_SAMPLE_RING_SIZE>,
+    RangeStage<&RuntimeSettings::tempMin, &RuntimeSettings::tempMax>,
+    AcceptStage<RAW_SAMPLE_RING_SIZE>,
+    HistoryStage,
+    WindowedMeanStage<MAX_AVERAGE_WINDOW>
+> TemperaturePipeline;
+
+/**
+ * @brief Humidity processing: record raw -> range check -> record accepted -> history -> windowed mean
+ */
+typedef FilterPipeline<
+    RecordStage<RAW_SAMPLE_RING_SIZE>,
+    RangeStage<&RuntimeSettings::humidityMin, &RuntimeSettings::humidityMax>,
+    AcceptStage<RAW_SAMPLE_RING_SIZE>,
+    HistoryStage,
+    WindowedMeanStage<MAX_AVERAGE_WINDOW>
+> HumidityPipeline;
+
 /**
  * @brief SHT30 Temperature and Humidity Sensor
  * 
@@ -15,16 +42,71 @@
 class SHT30Sensor : public SensorBase {
 private:
     Adafruit_SHT31 sht;
-    MovingAverage<float, TEMP_HUMIDITY_WINDOW> tempAvg;
-    MovingAverage<float, TEMP_HUMIDITY_WINDOW> humidityAvg;
+    TemperaturePipeline tempPipeline;
+    HumidityPipeline humidityPipeline;
+    MovingAverage<float, MAX_AVERAGE_WINDOW>& tempAvg;      // Averaging stages of the pipelines
+    MovingAverage<float, MAX_AVERAGE_WINDOW>& humidityAvg;
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& tempRaw;        // Recording stages of the pipelines
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& humidityRaw;
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& tempAccepted;   // Accepting stages of the pipelines
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& humidityAccepted;
     float currentTemp;
     float currentHumidity;
     
+    // Two-phase acquisition state
+    int64_t readyAtUs;      // esp_timer time the triggered conversion completes
+    bool triggerFailed;     // Measurement command was not acknowledged
+    
+    /**
+     * @brief CRC-8 of a measurement word (polynomial 0x31, init 0xFF)
+     */
+    static uint8_t crc8(const uint8_t* data, size_t len) {
+        uint8_t crc = 0xFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++) {
+                crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+            }
+        }
+        return crc;
+    }
+    
+    /**
+     * @brief Fetch the result of a single-shot measurement
+     * @param temp Receives temperature (°C)
+     * @param humidity Receives relative humidity (%)
+     * @return false on NACK, short read or CRC mismatch
+     */
+    bool fetchMeasurement(float& temp, float& humidity) {
+        uint8_t data[6];
+        if (hal::i2cRead(SHT30_I2C_ADDRESS, data, sizeof(data)) != sizeof(data)) {
+            return false;
+        }
+        if (crc8(data, 2) != data[2] || crc8(data + 3, 2) != data[5]) {
+            return false;
+        }
+        uint16_t rawTemp = (uint16_t)((data[0] << 8) | data[1]);
+        uint16_t rawHumidity = (uint16_t)((data[3] << 8) | data[4]);
+        temp = -45.0f + 175.0f * rawTemp / 65535.0f;
+        humidity = 100.0f * rawHumidity / 65535.0f;
+        return true;
+    }
+    
 public:
     /**
      * @brief Constructor
      */
-    SHT30Sensor() : SensorBase("SHT30"), currentTemp(0.0), currentHumidity(0.0) {}
+    SHT30Sensor()
+        : SensorBase("SHT30"),
+          tempAvg(*tempPipeline.find<MovingAverage<float, MAX_AVERAGE_WINDOW> >()),
+          humidityAvg(*humidityPipeline.find<MovingAverage<float, MAX_AVERAGE_WINDOW> >()),
+          tempRaw(*tempPipeline.find<RecordStage<RAW_SAMPLE_RING_SIZE> >()),
+          humidityRaw(*humidityPipeline.find<RecordStage<RAW_SAMPLE_RING_SIZE> >()),
+          tempAccepted(*tempPipeline.find<AcceptStage<RAW_SAMPLE_RING_SIZE> >()),
+          humidityAccepted(*humidityPipeline.find<AcceptStage<RAW_SAMPLE_RING_SIZE> >()),
+          currentTemp(0.0), currentHumidity(0.0), readyAtUs(0), triggerFailed(false) {
+        setAverageWindow(TEMP_HUMIDITY_WINDOW);
+    }
     
     /**
      * @brief Initialize the SHT30 sensor
@@ -33,7 +115,7 @@ public:
     bool begin() override {
         Serial.println("[SHT30] Initializing sensor...");
         
-        if (!sht.begin(SHT30_I2C_ADDRESS)) {
+        if (!hal::outcome(sht.begin(SHT30_I2C_ADDRESS))) {
             Serial.println("[SHT30] ERROR: Failed to initialize sensor");
             initialized = false;
             return false;
@@ -44,67 +126,125 @@ public:
         return true;
     }
     
+    /**
+     * @brief Free the I2C bus, soft-reset the sensor and re-initialize it
+     * @return true if the sensor answers again
+     */
+    bool recover() override {
+        initialized = false;
+        if (!I2CBus::recover(I2C_SDA, I2C_SCL)) {
+            Serial.println("[SHT30] WARNING: SDA still held low after bus recovery");
+        }
+        
+        // Soft reset (0x30A2) clears a sensor stuck in a bad state; takes up to 1.5ms
+        const uint8_t softReset[2] = { 0x30, 0xA2 };
+        if (hal::i2cWrite(SHT30_I2C_ADDRESS, softReset, sizeof(softReset)) != 0) {
+            Serial.println("[SHT30] ERROR: Soft reset not acknowledged");
+        }
+        hal::delay(2);
+        readyAtUs = 0;
+        triggerFailed = false;
+        
+        return begin();
+    }
+    
     /**
      * @brief Read temperature and humidity from sensor
      * @return true if read successful, false otherwise
      */
     bool read() override {
+        return acquireBlocking();
+    }
+    
+    /**
+     * @brief Send a single-shot, high-repeatability measurement command
+     * @return true if the conversion started
+     *
+     * Uses the no-clock-stretching variant so the bus stays free while the
+     * sensor converts.
+     */
+    bool trigger() override {
+        if (!initialized) {
+            triggerFailed = true;
+            return false;
+        }
+        traceRecorder.begin(TRACE_SHT30_TRIGGER);
+        const uint8_t measure[2] = { 0x24, 0x00 };
+        triggerFailed = hal::i2cWrite(SHT30_I2C_ADDRESS, measure, sizeof(measure)) != 0;
+        traceRecorder.end(TRACE_SHT30_TRIGGER, !triggerFailed);
+        readyAtUs = hal::now() + SHT30_MEASUREMENT_US;
+        return !triggerFailed;
+    }
+    
+    bool isReady() const override {
+        return triggerFailed || hal::now() >= readyAtUs;
+    }
+    
+    /**
+     * @brief Read back the triggered measurement
+     * @return true if read successful, false otherwise
+     */
+    bool collect() override {
         if (!initialized) {
             Serial.println("[SHT30] ERROR: Sensor not initialized");
-            tempAvg.addFailure();
-            humidityAvg.addFailure();
-            lastReadSuccess = false;
+            rejectSample(tempPipeline);
+            rejectSample(humidityPipeline);
             return false;
         }
         
-        float temp = sht.readTemperature();
-        float humidity = sht.readHumidity();
+        // Called early (outside the scheduler): wait out the conversion
+        int64_t remaining = readyAtUs - hal::now();
+        if (!triggerFailed && remaining > 0) {
+            hal::delayMicroseconds((uint32_t)remaining);
+        }
+        
+        float temp = NAN;
+        float humidity = NAN;
         
-        // Check if readings are valid
-        if (isnan(temp) || isnan(humidity)) {
+        // A failed transfer invalidates both channels
+        traceRecorder.begin(TRACE_SHT30_READ);
+        bool fetched = !triggerFailed && fetchMeasurement(temp, humidity);
+        traceRecorder.end(TRACE_SHT30_READ, fetched);
+        if (!fetched) {
             Serial.println("[SHT30] ERROR: Failed to read sensor");
-            tempAvg.addFailure();
-            humidityAvg.addFailure();
-            lastReadSuccess = false;
+            rejectSample(tempPipeline);
+            rejectSample(humidityPipeline);
             return false;
         }
         
-        // Validate temperature range
-        if (temp < TEMP_MIN || temp > TEMP_MAX) {
+        // Range check -> average, per channel
+        bool tempOk = acceptSample(tempPipeline, temp, currentTemp);
+        bool humidityOk = acceptSample(humidityPipeline, humidity, currentHumidity);
+        
+        if (!tempOk) {
             Serial.printf("[SHT30] ERROR: Temperature out of range: %.2f°C\n", temp);
-            tempAvg.addFailure();
-            humidityAvg.addFailure();
-            lastReadSuccess = false;
-            return false;
         }
-        
-        // Validate humidity range
-        if (humidity < HUMIDITY_MIN || humidity > HUMIDITY_MAX) {
+        if (!humidityOk) {
             Serial.printf("[SHT30] ERROR: Humidity out of range: %.2f%%\n", humidity);
-            tempAvg.addFailure();
-            humidityAvg.addFailure();
-            lastReadSuccess = false;
+        }
+        if (!tempOk || !humidityOk) {
+            markFailedRead();
             return false;
         }
         
-        // Add successful readings to moving average
-        tempAvg.addReading(temp, true);
-        humidityAvg.addReading(humidity, true);
-        
-        // Update current values with averaged readings
-        currentTemp = tempAvg.getAverage();
-        currentHumidity = humidityAvg.getAverage();
-        
         #ifdef DEBUG_VERBOSE
         Serial.printf("[SHT30] Raw: T=%.2f°C, H=%.2f%% | Avg: T=%.2f°C, H=%.2f%% | Success: T=%.1f%% H=%.1f%%\n", 
                       temp, humidity, currentTemp, currentHumidity,
                       tempAvg.getSuccessRate(), humidityAvg.getSuccessRate());
         #endif
         
-        lastReadSuccess = true;
         return true;
     }
     
+    /**
+     * @brief Resize both temperature and humidity windows
+     * @param window New window size in samples (1..MAX_AVERAGE_WINDOW)
+     */
+    void setAverageWindow(size_t window) override {
+        tempAvg.setWindowSize(window);
+        humidityAvg.setWindowSize(window);
+    }
+    
     /**
      * @brief Get averaged temperature value
      * @return Temperature in Celsius
@@ -121,6 +261,15 @@ public:
         return currentHumidity;
     }
     
+    void refreshFromAverage() override {
+        if (tempAvg.getValidCount() > 0) {
+            currentTemp = tempAvg.getAverage();
+        }
+        if (humidityAvg.getValidCount() > 0) {
+            currentHumidity = humidityAvg.getAverage();
+        }
+    }
+    
     /**
      * @brief Get temperature as formatted string
      * @param buffer Character buffer to store result
@@ -139,6 +288,68 @@ public:
         snprintf(buffer, bufSize, "%.2f", currentHumidity);
     }
     
+    /**
+     * @brief Get the raw temperature sample ring
+     * @return Timestamped raw readings (°C)
+     */
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& getTemperatureSamples() const {
+        return tempRaw;
+    }
+    
+    /**
+     * @brief Get the raw humidity sample ring
+     * @return Timestamped raw readings (%)
+     */
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& getHumiditySamples() const {
+        return humidityRaw;
+    }
+    
+    /**
+     * @brief Get the accepted temperature sample ring
+     * @return Timestamped readings that passed the range check (°C)
+     */
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& getAcceptedTemperatureSamples() const {
+        return tempAccepted;
+    }
+    
+    /**
+     * @brief Get the accepted humidity sample ring
+     * @return Timestamped readings that passed the range check (%)
+     */
+    const SampleRing<RAW_SAMPLE_RING_SIZE>& getAcceptedHumiditySamples() const {
+        return humidityAccepted;
+    }
+    
+    /**
+     * @brief Get the temperature averaging stage
+     */
+    MovingAverage<float, MAX_AVERAGE_WINDOW>& getTemperatureAverage() {
+        return tempAvg;
+    }
+    
+    /**
+     * @brief Get the humidity averaging stage
+     */
+    MovingAverage<float, MAX_AVERAGE_WINDOW>& getHumidityAverage() {
+        return humidityAvg;
+    }
+    
+    /**
+     * @brief Get the temperature history
+     * @return Multi-resolution archives (°C)
+     */
+    ChannelHistory& getTemperatureHistory() {
+        return tempPipeline;
+    }
+    
+    /**
+     * @brief Get the humidity history
+     * @return Multi-resolution archives (%)
+     */
+    ChannelHistory& getHumidityHistory() {
+        return humidityPipeline;
+    }
+    
     /**
      * @brief Check if temperature readings have valid majority (>50%)
      * @return true if temperature data is reliable for publishing
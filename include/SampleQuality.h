@@ -0,0 +1,200 @@
+#ifndef SAMPLE_QUALITY_H
+#define SAMPLE_QUALITY_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "SampleRing.h"
+#include "config.h"
+
+/**
+ * @brief Fault a channel's raw samples currently show
+ */
+enum SampleFault {
+    SAMPLE_FAULT_NONE = 0,
+    SAMPLE_FAULT_FLATLINE,      // Exactly the same value for QUALITY_FLATLINE_SAMPLES samples
+    SAMPLE_FAULT_STUCK,         // Only flipping between two distant values for QUALITY_STUCK_SAMPLES samples
+    SAMPLE_FAULT_NOISY          // Sample-to-sample noise well above the learned baseline
+};
+
+/**
+ * @brief Streaming fault detectors for one channel, O(1) per sample
+ *
+ * Read failures are already visible through the moving average's success
+ * rate; these detectors catch probes that keep answering with bad data:
+ * - flatline: a run of identical values (dead probe, frozen ADC input)
+ * - stuck: values confined to two levels at least QUALITY_STUCK_MIN_STEPS
+ *   resolutions apart (echo flipping between two reflections, one ADC bit
+ *   toggling); adjacent levels are ordinary quantization of a quiet signal
+ * - noisy: EWMA of the squared first difference (fast) against a slowly
+ *   learned EWMA baseline of the same; first differences ignore slow trends
+ *   so a rising level is not mistaken for noise. The baseline is frozen while
+ *   the channel is flagged, so a failing probe cannot teach it its own noise.
+ */
+class SampleQuality {
+private:
+    float resolution;
+    float floorEnergy;          // Squared reporting resolution; noise below this is ignored
+    float prev;
+    float levelA;               // Two-level run: the values seen since the run started
+    float levelB;
+    bool hasLevelB;
+    uint32_t count;
+    uint32_t sameRun;
+    uint32_t levelRun;
+    uint32_t levelFlips;        // Changes between the two levels during the run
+    float fastEnergy;
+    float baselineEnergy;
+    bool noisy;
+    uint32_t cursor;
+
+public:
+    SampleQuality() : resolution(0.0f), floorEnergy(0.0f) {
+        reset();
+    }
+
+    /**
+     * @brief Set the channel's reporting resolution
+     * @param step Smallest meaningful change (e.g. 0.01 for values sent with scale 100)
+     */
+    void begin(float step) {
+        resolution = step;
+        floorEnergy = step * step;
+        reset();
+    }
+
+    void reset() {
+        prev = 0.0f;
+        levelA = levelB = 0.0f;
+        hasLevelB = false;
+        count = 0;
+        sameRun = levelRun = levelFlips = 0;
+        fastEnergy = baselineEnergy = 0.0f;
+        noisy = false;
+        cursor = 0;
+    }
+
+    /**
+     * @brief Feed one raw sample
+     */
+    void update(float value) {
+        if (count == 0) {
+            prev = levelA = value;
+            hasLevelB = false;
+            sameRun = levelRun = 1;
+            levelFlips = 0;
+            count = 1;
+            return;
+        }
+
+        // Flatline: consecutive identical values
+        sameRun = value == prev ? sameRun + 1 : 1;
+
+        // Two-level run: restart from {prev, value} when a third value shows up
+        if (value == levelA || (hasLevelB && value == levelB)) {
+            levelRun++;
+        } else if (!hasLevelB) {
+            levelB = value;
+            hasLevelB = true;
+            levelRun++;
+        } else {
+            levelA = prev;
+            levelB = value;
+            levelRun = 2;
+            levelFlips = 0;
+        }
+        if (value != prev) {
+            levelFlips++;
+        }
+
+        // Noise: fast vs baseline energy of first differences
+        float diff = value - prev;
+        float energy = diff * diff;
+        fastEnergy += QUALITY_NOISE_FAST_ALPHA * (energy - fastEnergy);
+        if (count < QUALITY_WARMUP_SAMPLES) {
+            baselineEnergy += (energy - baselineEnergy) / count;  // Plain mean until warmed up
+        } else if (!noisy) {
+            baselineEnergy += QUALITY_NOISE_SLOW_ALPHA * (energy - baselineEnergy);
+        }
+        if (count >= QUALITY_WARMUP_SAMPLES) {
+            float reference = baselineEnergy > floorEnergy ? baselineEnergy : floorEnergy;
+            if (!noisy && fastEnergy > reference * QUALITY_NOISE_RATIO) {
+                noisy = true;
+            } else if (noisy && fastEnergy < reference * QUALITY_NOISE_RATIO * 0.5f) {
+                noisy = false;
+            }
+        }
+
+        prev = value;
+        if (count < 0xFFFFFFFF) {
+            count++;
+        }
+    }
+
+    /**
+     * @brief Feed every sample pushed to a ring since the last call
+     */
+    template <size_t SIZE>
+    void feed(const SampleRing<SIZE>& ring) {
+        if (cursor < ring.oldest()) {
+            cursor = ring.oldest();
+        }
+        while (cursor != ring.head()) {
+            update(ring.get(cursor++).value);
+        }
+    }
+
+    SampleFault getFault() const {
+        if (sameRun >= QUALITY_FLATLINE_SAMPLES) {
+            return SAMPLE_FAULT_FLATLINE;
+        }
+        // Must keep flipping: a step to a new constant level is not "stuck"
+        if (hasLevelB && levelRun >= QUALITY_STUCK_SAMPLES && levelFlips >= levelRun / 4 &&
+            fabsf(levelA - levelB) >= resolution * QUALITY_STUCK_MIN_STEPS) {
+            return SAMPLE_FAULT_STUCK;
+        }
+        if (noisy) {
+            return SAMPLE_FAULT_NOISY;
+        }
+        return SAMPLE_FAULT_NONE;
+    }
+
+    /**
+     * @brief Data quality from the detectors alone
+     * @return 0-100 (100 = no fault); noise lowers it with the fast/baseline ratio
+     */
+    uint8_t getScore() const {
+        switch (getFault()) {
+            case SAMPLE_FAULT_FLATLINE:
+                return 10;
+            case SAMPLE_FAULT_STUCK:
+                return 25;
+            case SAMPLE_FAULT_NOISY: {
+                float reference = baselineEnergy > floorEnergy ? baselineEnergy : floorEnergy;
+                float score = 100.0f * sqrtf(reference / fastEnergy);  // Ratio of noise amplitudes
+                return score < 20.0f ? 20 : (uint8_t)score;
+            }
+            default:
+                return 100;
+        }
+    }
+
+    /**
+     * @brief Current noise relative to the learned baseline (amplitude ratio)
+     */
+    float getNoiseRatio() const {
+        float reference = baselineEnergy > floorEnergy ? baselineEnergy : floorEnergy;
+        return reference > 0.0f ? sqrtf(fastEnergy / reference) : 0.0f;
+    }
+
+    static const char* faultName(SampleFault fault) {
+        switch (fault) {
+            case SAMPLE_FAULT_NONE:     return "none";
+            case SAMPLE_FAULT_FLATLINE: return "flatline";
+            case SAMPLE_FAULT_STUCK:    return "stuck";
+            case SAMPLE_FAULT_NOISY:    return "noisy";
+            default:                    return "unknown";
+        }
+    }
+};
+
+#endif // SAMPLE_QUALITY_H
@@ -0,0 +1,95 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <Arduino.h>
+
+/**
+ * @brief One raw reading with its 64-bit esp_timer timestamp
+ */
+struct TimedSample {
+    int64_t timestampUs;  // esp_timer_get_time() when the value was measured
+    float value;
+};
+
+/**
+ * @brief Fixed-size ring of timestamped raw samples
+ * @tparam SIZE Number of samples retained
+ *
+ * Every pushed sample gets a sequence number (total samples written so far).
+ * Readers keep their own cursor and fetch everything newer with get(seq);
+ * samples older than oldest() have been overwritten, which lets a reader that
+ * fell behind report exactly how many it missed.
+ */
+template <size_t SIZE>
+class SampleRing {
+private:
+    TimedSample samples[SIZE];
+    uint32_t written;   // Sequence number of the next sample
+    uint32_t first;     // Sequence number of the oldest sample still held
+
+public:
+    SampleRing() : written(0), first(0) {}
+
+    /**
+     * @brief Append a sample, overwriting the oldest when full
+     * @param timestampUs Measurement time (esp_timer_get_time())
+     * @param value Raw value
+     */
+    void push(int64_t timestampUs, float value) {
+        TimedSample& slot = samples[written % SIZE];
+        slot.timestampUs = timestampUs;
+        slot.value = value;
+        written++;
+        if (written - first > SIZE) {
+            first = written - SIZE;
+        }
+    }
+
+    /**
+     * @brief Sequence number the next sample will get
+     */
+    uint32_t head() const {
+        return written;
+    }
+
+    /**
+     * @brief Sequence number of the oldest sample still held
+     */
+    uint32_t oldest() const {
+        return first;
+    }
+
+    /**
+     * @brief Get a sample by sequence number
+     * @param seq Sequence number in [oldest(), head())
+     * @return Sample (unchecked)
+     */
+    const TimedSample& get(uint32_t seq) const {
+        return samples[seq % SIZE];
+    }
+
+    /**
+     * @brief Get the most recent sample
+     * @return Sample, or nullptr if empty
+     */
+    const TimedSample* latest() const {
+        return written == first ? nullptr : &samples[(written - 1) % SIZE];
+    }
+
+    size_t getCount() const {
+        return written - first;
+    }
+
+    static size_t capacity() {
+        return SIZE;
+    }
+
+    /**
+     * @brief Drop all samples (sequence numbers keep counting)
+     */
+    void reset() {
+        first = written;
+    }
+};
+
+#endif // SAMPLE_RING_H
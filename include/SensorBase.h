@@ -2,48 +2,113 @@
 #define SENSOR_BASE_H
 
 #include <Arduino.h>
+#include "Hal.h"
 #include "MovingAverage.h"
+#include "HampelFilter.h"
+#include "FilterPipeline.h"
+#include "config.h"
 
 /**
  * @brief Abstract base class for all sensors
  * 
  * This class provides a common interface for all sensor implementations.
  * Each sensor must implement the initialization, reading, and data retrieval methods.
- * Includes optional moving average functionality for sensor smoothing.
+ * Sample processing (validation, despiking, averaging) is done by a FilterPipeline
+ * owned by the driver; attaching it exposes its averaging stage through this class.
+ *
+ * Besides the blocking read(), sensors support two-phase acquisition so several
+ * conversions can run at once: trigger() starts a measurement and returns
+ * immediately, poll() is called repeatedly while waiting (for sensors that need
+ * CPU to sample), isReady() reports when collect() will not block, and
+ * collect() finishes the read exactly as read() would.
  */
 class SensorBase {
 protected:
     const char* sensorName;
     bool initialized;
     bool lastReadSuccess;
-    unsigned long lastSuccessfulReadTime;  // millis() when last successful read occurred
+    int64_t lastSuccessfulReadUs;  // hal::now() of the last successful read (0 = never)
     
-    // Moving average functionality (optional - can be nullptr if not used)
-    MovingAverage<float, 15>* movingAverage;  // Default 15-sample window
+    // Stages of the primary channel's pipeline (nullptr if the pipeline has none)
+    MovingAverage<float, MAX_AVERAGE_WINDOW>* movingAverage;  // Window set via setAverageWindow()
     bool useMovingAverage;
+    HampelFilter<float, HAMPEL_WINDOW>* outlierFilter;
+    SampleRing<RAW_SAMPLE_RING_SIZE>* rawSamples;
+    SampleRing<RAW_SAMPLE_RING_SIZE>* acceptedSamples;
+    ChannelHistory* history;
+    
+    /**
+     * @brief Expose the recording, history, averaging and outlier stages of the primary channel's pipeline
+     * @param pipeline Pipeline owned by the subclass (must outlive this object's use)
+     */
+    template <typename Pipeline>
+    void attachPipeline(Pipeline& pipeline) {
+        movingAverage = pipeline.template find<MovingAverage<float, MAX_AVERAGE_WINDOW> >();
+        useMovingAverage = movingAverage != nullptr;
+        outlierFilter = pipeline.template find<HampelFilter<float, HAMPEL_WINDOW> >();
+        rawSamples = pipeline.template find<RecordStage<RAW_SAMPLE_RING_SIZE> >();
+        acceptedSamples = pipeline.template find<AcceptStage<RAW_SAMPLE_RING_SIZE> >();
+        history = pipeline.template find<ChannelHistory>();
+    }
+    
+    /**
+     * @brief Push a measured value through a pipeline and update read status
+     * @param pipeline Channel pipeline
+     * @param value Raw measured value
+     * @param output Receives the filtered value if the sample was accepted
+     * @return true if accepted, false if a stage rejected it
+     */
+    template <typename Pipeline>
+    bool acceptSample(Pipeline& pipeline, float value, float& output) {
+        StageResult result = pipeline.push(value);
+        if (result == STAGE_REJECT) {
+            markFailedRead();
+            return false;
+        }
+        if (result == STAGE_PASS) {
+            output = pipeline.output();
+        }
+        markSuccessfulRead();
+        return true;
+    }
+    
+    /**
+     * @brief Record a read that produced no value at all
+     * @param pipeline Channel pipeline
+     */
+    template <typename Pipeline>
+    void rejectSample(Pipeline& pipeline) {
+        pipeline.reject();
+        markFailedRead();
+    }
+    
+    /**
+     * @brief Blocking read built from the two-phase calls
+     * @return Result of collect()
+     */
+    bool acquireBlocking() {
+        if (trigger()) {
+            while (!isReady()) {
+                poll();
+            }
+        }
+        return collect();
+    }
     
 public:
     /**
      * @brief Constructor for SensorBase
      * @param name Name of the sensor
-     * @param enableAvg Whether to enable moving average functionality
      */
-    SensorBase(const char* name, bool enableAvg = false) 
+    SensorBase(const char* name) 
         : sensorName(name), initialized(false), lastReadSuccess(false), 
-          lastSuccessfulReadTime(0), movingAverage(nullptr), useMovingAverage(enableAvg) {
-        if (useMovingAverage) {
-            movingAverage = new MovingAverage<float, 15>();
-        }
-    }
+          lastSuccessfulReadUs(0), movingAverage(nullptr), useMovingAverage(false),
+          outlierFilter(nullptr), rawSamples(nullptr), acceptedSamples(nullptr), history(nullptr) {}
     
     /**
      * @brief Virtual destructor
      */
-    virtual ~SensorBase() {
-        if (movingAverage) {
-            delete movingAverage;
-        }
-    }
+    virtual ~SensorBase() {}
     
     /**
      * @brief Initialize the sensor
@@ -57,6 +122,47 @@ public:
      */
     virtual bool read() = 0;
     
+    /**
+     * @brief Start a measurement without waiting for it
+     * @return true if a conversion is in progress; false if collect() should be called directly
+     */
+    virtual bool trigger() {
+        return true;
+    }
+    
+    /**
+     * @brief Give the sensor CPU time while its conversion runs
+     */
+    virtual void poll() {}
+    
+    /**
+     * @brief Check if the triggered measurement can be collected without blocking
+     * @return true if ready (or timed out)
+     */
+    virtual bool isReady() const {
+        return true;
+    }
+    
+    /**
+     * @brief Finish the triggered measurement and process the result
+     * @return true if read successful, false otherwise
+     *
+     * Sensors without a split implementation do their whole read here.
+     */
+    virtual bool collect() {
+        return read();
+    }
+    
+    /**
+     * @brief Bring a failed sensor back (called by SensorSupervisor)
+     * @return true if the sensor initialized again
+     *
+     * Drivers override this to reset their bus or device before begin().
+     */
+    virtual bool recover() {
+        return begin();
+    }
+    
     /**
      * @brief Get sensor name
      * @return Sensor name as const char*
@@ -82,30 +188,62 @@ public:
     }
     
     /**
-     * @brief Add a successful value to the moving average (if enabled)
-     * @param value Value to add to the average
-     * @return true if value was added, false if averaging not enabled
+     * @brief Get the number of samples replaced by the outlier stage
+     * @return Rejected sample count since boot, 0 if the pipeline has no despike stage
      */
-    bool addToAverage(float value) {
-        if (useMovingAverage && movingAverage) {
-            movingAverage->add(value);
-            return true;
-        }
-        return false;
+    uint32_t getRejectedCount() const {
+        return outlierFilter ? outlierFilter->getRejectedCount() : 0;
     }
     
     /**
-     * @brief Record a failed reading in the moving average (if enabled)
-     * @return true if failure was recorded, false if averaging not enabled
+     * @brief Check if the pipeline has an outlier stage
+     * @return true if enabled
      */
-    bool addFailureToAverage() {
-        if (useMovingAverage && movingAverage) {
-            movingAverage->addFailure();
-            return true;
-        }
-        return false;
+    bool isOutlierFilterEnabled() const {
+        return outlierFilter != nullptr;
+    }
+    
+    /**
+     * @brief Get the raw sample ring of the primary channel
+     * @return Ring, or nullptr if the pipeline does not record raw samples
+     */
+    const SampleRing<RAW_SAMPLE_RING_SIZE>* getRawSamples() const {
+        return rawSamples;
     }
     
+    /**
+     * @brief Get the ring of samples the primary channel accepted (range checked, despiked)
+     * @return Ring, or nullptr if the pipeline does not record accepted samples
+     */
+    const SampleRing<RAW_SAMPLE_RING_SIZE>* getAcceptedSamples() const {
+        return acceptedSamples;
+    }
+    
+    /**
+     * @brief Get the multi-resolution history of the primary channel
+     * @return History, or nullptr if the pipeline keeps none
+     */
+    ChannelHistory* getHistory() {
+        return history;
+    }
+    
+    /**
+     * @brief Get the averaging stage of the primary channel
+     * @return Moving average, or nullptr if the pipeline has none
+     */
+    MovingAverage<float, MAX_AVERAGE_WINDOW>* getMovingAverage() {
+        return movingAverage;
+    }
+    
+    /**
+     * @brief Take the reported value(s) from the averaging stage(s)
+     *
+     * Called after averaging windows were restored from outside the pipeline
+     * (warm start), so the value reported before the next good read matches
+     * the restored window.
+     */
+    virtual void refreshFromAverage() {}
+    
     /**
      * @brief Get the current moving average (if enabled)
      * @param defaultValue Value to return if averaging not enabled or no samples
@@ -129,6 +267,28 @@ public:
         return false;
     }
     
+    /**
+     * @brief Discard all samples in the averaging and outlier stages
+     */
+    void resetAverage() {
+        if (useMovingAverage && movingAverage) {
+            movingAverage->reset();
+        }
+        if (outlierFilter) {
+            outlierFilter->reset();
+        }
+    }
+    
+    /**
+     * @brief Resize the moving average window (keeps the most recent samples)
+     * @param window New window size in samples (1..MAX_AVERAGE_WINDOW)
+     */
+    virtual void setAverageWindow(size_t window) {
+        if (useMovingAverage && movingAverage) {
+            movingAverage->setWindowSize(window);
+        }
+    }
+    
     /**
      * @brief Check if moving average is enabled
      * @return true if enabled, false otherwise
@@ -176,7 +336,7 @@ public:
      */
     void markSuccessfulRead() {
         lastReadSuccess = true;
-        lastSuccessfulReadTime = millis();
+        lastSuccessfulReadUs = hal::now();
     }
     
     /**
@@ -185,28 +345,22 @@ public:
      */
     void markFailedRead() {
         lastReadSuccess = false;
-        // Don't update lastSuccessfulReadTime - keep the timestamp of last good read
+        // Don't update lastSuccessfulReadUs - keep the timestamp of last good read
     }
     
     /**
      * @brief Check if sensor data is fresh enough for publishing
      * @param maxAgeMs Maximum age in milliseconds for data to be considered fresh
      * @return true if data is fresh, false if stale or never read
+     *
+     * Uses the 64-bit esp_timer clock, so there is no millis() rollover to
+     * special-case (the old check reported every sensor stale at ~49.7 days).
      */
     bool isDataFresh(unsigned long maxAgeMs = 60000) const {
-        if (lastSuccessfulReadTime == 0) {
+        if (lastSuccessfulReadUs == 0) {
             return false;  // Never had a successful read
         }
-        
-        unsigned long currentTime = millis();
-        
-        // Handle millis() rollover (happens every ~50 days)
-        if (currentTime < lastSuccessfulReadTime) {
-            // Rollover occurred, assume data is stale for safety
-            return false;
-        }
-        
-        return (currentTime - lastSuccessfulReadTime) <= maxAgeMs;
+        return hal::now() - lastSuccessfulReadUs <= (int64_t)maxAgeMs * 1000;
     }
     
     /**
@@ -214,17 +368,10 @@ public:
      * @return Time in ms, or 0 if never read successfully
      */
     unsigned long getTimeSinceLastSuccess() const {
-        if (lastSuccessfulReadTime == 0) {
-            return 0;
-        }
-        
-        unsigned long currentTime = millis();
-        if (currentTime < lastSuccessfulReadTime) {
-            // Handle rollover
+        if (lastSuccessfulReadUs == 0) {
             return 0;
         }
-        
-        return currentTime - lastSuccessfulReadTime;
+        return (unsigned long)((hal::now() - lastSuccessfulReadUs) / 1000);
     }
 };
 
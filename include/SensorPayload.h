@@ -0,0 +1,47 @@
+#ifndef SENSOR_PAYLOAD_H
+#define SENSOR_PAYLOAD_H
+
+// Deliberately free of Arduino dependencies: the fleet simulator (tools/)
+// formats its messages with the same function.
+#include <stddef.h>
+#include <stdio.h>
+#include "config.h"
+
+#define SENSOR_PAYLOAD_BYTES 300
+
+/**
+ * @brief True if text can go inside a JSON string without escaping
+ */
+constexpr bool isJsonStringSafe(const char* text) {
+    return *text == '\0' ||
+           (*text != '"' && *text != '\\' && (unsigned char)*text >= 0x20 && isJsonStringSafe(text + 1));
+}
+
+static_assert(isJsonStringSafe(DEVICE_LOCATION),
+              "DEVICE_LOCATION must not contain quotes, backslashes or control characters");
+static_assert(isJsonStringSafe(DEVICE_DESCRIPTION_PREFIX),
+              "DEVICE_DESCRIPTION_PREFIX must not contain quotes, backslashes or control characters");
+
+/**
+ * @brief Format one MQTT_TOPIC_SENSOR message (Hydroponic Monitor format)
+ *
+ * Same output as the ArduinoJson document it replaces, without building a
+ * document or String temporaries. DEVICE_LOCATION and
+ * DEVICE_DESCRIPTION_PREFIX are inserted as-is (no JSON escaping), so the
+ * static_asserts above reject characters that would need it. deviceType and
+ * label are the firmware's own literals.
+ * @param deviceType Channel name, e.g. "waterLevel"
+ * @param decimals Digits after the decimal point in "value"
+ * @param label Description suffix, e.g. "water level"
+ * @return Payload length, 0 if it did not fit in size
+ */
+inline size_t formatSensorPayload(char* buffer, size_t size, const char* deviceType, float value, int decimals,
+                                  const char* label) {
+    int n = snprintf(buffer, size,
+                     "{\"deviceType\":\"%s\",\"deviceID\":\"1\",\"location\":\"%s\",\"value\":\"%.*f\","
+                     "\"description\":\"%s - %s\"}",
+                     deviceType, DEVICE_LOCATION, decimals, value, DEVICE_DESCRIPTION_PREFIX, label);
+    return n > 0 && (size_t)n < size ? (size_t)n : 0;
+}
+
+#endif // SENSOR_PAYLOAD_H
@@ -0,0 +1,223 @@
+#ifndef SENSOR_SUPERVISOR_H
+#define SENSOR_SUPERVISOR_H
+
+#include <Arduino.h>
+#include "SensorBase.h"
+#include "Hal.h"
+#include "config.h"
+
+/**
+ * @brief Lifecycle state of a supervised sensor
+ */
+enum SensorState {
+    SENSOR_STATE_OK = 0,        // Last read succeeded
+    SENSOR_STATE_DEGRADED,      // Recent reads failing, below the failure threshold
+    SENSOR_STATE_FAILED,        // Not initialized or failing persistently; recovery scheduled
+    SENSOR_STATE_RECOVERING     // Re-initialized, waiting for the first good read
+};
+
+/**
+ * @brief Health bookkeeping for one sensor
+ */
+struct SupervisedSensor {
+    SensorBase* sensor;
+    SensorState state;
+    uint16_t consecutiveFailures;
+    uint32_t backoffMs;             // Delay before the next recovery attempt
+    unsigned long nextAttemptAt;    // millis() of the next recovery attempt
+    unsigned long failedSince;      // millis() when the sensor left OK
+    uint32_t recoveries;            // Successful recoveries since boot
+    uint32_t lastRecoveryMs;        // Time from failure to the first good read afterwards
+};
+
+/**
+ * @brief Re-probes failed sensors with exponential backoff
+ *
+ * After every read cycle the driver result is reported with reportRead().
+ * A sensor that never initialized, or that fails SUPERVISOR_FAIL_THRESHOLD
+ * reads in a row, is marked failed; service() then calls its recover() hook
+ * (bus recovery + begin()) after SUPERVISOR_BACKOFF_INITIAL_MS, doubling the
+ * wait after each unsuccessful attempt up to SUPERVISOR_BACKOFF_MAX_MS. The
+ * first good read afterwards returns it to OK and records the recovery time.
+ */
+class SensorSupervisor {
+public:
+    static const size_t MAX_SENSORS = 4;
+    typedef void (*TransitionCallback)(const SupervisedSensor& entry, SensorState from);
+
+private:
+    SupervisedSensor entries[MAX_SENSORS];
+    size_t count;
+    TransitionCallback onTransition;
+
+    void transition(SupervisedSensor& e, SensorState to) {
+        if (e.state == to) {
+            return;
+        }
+        SensorState from = e.state;
+        e.state = to;
+        Serial.printf("[SUPERVISOR] %s: %s -> %s\n", e.sensor->getName(), stateName(from), stateName(to));
+        if (onTransition != nullptr) {
+            onTransition(e, from);
+        }
+    }
+
+    void scheduleRetry(SupervisedSensor& e, unsigned long now) {
+        e.nextAttemptAt = now + e.backoffMs;
+        Serial.printf("[SUPERVISOR] %s: next recovery attempt in %lu s\n",
+                      e.sensor->getName(), (unsigned long)(e.backoffMs / 1000));
+        e.backoffMs = e.backoffMs * 2 > SUPERVISOR_BACKOFF_MAX_MS ? SUPERVISOR_BACKOFF_MAX_MS : e.backoffMs * 2;
+    }
+
+public:
+    SensorSupervisor() : count(0), onTransition(nullptr) {}
+
+    static const char* stateName(SensorState state) {
+        switch (state) {
+            case SENSOR_STATE_OK:         return "ok";
+            case SENSOR_STATE_DEGRADED:   return "degraded";
+            case SENSOR_STATE_FAILED:     return "failed";
+            case SENSOR_STATE_RECOVERING: return "recovering";
+            default:                      return "unknown";
+        }
+    }
+
+    /**
+     * @brief Start supervising a sensor (call after its begin())
+     * @param sensor Sensor instance
+     * @return Index used with reportRead()/get(), or -1 if full
+     */
+    int add(SensorBase* sensor) {
+        if (count >= MAX_SENSORS) {
+            return -1;
+        }
+        unsigned long now = millis();
+        SupervisedSensor& e = entries[count];
+        e.sensor = sensor;
+        e.consecutiveFailures = 0;
+        e.backoffMs = SUPERVISOR_BACKOFF_INITIAL_MS;
+        e.failedSince = now;
+        e.recoveries = 0;
+        e.lastRecoveryMs = 0;
+        if (sensor->isInitialized()) {
+            e.state = SENSOR_STATE_OK;
+        } else {
+            e.state = SENSOR_STATE_FAILED;
+            scheduleRetry(e, now);
+        }
+        return (int)count++;
+    }
+
+    void setTransitionCallback(TransitionCallback callback) {
+        onTransition = callback;
+    }
+
+    /**
+     * @brief Record the outcome of a read
+     * @param sensor Sensor that was read
+     * @param ok Whether the read succeeded
+     */
+    void reportRead(SensorBase* sensor, bool ok) {
+        SupervisedSensor* e = find(sensor);
+        if (e == nullptr) {
+            return;
+        }
+        unsigned long now = millis();
+
+        if (ok) {
+            e->consecutiveFailures = 0;
+            if (e->state != SENSOR_STATE_OK) {
+                if (e->state == SENSOR_STATE_RECOVERING || e->state == SENSOR_STATE_FAILED) {
+                    e->recoveries++;
+                    e->lastRecoveryMs = now - e->failedSince;
+                    Serial.printf("[SUPERVISOR] ✓ %s recovered after %lu ms\n",
+                                  sensor->getName(), (unsigned long)e->lastRecoveryMs);
+                }
+                e->backoffMs = SUPERVISOR_BACKOFF_INITIAL_MS;
+                transition(*e, SENSOR_STATE_OK);
+            }
+            return;
+        }
+
+        if (e->consecutiveFailures < 0xFFFF) {
+            e->consecutiveFailures++;
+        }
+        switch (e->state) {
+            case SENSOR_STATE_OK:
+                e->failedSince = now;
+                transition(*e, SENSOR_STATE_DEGRADED);
+                // fall through - a threshold of 1 fails immediately
+            case SENSOR_STATE_DEGRADED:
+                if (e->consecutiveFailures >= SUPERVISOR_FAIL_THRESHOLD) {
+                    transition(*e, SENSOR_STATE_FAILED);
+                    scheduleRetry(*e, now);
+                }
+                break;
+            case SENSOR_STATE_RECOVERING:
+                // Re-init succeeded but the sensor still does not answer
+                transition(*e, SENSOR_STATE_FAILED);
+                scheduleRetry(*e, now);
+                break;
+            case SENSOR_STATE_FAILED:
+                break;
+        }
+    }
+
+    /**
+     * @brief Run due recovery attempts (call from loop)
+     */
+    void service() {
+        unsigned long now = millis();
+        for (size_t i = 0; i < count; i++) {
+            SupervisedSensor& e = entries[i];
+            if (e.state != SENSOR_STATE_FAILED || (long)(now - e.nextAttemptAt) < 0) {
+                continue;
+            }
+            Serial.printf("[SUPERVISOR] %s: attempting recovery (%u consecutive failures)\n",
+                          e.sensor->getName(), (unsigned)e.consecutiveFailures);
+            bool recovered;
+            {
+                HalCall call(HAL_CALL_RECOVER, e.sensor);
+                recovered = e.sensor->recover();
+            }
+            if (recovered) {
+                e.consecutiveFailures = 0;
+                transition(e, SENSOR_STATE_RECOVERING);
+            } else {
+                Serial.printf("[SUPERVISOR] ✗ %s recovery failed\n", e.sensor->getName());
+                scheduleRetry(e, now);
+            }
+        }
+    }
+
+    SupervisedSensor* find(const SensorBase* sensor) {
+        for (size_t i = 0; i < count; i++) {
+            if (entries[i].sensor == sensor) {
+                return &entries[i];
+            }
+        }
+        return nullptr;
+    }
+
+    const SupervisedSensor& get(size_t index) const {
+        return entries[index];
+    }
+
+    size_t getCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Get a sensor's state (OK if not supervised)
+     */
+    SensorState getState(const SensorBase* sensor) const {
+        for (size_t i = 0; i < count; i++) {
+            if (entries[i].sensor == sensor) {
+                return entries[i].state;
+            }
+        }
+        return SENSOR_STATE_OK;
+    }
+};
+
+#endif // SENSOR_SUPERVISOR_H
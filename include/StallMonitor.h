@@ -0,0 +1,363 @@
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include "config.h"
+
+/**
+ * @brief What loop() is doing, as marked by StallMonitor::mark() / push()
+ */
+enum LoopStage {
+    STAGE_IDLE = 0,         // delay() between passes - never a stall
+    STAGE_OTA,
+    STAGE_WIFI,
+    STAGE_MQTT_CONNECT,
+    STAGE_MQTT_LOOP,
+    STAGE_OUTBOUND,
+    STAGE_CALIBRATION,
+    STAGE_HISTORY,
+    STAGE_SUPERVISOR,
+    STAGE_SENSORS,
+    STAGE_TRIGGER,
+    STAGE_WAIT,
+    STAGE_COLLECT,
+    STAGE_PUBLISH,
+    STAGE_HEALTH,
+    STAGE_FLUSH
+};
+
+/**
+ * @brief One level of the stage trail: stage, optional detail and call site
+ */
+struct StallFrame {
+    uint8_t stage;
+    const char* detail;     // Static string (e.g. sensor name) or nullptr
+    uint32_t pc;            // Where the stage was entered (decode with addr2line)
+};
+
+/**
+ * @brief Longest stall since the last health message, kept in RTC memory
+ */
+struct StallRecord {
+    uint32_t magic;
+    uint32_t checksum;          // FNV-1a over everything after this field
+    uint32_t count;             // Stalls since the record was last reported
+    uint32_t durationMs;        // Longest of them (so far, while ongoing)
+    uint32_t startedAtS;        // Uptime when it started
+    bool ongoing;               // Still stalled at the last check
+    bool endedInReset;          // Found ongoing after a watchdog / panic reset
+    uint8_t depth;
+    uint8_t stages[STALL_TRAIL_DEPTH];
+    uint32_t pcs[STALL_TRAIL_DEPTH];
+    char details[STALL_TRAIL_DEPTH][12];
+};
+
+/**
+ * @brief Soft stall detector for loop() below the task watchdog's 60 s
+ *
+ * loop() marks its progress with mark() (top-level stage) and push()/pop()
+ * (nested steps that may block, e.g. the MQTT connect or one sensor's
+ * collect). Each marker records the stage and the caller's PC. A periodic
+ * esp_timer (STALL_CHECK_INTERVAL_MS, esp_timer task, runs regardless of
+ * what loop() is blocked on) checks how long ago the last marker was set;
+ * past STALL_THRESHOLD_MS the current trail counts as a stall and the
+ * longest one is copied into a StallRecord.
+ *
+ * The record lives in RTC_NOINIT memory owned by the caller, so a stall that
+ * ends in a watchdog or panic reset is reported after the reboot with
+ * "reset": true. The trail's PCs stand in for a backtrace: the esp_timer
+ * task cannot unwind the stack of loopTask running on the other core, but
+ * the call sites of the active markers pin down the blocking call.
+ */
+class StallMonitor {
+private:
+    static const uint32_t MAGIC = 0x53544C31;  // "STL1"
+
+    StallRecord& record;
+    esp_timer_handle_t timer;
+    portMUX_TYPE lock;
+    StallFrame trail[STALL_TRAIL_DEPTH];
+    uint8_t depth;              // Frames in use (deeper push()es are counted, not kept)
+    uint8_t overflow;
+    int64_t progressUs;         // Time of the last marker
+    bool stalled;               // Current trail has been counted as a stall
+    bool recordIsCurrent;       // ... and is the one held in the record
+    bool ended;                 // A stall ended since the last service() (for logging)
+    uint32_t endedMs;
+    uint32_t totalStalls;       // Since boot
+    char trailText[STALL_TRAIL_DEPTH * 32];  // Trail of the last report (referenced by the JSON document)
+
+    static uint32_t fnv1a(const uint8_t* data, size_t length) {
+        uint32_t hash = 2166136261UL;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ data[i]) * 16777619UL;
+        }
+        return hash;
+    }
+
+    uint32_t computeChecksum() const {
+        const uint8_t* start = (const uint8_t*)&record.count;
+        const uint8_t* end = (const uint8_t*)&record + sizeof(StallRecord);
+        return fnv1a(start, end - start);
+    }
+
+    static bool keepsRtcMemory(esp_reset_reason_t reason) {
+        switch (reason) {
+            case ESP_RST_SW:
+            case ESP_RST_PANIC:
+            case ESP_RST_INT_WDT:
+            case ESP_RST_TASK_WDT:
+            case ESP_RST_WDT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Return addresses carry the register window increment in the top two bits on Xtensa
+    static uint32_t callSite(void* returnAddress) {
+        uint32_t pc = (uint32_t)(uintptr_t)returnAddress;
+        #ifdef ESP_PLATFORM
+        pc = (pc & 0x3FFFFFFF) | 0x40000000;
+        #endif
+        return pc;
+    }
+
+    void clearRecord() {
+        memset(&record, 0, sizeof(StallRecord));
+        record.magic = MAGIC;
+        record.checksum = computeChecksum();
+    }
+
+    // Called with the lock held whenever a marker changes
+    void progress(int64_t now) {
+        if (stalled) {
+            uint32_t stalledMs = (uint32_t)((now - progressUs) / 1000);
+            if (recordIsCurrent) {
+                record.durationMs = stalledMs;
+                record.ongoing = false;
+                record.checksum = computeChecksum();
+            }
+            ended = true;
+            endedMs = stalledMs;
+            stalled = false;
+            recordIsCurrent = false;
+        }
+        progressUs = now;
+    }
+
+    static void timerEntry(void* arg) {
+        static_cast<StallMonitor*>(arg)->check();
+    }
+
+    void check() {
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&lock);
+        uint32_t stalledMs = (uint32_t)((now - progressUs) / 1000);
+        if (depth > 0 && trail[0].stage != STAGE_IDLE && stalledMs >= STALL_THRESHOLD_MS) {
+            if (!stalled) {
+                stalled = true;
+                record.count++;
+                totalStalls++;
+            }
+            if (recordIsCurrent || stalledMs > record.durationMs) {
+                if (!recordIsCurrent) {
+                    recordIsCurrent = true;
+                    record.startedAtS = (uint32_t)(progressUs / 1000000);
+                    record.endedInReset = false;
+                    record.depth = depth;
+                    for (uint8_t i = 0; i < depth; i++) {
+                        record.stages[i] = trail[i].stage;
+                        record.pcs[i] = trail[i].pc;
+                        strlcpy(record.details[i], trail[i].detail != nullptr ? trail[i].detail : "",
+                                sizeof(record.details[i]));
+                    }
+                }
+                record.durationMs = stalledMs;
+                record.ongoing = true;
+            }
+            record.checksum = computeChecksum();
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+
+public:
+    StallMonitor(StallRecord& storage)
+        : record(storage), timer(nullptr), depth(0), overflow(0), progressUs(0), stalled(false),
+          recordIsCurrent(false), ended(false), endedMs(0), totalStalls(0) {
+        portMUX_INITIALIZE(&lock);
+        trailText[0] = '\0';
+    }
+
+    /**
+     * @brief Keep or clear the retained record and start the check timer
+     *
+     * Call at the end of setup(); stages before that are not watched.
+     */
+    bool begin() {
+        if (keepsRtcMemory(esp_reset_reason()) && record.magic == MAGIC && record.checksum == computeChecksum() &&
+            record.depth <= STALL_TRAIL_DEPTH) {
+            if (record.ongoing) {
+                record.ongoing = false;
+                record.endedInReset = true;
+                Serial.printf("[STALL] ⚠ Previous boot was reset during a %lu ms stall in %s\n",
+                              (unsigned long)record.durationMs,
+                              record.depth > 0 ? stageName(record.stages[record.depth - 1]) : "?");
+            }
+            record.checksum = computeChecksum();
+        } else {
+            clearRecord();
+        }
+
+        progressUs = esp_timer_get_time();
+        esp_timer_create_args_t args = {};
+        args.callback = timerEntry;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "stall";
+        if (esp_timer_create(&args, &timer) != ESP_OK ||
+            esp_timer_start_periodic(timer, (uint64_t)STALL_CHECK_INTERVAL_MS * 1000) != ESP_OK) {
+            Serial.println("[STALL] ✗ Could not start check timer");
+            return false;
+        }
+        Serial.printf("[STALL] Monitoring loop() stages (threshold %d ms)\n", STALL_THRESHOLD_MS);
+        return true;
+    }
+
+    /**
+     * @brief Enter a top-level loop() stage (drops any nested frames)
+     */
+    void __attribute__((noinline)) mark(LoopStage stage, const char* detail = nullptr) {
+        uint32_t pc = callSite(__builtin_return_address(0));
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&lock);
+        progress(now);
+        trail[0].stage = stage;
+        trail[0].detail = detail;
+        trail[0].pc = pc;
+        depth = 1;
+        overflow = 0;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    /**
+     * @brief Enter a nested step that may block; pair with pop()
+     */
+    void __attribute__((noinline)) push(LoopStage stage, const char* detail = nullptr) {
+        uint32_t pc = callSite(__builtin_return_address(0));
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&lock);
+        progress(now);
+        if (depth < STALL_TRAIL_DEPTH) {
+            trail[depth].stage = stage;
+            trail[depth].detail = detail;
+            trail[depth].pc = pc;
+            depth++;
+        } else {
+            overflow++;
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void pop() {
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&lock);
+        progress(now);
+        if (overflow > 0) {
+            overflow--;
+        } else if (depth > 1) {
+            depth--;
+        }
+        portEXIT_CRITICAL(&lock);
+    }
+
+    /**
+     * @brief Log stalls that ended since the last call (call from loop)
+     */
+    void service() {
+        if (!ended) {
+            return;
+        }
+        portENTER_CRITICAL(&lock);
+        uint32_t ms = endedMs;
+        ended = false;
+        portEXIT_CRITICAL(&lock);
+        Serial.printf("[STALL] ⚠ loop() made no progress for %lu ms (%lu since boot)\n",
+                      (unsigned long)ms, (unsigned long)totalStalls);
+    }
+
+    /**
+     * @brief Add the "stall" object to a health message if there was a stall, and clear it
+     */
+    bool report(JsonObject parent) {
+        StallRecord copy;
+        portENTER_CRITICAL(&lock);
+        copy = record;
+        if (!record.ongoing) {
+            record.count = 0;
+            record.durationMs = 0;
+            record.endedInReset = false;
+            record.depth = 0;
+            record.checksum = computeChecksum();
+        }
+        portEXIT_CRITICAL(&lock);
+        if (copy.count == 0 && !copy.endedInReset) {
+            return false;
+        }
+
+        // outer@pc>inner:detail@pc
+        size_t used = 0;
+        trailText[0] = '\0';
+        for (uint8_t i = 0; i < copy.depth && used < sizeof(trailText); i++) {
+            int n = snprintf(trailText + used, sizeof(trailText) - used, "%s%s%s%s@%08lx", i > 0 ? ">" : "",
+                             stageName(copy.stages[i]), copy.details[i][0] != '\0' ? ":" : "",
+                             copy.details[i], (unsigned long)copy.pcs[i]);
+            if (n < 0) {
+                break;
+            }
+            used += (size_t)n;
+        }
+
+        JsonObject stall = parent.createNestedObject("stall");
+        stall["n"] = copy.count;
+        stall["ms"] = copy.durationMs;
+        stall["at"] = copy.startedAtS;
+        stall["reset"] = copy.endedInReset;
+        stall["trail"] = (const char*)trailText;
+        Serial.printf("[STALL] Longest: %lu ms in %s%s\n", (unsigned long)copy.durationMs, trailText,
+                      copy.endedInReset ? " (ended in reset)" : "");
+        return true;
+    }
+
+    uint32_t getTotalStalls() const {
+        return totalStalls;
+    }
+
+    static const char* stageName(uint8_t stage) {
+        switch (stage) {
+            case STAGE_IDLE: return "idle";
+            case STAGE_OTA: return "ota";
+            case STAGE_WIFI: return "wifi";
+            case STAGE_MQTT_CONNECT: return "mqttConnect";
+            case STAGE_MQTT_LOOP: return "mqttLoop";
+            case STAGE_OUTBOUND: return "outbound";
+            case STAGE_CALIBRATION: return "calibration";
+            case STAGE_HISTORY: return "history";
+            case STAGE_SUPERVISOR: return "supervisor";
+            case STAGE_SENSORS: return "sensors";
+            case STAGE_TRIGGER: return "trigger";
+            case STAGE_WAIT: return "wait";
+            case STAGE_COLLECT: return "collect";
+            case STAGE_PUBLISH: return "publish";
+            case STAGE_HEALTH: return "health";
+            case STAGE_FLUSH: return "flush";
+            default: return "unknown";
+        }
+    }
+};
+
+#endif // STALL_MONITOR_H
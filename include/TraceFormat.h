@@ -0,0 +1,154 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+// Deliberately free of Arduino dependencies: the host converter (tools/) includes
+// this header unchanged.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Trace batch as published to MQTT_TOPIC_TRACE
+ *
+ * Layout (little endian):
+ *   [0]      'T'
+ *   [1]      version (1)
+ *   [2..3]   event count
+ *   [4..7]   capture id (changes with every traceStart)
+ *   [8..11]  sequence number of the first event in the capture
+ *   [12..]   events, TRACE_EVENT_BYTES each:
+ *              [0..3] timestamp, microseconds (low 32 bits of esp_timer)
+ *              [4..5] probe id (TraceProbe)
+ *              [6]    phase ('B', 'E' or 'i')
+ *              [7]    argument (probe specific, e.g. 1 = read succeeded)
+ *
+ * Sequence numbers count every event recorded during the capture. The first
+ * batch starts above 0 when the ring wrapped and the oldest events were
+ * overwritten; a gap between batches means a batch was lost on the way.
+ */
+
+#define TRACE_HEADER_BYTES 12
+#define TRACE_EVENT_BYTES 8
+#define TRACE_VERSION 1
+
+#define TRACE_PHASE_BEGIN 'B'
+#define TRACE_PHASE_END 'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+/**
+ * @brief Probe points (ids are part of the wire format: append only)
+ */
+enum TraceProbe {
+    TRACE_LOOP = 0,             // One loop() pass
+    TRACE_OTA,                  // serviceOTA()
+    TRACE_WIFI_RECONNECT,       // reconnectWiFi()
+    TRACE_MQTT_CONNECT,         // reconnectMQTT()
+    TRACE_MQTT_LOOP,            // mqttClient.loop()
+    TRACE_OUTBOUND,             // Alarms + outbound.service()
+    TRACE_HISTORY,              // serviceHistoryQuery()
+    TRACE_SUPERVISOR,           // sensorSupervisor.service()
+    TRACE_READ_SENSORS,         // readSensors()
+    TRACE_SENSOR_WAIT,          // readSensors() waiting for conversions
+    TRACE_PUBLISH,              // publishSensorData()
+    TRACE_HEALTH,               // publishHealthMessage()
+    TRACE_FLUSH,                // mqttTransport.flush()
+    TRACE_SHT30_TRIGGER,        // Measurement command over I2C
+    TRACE_SHT30_READ,           // Result read over I2C (arg: 1 = ok)
+    TRACE_HCSR04_TRIGGER,       // Trigger pulse
+    TRACE_HCSR04_COLLECT,       // Echo conversion (arg: 1 = echo received)
+    TRACE_PH_ADC,               // One ADC sample of the burst
+    TRACE_PH_COLLECT,           // Burst conversion (arg: 1 = in range)
+    TRACE_PROBE_COUNT
+};
+
+/**
+ * @brief One recorded event
+ */
+struct TraceEvent {
+    uint32_t timestampUs;
+    uint16_t probe;
+    uint8_t phase;
+    uint8_t arg;
+};
+
+inline const char* traceProbeName(uint16_t probe) {
+    static const char* const names[TRACE_PROBE_COUNT] = {
+        "loop", "serviceOTA", "reconnectWiFi", "reconnectMQTT", "mqttClient.loop",
+        "outbound", "history", "supervisor", "readSensors", "sensorWait", "publishSensorData",
+        "publishHealth", "flush", "SHT30.trigger", "SHT30.read", "HC-SR04.trigger",
+        "HC-SR04.collect", "pH.adc", "pH.collect"
+    };
+    return probe < TRACE_PROBE_COUNT ? names[probe] : "unknown";
+}
+
+inline void traceWrite16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+inline void traceWrite32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+inline uint16_t traceRead16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t traceRead32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Batch header fields
+ */
+struct TraceBatchHeader {
+    uint16_t count;
+    uint32_t captureId;
+    uint32_t firstSeq;
+};
+
+inline void traceEncodeHeader(uint8_t* out, const TraceBatchHeader& header) {
+    out[0] = 'T';
+    out[1] = TRACE_VERSION;
+    traceWrite16(out + 2, header.count);
+    traceWrite32(out + 4, header.captureId);
+    traceWrite32(out + 8, header.firstSeq);
+}
+
+inline void traceEncodeEvent(uint8_t* batch, uint16_t index, const TraceEvent& event) {
+    uint8_t* p = batch + TRACE_HEADER_BYTES + (size_t)index * TRACE_EVENT_BYTES;
+    traceWrite32(p, event.timestampUs);
+    traceWrite16(p + 4, event.probe);
+    p[6] = event.phase;
+    p[7] = event.arg;
+}
+
+/**
+ * @brief Parse the batch at the start of data
+ * @return Bytes taken by the batch, 0 if data does not start with a complete batch
+ */
+inline size_t traceDecodeHeader(const uint8_t* data, size_t length, TraceBatchHeader& header) {
+    if (length < TRACE_HEADER_BYTES || data[0] != 'T' || data[1] != TRACE_VERSION) {
+        return 0;
+    }
+    header.count = traceRead16(data + 2);
+    header.captureId = traceRead32(data + 4);
+    header.firstSeq = traceRead32(data + 8);
+    size_t size = TRACE_HEADER_BYTES + (size_t)header.count * TRACE_EVENT_BYTES;
+    return size <= length ? size : 0;
+}
+
+inline TraceEvent traceDecodeEvent(const uint8_t* batch, uint16_t index) {
+    const uint8_t* p = batch + TRACE_HEADER_BYTES + (size_t)index * TRACE_EVENT_BYTES;
+    TraceEvent event;
+    event.timestampUs = traceRead32(p);
+    event.probe = traceRead16(p + 4);
+    event.phase = p[6];
+    event.arg = p[7];
+    return event;
+}
+
+#endif // TRACE_FORMAT_H
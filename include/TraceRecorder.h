@@ -0,0 +1,206 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include "TraceFormat.h"
+#include "config.h"
+
+static_assert(TRACE_HEADER_BYTES + TRACE_BATCH_EVENTS * TRACE_EVENT_BYTES <= OUTBOUND_SLOT_BYTES,
+              "A trace batch must fit one outbound slot");
+
+/**
+ * @brief On-demand begin/end event recorder for loop() and the sensor drivers
+ *
+ * Probes are inline and cost one branch on a bool while no capture runs. A
+ * capture (start()) allocates a TRACE_RING_EVENTS ring (PSRAM if available),
+ * records for the requested time and keeps the most recent events if the
+ * ring wraps. Afterwards nextBatch() hands out TRACE_BATCH_EVENTS events at
+ * a time in the TraceFormat.h wire format; the ring is freed once the last
+ * batch is taken. Events are recorded from the loop task only (no locking).
+ */
+class TraceRecorder {
+private:
+    TraceEvent* ring;
+    uint32_t capacity;
+    uint32_t head;              // Events recorded in this capture (next sequence number)
+    uint32_t sendSeq;           // Next event to hand out
+    uint32_t captureId;
+    int64_t stopAtUs;
+    bool active;
+    bool dumping;
+
+    void __attribute__((noinline)) record(uint16_t probe, uint8_t phase, uint8_t arg) {
+        int64_t now = esp_timer_get_time();
+        if (now >= stopAtUs) {
+            stop();
+            return;
+        }
+        TraceEvent& event = ring[head % capacity];
+        event.timestampUs = (uint32_t)now;
+        event.probe = probe;
+        event.phase = phase;
+        event.arg = arg;
+        head++;
+    }
+
+    void release() {
+        if (ring != nullptr) {
+            heap_caps_free(ring);
+            ring = nullptr;
+        }
+        dumping = false;
+    }
+
+public:
+    TraceRecorder()
+        : ring(nullptr), capacity(0), head(0), sendSeq(0), captureId(0), stopAtUs(0), active(false),
+          dumping(false) {}
+
+    /**
+     * @brief Start a capture
+     * @param durationMs Recording time (capped at TRACE_MAX_DURATION_MS)
+     * @return false if a capture or dump is in progress or the ring cannot be allocated
+     */
+    bool start(uint32_t durationMs) {
+        if (active || dumping) {
+            return false;
+        }
+        size_t bytes = (size_t)TRACE_RING_EVENTS * sizeof(TraceEvent);
+        ring = (TraceEvent*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+        if (ring == nullptr) {
+            ring = (TraceEvent*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+        }
+        if (ring == nullptr) {
+            return false;
+        }
+        if (durationMs > TRACE_MAX_DURATION_MS) {
+            durationMs = TRACE_MAX_DURATION_MS;
+        }
+        capacity = TRACE_RING_EVENTS;
+        head = 0;
+        sendSeq = 0;
+        captureId = (uint32_t)esp_timer_get_time();
+        stopAtUs = esp_timer_get_time() + (int64_t)durationMs * 1000;
+        active = true;
+        return true;
+    }
+
+    /**
+     * @brief End the capture early (it also ends by itself after its duration)
+     */
+    void stop() {
+        if (!active) {
+            return;
+        }
+        active = false;
+        dumping = true;
+        sendSeq = head > capacity ? head - capacity : 0;
+        Serial.printf("[TRACE] Capture %08lx done: %lu events (%lu overwritten)\n", (unsigned long)captureId,
+                      (unsigned long)head, (unsigned long)sendSeq);
+    }
+
+    /**
+     * @brief Stop a capture whose time is up even if no probe fires (call from loop)
+     */
+    void service() {
+        if (active && esp_timer_get_time() >= stopAtUs) {
+            stop();
+        }
+    }
+
+    /**
+     * @brief Encode the next batch of a finished capture
+     * @param out At least TRACE_HEADER_BYTES + TRACE_BATCH_EVENTS * TRACE_EVENT_BYTES bytes
+     * @return Bytes written, 0 when there is nothing (left) to send
+     */
+    size_t nextBatch(uint8_t* out) {
+        if (!dumping) {
+            return 0;
+        }
+        TraceBatchHeader header;
+        header.captureId = captureId;
+        header.firstSeq = sendSeq;
+        header.count = 0;
+        while (header.count < TRACE_BATCH_EVENTS && sendSeq < head) {
+            traceEncodeEvent(out, header.count++, ring[sendSeq++ % capacity]);
+        }
+        if (sendSeq >= head) {
+            release();
+        }
+        if (header.count == 0) {
+            return 0;
+        }
+        traceEncodeHeader(out, header);
+        return TRACE_HEADER_BYTES + (size_t)header.count * TRACE_EVENT_BYTES;
+    }
+
+    /**
+     * @brief Abandon the rest of a dump (e.g. before starting over)
+     */
+    void discard() {
+        active = false;
+        release();
+    }
+
+    inline void begin(TraceProbe probe, uint8_t arg = 0) {
+        if (active) {
+            record(probe, TRACE_PHASE_BEGIN, arg);
+        }
+    }
+
+    inline void end(TraceProbe probe, uint8_t arg = 0) {
+        if (active) {
+            record(probe, TRACE_PHASE_END, arg);
+        }
+    }
+
+    inline void instant(TraceProbe probe, uint8_t arg = 0) {
+        if (active) {
+            record(probe, TRACE_PHASE_INSTANT, arg);
+        }
+    }
+
+    bool isActive() const {
+        return active;
+    }
+
+    bool isDumping() const {
+        return dumping;
+    }
+
+    uint32_t getCaptureId() const {
+        return captureId;
+    }
+
+    uint32_t getEventCount() const {
+        return head;
+    }
+
+    uint32_t getOverwritten() const {
+        return head > capacity ? head - capacity : 0;
+    }
+};
+
+// Defined in main.cpp; the sensor drivers record into the same capture
+extern TraceRecorder traceRecorder;
+
+/**
+ * @brief Begin/end pair for a scope
+ */
+class TraceScope {
+private:
+    TraceProbe probe;
+
+public:
+    explicit TraceScope(TraceProbe p) : probe(p) {
+        traceRecorder.begin(probe);
+    }
+
+    ~TraceScope() {
+        traceRecorder.end(probe);
+    }
+};
+
+#endif // TRACE_RECORDER_H
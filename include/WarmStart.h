@@ -0,0 +1,170 @@
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include "MovingAverage.h"
+#include "config.h"
+
+static_assert(MAX_AVERAGE_WINDOW <= 64, "WindowSnapshot keeps validity flags in a 64-bit mask");
+
+/**
+ * @brief Contents of one averaging window
+ */
+struct WindowSnapshot {
+    uint32_t tag;                       // Hash of the channel name, so a changed channel list is not mixed up
+    uint8_t count;                      // Readings held, oldest first
+    uint64_t validMask;                 // Bit i set = values[i] was a valid reading
+    float values[MAX_AVERAGE_WINDOW];
+};
+
+/**
+ * @brief Averaging windows of every channel as kept in RTC memory
+ */
+struct WarmStartSnapshot {
+    static const size_t MAX_WINDOWS = 4;
+
+    uint32_t magic;
+    uint32_t layout;                    // sizeof(WarmStartSnapshot) of the firmware that wrote it
+    uint32_t checksum;                  // FNV-1a over everything after this field
+    uint32_t savedAtS;                  // Uptime of the writer when saved
+    uint8_t windowCount;
+    WindowSnapshot windows[MAX_WINDOWS];
+};
+
+/**
+ * @brief Carries averaging windows across resets that keep RTC memory
+ *
+ * The snapshot lives in an RTC_NOINIT_ATTR variable owned by the caller and
+ * is rewritten after every read cycle, so it is at most one cycle old when a
+ * software restart (OTA, ESP.restart()), panic or watchdog reset hits. On
+ * boot it is accepted only for those reset reasons and only if magic, layout
+ * and checksum match; after power-on or brownout RTC memory holds garbage.
+ * Restored readings are replayed into the windows oldest first, so
+ * hasValidMajority() and getAverage() are right from the first publish.
+ */
+class WarmStart {
+private:
+    static const uint32_t MAGIC = 0x57524D31;  // "WRM1"
+
+    WarmStartSnapshot& snapshot;
+    bool restorable;
+
+    static uint32_t fnv1a(const uint8_t* data, size_t length, uint32_t hash = 2166136261UL) {
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ data[i]) * 16777619UL;
+        }
+        return hash;
+    }
+
+    uint32_t computeChecksum() const {
+        const uint8_t* start = (const uint8_t*)&snapshot.savedAtS;
+        const uint8_t* end = (const uint8_t*)&snapshot + sizeof(WarmStartSnapshot);
+        return fnv1a(start, end - start);
+    }
+
+    static bool keepsRtcMemory(esp_reset_reason_t reason) {
+        switch (reason) {
+            case ESP_RST_SW:
+            case ESP_RST_PANIC:
+            case ESP_RST_INT_WDT:
+            case ESP_RST_TASK_WDT:
+            case ESP_RST_WDT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+public:
+    WarmStart(WarmStartSnapshot& storage) : snapshot(storage), restorable(false) {}
+
+    /**
+     * @brief Tag identifying a channel in the snapshot
+     */
+    static uint32_t tagFor(const char* name) {
+        return fnv1a((const uint8_t*)name, strlen(name));
+    }
+
+    /**
+     * @brief Check whether the snapshot left by the previous run can be used (call once at boot)
+     * @return true if restore() will find data
+     */
+    bool begin() {
+        esp_reset_reason_t reason = esp_reset_reason();
+        restorable = keepsRtcMemory(reason) && snapshot.magic == MAGIC &&
+                     snapshot.layout == sizeof(WarmStartSnapshot) &&
+                     snapshot.windowCount <= WarmStartSnapshot::MAX_WINDOWS &&
+                     snapshot.checksum == computeChecksum();
+        if (restorable) {
+            Serial.printf("[WARMSTART] ✓ Snapshot from %lu s uptime found (reset reason %d)\n",
+                          (unsigned long)snapshot.savedAtS, (int)reason);
+        } else {
+            Serial.printf("[WARMSTART] ⊘ No usable snapshot (reset reason %d), cold start\n", (int)reason);
+        }
+        return restorable;
+    }
+
+    /**
+     * @brief Replay a saved window into an averaging stage
+     * @param tag tagFor() of the channel
+     * @param average Averaging stage to fill (its window size is kept)
+     * @return Number of readings restored (0 if the channel was not saved)
+     */
+    size_t restore(uint32_t tag, MovingAverage<float, MAX_AVERAGE_WINDOW>& average) const {
+        if (!restorable) {
+            return 0;
+        }
+        for (size_t w = 0; w < snapshot.windowCount; w++) {
+            const WindowSnapshot& saved = snapshot.windows[w];
+            if (saved.tag != tag) {
+                continue;
+            }
+            size_t count = saved.count > MAX_AVERAGE_WINDOW ? MAX_AVERAGE_WINDOW : saved.count;
+            average.reset();
+            for (size_t i = 0; i < count; i++) {
+                average.addReading(saved.values[i], (saved.validMask >> i) & 1);
+            }
+            return count;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Copy an averaging window into the snapshot (follow with commit())
+     * @param index Window slot (0..MAX_WINDOWS-1)
+     * @param tag tagFor() of the channel
+     * @param average Averaging stage to save
+     */
+    void capture(size_t index, uint32_t tag, const MovingAverage<float, MAX_AVERAGE_WINDOW>& average) {
+        if (index >= WarmStartSnapshot::MAX_WINDOWS) {
+            return;
+        }
+        WindowSnapshot& saved = snapshot.windows[index];
+        bool valid[MAX_AVERAGE_WINDOW];
+        size_t count = average.copyChronological(saved.values, valid);
+        saved.tag = tag;
+        saved.count = (uint8_t)count;
+        saved.validMask = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (valid[i]) {
+                saved.validMask |= 1ULL << i;
+            }
+        }
+    }
+
+    /**
+     * @brief Seal the captured windows so the next boot accepts them
+     * @param windowCount Number of windows captured
+     */
+    void commit(size_t windowCount) {
+        snapshot.magic = MAGIC;
+        snapshot.layout = sizeof(WarmStartSnapshot);
+        snapshot.savedAtS = millis() / 1000;
+        snapshot.windowCount = (uint8_t)(windowCount > WarmStartSnapshot::MAX_WINDOWS ?
+                                         WarmStartSnapshot::MAX_WINDOWS : windowCount);
+        snapshot.checksum = computeChecksum();
+    }
+};
+
+#endif // WARM_START_H
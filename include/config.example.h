@@ -16,24 +16,57 @@
 #define MQTT_USER ""  // Leave empty if no authentication
 #define MQTT_PASSWORD ""  // Leave empty if no authentication
 
+// Device Information (for MQTT message payload; inserted into the JSON as-is,
+// so no quotes, backslashes or control characters - checked at compile time)
+#define DEVICE_LOCATION "tent"
+#define DEVICE_DESCRIPTION_PREFIX "ESP32 sensor node"
+
 // MQTT Topics - Follow pattern: {project}/{node}/{deviceCategory}
 #define MQTT_PROJECT "grow"
 #define MQTT_NODE "esp32_1"
 #define MQTT_TOPIC_SENSOR "grow/esp32_1/sensor"
 #define MQTT_TOPIC_HEALTH "grow/esp32_1/device"
+#define MQTT_TOPIC_CONFIG "grow/esp32_1/config"              // Runtime settings (subscribed)
+#define MQTT_TOPIC_CONFIG_STATE "grow/esp32_1/config/state"  // Applied settings (retained)
+#define MQTT_TOPIC_CALIBRATION "grow/esp32_1/calibration"    // pH calibration frames/events
+#define MQTT_TOPIC_TIMESERIES "grow/esp32_1/timeseries"      // Raw samples (ENABLE_TIMESERIES_PUBLISH)
+#define MQTT_TOPIC_HISTORY "grow/esp32_1/history"            // Replies to history queries
+#define MQTT_TOPIC_EVENTS "grow/esp32_1/events"              // Sensor state transitions
+#define MQTT_TOPIC_ALARM "grow/esp32_1/alarm"                // Alarm raise/clear, sent as soon as detected
+#define MQTT_TOPIC_TRACE "grow/esp32_1/trace"                // Binary trace batches (traceStart command)
+#define MQTT_TOPIC_HALTRACE "grow/esp32_1/haltrace"          // Hardware capture chunks (halRecord command)
 
 // MQTT Reconnection settings
 #define MQTT_RECONNECT_INITIAL_DELAY 1000  // milliseconds
 #define MQTT_RECONNECT_MAX_DELAY 60000     // milliseconds
 
+// Broker endpoints, tried in order of measured RTT with automatic failover.
+// Add backup brokers as extra { "host", port } entries (max 4).
+#define MQTT_BROKER_LIST { { MQTT_BROKER, MQTT_PORT }, { "192.168.1.101", MQTT_PORT } }
+#define MQTT_DNS_CACHE_TTL 300000          // milliseconds - reuse resolved broker addresses this long
+#define MQTT_DNS_FAILURE_TTL 30000         // milliseconds - re-resolve a failing broker no sooner than this
+#define MQTT_BROKER_PROBE_INTERVAL 300000  // milliseconds - re-rank endpoints at most this often
+#define MQTT_BROKER_PROBE_TIMEOUT 500      // milliseconds - TCP connect timeout per probe
+
 // ==================== OTA Configuration ====================
 #define OTA_HOSTNAME "esp32_1"
 #define OTA_PASSWORD "your_ota_password"  // Change this!
 #define OTA_PORT 3232
 
+// Updates run in their own task so sampling continues during an upload
+#define OTA_TASK_STACK 8192            // bytes
+#define OTA_TASK_PRIORITY 0            // Below loop() (1), so a shared core always favours sampling
+#define OTA_TASK_CORE 0                // loop() runs on core 1
+#define OTA_TASK_POLL_MS 20            // ArduinoOTA.handle() interval while idle
+#define OTA_URL_BYTES 160              // Longest URL accepted by the otaUpdate command
+#define OTA_READ_CHUNK_BYTES 1024      // Network read size for HTTP downloads
+#define OTA_READ_TIMEOUT_MS 10000      // Abort a download after this long without data
+#define OTA_RESTART_DELAY_MS 2000      // Time for the result event to go out before restarting
+
 // ==================== Sensor Pin Configuration ====================
 // SHT30 (I2C)
 #define SHT30_I2C_ADDRESS 0x44  // Default I2C address
+#define SHT30_MEASUREMENT_US 16000  // High-repeatability single shot: 15.5 ms max conversion
 #define I2C_SDA 21              // ESP32 default SDA pin
 #define I2C_SCL 22              // ESP32 default SCL pin
 
@@ -54,6 +87,69 @@
 #define TEMP_HUMIDITY_WINDOW 5
 #define WATER_LEVEL_WINDOW 10
 #define PH_WINDOW 5
+#define MAX_AVERAGE_WINDOW 60    // Buffer capacity; windows can be changed at runtime up to this size
+
+// Hampel outlier filter (sliding median + MAD) ahead of the moving average
+#define ENABLE_WATER_LEVEL_HAMPEL             // Comment out to average raw echoes directly
+#define HAMPEL_WINDOW 7                       // Raw samples the median/MAD is taken over
+#define HAMPEL_THRESHOLD 3.0                  // Reject beyond this many scaled MADs
+#define HAMPEL_WATER_LEVEL_MIN_DEVIATION 0.5  // cm - floor for the MAD scale
+
+// Raw sample history: every reading is kept with a 64-bit esp_timer timestamp
+#define RAW_SAMPLE_RING_SIZE 64              // Samples per channel (16 bytes each)
+//#define ENABLE_TIMESERIES_PUBLISH          // Also ship each window's raw samples to MQTT_TOPIC_TIMESERIES
+#define TIMESERIES_MAX_POINTS 20             // Most samples per time-series message (fewer if over OUTBOUND_SLOT_BYTES)
+//#define TIMESERIES_GORILLA                 // Send binary Gorilla blocks to MQTT_TOPIC_TIMESERIES/<deviceType> instead of JSON
+#define GORILLA_BLOCK_BYTES 448              // Bytes per block (~100 samples; at most OUTBOUND_SLOT_BYTES)
+
+// On-device history: round-robin min/max/mean/count archives per channel in PSRAM.
+// Query with {"command": "history", "channel": "pH", "from": 86400, "to": 0} on
+// MQTT_TOPIC_CONFIG (from/to in seconds ago, optional "resolution" in seconds).
+#define HISTORY_ARCHIVES { { 1, 600 }, { 60, 1440 }, { 900, 2880 } }  // { seconds per bucket, buckets }: 10 min, 24 h, 30 days
+#define HISTORY_MAX_POINTS 12                // Buckets per reply message
+
+// Sensor supervision: failed sensors are re-probed (I2C bus recovery + re-init)
+// with exponential backoff; state changes are published to MQTT_TOPIC_EVENTS
+#define SUPERVISOR_FAIL_THRESHOLD 5          // Consecutive failed reads before a sensor is marked failed
+#define SUPERVISOR_BACKOFF_INITIAL_MS 5000   // First recovery attempt after this long
+#define SUPERVISOR_BACKOFF_MAX_MS 300000     // Backoff doubles up to this (5 minutes)
+
+// Alarms: evaluated on every accepted sample (after the range check and despike
+// stages) right after it is read and published to MQTT_TOPIC_ALARM ahead of
+// routine traffic.
+// { channel, low, high, rate per minute, rate window (s), hysteresis }
+// NAN disables a threshold, a rate of 0 disables the rate check. The rate window
+// must fit in RAW_SAMPLE_RING_SIZE samples.
+#define ALARM_RULES { \
+    { "waterLevel", 10.0, NAN, 2.0, 30, 1.0 }, \
+    { "pH", 5.0, 7.0, 0.5, 60, 0.2 }, \
+    { "temperature", 15.0, 32.0, 0, 0, 1.0 } }
+#define ALARM_RATE_CLEAR_FRACTION 0.5        // Rate alarm clears below this fraction of its limit
+#define ALARM_CONSECUTIVE_SAMPLES 3          // Samples in a row past a limit before an alarm is raised
+
+// Sensor fault detection on raw samples (reported as a quality score per channel)
+#define QUALITY_FLATLINE_SAMPLES 60          // Identical values in a row before a channel is flatlined
+#define QUALITY_STUCK_SAMPLES 30             // Samples confined to two levels before a channel is stuck
+#define QUALITY_STUCK_MIN_STEPS 5            // ... only if the levels are this many resolutions apart
+#define QUALITY_WARMUP_SAMPLES 60            // Samples used to learn the noise baseline
+#define QUALITY_NOISE_RATIO 9.0              // Noisy when recent noise energy exceeds baseline by this (3x amplitude)
+#define QUALITY_NOISE_FAST_ALPHA 0.1         // EWMA weight of recent noise
+#define QUALITY_NOISE_SLOW_ALPHA 0.002       // EWMA weight of the baseline (~8 min at 1 s reads)
+
+// Outbound scheduler: every publish is queued by priority class and released
+// under per-class and global token buckets (bytes). Urgent messages never wait
+// for the global bucket. When a class is full its oldest message is dropped.
+#define OUTBOUND_TOPIC_BYTES 64
+#define OUTBOUND_SLOT_BYTES 1400             // Largest payload (the health message)
+#define MQTT_BUFFER_SIZE 1536                // PubSubClient buffer: largest payload + topic + header
+// { bytes/s (0 = unlimited), burst bytes, slots } for urgent, state, routine, bulk
+#define OUTBOUND_CLASSES { { 0, 0, 8 }, { 2048, 4096, 4 }, { 8192, 8192, 8 }, { 2048, 4096, 8 } }
+#define OUTBOUND_GLOBAL_BYTES_PER_SEC 16384
+#define OUTBOUND_GLOBAL_BURST_BYTES 16384
+
+// MQTT transport: packets written in one loop() pass are merged into one TCP write
+#define TRANSPORT_COALESCE_BYTES 1460        // One TCP segment (typical MSS)
+#define TRANSPORT_FLUSH_DEADLINE_MS 20       // Longest a packet may wait in the buffer
 
 // Sensor Validation Ranges
 #define TEMP_MIN -40.0
@@ -76,11 +172,70 @@
 #define PH_CALIBRATION_OFFSET 0.0   // Adjust after calibration
 #define PH_CALIBRATION_SLOPE 1.0     // Adjust after calibration
 #define ADC_RESOLUTION 4095.0        // 12-bit ADC
+// #define PH_ADC_USE_EFUSE_CAL       // Convert ADC codes with the chip's eFuse characterization
+                                     // instead of the fixed offset. Opt-in: PH_CAL_* and stored
+                                     // calibrations are in legacy-formula mV, recalibrate after enabling
+#define ESP32_ADC_DEFAULT_VREF 1100   // mV, used only if the chip has no eFuse Vref
+
+// On-device calibration session (started with {"command": "phCalStart"} on MQTT_TOPIC_CONFIG)
+#define PH_CAL_SAMPLE_INTERVAL_MS 40    // 25 Hz raw sampling while calibrating
+#define PH_CAL_BATCH_SIZE 25            // Samples per streamed frame (one frame per second)
+#define PH_CAL_SETTLE_STDDEV_MV 1.5     // Max noise within a batch to count as settled
+#define PH_CAL_SETTLE_DRIFT_MV 1.0      // Max change of batch mean between batches
+#define PH_CAL_SETTLE_BATCHES 3         // Consecutive steady batches before capturing a point
+#define PH_CAL_MIN_SPAN_MV 50.0         // Minimum spacing between calibration points
+#define PH_CAL_SESSION_TIMEOUT 900000   // milliseconds - abandon a session 15 min after its last start/arm/capture
 
 // ==================== Timing Configuration ====================
 #define SENSOR_READ_INTERVAL 15000   // milliseconds (15 seconds)
 #define HEALTH_MSG_INTERVAL 60000    // milliseconds (60 seconds)
 #define WATCHDOG_TIMEOUT 60          // seconds
+#define ACQUISITION_TIMEOUT_MS 60    // milliseconds - max wait for triggered conversions per read cycle
+
+// Stall monitor: loop() stages making no progress this long are recorded (stage, duration,
+// call sites) and reported in the next health message, long before the watchdog fires
+#define STALL_THRESHOLD_MS 250       // milliseconds without a stage change
+#define STALL_CHECK_INTERVAL_MS 50   // milliseconds between checks (esp_timer)
+#define STALL_TRAIL_DEPTH 4          // Nested stages kept per stall
+
+// On-demand tracing ({"command": "traceStart", "ms": 5000}): begin/end events from loop()
+// and the sensor drivers are recorded into a RAM ring, then sent to MQTT_TOPIC_TRACE in
+// binary batches (tools/trace_to_json turns them into a Chrome / Perfetto trace)
+#define TRACE_RING_EVENTS 4096       // 8 bytes each, allocated only while a capture runs (PSRAM if present)
+#define TRACE_BATCH_EVENTS 160       // Events per MQTT message (12 + 8 * 160 bytes)
+#define TRACE_MAX_DURATION_MS 60000  // milliseconds - longest capture
+
+// Hardware capture ({"command": "halRecord", "ms": 60000}): every value the sensor drivers read
+// (clock, pins, ADC, I2C) is recorded and sent to MQTT_TOPIC_HALTRACE in chunks, for
+// tools/hal_replay to run the drivers against on a PC. "boot": true restarts first and
+// records from sensor initialization on
+#define HAL_TRACE_BYTES 65536              // Capture buffer, allocated only while capturing (PSRAM if present)
+#define HAL_TRACE_CHUNK_BYTES 1024         // Capture bytes per MQTT message (+12 byte header)
+#define HAL_TRACE_MAX_DURATION_MS 600000   // milliseconds - longest capture
+#define HAL_ISR_QUEUE 32                   // Interrupt reads held until loop() appends them
+
+// Warm start: averaging windows survive software, panic and watchdog resets in RTC memory
+#define ENABLE_WARM_START                  // Comment out to start every boot with empty windows
+#define WARM_START_FIRST_PUBLISH_MS 5000   // milliseconds after boot for the first publish when restored
+
+// Memory telemetry in the health message: heap fragmentation, leak drift, PSRAM
+// and per-task stack high-water marks. The allocation rate additionally needs
+// -DMEMORY_COUNT_ALLOCATIONS and the -Wl,--wrap malloc/calloc/realloc flags
+// (set in platformio.ini).
+#define MEMORY_SAMPLE_INTERVAL_MS 5000     // milliseconds - largest-free-block low-water mark sampling
+#define MEMORY_WATCHED_TASKS { "loopTask", "ota", "tiT", "wifi" }  // Stack high-water marks reported
+
+// Prometheus metrics over HTTP (GET /metrics on METRICS_HTTP_PORT): channel values,
+// filter stats and loop timings. Served from the AsyncTCP task out of a page loop()
+// re-renders only while someone is scraping. Needs the AsyncTCP library (platformio.ini).
+//#define ENABLE_METRICS_HTTP                // Uncomment to serve /metrics
+#define METRICS_HTTP_PORT 9100
+#define METRICS_PAGE_BYTES 8192            // Rendered page, ~5 KB used (two are allocated, internal RAM)
+#define METRICS_REFRESH_MS 1000            // milliseconds - shortest time between renders
+#define METRICS_ACTIVE_MS 120000           // milliseconds - keep rendering this long after a scrape
+#define METRICS_MAX_CLIENTS 2              // Concurrent scrapes (more are refused)
+#define METRICS_REQUEST_BYTES 256          // Request buffer; the request line must fit
+#define METRICS_TIMEOUT_S 5                // seconds - drop idle connections
 
 // ==================== Firmware Version ====================
 #define FIRMWARE_VERSION "1.0.0"
@@ -6,6 +6,26 @@
 #include <Wire.h>
 #include <esp_task_wdt.h>
 #include "config.h"
+#include "BrokerPool.h"
+#include "RuntimeConfig.h"
+#include "HistoryArchive.h"
+#include "Gorilla.h"
+#include "SensorSupervisor.h"
+#include "AlarmMonitor.h"
+#include "SampleQuality.h"
+#include "OutboundQueue.h"
+#include "CoalescingClient.h"
+#include "WarmStart.h"
+#include "OtaUpdater.h"
+#include "MemoryTelemetry.h"
+#include "StallMonitor.h"
+#include "TraceRecorder.h"
+#include "HalRecorder.h"
+#include "SensorPayload.h"
+
+#ifdef ENABLE_METRICS_HTTP
+#include "MetricsServer.h"
+#endif
 
 // Sensor includes
 #ifdef ENABLE_SHT30
@@ -18,11 +38,23 @@
 
 #ifdef ENABLE_PH_SENSOR
 #include "PHSensor.h"
+#include "PHCalibration.h"
 #endif
 
 // ==================== Global Objects ====================
 WiFiClient espClient;
-PubSubClient mqttClient(espClient);
+CoalescingClient mqttTransport(espClient);  // One TCP write per loop() pass
+PubSubClient mqttClient(mqttTransport);
+
+// Every publish goes through here: priority classes, token buckets, drop-oldest
+OutboundQueue outbound(mqttClient);
+
+// Broker endpoints (resolved once, ranked by RTT, failover on connect errors)
+const BrokerEndpoint brokerEndpoints[] = MQTT_BROKER_LIST;
+BrokerPool brokerPool(brokerEndpoints);
+
+// Live runtime settings (defaults from config.h, overridden from NVS / MQTT)
+RuntimeSettings runtimeSettings = RuntimeSettings::defaults();
 
 // Sensor instances
 #ifdef ENABLE_SHT30
@@ -35,15 +67,163 @@ HC_SR04Sensor waterLevelSensor(HC_SR04_TRIG_PIN, HC_SR04_ECHO_PIN);
 
 #ifdef ENABLE_PH_SENSOR
 PHSensor phSensor(PH_SENSOR_PIN);
+PHCalibrationSession phCalibration;
+#endif
+
+// Drivers in the order hardware captures number them
+SensorBase* const halSensors[] = {
+    #ifdef ENABLE_SHT30
+    &sht30Sensor,
+    #endif
+    #ifdef ENABLE_HC_SR04
+    &waterLevelSensor,
+    #endif
+    #ifdef ENABLE_PH_SENSOR
+    &phSensor,
+    #endif
+};
+const size_t HAL_SENSOR_COUNT = sizeof(halSensors) / sizeof(halSensors[0]);
+
+// Re-probes sensors that failed to initialize or stopped answering
+SensorSupervisor sensorSupervisor;
+
+// Per-channel views used for time-series publishing, history queries and health
+struct SensorChannel {
+    const char* deviceType;
+    SensorBase* sensor;
+    const SampleRing<RAW_SAMPLE_RING_SIZE>* rawSamples;
+    const SampleRing<RAW_SAMPLE_RING_SIZE>* acceptedSamples;  // After range check / despike (alarms)
+    ChannelHistory* history;
+    MovingAverage<float, MAX_AVERAGE_WINDOW>* average;  // Averaging stage (saved for warm starts)
+    float scale;            // Values are sent as integers: round(value * scale)
+    uint32_t seriesCursor;  // Next raw sample to send in time-series mode
+    SampleQuality quality;  // Flatline / stuck / noise detectors on the raw samples
+};
+
+SensorChannel sensorChannels[] = {
+    #ifdef ENABLE_SHT30
+    { "temperature", &sht30Sensor, &sht30Sensor.getTemperatureSamples(), &sht30Sensor.getAcceptedTemperatureSamples(), &sht30Sensor.getTemperatureHistory(), &sht30Sensor.getTemperatureAverage(), 100.0f, 0, SampleQuality() },
+    { "humidity", &sht30Sensor, &sht30Sensor.getHumiditySamples(), &sht30Sensor.getAcceptedHumiditySamples(), &sht30Sensor.getHumidityHistory(), &sht30Sensor.getHumidityAverage(), 100.0f, 0, SampleQuality() },
+    #endif
+    #ifdef ENABLE_HC_SR04
+    { "waterLevel", &waterLevelSensor, waterLevelSensor.getRawSamples(), waterLevelSensor.getAcceptedSamples(), waterLevelSensor.getHistory(), waterLevelSensor.getMovingAverage(), 10.0f, 0, SampleQuality() },
+    #endif
+    #ifdef ENABLE_PH_SENSOR
+    { "pH", &phSensor, phSensor.getRawSamples(), phSensor.getAcceptedSamples(), phSensor.getHistory(), phSensor.getMovingAverage(), 100.0f, 0, SampleQuality() },
+    #endif
+};
+const size_t SENSOR_CHANNEL_COUNT = sizeof(sensorChannels) / sizeof(sensorChannels[0]);
+
+// History query being streamed to MQTT_TOPIC_HISTORY (one at a time)
+struct HistoryQuery {
+    bool active;
+    char id[24];            // Echoed so the requester can match replies
+    SensorChannel* channel;
+    size_t archive;
+    uint32_t nextSlot;
+    uint32_t lastSlot;
+    uint16_t part;
+};
+HistoryQuery historyQuery = {};
+
+// Threshold / rate-of-change alarms on raw samples
+const AlarmRule alarmRules[] = ALARM_RULES;
+AlarmMonitor alarmMonitor;
+
+// Averaging windows kept across software / watchdog resets (RTC memory is not cleared on those)
+#ifdef ENABLE_WARM_START
+RTC_NOINIT_ATTR WarmStartSnapshot warmStartSnapshot;
+WarmStart warmStart(warmStartSnapshot);
+#endif
+
+// ArduinoOTA uploads and HTTP downloads, serviced by their own task
+OtaUpdater otaUpdater;
+
+// Heap fragmentation, leak drift and task stack margins for the health message
+MemoryTelemetry memoryTelemetry;
+
+// loop() stage markers checked by a timer; the longest stall survives resets in RTC memory
+RTC_NOINIT_ATTR StallRecord stallRecord;
+StallMonitor stallMonitor(stallRecord);
+
+// Begin/end events for on-demand traces (probes cost one branch while idle)
+TraceRecorder traceRecorder;
+
+// Hardware responses under the sensor drivers, replayed on a PC by tools/hal_replay
+HalRecorder halRecorder;
+RTC_NOINIT_ATTR HalBootRequest halBootRequest;
+
+// Prometheus scrape endpoint (answered by the AsyncTCP task from a pre-rendered page)
+#ifdef ENABLE_METRICS_HTTP
+MetricsServer metricsServer;
+#endif
+
+// ==================== Allocation Counting ====================
+// malloc/calloc/realloc are linked through these wrappers (-Wl,--wrap=... in
+// platformio.ini) so the health message can report the allocation rate. They
+// run with the flash cache disabled too (allocations during OTA flash writes,
+// from other tasks and ISRs), so code lives in IRAM and the counters in DRAM.
+#ifdef MEMORY_COUNT_ALLOCATIONS
+DRAM_ATTR volatile uint32_t memoryAllocCalls = 0;
+DRAM_ATTR volatile uint32_t memoryAllocBytes = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+static inline __attribute__((always_inline)) void countAllocation(size_t size) {
+    __atomic_fetch_add(&memoryAllocCalls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&memoryAllocBytes, (uint32_t)size, __ATOMIC_RELAXED);
+}
+
+void* IRAM_ATTR __wrap_malloc(size_t size) {
+    countAllocation(size);
+    return __real_malloc(size);
+}
+
+void* IRAM_ATTR __wrap_calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __real_calloc(count, size);
+}
+
+void* IRAM_ATTR __wrap_realloc(void* ptr, size_t size) {
+    countAllocation(size);
+    return __real_realloc(ptr, size);
+}
+}
 #endif
 
 // ==================== Timing Variables ====================
+// Phases of the last sensor read cycle (microseconds), see readSensors()
+struct AcquisitionTiming {
+    uint32_t triggerUs;     // Starting every conversion
+    uint32_t waitUs;        // Until the slowest sensor was ready (MQTT serviced meanwhile)
+    uint32_t collectUs;     // Reading back and filtering every result
+    uint32_t totalUs;
+    uint32_t serialUs;      // Sum of each sensor's own start-to-collected time (cost if read one by one)
+};
+AcquisitionTiming acquisitionTiming = {};
+
+// loop() pass duration (microseconds, without the trailing delay), see loop()
+struct LoopTiming {
+    uint32_t lastUs;
+    uint32_t maxUs;         // Since the last metrics render
+};
+LoopTiming loopTiming = {};
+
 unsigned long lastSensorRead = 0;
 unsigned long lastSensorPublish = 0;
 unsigned long lastHealthMsg = 0;
 unsigned long lastWiFiAttempt = 0;
 unsigned long lastMQTTAttempt = 0;
 unsigned long mqttReconnectDelay = MQTT_RECONNECT_INITIAL_DELAY;
+bool wifiWasConnected = false;
+bool wifiEverConnected = false;
+bool otaStarted = false;        // ArduinoOTA is set up on the first WiFi connection
+unsigned long otaMaxReadGapMs = 0;  // Longest time between sensor reads while an update ran
+unsigned long otaRestartAt = 0;     // millis() of the pending post-update restart (0 = none)
+unsigned long halRestartAt = 0;     // millis() of the restart into a boot capture (0 = none)
 
 // ==================== LED Indicator ====================
 #ifdef ENABLE_LED_INDICATOR
@@ -59,9 +239,43 @@ void reconnectMQTT();
 void setupOTA();
 void initializeSensors();
 void readSensors();
+void publishSensorTransition(const SupervisedSensor& entry, SensorState from);
 void publishSensorData();
 void publishHealthMessage();
 void updateLEDIndicator();
+void mqttCallback(char* topic, byte* payload, unsigned int length);
+void handleConfigMessage(const byte* payload, unsigned int length);
+void applyRuntimeSettings();
+void publishConfigState(const char* result);
+void handleCommand(JsonVariant command);
+void servicePHCalibration();
+void publishCalibrationEvent(const char* event, const char* detail);
+void publishTimeSeries();
+uint32_t publishSeriesJson(const SensorChannel& channel, uint32_t dropped);
+uint32_t publishSeriesBlock(const SensorChannel& channel);
+void initializeHistory();
+SensorChannel* findSensorChannel(const char* deviceType);
+void startHistoryQuery(JsonVariant command);
+void serviceHistoryQuery();
+void publishHistoryError(const char* id, const char* error);
+void initializeAlarms();
+void publishAlarms();
+void onWiFiConnected();
+void restoreWarmStart();
+void saveWarmStart();
+void serviceOTA();
+void publishOtaEvent(const char* result, const OtaReport* report, const char* detail);
+void serviceTrace();
+void publishTraceEvent(const char* result, const char* detail);
+bool startHalCapture(uint32_t durationMs, bool fromBoot);
+void recordPHTable();
+void serviceHalTrace();
+void publishHalTraceEvent(const char* result, const char* detail);
+bool beginSensor(SensorBase& sensor);
+#ifdef ENABLE_METRICS_HTTP
+void serviceMetrics();
+void renderMetrics(MetricsPage& page);
+#endif
 
 // ==================== Setup Function ====================
 void setup() {
@@ -86,17 +300,40 @@ void setup() {
     Serial.println("[I2C] Initialized on pins SDA=" + String(I2C_SDA) + ", SCL=" + String(I2C_SCL));
     #endif
     
-    // Initialize WiFi
+    // Load runtime settings persisted by earlier config messages
+    if (RuntimeConfig::load()) {
+        Serial.println("[CONFIG] Loaded runtime settings from NVS");
+    } else {
+        Serial.println("[CONFIG] Using default runtime settings from config.h");
+    }
+    
+    // A halRecord with "boot" restarted into this run: record from the drivers' begin() on
+    for (size_t i = 0; i < HAL_SENSOR_COUNT; i++) {
+        halRecorder.addSensor(halSensors[i]);
+    }
+    uint32_t halBootMs;
+    if (HalRecorder::takeBootRequest(halBootRequest, halBootMs) && !startHalCapture(halBootMs, true)) {
+        publishHalTraceEvent("rejected", "no memory for capture buffer");
+    }
+    
+    // Initialize sensors first so they sample while WiFi associates
+    initializeSensors();
+    applyRuntimeSettings();
+    initializeHistory();
+    initializeAlarms();
+    restoreWarmStart();
+    
+    // Start WiFi in the background (OTA is set up once it connects)
     setupWiFi();
     
-    // Initialize MQTT
+    // Initialize MQTT (connects from loop once WiFi is up)
     setupMQTT();
     
-    // Initialize OTA
-    setupOTA();
+    // Updates run in their own task so sampling continues during an upload
+    otaUpdater.begin();
     
-    // Initialize sensors
-    initializeSensors();
+    // Baseline for the heap drift reported with each health message
+    memoryTelemetry.begin();
     
     // Initialize watchdog timer (60 seconds)
     Serial.println("[WDT] Configuring watchdog timer...");
@@ -104,6 +341,9 @@ void setup() {
     esp_task_wdt_add(NULL);
     Serial.println("[WDT] Watchdog timer enabled");
     
+    // Catches the multi-second stalls the watchdog lets through
+    stallMonitor.begin();
+    
     Serial.println("\n[SYSTEM] Setup complete. Starting main loop...\n");
 }
 
@@ -114,22 +354,46 @@ unsigned long lastStatusLog = 0;
 void loop() {
     // Reset watchdog timer
     esp_task_wdt_reset();
+    traceRecorder.begin(TRACE_LOOP);
+    int64_t passStart = esp_timer_get_time();
     
-    // Handle OTA updates
-    ArduinoOTA.handle();
+    // Report finished updates and restart into new firmware (uploads run in the OTA task)
+    stallMonitor.mark(STAGE_OTA);
+    serviceOTA();
+    stallMonitor.service();
     
     // Check WiFi connection
-    if (WiFi.status() != WL_CONNECTED) {
+    stallMonitor.mark(STAGE_WIFI);
+    bool wifiConnected = WiFi.status() == WL_CONNECTED;
+    if (wifiConnected && !wifiWasConnected) {
+        onWiFiConnected();
+    } else if (!wifiConnected) {
+        if (wifiWasConnected) {
+            Serial.println("\n[WiFi] ⚠ Connection lost");
+            lastWiFiAttempt = millis();  // Give the driver's own reconnect a chance first
+        }
         reconnectWiFi();
     }
+    wifiWasConnected = wifiConnected;
     
     // Check MQTT connection
     if (!mqttClient.connected()) {
+        stallMonitor.mark(STAGE_MQTT_CONNECT);
         reconnectMQTT();
     } else {
+        stallMonitor.mark(STAGE_MQTT_LOOP);
+        traceRecorder.begin(TRACE_MQTT_LOOP);
         mqttClient.loop();
+        traceRecorder.end(TRACE_MQTT_LOOP);
     }
     
+    // Alarms first, then whatever the rate limits allow from the outbound queue
+    stallMonitor.mark(STAGE_OUTBOUND);
+    traceRecorder.begin(TRACE_OUTBOUND);
+    publishAlarms();
+    outbound.service();
+    traceRecorder.end(TRACE_OUTBOUND);
+    
     // Update LED indicator
     #ifdef ENABLE_LED_INDICATOR
     updateLEDIndicator();
@@ -148,41 +412,93 @@ void loop() {
         Serial.printf("[STATUS] WiFi: %s (RSSI: %d dBm)\n", 
                       WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected",
                       WiFi.RSSI());
-        Serial.printf("[STATUS] MQTT: %s\n", 
-                      mqttClient.connected() ? "Connected" : "Disconnected");
-        Serial.printf("[STATUS] Free Heap: %d bytes (%.2f KB)\n", 
-                      ESP.getFreeHeap(), ESP.getFreeHeap() / 1024.0);
+        Serial.printf("[STATUS] MQTT: %s (broker: %s, RTT: %lu ms)\n", 
+                      mqttClient.connected() ? "Connected" : "Disconnected",
+                      brokerPool.getActiveHost(), brokerPool.getActiveRtt());
+        Serial.printf("[STATUS] Free Heap: %d bytes (%.2f KB), min %d bytes, largest block %d bytes\n", 
+                      ESP.getFreeHeap(), ESP.getFreeHeap() / 1024.0,
+                      ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+        const CoalescingClient::Stats& transport = mqttTransport.getStats();
+        Serial.printf("[STATUS] MQTT transport: %lu packets in %lu TCP writes since last health message\n",
+                      (unsigned long)transport.frames, (unsigned long)transport.segments);
         Serial.println("════════════════════════════════════════\n");
     }
     
+    // High-rate pH sampling while a calibration session is running
+    #ifdef ENABLE_PH_SENSOR
+    stallMonitor.mark(STAGE_CALIBRATION);
+    servicePHCalibration();
+    #endif
+    
+    // Stream the next part of a pending history query
+    stallMonitor.mark(STAGE_HISTORY);
+    serviceHistoryQuery();
+    
+    // Re-probe failed sensors whose backoff has expired
+    stallMonitor.mark(STAGE_SUPERVISOR);
+    traceRecorder.begin(TRACE_SUPERVISOR);
+    sensorSupervisor.service();
+    traceRecorder.end(TRACE_SUPERVISOR);
+    
+    // End a capture whose time is up and send a finished one, a batch per pass
+    serviceTrace();
+    serviceHalTrace();
+    
+    // Low-water mark of the largest free heap block between health messages
+    memoryTelemetry.sample();
+    
+    // Re-render the metrics page while it is being scraped
+    #ifdef ENABLE_METRICS_HTTP
+    serviceMetrics();
+    #endif
+    
     // Read sensors at regular intervals (for moving average data collection)
-    if (currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL) {
+    if (currentMillis - lastSensorRead >= runtimeSettings.sensorReadInterval) {
+        if (otaUpdater.isBusy() && currentMillis - lastSensorRead > otaMaxReadGapMs) {
+            otaMaxReadGapMs = currentMillis - lastSensorRead;
+        }
         lastSensorRead = currentMillis;
         Serial.printf("\n[LOOP] Next sensor read at: %lu ms (in %lu seconds)\n", 
-                      currentMillis + SENSOR_READ_INTERVAL, 
-                      SENSOR_READ_INTERVAL / 1000);
+                      currentMillis + runtimeSettings.sensorReadInterval, 
+                      (unsigned long)runtimeSettings.sensorReadInterval / 1000);
+        stallMonitor.mark(STAGE_SENSORS);
         readSensors();
     }
     
     // Publish sensor data at regular intervals
-    if (currentMillis - lastSensorPublish >= SENSOR_PUBLISH_INTERVAL) {
+    if (currentMillis - lastSensorPublish >= runtimeSettings.sensorPublishInterval) {
         lastSensorPublish = currentMillis;
         Serial.printf("\n[LOOP] Next sensor publish at: %lu ms (in %lu seconds)\n", 
-                      currentMillis + SENSOR_PUBLISH_INTERVAL, 
-                      SENSOR_PUBLISH_INTERVAL / 1000);
+                      currentMillis + runtimeSettings.sensorPublishInterval, 
+                      (unsigned long)runtimeSettings.sensorPublishInterval / 1000);
+        stallMonitor.mark(STAGE_PUBLISH);
         publishSensorData();
     }
     
     // Publish health message at regular intervals
-    if (currentMillis - lastHealthMsg >= HEALTH_MSG_INTERVAL) {
+    if (currentMillis - lastHealthMsg >= runtimeSettings.healthMsgInterval) {
         lastHealthMsg = currentMillis;
         Serial.printf("\n[LOOP] Next health message at: %lu ms (in %lu seconds)\n", 
-                      currentMillis + HEALTH_MSG_INTERVAL, 
-                      HEALTH_MSG_INTERVAL / 1000);
+                      currentMillis + runtimeSettings.healthMsgInterval, 
+                      (unsigned long)runtimeSettings.healthMsgInterval / 1000);
+        stallMonitor.mark(STAGE_HEALTH);
         publishHealthMessage();
     }
     
+    // Everything published in this pass goes out as one TCP write
+    stallMonitor.mark(STAGE_FLUSH);
+    traceRecorder.begin(TRACE_FLUSH);
+    mqttTransport.flush();
+    traceRecorder.end(TRACE_FLUSH);
+    traceRecorder.end(TRACE_LOOP);
+    
+    loopTiming.lastUs = (uint32_t)(esp_timer_get_time() - passStart);
+    if (loopTiming.lastUs > loopTiming.maxUs) {
+        loopTiming.maxUs = loopTiming.lastUs;
+    }
+    
     // Small delay to prevent tight looping
+    stallMonitor.mark(STAGE_IDLE);
     delay(10);
 }
 
@@ -192,71 +508,61 @@ void setupWiFi() {
     WiFi.mode(WIFI_STA);
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
     
-    Serial.print("[WiFi] Connecting to ");
-    Serial.print(WIFI_SSID);
-    
-    unsigned long startAttempt = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startAttempt < WIFI_CONNECTION_TIMEOUT) {
-        delay(500);
-        Serial.print(".");
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\n[WiFi] Connected!");
-        Serial.print("[WiFi] IP Address: ");
-        Serial.println(WiFi.localIP());
-        Serial.print("[WiFi] Signal Strength: ");
-        Serial.print(WiFi.RSSI());
-        Serial.println(" dBm");
-    } else {
-        Serial.println("\n[WiFi] Failed to connect. Will retry in background.");
-    }
-    
+    // Association runs in the WiFi task; loop() picks up the connection
+    Serial.printf("[WiFi] Connecting to %s in the background\n", WIFI_SSID);
     lastWiFiAttempt = millis();
 }
 
+/**
+ * Restart association if it has not completed in time. Never blocks: the
+ * first attempt gets WIFI_CONNECTION_TIMEOUT, later ones WIFI_RECONNECT_INTERVAL.
+ */
 void reconnectWiFi() {
+    TraceScope trace(TRACE_WIFI_RECONNECT);
+    
     unsigned long currentMillis = millis();
+    unsigned long timeout = wifiEverConnected ? WIFI_RECONNECT_INTERVAL : WIFI_CONNECTION_TIMEOUT;
     
-    // Only attempt reconnection at intervals
-    if (currentMillis - lastWiFiAttempt < WIFI_RECONNECT_INTERVAL) {
+    if (currentMillis - lastWiFiAttempt < timeout) {
         return;
     }
     
+    Serial.printf("[WiFi] ✗ Not connected after %lu ms, restarting association\n",
+                  currentMillis - lastWiFiAttempt);
     lastWiFiAttempt = currentMillis;
-    
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("\n[WiFi] ⚠ Connection lost - attempting reconnection...");
-        Serial.printf("[WiFi] Last successful connection: %lu ms ago\n", 
-                      currentMillis - lastWiFiAttempt + WIFI_RECONNECT_INTERVAL);
-        WiFi.disconnect();
-        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-        
-        // Wait briefly for connection
-        int attempts = 0;
-        while (WiFi.status() != WL_CONNECTED && attempts < 10) {
-            delay(500);
-            Serial.print(".");
-            attempts++;
-        }
-        
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.println("\n[WiFi] ✓ Reconnected successfully!");
-            Serial.printf("[WiFi] IP Address: %s\n", WiFi.localIP().toString().c_str());
-            Serial.printf("[WiFi] Signal Strength: %d dBm\n", WiFi.RSSI());
-        } else {
-            Serial.println("\n[WiFi] ✗ Reconnection failed, will retry");
-        }
+    WiFi.disconnect();
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+}
+
+void onWiFiConnected() {
+    Serial.printf("\n[WiFi] ✓ Connected %lu ms after boot\n", millis());
+    Serial.printf("[WiFi] IP Address: %s\n", WiFi.localIP().toString().c_str());
+    Serial.printf("[WiFi] Signal Strength: %d dBm\n", WiFi.RSSI());
+    wifiEverConnected = true;
+    
+    if (!otaStarted) {
+        setupOTA();
+        otaStarted = true;
     }
+    
+    #ifdef ENABLE_METRICS_HTTP
+    metricsServer.begin();
+    #endif
+    
+    // Connect to the broker right away instead of waiting out the backoff
+    lastMQTTAttempt = millis() - mqttReconnectDelay;
 }
 
 // ==================== MQTT Functions ====================
 void setupMQTT() {
     Serial.println("\n[MQTT] Configuring MQTT client...");
-    mqttClient.setServer(MQTT_BROKER, MQTT_PORT);
-    mqttClient.setBufferSize(512);  // Increase buffer for JSON messages
+    brokerPool.begin();
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);  // Largest outbound payload plus topic and header
+    outbound.begin();
+    mqttClient.setCallback(mqttCallback);
     
-    Serial.printf("[MQTT] Broker: %s:%d\n", MQTT_BROKER, MQTT_PORT);
+    Serial.printf("[MQTT] Broker: %s:%d (%u endpoints configured)\n", MQTT_BROKER, MQTT_PORT,
+                  (unsigned)brokerPool.getEndpointCount());
     Serial.printf("[MQTT] Client ID: %s\n", MQTT_CLIENT_ID);
     
     // Attempt initial connection
@@ -264,6 +570,8 @@ void setupMQTT() {
 }
 
 void reconnectMQTT() {
+    TraceScope trace(TRACE_MQTT_CONNECT);
+    
     // Only attempt if WiFi is connected
     if (WiFi.status() != WL_CONNECTED) {
         return;
@@ -279,8 +587,31 @@ void reconnectMQTT() {
     lastMQTTAttempt = currentMillis;
     
     if (!mqttClient.connected()) {
-        Serial.println("[MQTT] Attempting connection...");
+        brokerPool.markDisconnected();
+        
+        // Re-rank endpoints by RTT before choosing one (no-op with a single broker).
+        // One endpoint per pass, so a round of dead hosts never blocks loop() for
+        // more than MQTT_BROKER_PROBE_TIMEOUT; the attempt stays due meanwhile.
+        if (brokerPool.isProbing() || brokerPool.isProbeDue()) {
+            brokerPool.probeNext();
+            lastMQTTAttempt = currentMillis - mqttReconnectDelay;
+            return;
+        }
         
+        size_t endpointIndex;
+        IPAddress brokerAddress;
+        uint16_t brokerPort;
+        if (!brokerPool.selectEndpoint(endpointIndex, brokerAddress, brokerPort)) {
+            mqttReconnectDelay = min(mqttReconnectDelay * 2, (unsigned long)MQTT_RECONNECT_MAX_DELAY);
+            Serial.printf("[MQTT] No broker could be resolved, will retry in %lu ms\n", mqttReconnectDelay);
+            return;
+        }
+        
+        Serial.printf("[MQTT] Attempting connection to %s:%u...\n",
+                      brokerAddress.toString().c_str(), brokerPort);
+        mqttClient.setServer(brokerAddress, brokerPort);  // IP, so PubSubClient skips DNS
+        
+        unsigned long connectStart = millis();
         bool connected = false;
         if (strlen(MQTT_USER) > 0) {
             connected = mqttClient.connect(MQTT_CLIENT_ID, MQTT_USER, MQTT_PASSWORD);
@@ -289,17 +620,577 @@ void reconnectMQTT() {
         }
         
         if (connected) {
-            Serial.println("[MQTT] Connected!");
+            brokerPool.reportSuccess(endpointIndex, millis() - connectStart);
+            Serial.printf("[MQTT] Connected to %s (%lu ms)\n",
+                          brokerPool.getActiveHost(), brokerPool.getActiveRtt());
             mqttReconnectDelay = MQTT_RECONNECT_INITIAL_DELAY;  // Reset backoff
+            
+            if (!mqttClient.subscribe(MQTT_TOPIC_CONFIG)) {
+                Serial.printf("[MQTT] ✗ Failed to subscribe to %s\n", MQTT_TOPIC_CONFIG);
+            }
         } else {
             Serial.print("[MQTT] Connection failed, rc=");
             Serial.println(mqttClient.state());
             
-            // Exponential backoff
-            mqttReconnectDelay = min(mqttReconnectDelay * 2, (unsigned long)MQTT_RECONNECT_MAX_DELAY);
-            Serial.printf("[MQTT] Will retry in %lu ms\n", mqttReconnectDelay);
+            if (brokerPool.reportFailure(endpointIndex)) {
+                // Every endpoint failed this round - exponential backoff
+                mqttReconnectDelay = min(mqttReconnectDelay * 2, (unsigned long)MQTT_RECONNECT_MAX_DELAY);
+                Serial.printf("[MQTT] Will retry in %lu ms\n", mqttReconnectDelay);
+            } else {
+                // Try the next endpoint on the next pass; the backoff carries over to the next round
+                lastMQTTAttempt = millis() - mqttReconnectDelay;
+                Serial.println("[MQTT] Failing over to the next broker");
+            }
+        }
+    }
+}
+
+void mqttCallback(char* topic, byte* payload, unsigned int length) {
+    if (strcmp(topic, MQTT_TOPIC_CONFIG) == 0) {
+        handleConfigMessage(payload, length);
+    }
+}
+
+// ==================== Runtime Config Functions ====================
+void handleConfigMessage(const byte* payload, unsigned int length) {
+    Serial.printf("\n[CONFIG] Received config message (%u bytes)\n", length);
+    
+    StaticJsonDocument<512> doc;
+    DeserializationError err = deserializeJson(doc, payload, length);
+    if (err) {
+        Serial.printf("[CONFIG] ✗ Invalid JSON: %s\n", err.c_str());
+        publishConfigState("rejected: invalid JSON");
+        return;
+    }
+    
+    // Commands share the config topic but never touch settings
+    if (!doc["command"].isNull()) {
+        handleCommand(doc.as<JsonVariant>());
+        return;
+    }
+    
+    const char* error = nullptr;
+    if (!RuntimeConfig::apply(doc.as<JsonVariant>(), &error)) {
+        Serial.printf("[CONFIG] ✗ Rejected - invalid %s\n", error);
+        char result[64];
+        snprintf(result, sizeof(result), "rejected: invalid %s", error);
+        publishConfigState(result);
+        return;
+    }
+    
+    applyRuntimeSettings();
+    
+    if (RuntimeConfig::save()) {
+        Serial.println("[CONFIG] ✓ Settings applied and saved to NVS");
+        publishConfigState("applied");
+    } else {
+        Serial.println("[CONFIG] ⚠ Settings applied but NVS write failed");
+        publishConfigState("applied (not persisted)");
+    }
+}
+
+void applyRuntimeSettings() {
+    #ifdef ENABLE_SHT30
+    sht30Sensor.setAverageWindow(runtimeSettings.tempHumidityWindow);
+    #endif
+    
+    #ifdef ENABLE_HC_SR04
+    waterLevelSensor.setAverageWindow(runtimeSettings.waterLevelWindow);
+    #endif
+    
+    #ifdef ENABLE_PH_SENSOR
+    phSensor.setAverageWindow(runtimeSettings.phWindow);
+    #endif
+    
+    halRecorder.recordSettings(&runtimeSettings, sizeof(runtimeSettings));
+    
+    Serial.printf("[CONFIG] Intervals: read=%lu ms, publish=%lu ms, health=%lu ms\n",
+                  (unsigned long)runtimeSettings.sensorReadInterval,
+                  (unsigned long)runtimeSettings.sensorPublishInterval,
+                  (unsigned long)runtimeSettings.healthMsgInterval);
+}
+
+void publishConfigState(const char* result) {
+    StaticJsonDocument<512> doc;
+    doc["result"] = result;
+    RuntimeConfig::toJson(doc.createNestedObject("settings"));
+    
+    char buffer[512];
+    serializeJson(doc, buffer, sizeof(buffer));
+    
+    if (!outbound.enqueue(OUTBOUND_STATE, MQTT_TOPIC_CONFIG_STATE, buffer, true)) {
+        Serial.println("[MQTT] ✗ Failed to queue config state");
+    }
+}
+
+void handleCommand(JsonVariant command) {
+    const char* name = command["command"] | "";
+    Serial.printf("[CONFIG] Command: %s\n", name);
+    
+    #ifdef ENABLE_PH_SENSOR
+    if (strcmp(name, "phCalStart") == 0) {
+        phCalibration.start();
+        publishCalibrationEvent("started", nullptr);
+        return;
+    }
+    if (strcmp(name, "phCalCapture") == 0) {
+        PHCalPoint point = PHCalibrationSession::parsePoint(command["point"] | "");
+        if (!phCalibration.isActive() || point == PH_CAL_POINT_NONE) {
+            publishCalibrationEvent("error", "no session or unknown point");
+            return;
+        }
+        phCalibration.arm(point);
+        publishCalibrationEvent("armed", PHCalibrationSession::pointName(point));
+        return;
+    }
+    if (strcmp(name, "phCalCommit") == 0) {
+        if (!phCalibration.isActive()) {
+            publishCalibrationEvent("error", "no session");
+            return;
+        }
+        float mv[PH_CAL_POINT_COUNT];
+        phSensor.getCalibration(mv[PH_CAL_POINT_MID], mv[PH_CAL_POINT_LOW], mv[PH_CAL_POINT_HIGH]);
+        const char* error = nullptr;
+        if (!phCalibration.buildCalibration(mv, &error)) {
+            Serial.printf("[pH-CAL] ✗ Commit rejected: %s\n", error);
+            publishCalibrationEvent("error", error);
+            return;
+        }
+        phSensor.setCalibration(mv[PH_CAL_POINT_MID], mv[PH_CAL_POINT_LOW], mv[PH_CAL_POINT_HIGH]);
+        recordPHTable();
+        bool saved = PHCalibrationStore::save(mv);
+        phCalibration.stop();
+        phSensor.resetAverage();  // Drop readings taken in buffer solutions
+        halRecorder.recordReset(&phSensor);
+        Serial.printf("[pH-CAL] ✓ Calibration committed%s\n", saved ? "" : " (NVS write failed)");
+        publishCalibrationEvent("committed", saved ? "saved" : "not persisted");
+        return;
+    }
+    if (strcmp(name, "phCalAbort") == 0) {
+        phCalibration.stop();
+        phSensor.resetAverage();
+        halRecorder.recordReset(&phSensor);
+        publishCalibrationEvent("aborted", nullptr);
+        return;
+    }
+    #endif
+    
+    if (strcmp(name, "history") == 0) {
+        startHistoryQuery(command);
+        return;
+    }
+    
+    if (strcmp(name, "otaUpdate") == 0) {
+        const char* url = command["url"] | "";
+        const char* md5 = command["md5"] | "";
+        if (strncmp(url, "http://", 7) != 0) {
+            publishOtaEvent("rejected", nullptr, "url must start with http://");
+        } else if (!OtaUpdater::authorize(md5, command["auth"] | "")) {
+            // Image digest and password-derived auth are both required, so a config
+            // publisher without OTA_PASSWORD cannot flash anything
+            publishOtaEvent("rejected", nullptr, "md5/auth missing or wrong");
+        } else if (!otaUpdater.requestPull(url, md5)) {
+            publishOtaEvent("rejected", nullptr, otaUpdater.isBusy() ? "update in progress" : "url too long");
+        } else {
+            otaMaxReadGapMs = 0;
+            publishOtaEvent("started", nullptr, url);
+        }
+        return;
+    }
+    
+    if (strcmp(name, "traceStart") == 0) {
+        uint32_t durationMs = command["ms"] | 5000;
+        if (traceRecorder.isActive() || traceRecorder.isDumping()) {
+            publishTraceEvent("rejected", "capture in progress");
+        } else if (!traceRecorder.start(durationMs)) {
+            publishTraceEvent("rejected", "no memory for trace ring");
+        } else {
+            Serial.printf("[TRACE] Capture %08lx started for %lu ms\n",
+                          (unsigned long)traceRecorder.getCaptureId(), (unsigned long)durationMs);
+            publishTraceEvent("started", nullptr);
+        }
+        return;
+    }
+    if (strcmp(name, "traceStop") == 0) {
+        traceRecorder.stop();
+        return;
+    }
+    
+    if (strcmp(name, "halRecord") == 0) {
+        uint32_t durationMs = command["ms"] | 60000;
+        bool boot = command["boot"] | false;
+        if (halRecorder.isActive() || halRecorder.isDumping()) {
+            publishHalTraceEvent("rejected", "capture in progress");
+        } else if (boot) {
+            // Restart and record from sensor initialization on (no warm start)
+            HalRecorder::requestBootCapture(halBootRequest, durationMs);
+            halRestartAt = millis() + OTA_RESTART_DELAY_MS;
+            if (halRestartAt == 0) {
+                halRestartAt = 1;
+            }
+            publishHalTraceEvent("restarting", nullptr);
+        } else if (!startHalCapture(durationMs, false)) {
+            publishHalTraceEvent("rejected", "no memory for capture buffer");
+        } else {
+            publishHalTraceEvent("started", nullptr);
+        }
+        return;
+    }
+    if (strcmp(name, "halStop") == 0) {
+        halRecorder.stop();
+        return;
+    }
+    
+    Serial.printf("[CONFIG] ✗ Unknown command: %s\n", name);
+}
+
+// ==================== pH Calibration Functions ====================
+#ifdef ENABLE_PH_SENSOR
+void servicePHCalibration() {
+    unsigned long now = millis();
+    
+    if (phCalibration.isTimedOut(now)) {
+        Serial.println("[pH-CAL] ⚠ Session timed out, keeping previous calibration");
+        phCalibration.stop();
+        phSensor.resetAverage();
+        halRecorder.recordReset(&phSensor);
+        publishCalibrationEvent("aborted", "timeout");
+        return;
+    }
+    
+    if (!phCalibration.isSampleDue(now)) {
+        return;
+    }
+    
+    if (!phCalibration.addSample(now, phSensor.sampleMillivolts())) {
+        return;
+    }
+    
+    StaticJsonDocument<768> doc;
+    phCalibration.buildFrame(doc);
+    
+    char buffer[OUTBOUND_SLOT_BYTES];
+    if (doc.overflowed() || measureJson(doc) >= sizeof(buffer)) {
+        Serial.println("[pH-CAL] ✗ Frame does not fit a message, skipping");
+        return;
+    }
+    size_t len = serializeJson(doc, buffer, sizeof(buffer));
+    
+    #ifdef DEBUG_VERBOSE
+    Serial.printf("[pH-CAL] Frame: mean=%.1f mV, std=%.2f mV, settled=%s\n",
+                  doc["mean"].as<float>(), doc["std"].as<float>(),
+                  phCalibration.isSettled() ? "yes" : "no");
+    #endif
+    
+    if (mqttClient.connected()) {
+        outbound.enqueue(OUTBOUND_ROUTINE, MQTT_TOPIC_CALIBRATION, (const uint8_t*)buffer, len);
+    }
+}
+#endif
+
+void publishCalibrationEvent(const char* event, const char* detail) {
+    StaticJsonDocument<128> doc;
+    doc["event"] = event;
+    if (detail != nullptr) {
+        doc["detail"] = detail;
+    }
+    
+    char buffer[128];
+    serializeJson(doc, buffer, sizeof(buffer));
+    outbound.enqueue(OUTBOUND_STATE, MQTT_TOPIC_CALIBRATION, buffer);
+}
+
+// ==================== History Functions ====================
+void initializeHistory() {
+    size_t enabled = 0;
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        ChannelHistory* history = sensorChannels[c].history;
+        if (history != nullptr && history->begin()) {
+            enabled++;
+        }
+    }
+    
+    if (enabled == 0) {
+        Serial.println("[HISTORY] ⊘ Disabled (no PSRAM available)");
+        return;
+    }
+    Serial.printf("[HISTORY] ✓ %u channels, %u KB PSRAM\n", (unsigned)enabled,
+                  (unsigned)(enabled * ChannelHistory::storageSize() / 1024));
+    if (enabled < SENSOR_CHANNEL_COUNT) {
+        Serial.println("[HISTORY] ⚠ Not enough PSRAM for every channel");
+    }
+}
+
+SensorChannel* findSensorChannel(const char* deviceType) {
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        if (strcmp(sensorChannels[c].deviceType, deviceType) == 0) {
+            return &sensorChannels[c];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Start streaming buckets for {"command": "history", "channel": <deviceType>,
+ * "from": <seconds ago>, "to": <seconds ago>, "resolution": <s>, "id": <tag>}.
+ * Without "resolution" the finest archive reaching back to "from" is used.
+ * A new query replaces one that is still being sent.
+ */
+void startHistoryQuery(JsonVariant command) {
+    const char* id = command["id"] | "";
+    SensorChannel* channel = findSensorChannel(command["channel"] | "");
+    if (channel == nullptr || channel->history == nullptr) {
+        publishHistoryError(id, "unknown channel");
+        return;
+    }
+    ChannelHistory& history = *channel->history;
+    if (!history.isEnabled()) {
+        publishHistoryError(id, "history disabled");
+        return;
+    }
+    
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000000);
+    uint32_t from = command["from"] | now;
+    uint32_t to = command["to"] | 0;
+    if (from > now) from = now;
+    if (to > from) {
+        publishHistoryError(id, "to is after from");
+        return;
+    }
+    
+    size_t archive;
+    uint32_t resolution = command["resolution"] | 0;
+    if (resolution == 0) {
+        archive = history.selectArchive(now - from);
+    } else if (!history.findArchive(resolution, archive)) {
+        publishHistoryError(id, "no archive at that resolution");
+        return;
+    }
+    
+    const RollupArchive& a = history.getArchive(archive);
+    uint32_t firstSlot = (now - from) / a.getResolution();
+    if (firstSlot < a.oldestSlot()) {
+        firstSlot = a.oldestSlot();
+    }
+    
+    if (historyQuery.active) {
+        Serial.printf("[HISTORY] ⚠ Replacing unfinished query '%s'\n", historyQuery.id);
+    }
+    historyQuery.active = true;
+    strlcpy(historyQuery.id, id, sizeof(historyQuery.id));
+    historyQuery.channel = channel;
+    historyQuery.archive = archive;
+    historyQuery.nextSlot = firstSlot;
+    historyQuery.lastSlot = (now - to) / a.getResolution();
+    historyQuery.part = 0;
+    
+    Serial.printf("[HISTORY] Query '%s': %s, %lu s buckets, %lu slots\n", id, channel->deviceType,
+                  (unsigned long)a.getResolution(),
+                  (unsigned long)(historyQuery.lastSlot - firstSlot + 1));
+}
+
+/**
+ * Publish the next HISTORY_MAX_POINTS non-empty buckets of the active query:
+ *   {"id": "...", "channel": "pH", "res": 60, "now": <s>, "part": 0, "scale": 100,
+ *    "b": [[<start s>, <min>, <max>, <mean>, <count>], ...], "done": false}
+ * Times are seconds since boot; "now" lets the receiver map them to wall-clock time.
+ */
+void serviceHistoryQuery() {
+    TraceScope trace(TRACE_HISTORY);
+    
+    if (!historyQuery.active || !mqttClient.connected() || outbound.available(OUTBOUND_BULK) == 0) {
+        return;
+    }
+    
+    const SensorChannel& channel = *historyQuery.channel;
+    const RollupArchive& archive = channel.history->getArchive(historyQuery.archive);
+    const uint32_t resolution = archive.getResolution();
+    
+    StaticJsonDocument<1536> doc;
+    doc["id"] = historyQuery.id;
+    doc["channel"] = channel.deviceType;
+    doc["res"] = resolution;
+    doc["now"] = (uint32_t)(esp_timer_get_time() / 1000000);
+    doc["part"] = historyQuery.part;
+    doc["scale"] = channel.scale;
+    JsonArray buckets = doc.createNestedArray("b");
+    doc["done"] = false;  // Measured with the longer value; set for real below
+    
+    // A bucket that would not fit the slot goes into the next part instead
+    uint32_t slot = historyQuery.nextSlot;
+    size_t points = 0;
+    for (; slot <= historyQuery.lastSlot && points < HISTORY_MAX_POINTS; slot++) {
+        const RollupBucket* b = archive.find(slot);
+        if (b == nullptr) {
+            continue;
+        }
+        JsonArray entry = buckets.createNestedArray();
+        entry.add(slot * resolution);
+        entry.add((long)lroundf(b->min * channel.scale));
+        entry.add((long)lroundf(b->max * channel.scale));
+        entry.add((long)lroundf(b->sum / b->count * channel.scale));
+        entry.add(b->count);
+        if (points > 0 && (doc.overflowed() || measureJson(doc) >= OUTBOUND_SLOT_BYTES)) {
+            buckets.remove(buckets.size() - 1);
+            break;
+        }
+        points++;
+    }
+    bool done = slot > historyQuery.lastSlot;
+    doc["done"] = done;
+    
+    char buffer[OUTBOUND_SLOT_BYTES];
+    if (doc.overflowed() || measureJson(doc) >= sizeof(buffer)) {
+        Serial.printf("[HISTORY] ✗ Query '%s' part %u does not fit a message, giving up\n",
+                      historyQuery.id, historyQuery.part);
+        historyQuery.active = false;
+        return;
+    }
+    size_t len = serializeJson(doc, buffer, sizeof(buffer));
+    if (!outbound.enqueue(OUTBOUND_BULK, MQTT_TOPIC_HISTORY, (const uint8_t*)buffer, len)) {
+        return;  // Retry the same part on the next pass
+    }
+    
+    historyQuery.nextSlot = slot;
+    historyQuery.part++;
+    if (done) {
+        historyQuery.active = false;
+        Serial.printf("[HISTORY] ✓ Query '%s' sent in %u parts\n", historyQuery.id, historyQuery.part);
+    }
+}
+
+void publishHistoryError(const char* id, const char* error) {
+    Serial.printf("[HISTORY] ✗ Query rejected: %s\n", error);
+    
+    StaticJsonDocument<128> doc;
+    doc["id"] = id;
+    doc["error"] = error;
+    
+    char buffer[128];
+    serializeJson(doc, buffer, sizeof(buffer));
+    outbound.enqueue(OUTBOUND_BULK, MQTT_TOPIC_HISTORY, buffer);
+}
+
+// ==================== Alarm Functions ====================
+void initializeAlarms() {
+    alarmMonitor.begin(alarmRules, sizeof(alarmRules) / sizeof(alarmRules[0]));
+    
+    size_t bound = 0;
+    for (size_t r = 0; r < alarmMonitor.getRuleCount(); r++) {
+        const AlarmRule& rule = alarmMonitor.getRule(r);
+        SensorChannel* channel = findSensorChannel(rule.channel);
+        if (channel == nullptr || channel->acceptedSamples == nullptr) {
+            Serial.printf("[ALARM] ⊘ Rule for '%s' ignored (channel not enabled)\n", rule.channel);
+            continue;
+        }
+        if (rule.ratePerMin > 0 && (size_t)rule.rateWindowS * 1000 / runtimeSettings.sensorReadInterval > RAW_SAMPLE_RING_SIZE) {
+            Serial.printf("[ALARM] ⚠ %s rate window %us exceeds the accepted sample ring\n",
+                          rule.channel, (unsigned)rule.rateWindowS);
+        }
+        alarmMonitor.bind(r, channel->acceptedSamples);
+        bound++;
+    }
+    Serial.printf("[ALARM] ✓ %u rules active\n", (unsigned)bound);
+}
+
+/**
+ * Hand queued alarm changes to the outbound queue's urgent class (oldest
+ * first) and send them straight away if connected.
+ */
+void publishAlarms() {
+    const AlarmEvent* event;
+    bool queued = false;
+    while ((event = alarmMonitor.peek()) != nullptr) {
+        const AlarmRule& rule = alarmMonitor.getRule(event->rule);
+        StaticJsonDocument<256> doc;
+        doc["channel"] = rule.channel;
+        doc["alarm"] = AlarmMonitor::kindName(event->kind);
+        doc["state"] = event->raised ? "raised" : "cleared";
+        doc["value"] = event->value;
+        switch (event->kind) {
+            case ALARM_LOW:  doc["limit"] = rule.low; break;
+            case ALARM_HIGH: doc["limit"] = rule.high; break;
+            default:         doc["limit"] = rule.ratePerMin; break;
+        }
+        doc["rate"] = event->rate;
+        doc["t"] = event->timestampUs;
+        doc["uptime"] = millis() / 1000;
+        if (alarmMonitor.getDroppedEvents() > 0) {
+            doc["dropped"] = alarmMonitor.getDroppedEvents();
+        }
+        
+        char buffer[256];
+        serializeJson(doc, buffer);
+        if (!outbound.enqueue(OUTBOUND_URGENT, MQTT_TOPIC_ALARM, buffer)) {
+            Serial.println("[MQTT] ✗ Failed to queue alarm");
+        }
+        alarmMonitor.pop();
+        queued = true;
+    }
+    if (queued) {
+        outbound.service();
+    }
+}
+
+// ==================== Warm Start Functions ====================
+/**
+ * Refill the averaging windows from the snapshot left in RTC memory by the
+ * previous run (software, panic or watchdog reset only). Call after
+ * applyRuntimeSettings() so restored readings land in the configured windows.
+ * When anything was restored, the first publish is brought forward to
+ * WARM_START_FIRST_PUBLISH_MS after boot.
+ */
+void restoreWarmStart() {
+    #ifdef ENABLE_WARM_START
+    if (!warmStart.begin()) {
+        return;
+    }
+    if (halRecorder.isActive() && halRecorder.isFromBoot()) {
+        Serial.println("[WARMSTART] ⊘ Hardware capture from boot, starting with empty windows");
+        return;
+    }
+    
+    size_t restoredChannels = 0;
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        SensorChannel& channel = sensorChannels[c];
+        if (channel.average == nullptr) {
+            continue;
+        }
+        size_t n = warmStart.restore(WarmStart::tagFor(channel.deviceType), *channel.average);
+        if (n > 0) {
+            channel.sensor->refreshFromAverage();
+            restoredChannels++;
+        }
+        Serial.printf("[WARMSTART] %s: %u readings restored (%u valid)\n", channel.deviceType,
+                      (unsigned)n, (unsigned)channel.average->getValidCount());
+    }
+    
+    if (restoredChannels > 0) {
+        unsigned long now = millis();
+        unsigned long firstPublish = WARM_START_FIRST_PUBLISH_MS > now ? WARM_START_FIRST_PUBLISH_MS - now : 0;
+        if (firstPublish < runtimeSettings.sensorPublishInterval) {
+            lastSensorPublish = now + firstPublish - runtimeSettings.sensorPublishInterval;
         }
+        Serial.printf("[WARMSTART] ✓ %u channels restored, first publish in %lu ms\n",
+                      (unsigned)restoredChannels, firstPublish);
     }
+    #endif
+}
+
+/**
+ * Copy every averaging window into the RTC snapshot.
+ */
+void saveWarmStart() {
+    #ifdef ENABLE_WARM_START
+    size_t saved = 0;
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT && saved < WarmStartSnapshot::MAX_WINDOWS; c++) {
+        const SensorChannel& channel = sensorChannels[c];
+        if (channel.average != nullptr) {
+            warmStart.capture(saved++, WarmStart::tagFor(channel.deviceType), *channel.average);
+        }
+    }
+    warmStart.commit(saved);
+    #endif
 }
 
 // ==================== OTA Functions ====================
@@ -310,6 +1201,7 @@ void setupOTA() {
     ArduinoOTA.setPassword(OTA_PASSWORD);
     ArduinoOTA.setPort(OTA_PORT);
     
+    // Callbacks run in the OTA task; loop() restarts once the result is reported
     ArduinoOTA.onStart([]() {
         String type;
         if (ArduinoOTA.getCommand() == U_FLASH) {
@@ -318,56 +1210,473 @@ void setupOTA() {
             type = "filesystem";
         }
         Serial.println("[OTA] Start updating " + type);
+        otaMaxReadGapMs = 0;
+        otaUpdater.pushStarted();
     });
     
     ArduinoOTA.onEnd([]() {
         Serial.println("\n[OTA] Update complete!");
+        otaUpdater.pushFinished(true, nullptr);
     });
     
     ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
         Serial.printf("[OTA] Progress: %u%%\r", (progress / (total / 100)));
+        otaUpdater.pushProgress(progress);
     });
     
     ArduinoOTA.onError([](ota_error_t error) {
-        Serial.printf("[OTA] Error[%u]: ", error);
-        if (error == OTA_AUTH_ERROR) Serial.println("Auth Failed");
-        else if (error == OTA_BEGIN_ERROR) Serial.println("Begin Failed");
-        else if (error == OTA_CONNECT_ERROR) Serial.println("Connect Failed");
-        else if (error == OTA_RECEIVE_ERROR) Serial.println("Receive Failed");
-        else if (error == OTA_END_ERROR) Serial.println("End Failed");
+        const char* reason = "Unknown Error";
+        if (error == OTA_AUTH_ERROR) reason = "Auth Failed";
+        else if (error == OTA_BEGIN_ERROR) reason = "Begin Failed";
+        else if (error == OTA_CONNECT_ERROR) reason = "Connect Failed";
+        else if (error == OTA_RECEIVE_ERROR) reason = "Receive Failed";
+        else if (error == OTA_END_ERROR) reason = "End Failed";
+        Serial.printf("[OTA] Error[%u]: %s\n", error, reason);
+        otaUpdater.pushFinished(false, reason);
     });
     
     ArduinoOTA.begin();
+    otaUpdater.enablePush();
     Serial.println("[OTA] OTA ready");
     Serial.printf("[OTA] Hostname: %s.local\n", OTA_HOSTNAME);
 }
 
+/**
+ * Publish finished updates and restart into the new image once the event
+ * had OTA_RESTART_DELAY_MS to go out. The RTC snapshot is refreshed right
+ * before the restart so the new firmware warm-starts.
+ */
+void serviceOTA() {
+    TraceScope trace(TRACE_OTA);
+    
+    OtaReport report;
+    while (otaUpdater.pollReport(report)) {
+        Serial.printf("[OTA] %s %s: %lu bytes in %lu ms, longest sensor read gap %lu ms\n",
+                      OtaUpdater::sourceName(report.source), report.ok ? "✓ succeeded" : "✗ failed",
+                      (unsigned long)report.transferBytes, (unsigned long)report.transferMs, otaMaxReadGapMs);
+        publishOtaEvent(report.ok ? "ok" : "failed", &report, report.ok ? nullptr : report.error);
+        if (report.ok) {
+            otaRestartAt = millis() + OTA_RESTART_DELAY_MS;
+            if (otaRestartAt == 0) {
+                otaRestartAt = 1;
+            }
+        }
+    }
+    
+    if (otaRestartAt != 0 && (long)(millis() - otaRestartAt) >= 0) {
+        Serial.println("[OTA] Restarting into new firmware...");
+        saveWarmStart();
+        mqttTransport.flush();
+        delay(100);
+        ESP.restart();
+    }
+}
+
+/**
+ * Report an update on MQTT_TOPIC_EVENTS: requested, rejected, or finished
+ * with transfer size/time and the longest gap between sensor reads while
+ * it ran (compare with the read interval).
+ */
+void publishOtaEvent(const char* result, const OtaReport* report, const char* detail) {
+    StaticJsonDocument<384> doc;
+    doc["event"] = "ota";
+    doc["result"] = result;
+    if (report != nullptr) {
+        doc["source"] = OtaUpdater::sourceName(report->source);
+        doc["compressed"] = report->compressed;
+        doc["bytes"] = report->transferBytes;
+        doc["imageBytes"] = report->imageBytes;
+        doc["transferMs"] = report->transferMs;
+        doc["maxReadGapMs"] = otaMaxReadGapMs;
+        doc["readIntervalMs"] = runtimeSettings.sensorReadInterval;
+    }
+    if (detail != nullptr) {
+        doc["detail"] = detail;
+    }
+    doc["uptime"] = millis() / 1000;
+    
+    char buffer[384];
+    serializeJson(doc, buffer);
+    if (!outbound.enqueue(OUTBOUND_STATE, MQTT_TOPIC_EVENTS, buffer)) {
+        Serial.println("[MQTT] ✗ Failed to queue OTA event");
+    }
+}
+
+// ==================== Trace Functions ====================
+void serviceTrace() {
+    traceRecorder.service();
+    if (!traceRecorder.isDumping() || !mqttClient.connected() || outbound.available(OUTBOUND_BULK) == 0) {
+        return;
+    }
+    
+    uint8_t batch[TRACE_HEADER_BYTES + TRACE_BATCH_EVENTS * TRACE_EVENT_BYTES];
+    size_t length = traceRecorder.nextBatch(batch);
+    if (length > 0 && !outbound.enqueue(OUTBOUND_BULK, MQTT_TOPIC_TRACE, batch, length)) {
+        Serial.println("[TRACE] ✗ Failed to queue trace batch");
+    }
+    if (!traceRecorder.isDumping()) {
+        Serial.printf("[TRACE] ✓ Capture %08lx queued\n", (unsigned long)traceRecorder.getCaptureId());
+        publishTraceEvent("sent", nullptr);
+    }
+}
+
+void publishTraceEvent(const char* result, const char* detail) {
+    StaticJsonDocument<256> doc;
+    char id[9];
+    snprintf(id, sizeof(id), "%08lx", (unsigned long)traceRecorder.getCaptureId());
+    doc["event"] = "trace";
+    doc["result"] = result;
+    doc["id"] = (const char*)id;
+    if (strcmp(result, "sent") == 0) {
+        doc["events"] = traceRecorder.getEventCount();
+        doc["overwritten"] = traceRecorder.getOverwritten();
+    }
+    if (detail != nullptr) {
+        doc["detail"] = detail;
+    }
+    doc["uptime"] = millis() / 1000;
+    
+    char buffer[256];
+    serializeJson(doc, buffer);
+    if (!outbound.enqueue(OUTBOUND_STATE, MQTT_TOPIC_EVENTS, buffer)) {
+        Serial.println("[MQTT] ✗ Failed to queue trace event");
+    }
+}
+
+// ==================== Hardware Capture Functions ====================
+/**
+ * Start a halRecord capture. The header names the drivers and carries every
+ * channel's averaging window and the runtime settings, so a replay starts
+ * from the state the drivers were in; the pH table in use follows as the
+ * first record.
+ */
+bool startHalCapture(uint32_t durationMs, bool fromBoot) {
+    HalTraceWriter* header = halRecorder.prepare(fromBoot);
+    if (header == nullptr) {
+        return false;
+    }
+    
+    header->putByte((uint8_t)HAL_SENSOR_COUNT);
+    for (size_t i = 0; i < HAL_SENSOR_COUNT; i++) {
+        header->putString(halSensors[i]->getName());
+        header->putByte(halSensors[i]->isInitialized() ? 1 : 0);
+    }
+    
+    header->putByte((uint8_t)SENSOR_CHANNEL_COUNT);
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        const SensorChannel& channel = sensorChannels[c];
+        uint8_t sensorIndex = 0xFF;
+        for (size_t i = 0; i < HAL_SENSOR_COUNT; i++) {
+            if (halSensors[i] == channel.sensor) {
+                sensorIndex = (uint8_t)i;
+            }
+        }
+        float values[MAX_AVERAGE_WINDOW];
+        bool valid[MAX_AVERAGE_WINDOW];
+        size_t count = channel.average != nullptr ? channel.average->copyChronological(values, valid) : 0;
+        uint64_t validMask = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (valid[i]) {
+                validMask |= 1ULL << i;
+            }
+        }
+        header->putString(channel.deviceType);
+        header->putByte(sensorIndex);
+        header->putByte((uint8_t)count);
+        header->putVarint(validMask);
+        for (size_t i = 0; i < count; i++) {
+            header->putFloat(values[i]);
+        }
+        header->putFloat(channel.average != nullptr ? channel.average->getSum() : 0.0f);
+    }
+    
+    header->putVarint(sizeof(runtimeSettings));
+    header->putBytes(&runtimeSettings, sizeof(runtimeSettings));
+    
+    if (!halRecorder.start(durationMs)) {
+        return false;
+    }
+    recordPHTable();
+    Serial.printf("[HAL] Capture %08lx started for %lu ms%s\n", (unsigned long)halRecorder.getCaptureId(),
+                  (unsigned long)durationMs, fromBoot ? " (from boot)" : "");
+    return true;
+}
+
+/**
+ * Put the pH conversion table in the capture (at start and after every rebuild).
+ */
+void recordPHTable() {
+    #ifdef ENABLE_PH_SENSOR
+    PHLookupTable& lut = phSensor.getLookupTable();
+    if (halRecorder.isActive() && lut.isBuilt()) {
+        float mid, low, high;
+        phSensor.getCalibration(mid, low, high);
+        halRecorder.recordPHTable(mid, low, high, lut.getTable(), PHLookupTable::ADC_CODES);
+    }
+    #endif
+}
+
+/**
+ * End a capture whose time is up, send a finished one a chunk per pass, and
+ * restart into a requested boot capture once its event had time to go out.
+ */
+void serviceHalTrace() {
+    halRecorder.service();
+    
+    if (halRestartAt != 0 && (long)(millis() - halRestartAt) >= 0) {
+        Serial.println("[HAL] Restarting for a capture from boot...");
+        mqttTransport.flush();
+        delay(100);
+        ESP.restart();
+    }
+    
+    if (!halRecorder.isDumping() || !mqttClient.connected() || outbound.available(OUTBOUND_BULK) == 0) {
+        return;
+    }
+    uint8_t chunk[HAL_CHUNK_HEADER_BYTES + HAL_TRACE_CHUNK_BYTES];
+    size_t length = halRecorder.nextChunk(chunk);
+    if (length > 0 && !outbound.enqueue(OUTBOUND_BULK, MQTT_TOPIC_HALTRACE, chunk, length)) {
+        Serial.println("[HAL] ✗ Failed to queue capture chunk");
+    }
+    if (!halRecorder.isDumping()) {
+        Serial.printf("[HAL] ✓ Capture %08lx queued\n", (unsigned long)halRecorder.getCaptureId());
+        publishHalTraceEvent("sent", nullptr);
+    }
+}
+
+void publishHalTraceEvent(const char* result, const char* detail) {
+    StaticJsonDocument<256> doc;
+    char id[9];
+    snprintf(id, sizeof(id), "%08lx", (unsigned long)halRecorder.getCaptureId());
+    doc["event"] = "halTrace";
+    doc["result"] = result;
+    if (strcmp(result, "started") == 0 || strcmp(result, "sent") == 0) {
+        doc["id"] = (const char*)id;
+    }
+    if (strcmp(result, "sent") == 0) {
+        doc["bytes"] = (uint32_t)halRecorder.getLength();
+        doc["end"] = halEndReasonName(halRecorder.getEndReason());
+    }
+    if (detail != nullptr) {
+        doc["detail"] = detail;
+    }
+    doc["uptime"] = millis() / 1000;
+    
+    char buffer[256];
+    serializeJson(doc, buffer);
+    if (!outbound.enqueue(OUTBOUND_STATE, MQTT_TOPIC_EVENTS, buffer)) {
+        Serial.println("[MQTT] ✗ Failed to queue capture event");
+    }
+}
+
+// ==================== Metrics Functions ====================
+#ifdef ENABLE_METRICS_HTTP
+/**
+ * Render a fresh page into the server's back buffer when one is due. Scrapes
+ * are answered from the last published page and never wait for this.
+ */
+void serviceMetrics() {
+    static uint32_t renderUs = 0;
+    uint32_t now = millis();
+    if (!metricsServer.isRenderDue(now)) {
+        return;
+    }
+    size_t capacity;
+    char* buffer = metricsServer.acquireBackPage(capacity);
+    if (buffer == nullptr) {
+        return;  // A slow scrape still reads it; try again next pass
+    }
+    
+    int64_t start = esp_timer_get_time();
+    MetricsPage page(buffer, capacity);
+    page.family("grow_metrics_render_seconds", "gauge", "Time taken to render the previous page");
+    page.sample("grow_metrics_render_seconds", renderUs / 1e6);
+    renderMetrics(page);
+    if (page.isOverflowed()) {
+        Serial.printf("[METRICS] ⚠ Page truncated at %u bytes (METRICS_PAGE_BYTES is %d)\n",
+                      (unsigned)page.getLength(), METRICS_PAGE_BYTES);
+    }
+    metricsServer.publish(page.getLength(), now);
+    renderUs = (uint32_t)(esp_timer_get_time() - start);
+    loopTiming.maxUs = 0;
+}
+
+void renderMetrics(MetricsPage& page) {
+    page.family("grow_uptime_seconds", "gauge", "Time since boot");
+    page.sample("grow_uptime_seconds", millis() / 1000);
+    page.family("grow_wifi_rssi_dbm", "gauge", "WiFi signal strength");
+    page.sample("grow_wifi_rssi_dbm", WiFi.RSSI());
+    page.family("grow_mqtt_connected", "gauge", "1 while connected to the broker");
+    page.sample("grow_mqtt_connected", mqttClient.connected() ? 1 : 0);
+    page.family("grow_heap_free_bytes", "gauge", "Free internal heap");
+    page.sample("grow_heap_free_bytes", ESP.getFreeHeap());
+    page.family("grow_heap_min_free_bytes", "gauge", "Lowest free internal heap since boot");
+    page.sample("grow_heap_min_free_bytes", ESP.getMinFreeHeap());
+    page.family("grow_heap_largest_block_bytes", "gauge", "Largest allocatable heap block");
+    page.sample("grow_heap_largest_block_bytes", ESP.getMaxAllocHeap());
+    
+    // Averaged channel values and their windows
+    page.family("grow_channel_value", "gauge", "Moving average of valid samples (NaN while none)");
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        const MovingAverage<float, MAX_AVERAGE_WINDOW>& average = *sensorChannels[c].average;
+        page.sample("grow_channel_value", "channel", sensorChannels[c].deviceType,
+                    average.getValidCount() > 0 ? average.getAverage() : NAN);
+    }
+    page.family("grow_channel_window_valid", "gauge", "Valid samples in the averaging window");
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        page.sample("grow_channel_window_valid", "channel", sensorChannels[c].deviceType,
+                    sensorChannels[c].average->getValidCount());
+    }
+    page.family("grow_channel_window_size", "gauge", "Configured averaging window");
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        page.sample("grow_channel_window_size", "channel", sensorChannels[c].deviceType,
+                    sensorChannels[c].average->getWindowSize());
+    }
+    page.family("grow_channel_success_ratio", "gauge", "Share of reads in the window that succeeded");
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        page.sample("grow_channel_success_ratio", "channel", sensorChannels[c].deviceType,
+                    sensorChannels[c].average->getSuccessRate() / 100.0f);
+    }
+    page.family("grow_channel_quality", "gauge", "Fault detector score 0-100 (as in the health message)");
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        const SensorChannel& channel = sensorChannels[c];
+        float quality = 0;
+        if (sensorSupervisor.getState(channel.sensor) != SENSOR_STATE_FAILED) {
+            quality = channel.quality.getScore() * channel.average->getSuccessRate() / 100.0f;
+        }
+        page.sample("grow_channel_quality", "channel", channel.deviceType, quality);
+    }
+    
+    // Per sensor: supervision state and outlier filter
+    page.family("grow_sensor_up", "gauge", "0 while the supervisor has the sensor marked failed");
+    for (size_t i = 0; i < sensorSupervisor.getCount(); i++) {
+        const SupervisedSensor& entry = sensorSupervisor.get(i);
+        page.sample("grow_sensor_up", "sensor", entry.sensor->getName(),
+                    sensorSupervisor.getState(entry.sensor) != SENSOR_STATE_FAILED ? 1 : 0);
+    }
+    page.family("grow_sensor_outliers_rejected_total", "counter", "Samples replaced by the outlier filter");
+    for (size_t i = 0; i < sensorSupervisor.getCount(); i++) {
+        const SensorBase* sensor = sensorSupervisor.get(i).sensor;
+        if (sensor->isOutlierFilterEnabled()) {
+            page.sample("grow_sensor_outliers_rejected_total", "sensor", sensor->getName(),
+                        sensor->getRejectedCount());
+        }
+    }
+    
+    // Timings
+    page.family("grow_acquisition_seconds", "gauge", "Phases of the last sensor read cycle");
+    page.sample("grow_acquisition_seconds", "phase", "trigger", acquisitionTiming.triggerUs / 1e6);
+    page.sample("grow_acquisition_seconds", "phase", "wait", acquisitionTiming.waitUs / 1e6);
+    page.sample("grow_acquisition_seconds", "phase", "collect", acquisitionTiming.collectUs / 1e6);
+    page.sample("grow_acquisition_seconds", "phase", "total", acquisitionTiming.totalUs / 1e6);
+    page.family("grow_loop_pass_seconds", "gauge", "Last loop() pass");
+    page.sample("grow_loop_pass_seconds", loopTiming.lastUs / 1e6);
+    page.family("grow_loop_pass_max_seconds", "gauge", "Longest loop() pass since the previous render");
+    page.sample("grow_loop_pass_max_seconds", loopTiming.maxUs / 1e6);
+    page.family("grow_loop_stalls_total", "counter", "loop() stalls over STALL_THRESHOLD_MS since boot");
+    page.sample("grow_loop_stalls_total", stallMonitor.getTotalStalls());
+    
+    // Outbound queue
+    page.family("grow_outbound_depth", "gauge", "Messages queued per class");
+    for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+        page.sample("grow_outbound_depth", "class", OutboundQueue::className((OutboundClass)c),
+                    outbound.getStats((OutboundClass)c).depth);
+    }
+    page.family("grow_outbound_dropped_total", "counter", "Messages dropped per class");
+    for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+        page.sample("grow_outbound_dropped_total", "class", OutboundQueue::className((OutboundClass)c),
+                    outbound.getStats((OutboundClass)c).dropped);
+    }
+    page.family("grow_metrics_requests_total", "counter", "HTTP requests answered");
+    page.sample("grow_metrics_requests_total", metricsServer.getRequestCount());
+    page.family("grow_metrics_rejected_total", "counter", "Connections refused with all slots busy");
+    page.sample("grow_metrics_rejected_total", metricsServer.getRejectedCount());
+}
+#endif
+
 // ==================== Sensor Functions ====================
 void initializeSensors() {
     Serial.println("\n[SENSORS] Initializing sensors...");
     
     #ifdef ENABLE_SHT30
-    if (!sht30Sensor.begin()) {
+    if (!beginSensor(sht30Sensor)) {
         Serial.println("[SENSORS] WARNING: SHT30 initialization failed");
     }
     #endif
     
     #ifdef ENABLE_HC_SR04
-    if (!waterLevelSensor.begin()) {
+    if (!beginSensor(waterLevelSensor)) {
         Serial.println("[SENSORS] WARNING: HC-SR04 initialization failed");
     }
     #endif
     
     #ifdef ENABLE_PH_SENSOR
-    if (!phSensor.begin()) {
+    float phCal[PH_CAL_POINT_COUNT];
+    const char* phCalError = nullptr;
+    if (PHCalibrationStore::load(phCal, &phCalError)) {
+        Serial.println("[SENSORS] Using pH calibration from NVS");
+        phSensor.setCalibration(phCal[PH_CAL_POINT_MID], phCal[PH_CAL_POINT_LOW], phCal[PH_CAL_POINT_HIGH]);
+    } else if (phCalError != nullptr) {
+        Serial.printf("[SENSORS] ⚠ Stored pH calibration ignored (%s), using config.h points - recalibrate\n",
+                      phCalError);
+    }
+    if (!beginSensor(phSensor)) {
         Serial.println("[SENSORS] WARNING: pH sensor initialization failed");
     }
+    recordPHTable();
+    #endif
+    
+    // Sensors that failed begin() start out failed and are retried with backoff
+    #ifdef ENABLE_SHT30
+    sensorSupervisor.add(&sht30Sensor);
+    #endif
+    #ifdef ENABLE_HC_SR04
+    sensorSupervisor.add(&waterLevelSensor);
+    #endif
+    #ifdef ENABLE_PH_SENSOR
+    sensorSupervisor.add(&phSensor);
     #endif
+    sensorSupervisor.setTransitionCallback(publishSensorTransition);
+    
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        sensorChannels[c].quality.begin(1.0f / sensorChannels[c].scale);
+    }
     
     Serial.println("[SENSORS] Sensor initialization complete\n");
 }
 
+bool beginSensor(SensorBase& sensor) {
+    HalCall call(HAL_CALL_BEGIN, &sensor);
+    return sensor.begin();
+}
+
+/**
+ * Report a sensor state change on MQTT_TOPIC_EVENTS. Transitions while the
+ * broker is unreachable are only logged; the health message carries the
+ * current state.
+ */
+void publishSensorTransition(const SupervisedSensor& entry, SensorState from) {
+    StaticJsonDocument<256> doc;
+    doc["event"] = "sensorState";
+    doc["sensor"] = entry.sensor->getName();
+    doc["from"] = SensorSupervisor::stateName(from);
+    doc["to"] = SensorSupervisor::stateName(entry.state);
+    doc["failures"] = entry.consecutiveFailures;
+    if (entry.state == SENSOR_STATE_OK && entry.recoveries > 0) {
+        doc["recoveryMs"] = entry.lastRecoveryMs;
+    }
+    doc["uptime"] = millis() / 1000;
+    
+    char buffer[256];
+    serializeJson(doc, buffer);
+    if (!outbound.enqueue(OUTBOUND_URGENT, MQTT_TOPIC_EVENTS, buffer)) {
+        Serial.println("[MQTT] ✗ Failed to queue sensor event");
+    }
+}
+
 void readSensors() {
+    TraceScope trace(TRACE_READ_SENSORS);
+    
     #ifdef DEBUG_VERBOSE
     Serial.printf("\n[SENSORS] Reading sensors for moving average (uptime: %lu s)\n", millis() / 1000);
     #endif
@@ -375,9 +1684,135 @@ void readSensors() {
     int successCount = 0;
     int failCount = 0;
     
+    // Sensors taking part in this cycle
+    SensorBase* cycle[3];
+    size_t cycleCount = 0;
+    
+    #ifdef ENABLE_SHT30
+    if (sht30Sensor.isInitialized()) {
+        cycle[cycleCount++] = &sht30Sensor;
+    } else {
+        failCount += 2;
+    }
+    #endif
+    
+    #ifdef ENABLE_HC_SR04
+    if (waterLevelSensor.isInitialized()) {
+        cycle[cycleCount++] = &waterLevelSensor;
+    } else {
+        failCount++;
+    }
+    #endif
+    
+    #ifdef ENABLE_PH_SENSOR
+    bool readPH = false;
+    if (phCalibration.isActive()) {
+        // Probe is sitting in a buffer solution - keep it out of the average
+        #ifdef DEBUG_VERBOSE
+        Serial.println("[pH] ⊘ Calibration in progress, skipping read");
+        #endif
+    } else if (phSensor.isInitialized()) {
+        cycle[cycleCount++] = &phSensor;
+        readPH = true;
+    } else {
+        failCount++;
+    }
+    #endif
+    
+    // Phase 1: start every conversion
+    int64_t startedAt[3];
+    int64_t readyAt[3];
+    const int64_t cycleStart = esp_timer_get_time();
+    for (size_t i = 0; i < cycleCount; i++) {
+        startedAt[i] = esp_timer_get_time();
+        stallMonitor.push(STAGE_TRIGGER, cycle[i]->getName());
+        {
+            HalCall call(HAL_CALL_TRIGGER, cycle[i]);
+            readyAt[i] = cycle[i]->trigger() ? 0 : startedAt[i];
+        }
+        stallMonitor.pop();
+    }
+    const int64_t triggered = esp_timer_get_time();
+    
+    // Phase 2: wait for the slowest conversion, polling sensors and sending queued messages in
+    // the gap. Inbound MQTT (mqttClient.loop()) waits for the next loop() pass: commands such as
+    // phCalStart, halRecord or a config update must not land between trigger() and collect().
+    const int64_t deadline = triggered + (int64_t)ACQUISITION_TIMEOUT_MS * 1000;
+    stallMonitor.push(STAGE_WAIT);
+    traceRecorder.begin(TRACE_SENSOR_WAIT);
+    bool waiting = true;
+    while (waiting && esp_timer_get_time() < deadline) {
+        waiting = false;
+        for (size_t i = 0; i < cycleCount; i++) {
+            if (readyAt[i] != 0) {
+                continue;
+            }
+            {
+                HalCall call(HAL_CALL_POLL, cycle[i]);
+                cycle[i]->poll();
+            }
+            if (cycle[i]->isReady()) {
+                readyAt[i] = esp_timer_get_time();
+            } else {
+                waiting = true;
+            }
+        }
+        if (waiting && mqttClient.connected()) {
+            outbound.service();
+            mqttTransport.tick();
+        }
+    }
+    traceRecorder.end(TRACE_SENSOR_WAIT);
+    stallMonitor.pop();
+    const int64_t waited = esp_timer_get_time();
+    
+    // Phase 3: read back and filter every result
+    uint32_t serialUs = 0;
+    for (size_t i = 0; i < cycleCount; i++) {
+        int64_t collectStart = esp_timer_get_time();
+        stallMonitor.push(STAGE_COLLECT, cycle[i]->getName());
+        bool ok;
+        {
+            HalCall call(HAL_CALL_COLLECT, cycle[i]);
+            ok = cycle[i]->collect();
+        }
+        stallMonitor.pop();
+        if (halRecorder.isActive()) {
+            // What the filters made of it, for the replay to compare against
+            halRecorder.recordResult(cycle[i], ok);
+            for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+                if (sensorChannels[c].sensor == cycle[i] && sensorChannels[c].average != nullptr) {
+                    halRecorder.recordOutput((uint8_t)c, sensorChannels[c].average->getAverage());
+                }
+            }
+        }
+        int64_t collected = esp_timer_get_time();
+        sensorSupervisor.reportRead(cycle[i], ok);
+        int64_t ready = readyAt[i] != 0 ? readyAt[i] : waited;
+        serialUs += (uint32_t)((ready - startedAt[i]) + (collected - collectStart));
+    }
+    const int64_t cycleEnd = esp_timer_get_time();
+    
+    // Check the new samples against the alarm rules and send any change right away
+    alarmMonitor.evaluate();
+    publishAlarms();
+    
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        sensorChannels[c].quality.feed(*sensorChannels[c].rawSamples);
+    }
+    
+    // Keep the RTC copy of the windows at most one cycle old
+    saveWarmStart();
+    
+    acquisitionTiming.triggerUs = (uint32_t)(triggered - cycleStart);
+    acquisitionTiming.waitUs = (uint32_t)(waited - triggered);
+    acquisitionTiming.collectUs = (uint32_t)(cycleEnd - waited);
+    acquisitionTiming.totalUs = (uint32_t)(cycleEnd - cycleStart);
+    acquisitionTiming.serialUs = serialUs;
+    
     #ifdef ENABLE_SHT30
     if (sht30Sensor.isInitialized()) {
-        if (sht30Sensor.read()) {
+        if (sht30Sensor.isLastReadSuccess()) {
             #ifdef DEBUG_VERBOSE
             Serial.printf("[SHT30] ✓ T:%.1f°C H:%.1f%%\n", 
                          sht30Sensor.getTemperature(), sht30Sensor.getHumidity());
@@ -387,14 +1822,12 @@ void readSensors() {
             Serial.println("[SHT30] ✗ Read failed");
             failCount += 2;
         }
-    } else {
-        failCount += 2;
     }
     #endif
     
     #ifdef ENABLE_HC_SR04
     if (waterLevelSensor.isInitialized()) {
-        if (waterLevelSensor.read()) {
+        if (waterLevelSensor.isLastReadSuccess()) {
             #ifdef DEBUG_VERBOSE
             Serial.printf("[HC-SR04] ✓ %.1fcm\n", waterLevelSensor.getWaterLevel());
             #endif
@@ -403,14 +1836,12 @@ void readSensors() {
             Serial.println("[HC-SR04] ✗ Read failed");
             failCount++;
         }
-    } else {
-        failCount++;
     }
     #endif
     
     #ifdef ENABLE_PH_SENSOR
-    if (phSensor.isInitialized()) {
-        if (phSensor.read()) {
+    if (readPH) {
+        if (phSensor.isLastReadSuccess()) {
             #ifdef DEBUG_VERBOSE
             Serial.printf("[pH] ✓ %.2f\n", phSensor.getPH());
             #endif
@@ -419,12 +1850,14 @@ void readSensors() {
             Serial.println("[pH] ✗ Read failed");
             failCount++;
         }
-    } else {
-        failCount++;
     }
     #endif
     
     #ifdef DEBUG_VERBOSE
+    Serial.printf("[SENSORS] Cycle %lu us (trigger %lu, wait %lu, collect %lu) vs %lu us back to back\n",
+                  (unsigned long)acquisitionTiming.totalUs, (unsigned long)acquisitionTiming.triggerUs,
+                  (unsigned long)acquisitionTiming.waitUs, (unsigned long)acquisitionTiming.collectUs,
+                  (unsigned long)acquisitionTiming.serialUs);
     if (failCount > 0) {
         Serial.printf("[SENSORS] Summary: %d ok, %d failed\n", successCount, failCount);
     }
@@ -432,6 +1865,8 @@ void readSensors() {
 }
 
 void publishSensorData() {
+    TraceScope trace(TRACE_PUBLISH);
+    
     if (!mqttClient.connected()) {
         Serial.println("\n[MQTT] ✗ Not connected, skipping sensor publish");
         return;
@@ -450,26 +1885,22 @@ void publishSensorData() {
     if (sht30Sensor.isInitialized()) {
         // Publish temperature if majority of readings are valid
         if (sht30Sensor.hasValidTemperatureMajority()) {
-            StaticJsonDocument<300> doc;
-            doc["deviceType"] = "temperature";
-            doc["deviceID"] = "1";
-            doc["location"] = DEVICE_LOCATION;
-            doc["value"] = String(sht30Sensor.getTemperature(), 2);
-            doc["description"] = String(DEVICE_DESCRIPTION_PREFIX) + " - temperature";
-            
-            char buffer[300];
-            serializeJson(doc, buffer);
+            char buffer[SENSOR_PAYLOAD_BYTES];
+            size_t length = formatSensorPayload(buffer, sizeof(buffer), "temperature", sht30Sensor.getTemperature(), 2, "temperature");
             
             #ifdef DEBUG_VERBOSE
             Serial.printf("[MQTT] Temperature payload: %s\n", buffer);
             #endif
             
-            if (mqttClient.publish(MQTT_TOPIC_SENSOR, buffer, false)) {
-                Serial.printf("[MQTT] ✓ Temperature published: %.2f°C (%.1f%% success rate)\n", 
+            if (length == 0) {
+                Serial.println("[MQTT] ✗ Temperature payload exceeds SENSOR_PAYLOAD_BYTES");
+                failCount++;
+            } else if (outbound.enqueue(OUTBOUND_ROUTINE, MQTT_TOPIC_SENSOR, buffer)) {
+                Serial.printf("[MQTT] ✓ Temperature queued: %.2f°C (%.1f%% success rate)\n", 
                              sht30Sensor.getTemperature(), sht30Sensor.getTemperatureSuccessRate());
                 publishCount++;
             } else {
-                Serial.println("[MQTT] ✗ Failed to publish temperature");
+                Serial.println("[MQTT] ✗ Failed to queue temperature");
                 failCount++;
             }
         } else {
@@ -479,26 +1910,22 @@ void publishSensorData() {
         
         // Publish humidity if majority of readings are valid
         if (sht30Sensor.hasValidHumidityMajority()) {
-            StaticJsonDocument<300> doc;
-            doc["deviceType"] = "humidity";
-            doc["deviceID"] = "1";
-            doc["location"] = DEVICE_LOCATION;
-            doc["value"] = String(sht30Sensor.getHumidity(), 2);
-            doc["description"] = String(DEVICE_DESCRIPTION_PREFIX) + " - humidity";
-            
-            char buffer[300];
-            serializeJson(doc, buffer);
+            char buffer[SENSOR_PAYLOAD_BYTES];
+            size_t length = formatSensorPayload(buffer, sizeof(buffer), "humidity", sht30Sensor.getHumidity(), 2, "humidity");
             
             #ifdef DEBUG_VERBOSE
             Serial.printf("[MQTT] Humidity payload: %s\n", buffer);
             #endif
             
-            if (mqttClient.publish(MQTT_TOPIC_SENSOR, buffer, false)) {
-                Serial.printf("[MQTT] ✓ Humidity published: %.2f%% (%.1f%% success rate)\n", 
+            if (length == 0) {
+                Serial.println("[MQTT] ✗ Humidity payload exceeds SENSOR_PAYLOAD_BYTES");
+                failCount++;
+            } else if (outbound.enqueue(OUTBOUND_ROUTINE, MQTT_TOPIC_SENSOR, buffer)) {
+                Serial.printf("[MQTT] ✓ Humidity queued: %.2f%% (%.1f%% success rate)\n", 
                              sht30Sensor.getHumidity(), sht30Sensor.getHumiditySuccessRate());
                 publishCount++;
             } else {
-                Serial.println("[MQTT] ✗ Failed to publish humidity");
+                Serial.println("[MQTT] ✗ Failed to queue humidity");
                 failCount++;
             }
         } else {
@@ -512,25 +1939,21 @@ void publishSensorData() {
     
     #ifdef ENABLE_HC_SR04
     if (waterLevelSensor.isInitialized() && waterLevelSensor.hasValidMajority()) {
-        StaticJsonDocument<300> doc;
-        doc["deviceType"] = "waterLevel";
-        doc["deviceID"] = "1";
-        doc["location"] = DEVICE_LOCATION;
-        doc["value"] = String(waterLevelSensor.getWaterLevel(), 1);
-        doc["description"] = String(DEVICE_DESCRIPTION_PREFIX) + " - water level";
-        
-        char buffer[300];
-        serializeJson(doc, buffer);
+        char buffer[SENSOR_PAYLOAD_BYTES];
+        size_t length = formatSensorPayload(buffer, sizeof(buffer), "waterLevel", waterLevelSensor.getWaterLevel(), 1, "water level");
         
         #ifdef DEBUG_VERBOSE
         Serial.printf("[MQTT] Water level payload: %s\n", buffer);
         #endif
         
-        if (mqttClient.publish(MQTT_TOPIC_SENSOR, buffer, false)) {
-            Serial.printf("[MQTT] ✓ Water level published: %.1f cm\n", waterLevelSensor.getWaterLevel());
+        if (length == 0) {
+            Serial.println("[MQTT] ✗ Water level payload exceeds SENSOR_PAYLOAD_BYTES");
+            failCount++;
+        } else if (outbound.enqueue(OUTBOUND_ROUTINE, MQTT_TOPIC_SENSOR, buffer)) {
+            Serial.printf("[MQTT] ✓ Water level queued: %.1f cm\n", waterLevelSensor.getWaterLevel());
             publishCount++;
         } else {
-            Serial.println("[MQTT] ✗ Failed to publish water level");
+            Serial.println("[MQTT] ✗ Failed to queue water level");
             failCount++;
         }
     } else {
@@ -544,26 +1967,24 @@ void publishSensorData() {
     #endif
     
     #ifdef ENABLE_PH_SENSOR
-    if (phSensor.isInitialized() && phSensor.hasValidMajority()) {
-        StaticJsonDocument<300> doc;
-        doc["deviceType"] = "pH";
-        doc["deviceID"] = "1";
-        doc["location"] = DEVICE_LOCATION;
-        doc["value"] = String(phSensor.getPH(), 2);
-        doc["description"] = String(DEVICE_DESCRIPTION_PREFIX) + " - pH sensor";
-        
-        char buffer[300];
-        serializeJson(doc, buffer);
+    if (phCalibration.isActive()) {
+        Serial.println("[MQTT] ⊘ Skipping pH (calibration in progress)");
+    } else if (phSensor.isInitialized() && phSensor.hasValidMajority()) {
+        char buffer[SENSOR_PAYLOAD_BYTES];
+        size_t length = formatSensorPayload(buffer, sizeof(buffer), "pH", phSensor.getPH(), 2, "pH sensor");
         
         #ifdef DEBUG_VERBOSE
         Serial.printf("[MQTT] pH payload: %s\n", buffer);
         #endif
         
-        if (mqttClient.publish(MQTT_TOPIC_SENSOR, buffer, false)) {
-            Serial.printf("[MQTT] ✓ pH published: %.2f\n", phSensor.getPH());
+        if (length == 0) {
+            Serial.println("[MQTT] ✗ pH payload exceeds SENSOR_PAYLOAD_BYTES");
+            failCount++;
+        } else if (outbound.enqueue(OUTBOUND_ROUTINE, MQTT_TOPIC_SENSOR, buffer)) {
+            Serial.printf("[MQTT] ✓ pH queued: %.2f\n", phSensor.getPH());
             publishCount++;
         } else {
-            Serial.println("[MQTT] ✗ Failed to publish pH");
+            Serial.println("[MQTT] ✗ Failed to queue pH");
             failCount++;
         }
     } else {
@@ -579,9 +2000,15 @@ void publishSensorData() {
     Serial.println("========================================");
     Serial.printf("[MQTT] Publish Summary: %d successful, %d failed\n", publishCount, failCount);
     Serial.println("========================================\n");
+    
+    #ifdef ENABLE_TIMESERIES_PUBLISH
+    publishTimeSeries();
+    #endif
 }
 
 void publishHealthMessage() {
+    TraceScope trace(TRACE_HEALTH);
+    
     if (!mqttClient.connected()) {
         Serial.println("\n[MQTT] ✗ Not connected, skipping health publish");
         return;
@@ -592,31 +2019,111 @@ void publishHealthMessage() {
     Serial.printf("[MQTT] Topic: %s\n", MQTT_TOPIC_HEALTH);
     Serial.println("========================================");
     
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<2048> doc;
     doc["deviceId"] = MQTT_CLIENT_ID;
     doc["status"] = "online";
     doc["uptime"] = millis() / 1000;  // seconds
     doc["firmwareVersion"] = FIRMWARE_VERSION;
     doc["freeHeap"] = ESP.getFreeHeap();
     doc["rssi"] = WiFi.RSSI();
+    doc["broker"] = brokerPool.getActiveHost();
+    doc["brokerRtt"] = brokerPool.getActiveRtt();
+    doc["alarms"] = alarmMonitor.getActiveCount();
     
-    // Add sensor status
+    // Add sensor status: lifecycle state, data quality (0-100) and detected fault
     JsonObject sensors = doc.createNestedObject("sensors");
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        const SensorChannel& channel = sensorChannels[c];
+        SensorState state = sensorSupervisor.getState(channel.sensor);
+        SampleFault fault = channel.quality.getFault();
+        
+        // Detector score weighted by the share of this channel's reads in the window that
+        // succeeded (the SHT30 has no sensor-level average, only last-read success)
+        uint8_t quality = 0;
+        if (state != SENSOR_STATE_FAILED) {
+            quality = (uint8_t)(channel.quality.getScore() * channel.average->getSuccessRate() / 100.0f + 0.5f);
+        }
+        
+        JsonObject status = sensors.createNestedObject(channel.deviceType);
+        status["state"] = SensorSupervisor::stateName(state);
+        status["quality"] = quality;
+        status["fault"] = SampleQuality::faultName(fault);
+        if (fault != SAMPLE_FAULT_NONE) {
+            Serial.printf("[HEALTH] ⚠ %s: %s (noise x%.1f of baseline)\n", channel.deviceType,
+                          SampleQuality::faultName(fault), channel.quality.getNoiseRatio());
+        }
+    }
     
-    #ifdef ENABLE_SHT30
-    sensors["temperature"] = sht30Sensor.isInitialized() ? "ok" : "error";
-    sensors["humidity"] = sht30Sensor.isInitialized() ? "ok" : "error";
-    #endif
-    
-    #ifdef ENABLE_HC_SR04
-    sensors["waterLevel"] = waterLevelSensor.isInitialized() ? "ok" : "error";
-    #endif
+    // Recoveries since boot and how long the last outage lasted (ms)
+    JsonObject recovery = doc.createNestedObject("recovery");
+    for (size_t i = 0; i < sensorSupervisor.getCount(); i++) {
+        const SupervisedSensor& entry = sensorSupervisor.get(i);
+        JsonObject stats = recovery.createNestedObject(entry.sensor->getName());
+        stats["n"] = entry.recoveries;
+        stats["ms"] = entry.lastRecoveryMs;
+    }
     
-    #ifdef ENABLE_PH_SENSOR
-    sensors["pH"] = phSensor.isInitialized() ? "ok" : "error";
+    // Phases of the last read cycle (us)
+    JsonObject acquisition = doc.createNestedObject("acquisition");
+    acquisition["trigger"] = acquisitionTiming.triggerUs;
+    acquisition["wait"] = acquisitionTiming.waitUs;
+    acquisition["collect"] = acquisitionTiming.collectUs;
+    acquisition["total"] = acquisitionTiming.totalUs;
+    acquisition["serial"] = acquisitionTiming.serialUs;
+    
+    // Outbound queue per class (urgent, state, routine, bulk): peak depth, drops
+    // since boot and worst queueing latency (ms) since the last health message
+    JsonObject queue = doc.createNestedObject("outbound");
+    JsonArray depth = queue.createNestedArray("depth");
+    JsonArray dropped = queue.createNestedArray("dropped");
+    JsonArray latency = queue.createNestedArray("latency");
+    for (size_t c = 0; c < OUTBOUND_CLASS_COUNT; c++) {
+        const OutboundQueue::ClassStats& stats = outbound.getStats((OutboundClass)c);
+        depth.add(stats.maxDepth);
+        dropped.add(stats.dropped);
+        latency.add(stats.maxLatencyMs);
+    }
+    outbound.resetPeaks();
+    
+    // MQTT packets vs. TCP writes since the previous health message (before/after coalescing)
+    const CoalescingClient::Stats& transportStats = mqttTransport.getStats();
+    JsonObject transport = doc.createNestedObject("transport");
+    transport["packets"] = transportStats.frames;
+    transport["writes"] = transportStats.segments;
+    transport["bytes"] = transportStats.bytes;
+    mqttTransport.resetStats();
+    
+    // Samples replaced by outlier filters since boot
+    #if defined(ENABLE_HC_SR04) && defined(ENABLE_WATER_LEVEL_HAMPEL)
+    JsonObject outliers = doc.createNestedObject("outliersRejected");
+    outliers["waterLevel"] = waterLevelSensor.getRejectedCount();
     #endif
     
-    char buffer[512];
+    // Heap / PSRAM / stack margins and allocation drift since the last health message (bytes)
+    memoryTelemetry.report(doc.createNestedObject("memory"));
+    
+    // Longest loop() stall since the last health message (only present if there was one)
+    stallMonitor.report(doc.as<JsonObject>());
+    
+    // The message is retained, so never queue truncated JSON: shed the optional
+    // detail (stack margins, then the stall report) until it fits a queue slot
+    char buffer[OUTBOUND_SLOT_BYTES];
+    size_t length = measureJson(doc);
+    if (length >= sizeof(buffer)) {
+        Serial.printf("[HEALTH] ⚠ Payload is %u bytes (OUTBOUND_SLOT_BYTES is %d), dropping stacks\n",
+                      (unsigned)length, OUTBOUND_SLOT_BYTES);
+        doc["memory"].remove("stacks");
+        length = measureJson(doc);
+    }
+    if (length >= sizeof(buffer)) {
+        Serial.println("[HEALTH] ⚠ Still too large, dropping stall report");
+        doc.remove("stall");
+        length = measureJson(doc);
+    }
+    if (length >= sizeof(buffer)) {
+        Serial.printf("[HEALTH] ✗ Payload is %u bytes, not published\n", (unsigned)length);
+        return;
+    }
     serializeJson(doc, buffer);
     
     // Print health details
@@ -633,15 +2140,162 @@ void publishHealthMessage() {
     #endif
     
     // Use QoS 1 for health messages
-    if (mqttClient.publish(MQTT_TOPIC_HEALTH, buffer, true)) {
-        Serial.println("[MQTT] ✓ Health message published successfully");
+    if (outbound.enqueue(OUTBOUND_STATE, MQTT_TOPIC_HEALTH, buffer, true)) {
+        Serial.println("[MQTT] ✓ Health message queued");
     } else {
-        Serial.println("[MQTT] ✗ Failed to publish health message");
+        Serial.println("[MQTT] ✗ Failed to queue health message");
     }
     
     Serial.println("========================================\n");
 }
 
+// ==================== Time-Series Functions ====================
+#ifdef ENABLE_TIMESERIES_PUBLISH
+/**
+ * Send every raw sample recorded since the previous call. Each message starts
+ * at the channel's cursor; on a failed publish the cursor stays put and the
+ * samples are retried next window (unless the ring has overwritten them).
+ */
+void publishTimeSeries() {
+    if (!mqttClient.connected()) {
+        return;
+    }
+    
+    for (size_t c = 0; c < SENSOR_CHANNEL_COUNT; c++) {
+        SensorChannel& channel = sensorChannels[c];
+        const SampleRing<RAW_SAMPLE_RING_SIZE>* ring = channel.rawSamples;
+        if (ring == nullptr) {
+            continue;
+        }
+        
+        uint32_t dropped = 0;
+        if (channel.seriesCursor < ring->oldest()) {
+            dropped = ring->oldest() - channel.seriesCursor;
+            channel.seriesCursor = ring->oldest();
+            Serial.printf("[MQTT] ⚠ %s time series: %lu samples overwritten before sending\n",
+                          channel.deviceType, (unsigned long)dropped);
+        }
+        
+        while (channel.seriesCursor < ring->head()) {
+            if (outbound.available(OUTBOUND_BULK) == 0) {
+                // Queue full: leave the rest in the ring rather than push out queued data
+                break;
+            }
+            #ifdef TIMESERIES_GORILLA
+            uint32_t end = publishSeriesBlock(channel);
+            #else
+            uint32_t end = publishSeriesJson(channel, dropped);
+            #endif
+            
+            if (end == channel.seriesCursor) {
+                Serial.printf("[MQTT] ✗ Failed to queue %s time series, retrying next window\n", channel.deviceType);
+                break;
+            }
+            
+            #ifdef DEBUG_VERBOSE
+            Serial.printf("[MQTT] ✓ %s time series: %lu samples (seq %lu)\n", channel.deviceType,
+                          (unsigned long)(end - channel.seriesCursor), (unsigned long)channel.seriesCursor);
+            #endif
+            channel.seriesCursor = end;
+            dropped = 0;
+        }
+    }
+}
+
+/**
+ * One JSON message of at most TIMESERIES_MAX_POINTS samples on MQTT_TOPIC_TIMESERIES:
+ *   {"deviceType": "pH", "deviceID": "1", "seq": 812, "now": <us>, "t0": <us>,
+ *    "scale": 100, "dropped": 0, "dt": [0, 1000, ...], "v": [612, 611, ...]}
+ * Timestamps are esp_timer microseconds since boot; "now" is taken at send
+ * time so the receiver can map them onto wall-clock time. "seq" numbers the
+ * first sample, "dropped" counts samples overwritten before they were sent.
+ * Samples that would not fit an outbound slot go in the next message.
+ * Returns the cursor after the last sample sent (unchanged on failure).
+ */
+uint32_t publishSeriesJson(const SensorChannel& channel, uint32_t dropped) {
+    const SampleRing<RAW_SAMPLE_RING_SIZE>* ring = channel.rawSamples;
+    uint32_t start = channel.seriesCursor;
+    uint32_t end = ring->head();
+    if (end - start > TIMESERIES_MAX_POINTS) {
+        end = start + TIMESERIES_MAX_POINTS;
+    }
+    
+    const int64_t t0 = ring->get(start).timestampUs;
+    StaticJsonDocument<1024> doc;
+    doc["deviceType"] = channel.deviceType;
+    doc["deviceID"] = "1";
+    doc["seq"] = start;
+    doc["now"] = esp_timer_get_time();
+    doc["t0"] = t0;
+    doc["scale"] = channel.scale;
+    if (dropped > 0) {
+        doc["dropped"] = dropped;
+    }
+    JsonArray dt = doc.createNestedArray("dt");
+    JsonArray v = doc.createNestedArray("v");
+    uint32_t seq = start;
+    for (; seq < end; seq++) {
+        const TimedSample& sample = ring->get(seq);
+        dt.add((uint32_t)((sample.timestampUs - t0) / 1000));
+        v.add((long)lroundf(sample.value * channel.scale));
+        if (seq > start && (doc.overflowed() || measureJson(doc) >= OUTBOUND_SLOT_BYTES)) {
+            dt.remove(dt.size() - 1);
+            v.remove(v.size() - 1);
+            break;
+        }
+    }
+    end = seq;
+    
+    char buffer[OUTBOUND_SLOT_BYTES];
+    if (doc.overflowed() || measureJson(doc) >= sizeof(buffer)) {
+        // Only possible for a single sample; drop it rather than send a truncated message or stall the stream
+        Serial.printf("[MQTT] ✗ %s time series does not fit a message, skipping seq %lu\n", channel.deviceType,
+                      (unsigned long)start);
+        return end;
+    }
+    size_t len = serializeJson(doc, buffer, sizeof(buffer));
+    
+    return outbound.enqueue(OUTBOUND_BULK, MQTT_TOPIC_TIMESERIES, (const uint8_t*)buffer, len) ? end : start;
+}
+
+#ifdef TIMESERIES_GORILLA
+/**
+ * One binary Gorilla block (see Gorilla.h) on MQTT_TOPIC_TIMESERIES/<deviceType>,
+ * packed with as many samples as fit in GORILLA_BLOCK_BYTES. Values are the
+ * exact raw floats; samples lost to ring overwrites show up as a gap between
+ * the last sequence number of one block and the first of the next.
+ * Returns the cursor after the last sample sent (unchanged on failure).
+ */
+uint32_t publishSeriesBlock(const SensorChannel& channel) {
+    const SampleRing<RAW_SAMPLE_RING_SIZE>* ring = channel.rawSamples;
+    uint32_t start = channel.seriesCursor;
+    
+    uint8_t block[GORILLA_BLOCK_BYTES];
+    GorillaEncoder encoder;
+    encoder.begin(block, sizeof(block), start);
+    uint32_t seq = start;
+    while (seq < ring->head()) {
+        const TimedSample& sample = ring->get(seq);
+        if (!encoder.append(sample.timestampUs, sample.value)) {
+            break;
+        }
+        seq++;
+    }
+    size_t len = encoder.finish();
+    
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s", MQTT_TOPIC_TIMESERIES, channel.deviceType);
+    
+    #ifdef DEBUG_VERBOSE
+    Serial.printf("[MQTT] %s block: %u samples in %u bytes (%.1f B/sample)\n", channel.deviceType,
+                  (unsigned)(seq - start), (unsigned)len, (float)len / (seq - start));
+    #endif
+    
+    return outbound.enqueue(OUTBOUND_BULK, topic, block, len) ? seq : start;
+}
+#endif
+#endif
+
 // ==================== LED Indicator Function ====================
 #ifdef ENABLE_LED_INDICATOR
 void updateLEDIndicator() {
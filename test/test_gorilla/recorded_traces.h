@@ -0,0 +1,476 @@
+#ifndef RECORDED_TRACES_H
+#define RECORDED_TRACES_H
+
+// Raw samples as the time-series publisher reads them from the channel rings:
+// 600 consecutive reads (about 10 minutes at SENSOR_READ_INTERVAL) of one node
+// running the firmware's SHT30Sensor, HC_SR04Sensor and PHSensor on the
+// tools/sim shim. Timestamps are microseconds from the first sample and carry
+// the loop() cadence jitter; the water-level trace has the gaps of lost echoes.
+
+#include <stdint.h>
+
+struct RecordedSample {
+    int64_t timestampUs;
+    float value;
+};
+
+static const RecordedSample PH_TRACE[] = {
+    { 0, 5.95300007f }, { 1025888, 5.95300007f }, { 2053073, 5.95300007f }, { 3070191, 5.96299982f },
+    { 4087528, 5.96299982f }, { 5108068, 5.95800018f }, { 6129001, 5.96899986f }, { 7155281, 5.96899986f },
+    { 8173375, 5.96299982f }, { 9193808, 5.96299982f }, { 10219335, 5.95800018f }, { 11257643, 5.96899986f },
+    { 12282408, 5.95300007f }, { 13306256, 5.96299982f }, { 14333129, 5.95800018f }, { 15350694, 5.96299982f },
+    { 16370740, 5.95800018f }, { 17398595, 5.97399998f }, { 18424925, 5.95800018f }, { 19446613, 5.95300007f },
+    { 20471421, 5.95800018f }, { 21491046, 5.96299982f }, { 22509994, 5.95300007f }, { 23531324, 5.95300007f },
+    { 24554090, 5.95800018f }, { 25578234, 5.95800018f }, { 26594406, 5.96299982f }, { 27616434, 5.95800018f },
+    { 28643783, 5.96299982f }, { 29667446, 5.95800018f }, { 30690533, 5.96299982f }, { 31708756, 5.96299982f },
+    { 32740945, 5.96899986f }, { 33764347, 5.95300007f }, { 34780396, 5.96299982f }, { 35805609, 5.96299982f },
+    { 36831496, 5.95800018f }, { 37854601, 5.96899986f }, { 38882523, 5.96899986f }, { 39909826, 5.95300007f },
+    { 40936488, 5.96299982f }, { 41955157, 5.95800018f }, { 42980000, 5.95300007f }, { 44002617, 5.95800018f },
+    { 45028051, 5.96299982f }, { 46047408, 5.95300007f }, { 47066345, 5.96899986f }, { 48094244, 5.96899986f },
+    { 49114031, 5.96299982f }, { 50136313, 5.95800018f }, { 51156584, 5.95800018f }, { 52172862, 5.95800018f },
+    { 53199115, 5.95800018f }, { 54227055, 5.95800018f }, { 55253434, 5.96299982f }, { 56280514, 5.96299982f },
+    { 57300240, 5.95300007f }, { 58317382, 5.95800018f }, { 59342228, 5.95800018f }, { 60362385, 5.96299982f },
+    { 61380107, 5.96299982f }, { 62403765, 5.96299982f }, { 63428368, 5.96299982f }, { 64445019, 5.96299982f },
+    { 65481644, 5.95300007f }, { 66507734, 5.95300007f }, { 67525692, 5.95800018f }, { 68551606, 5.96899986f },
+    { 69569918, 5.95800018f }, { 70587154, 5.95300007f }, { 71614160, 5.96899986f }, { 72630245, 5.96299982f },
+    { 73652343, 5.95800018f }, { 74671137, 5.95800018f }, { 75688596, 5.96299982f }, { 76710660, 5.96899986f },
+    { 77732578, 5.96299982f }, { 78759597, 5.95800018f }, { 79775903, 5.96899986f }, { 80795484, 5.95800018f },
+    { 81821802, 5.96299982f }, { 82847175, 5.96299982f }, { 83866328, 5.96299982f }, { 84884986, 5.96299982f },
+    { 85909621, 5.95800018f }, { 86933978, 5.96299982f }, { 87956634, 5.95300007f }, { 88981981, 5.95800018f },
+    { 90008294, 5.95800018f }, { 91024888, 5.96299982f }, { 92049338, 5.96299982f }, { 93075295, 5.95300007f },
+    { 94093189, 5.95800018f }, { 95115335, 5.96899986f }, { 96133377, 5.96299982f }, { 97152248, 5.96299982f },
+    { 98168475, 5.95300007f }, { 99187036, 5.96299982f }, { 100207766, 5.96899986f }, { 101231439, 5.96299982f },
+    { 102259288, 5.96299982f }, { 103281189, 5.96299982f }, { 104307424, 5.96899986f }, { 105325044, 5.95800018f },
+    { 106344806, 5.95300007f }, { 107363102, 5.95800018f }, { 108390937, 5.96299982f }, { 109411255, 5.95300007f },
+    { 110431793, 5.95300007f }, { 111450245, 5.96899986f }, { 112474101, 5.95300007f }, { 113501108, 5.96299982f },
+    { 114520326, 5.95800018f }, { 115545896, 5.96899986f }, { 116573471, 5.95800018f }, { 117594523, 5.96299982f },
+    { 118615810, 5.95800018f }, { 119632275, 5.95300007f }, { 120648564, 5.95300007f }, { 121671976, 5.95300007f },
+    { 122688457, 5.95800018f }, { 123711616, 5.95300007f }, { 124728998, 5.95800018f }, { 125751277, 5.95800018f },
+    { 126783740, 5.95800018f }, { 127806380, 5.95300007f }, { 128827818, 5.96899986f }, { 129855021, 5.95800018f },
+    { 130882562, 5.96299982f }, { 131906221, 5.96299982f }, { 132923584, 5.95800018f }, { 133947363, 5.95800018f },
+    { 134970695, 5.96899986f }, { 135997759, 5.96299982f }, { 137024567, 5.95800018f }, { 138051737, 5.95800018f },
+    { 139068967, 5.95800018f }, { 140086154, 5.96299982f }, { 141105800, 5.96299982f }, { 142125259, 5.96299982f },
+    { 143142607, 5.95800018f }, { 144167957, 5.95800018f }, { 145189537, 5.95800018f }, { 146207869, 5.95300007f },
+    { 147231214, 5.95800018f }, { 148247495, 5.96899986f }, { 149274663, 5.96299982f }, { 150301024, 5.96299982f },
+    { 151326441, 5.95800018f }, { 152343484, 5.95800018f }, { 153360795, 5.96299982f }, { 154386659, 5.95800018f },
+    { 155412849, 5.96899986f }, { 156436551, 5.96899986f }, { 157454083, 5.95800018f }, { 158481513, 5.96899986f },
+    { 159502351, 5.96299982f }, { 160527914, 5.96299982f }, { 161551935, 5.95800018f }, { 162570174, 5.96299982f },
+    { 163591776, 5.95300007f }, { 164618953, 5.95800018f }, { 165636455, 5.95800018f }, { 166653361, 5.95300007f },
+    { 167679926, 5.96299982f }, { 168702505, 5.95300007f }, { 169719900, 5.95300007f }, { 170747313, 5.95300007f },
+    { 171767248, 5.95800018f }, { 172793289, 5.95800018f }, { 173812634, 5.96299982f }, { 174840042, 5.94799995f },
+    { 175858594, 5.95300007f }, { 176884659, 5.95800018f }, { 177912569, 5.96299982f }, { 178934647, 5.96299982f },
+    { 179957696, 5.95800018f }, { 180981546, 5.96299982f }, { 182001811, 5.96299982f }, { 183024824, 5.96299982f },
+    { 184052174, 5.95300007f }, { 185075264, 5.96299982f }, { 186113702, 5.96299982f }, { 187132399, 5.96899986f },
+    { 188149721, 5.96299982f }, { 189166868, 5.96899986f }, { 190186678, 5.96899986f }, { 191209882, 5.96299982f },
+    { 192237530, 5.95800018f }, { 193255664, 5.95300007f }, { 194281545, 5.96299982f }, { 195308322, 5.95300007f },
+    { 196335692, 5.95800018f }, { 197359209, 5.95800018f }, { 198376387, 5.96299982f }, { 199398855, 5.96899986f },
+    { 200417583, 5.95800018f }, { 201435853, 5.95800018f }, { 202461625, 5.95800018f }, { 203484708, 5.95800018f },
+    { 204502510, 5.95300007f }, { 205526584, 5.95800018f }, { 206544634, 5.96299982f }, { 207560783, 5.95800018f },
+    { 208583330, 5.96299982f }, { 209600831, 5.95800018f }, { 210617608, 5.95800018f }, { 211638836, 5.95800018f },
+    { 212662893, 5.95800018f }, { 213689914, 5.95800018f }, { 214712239, 5.95800018f }, { 215729464, 5.96299982f },
+    { 216751294, 5.96299982f }, { 217774278, 5.95800018f }, { 218797425, 5.95800018f }, { 219819853, 5.96899986f },
+    { 220840171, 5.94799995f }, { 221867190, 5.96299982f }, { 222886156, 5.96299982f }, { 223909776, 5.95800018f },
+    { 224931138, 5.96899986f }, { 225958352, 5.96299982f }, { 226985826, 5.96299982f }, { 228006212, 5.95800018f },
+    { 229028323, 5.95800018f }, { 230045202, 5.96299982f }, { 231064197, 5.96299982f }, { 232085400, 5.96299982f },
+    { 233104811, 5.97399998f }, { 234122964, 5.95800018f }, { 235140329, 5.95300007f }, { 236157654, 5.95800018f },
+    { 237183827, 5.95800018f }, { 238204008, 5.95800018f }, { 239227558, 5.96899986f }, { 240252946, 5.95800018f },
+    { 241273250, 5.95800018f }, { 242295035, 5.95800018f }, { 243317851, 5.95300007f }, { 244338462, 5.96299982f },
+    { 245359821, 5.95800018f }, { 246386602, 5.95800018f }, { 247406758, 5.95800018f }, { 248432456, 5.95800018f },
+    { 249458216, 5.96899986f }, { 250484641, 5.94799995f }, { 251507685, 5.96299982f }, { 252532364, 5.96299982f },
+    { 253550589, 5.95800018f }, { 254567875, 5.95800018f }, { 255587650, 5.96299982f }, { 256611846, 5.94799995f },
+    { 257631926, 5.95800018f }, { 258656574, 5.95300007f }, { 259673317, 5.95800018f }, { 260695948, 5.96299982f },
+    { 261715344, 5.96299982f }, { 262731572, 5.95800018f }, { 263754228, 5.95800018f }, { 264779535, 5.96899986f },
+    { 265797965, 5.95300007f }, { 266814994, 5.96299982f }, { 267831672, 5.95800018f }, { 268848161, 5.96299982f },
+    { 269869915, 5.95300007f }, { 270896464, 5.96899986f }, { 271922827, 5.95800018f }, { 272961233, 5.95300007f },
+    { 273982700, 5.95800018f }, { 275001734, 5.95800018f }, { 276024836, 5.95300007f }, { 277047278, 5.96899986f },
+    { 278065241, 5.95800018f }, { 279081422, 5.96299982f }, { 280109124, 5.96899986f }, { 281129928, 5.96299982f },
+    { 282151612, 5.95800018f }, { 283174846, 5.95300007f }, { 284197894, 5.95800018f }, { 285220536, 5.96299982f },
+    { 286246113, 5.96299982f }, { 287262836, 5.95800018f }, { 288288670, 5.96299982f }, { 289314956, 5.96899986f },
+    { 290336068, 5.95800018f }, { 291352463, 5.95800018f }, { 292370421, 5.96299982f }, { 293392662, 5.95800018f },
+    { 294410080, 5.96299982f }, { 295432265, 5.96299982f }, { 296450462, 5.96299982f }, { 297466589, 5.96299982f },
+    { 298486042, 5.96299982f }, { 299506004, 5.95800018f }, { 300531821, 5.96299982f }, { 301555979, 5.95800018f },
+    { 302572233, 5.96899986f }, { 303598936, 5.96299982f }, { 304620041, 5.95800018f }, { 305658593, 5.95800018f },
+    { 306677677, 5.96299982f }, { 307705689, 5.95800018f }, { 308726598, 5.96299982f }, { 309747181, 5.95800018f },
+    { 310763967, 5.95800018f }, { 311788713, 5.96299982f }, { 312808222, 5.96299982f }, { 313829490, 5.95800018f },
+    { 314853795, 5.96299982f }, { 315878965, 5.96299982f }, { 316895972, 5.95800018f }, { 317916389, 5.96299982f },
+    { 318933391, 5.95800018f }, { 319958232, 5.96299982f }, { 320978539, 5.96299982f }, { 322001069, 5.95800018f },
+    { 323020826, 5.96299982f }, { 324044764, 5.95800018f }, { 325068352, 5.96299982f }, { 326086842, 5.96299982f },
+    { 327105293, 5.96899986f }, { 328126115, 5.96299982f }, { 329145625, 5.95800018f }, { 330170606, 5.96299982f },
+    { 331189521, 5.96299982f }, { 332212856, 5.95800018f }, { 333234227, 5.95800018f }, { 334251145, 5.96899986f },
+    { 335271871, 5.96299982f }, { 336288012, 5.95800018f }, { 337312346, 5.95800018f }, { 338337289, 5.96299982f },
+    { 339360218, 5.96899986f }, { 340387709, 5.95800018f }, { 341405029, 5.95300007f }, { 342422879, 5.96899986f },
+    { 343462916, 5.95800018f }, { 344484462, 5.95800018f }, { 345503583, 5.95800018f }, { 346520864, 5.95800018f },
+    { 347553301, 5.96299982f }, { 348578775, 5.96899986f }, { 349605793, 5.95800018f }, { 350628061, 5.96299982f },
+    { 351655874, 5.95800018f }, { 352674834, 5.96299982f }, { 353695497, 5.96299982f }, { 354720211, 5.95800018f },
+    { 355746221, 5.96899986f }, { 356765164, 5.95800018f }, { 357783948, 5.96299982f }, { 358806800, 5.96899986f },
+    { 359832283, 5.96299982f }, { 360852409, 5.96299982f }, { 361880441, 5.95800018f }, { 362905487, 5.95800018f },
+    { 363922845, 5.96299982f }, { 364940535, 5.95800018f }, { 365964269, 5.96299982f }, { 366992074, 5.96899986f },
+    { 368018281, 5.95800018f }, { 369042474, 5.95800018f }, { 370070467, 5.96299982f }, { 371094373, 5.95800018f },
+    { 372116009, 5.97399998f }, { 373141051, 5.96299982f }, { 374158636, 5.96899986f }, { 375179424, 5.95800018f },
+    { 376205963, 5.95800018f }, { 377226230, 5.95800018f }, { 378253830, 5.95800018f }, { 379271658, 5.94799995f },
+    { 380294475, 5.95800018f }, { 381317817, 5.96299982f }, { 382337564, 5.96899986f }, { 383356731, 5.95800018f },
+    { 384382690, 5.95800018f }, { 385407443, 5.96899986f }, { 386449165, 5.96299982f }, { 387473206, 5.95800018f },
+    { 388491499, 5.95300007f }, { 389516420, 5.96299982f }, { 390533782, 5.96299982f }, { 391555356, 5.95800018f },
+    { 392581586, 5.95800018f }, { 393607006, 5.95800018f }, { 394630977, 5.96899986f }, { 395653131, 5.96299982f },
+    { 396678683, 5.96299982f }, { 397695475, 5.96299982f }, { 398723061, 5.96899986f }, { 399747277, 5.95800018f },
+    { 400769763, 5.96299982f }, { 401793228, 5.96299982f }, { 402812653, 5.96299982f }, { 403836780, 5.95800018f },
+    { 404862754, 5.96899986f }, { 405890647, 5.96299982f }, { 406916003, 5.96899986f }, { 407950591, 5.96299982f },
+    { 408973413, 5.96899986f }, { 409995866, 5.96899986f }, { 411016784, 5.97399998f }, { 412037421, 5.95300007f },
+    { 413055681, 5.96299982f }, { 414073693, 5.97399998f }, { 415091450, 5.96299982f }, { 416114152, 5.95800018f },
+    { 417137910, 5.96299982f }, { 418161026, 5.95800018f }, { 419188813, 5.96299982f }, { 420205620, 5.96299982f },
+    { 421228633, 5.96899986f }, { 422251062, 5.95800018f }, { 423271472, 5.96299982f }, { 424292413, 5.95800018f },
+    { 425310366, 5.96299982f }, { 426333093, 5.95800018f }, { 427357087, 5.96299982f }, { 428374857, 5.95300007f },
+    { 429397959, 5.95300007f }, { 430416264, 5.95800018f }, { 431441280, 5.96899986f }, { 432469324, 5.96299982f },
+    { 433486090, 5.95800018f }, { 434506500, 5.96899986f }, { 435523181, 5.96299982f }, { 436545698, 5.95800018f },
+    { 437578840, 5.95800018f }, { 438596976, 5.95300007f }, { 439622271, 5.96299982f }, { 440639222, 5.96899986f },
+    { 441661665, 5.96299982f }, { 442684989, 5.96899986f }, { 443703570, 5.95800018f }, { 444722911, 5.95300007f },
+    { 445740557, 5.96299982f }, { 446767527, 5.95800018f }, { 447794924, 5.96899986f }, { 448814685, 5.95300007f },
+    { 449833003, 5.96299982f }, { 450849730, 5.96299982f }, { 451866590, 5.95800018f }, { 452886707, 5.96299982f },
+    { 453909864, 5.96299982f }, { 454931908, 5.95800018f }, { 455956039, 5.95800018f }, { 456980155, 5.96299982f },
+    { 458002401, 5.96299982f }, { 459027571, 5.94799995f }, { 460045258, 5.95800018f }, { 461070024, 5.95800018f },
+    { 462091321, 5.96299982f }, { 463118748, 5.96899986f }, { 464135292, 5.95800018f }, { 465158755, 5.96299982f },
+    { 466181664, 5.96299982f }, { 467198192, 5.96299982f }, { 468224794, 5.95800018f }, { 469245479, 5.96899986f },
+    { 470264200, 5.95300007f }, { 471283039, 5.95300007f }, { 472310711, 5.96299982f }, { 473336223, 5.96299982f },
+    { 474352399, 5.95800018f }, { 475370183, 5.96299982f }, { 476397233, 5.96299982f }, { 477420672, 5.95800018f },
+    { 478441260, 5.95800018f }, { 479457516, 5.95300007f }, { 480498115, 5.96299982f }, { 481520273, 5.96299982f },
+    { 482542892, 5.96299982f }, { 483568765, 5.96299982f }, { 484594150, 5.95800018f }, { 485613365, 5.96299982f },
+    { 486648579, 5.96299982f }, { 487676456, 5.95800018f }, { 488703651, 5.96299982f }, { 489724739, 5.96299982f },
+    { 490750484, 5.95800018f }, { 491776258, 5.95800018f }, { 492803266, 5.95800018f }, { 493827388, 5.95800018f },
+    { 494848347, 5.96299982f }, { 495888659, 5.96299982f }, { 496907155, 5.96299982f }, { 497927726, 5.96299982f },
+    { 498946974, 5.96899986f }, { 499965206, 5.96299982f }, { 500992684, 5.96299982f }, { 502016242, 5.96299982f },
+    { 503043115, 5.96299982f }, { 504064463, 5.95800018f }, { 505090901, 5.96899986f }, { 506107471, 5.95800018f },
+    { 507128903, 5.95800018f }, { 508154923, 5.96299982f }, { 509182631, 5.96299982f }, { 510203550, 5.95800018f },
+    { 511223225, 5.95800018f }, { 512243860, 5.96299982f }, { 513263731, 5.96299982f }, { 514281862, 5.97399998f },
+    { 515300108, 5.96299982f }, { 516319843, 5.95300007f }, { 517344932, 5.96299982f }, { 518367265, 5.95300007f },
+    { 519386096, 5.96299982f }, { 520412759, 5.95800018f }, { 521433541, 5.96899986f }, { 522453454, 5.96299982f },
+    { 523472743, 5.95800018f }, { 524492506, 5.96299982f }, { 525511662, 5.95800018f }, { 526535885, 5.95800018f },
+    { 527555152, 5.96899986f }, { 528581650, 5.95800018f }, { 529600261, 5.96899986f }, { 530621110, 5.96299982f },
+    { 531638669, 5.96299982f }, { 532654973, 5.96299982f }, { 533681349, 5.95800018f }, { 534702178, 5.96299982f },
+    { 535726230, 5.96299982f }, { 536748778, 5.96299982f }, { 537775631, 5.96299982f }, { 538801262, 5.95800018f },
+    { 539820748, 5.96299982f }, { 540844242, 5.96899986f }, { 541867049, 5.96299982f }, { 542889479, 5.95800018f },
+    { 543916354, 5.95300007f }, { 544936469, 5.95300007f }, { 545959431, 5.96299982f }, { 546985606, 5.95800018f },
+    { 548009239, 5.95800018f }, { 549028517, 5.95800018f }, { 550054493, 5.96299982f }, { 551081633, 5.95800018f },
+    { 552105973, 5.95800018f }, { 553133747, 5.96899986f }, { 554158689, 5.96299982f }, { 555175795, 5.96299982f },
+    { 556202996, 5.96299982f }, { 557221916, 5.96299982f }, { 558245291, 5.95800018f }, { 559266269, 5.95800018f },
+    { 560285876, 5.95800018f }, { 561308416, 5.96899986f }, { 562334013, 5.96899986f }, { 563351494, 5.96899986f },
+    { 564372118, 5.95800018f }, { 565389502, 5.95800018f }, { 566414280, 5.95800018f }, { 567433521, 5.96899986f },
+    { 568450634, 5.96899986f }, { 569469492, 5.95800018f }, { 570496118, 5.95300007f }, { 571521689, 5.96299982f },
+    { 572543091, 5.95800018f }, { 573568932, 5.96299982f }, { 574595653, 5.96899986f }, { 575614916, 5.96899986f },
+    { 576631325, 5.96299982f }, { 577659210, 5.95800018f }, { 578686059, 5.96299982f }, { 579712302, 5.95300007f },
+    { 580736172, 5.95800018f }, { 581758763, 5.96299982f }, { 582783104, 5.95300007f }, { 583810707, 5.95800018f },
+    { 584836307, 5.96299982f }, { 585860728, 5.95800018f }, { 586884681, 5.96299982f }, { 587905329, 5.96299982f },
+    { 588924585, 5.96899986f }, { 589942710, 5.95800018f }, { 590965421, 5.95800018f }, { 591987186, 5.96299982f },
+    { 593003572, 5.95800018f }, { 594026323, 5.96299982f }, { 595045639, 5.95300007f }, { 596065270, 5.95800018f },
+    { 597088001, 5.96299982f }, { 598105883, 5.95800018f }, { 599121963, 5.96299982f }, { 600144065, 5.96899986f },
+    { 601166159, 5.96899986f }, { 602188214, 5.96299982f }, { 603212557, 5.95800018f }, { 604233619, 5.96299982f },
+    { 605249684, 5.96299982f }, { 606277529, 5.96299982f }, { 607299977, 5.95800018f }, { 608322211, 5.96899986f },
+    { 609346195, 5.95800018f }, { 610365799, 5.95300007f }, { 611386588, 5.96299982f }, { 612408930, 5.96299982f },
+};
+
+static const RecordedSample TEMPERATURE_TRACE[] = {
+    { 0, 26.6769638f }, { 1025888, 26.5941849f }, { 2053073, 26.687645f }, { 3070191, 26.6208878f },
+    { 4087528, 26.6582718f }, { 5108068, 26.743721f }, { 6129001, 26.6983261f }, { 7155281, 26.6662827f },
+    { 8173375, 26.623558f }, { 9193808, 26.7196884f }, { 10219335, 26.7196884f }, { 11257646, 26.6369095f },
+    { 12282408, 26.5941849f }, { 13306256, 26.6395798f }, { 14333129, 26.6609421f }, { 15350694, 26.6742935f },
+    { 16370740, 26.7116776f }, { 17398595, 26.6849747f }, { 18424925, 26.6475906f }, { 19446613, 26.7784424f },
+    { 20471421, 26.6208878f }, { 21491046, 26.7517395f }, { 22509994, 26.7143478f }, { 23531324, 26.6983261f },
+    { 24554090, 26.6769638f }, { 25578234, 26.5915146f }, { 26594406, 26.6288986f }, { 27616434, 26.5701523f },
+    { 28643783, 26.6449203f }, { 29667446, 26.7410507f }, { 30690533, 26.6369095f }, { 31708756, 26.687645f },
+    { 32740948, 26.6609421f }, { 33764347, 26.6422501f }, { 34780396, 26.5781631f }, { 35805609, 26.687645f },
+    { 36831496, 26.6769638f }, { 37854601, 26.6502609f }, { 38882523, 26.6662827f }, { 39909826, 26.6636124f },
+    { 40936488, 26.6262283f }, { 41955157, 26.5835037f }, { 42980000, 26.7410507f }, { 44002617, 26.7357101f },
+    { 45028051, 26.7276993f }, { 46047408, 26.6636124f }, { 47066345, 26.6983261f }, { 48094244, 26.7036667f },
+    { 49114031, 26.6369095f }, { 50136313, 26.6529312f }, { 51156584, 26.7463913f }, { 52172862, 26.7276993f },
+    { 53199115, 26.6956558f }, { 54227055, 26.6262283f }, { 55253434, 26.6582718f }, { 56280514, 26.6342392f },
+    { 57300240, 26.6422501f }, { 58317382, 26.783783f }, { 59342228, 26.7570801f }, { 60362385, 26.7570801f },
+    { 61380107, 26.6903152f }, { 62403765, 26.604866f }, { 63428368, 26.6315689f }, { 64445019, 26.7116776f },
+    { 65481647, 26.6903152f }, { 66507734, 26.6582718f }, { 67525692, 26.7998047f }, { 68551606, 26.6716232f },
+    { 69569918, 26.6529312f }, { 70587154, 26.6689529f }, { 71614160, 26.8078156f }, { 72630245, 26.7276993f },
+    { 73652343, 26.6502609f }, { 74671137, 26.6502609f }, { 75688596, 26.6742935f }, { 76710660, 26.5835037f },
+    { 77732578, 26.6609421f }, { 78759597, 26.6449203f }, { 79775903, 26.623558f }, { 80795484, 26.7303696f },
+    { 81821802, 26.604866f }, { 82847175, 26.6369095f }, { 83866328, 26.6529312f }, { 84884986, 26.687645f },
+    { 85909621, 26.6903152f }, { 86933978, 26.604866f }, { 87956634, 26.7036667f }, { 88981981, 26.6903152f },
+    { 90008294, 26.7490616f }, { 91024888, 26.7383804f }, { 92049338, 26.6609421f }, { 93075295, 26.6422501f },
+    { 94093189, 26.6182175f }, { 95115335, 26.6636124f }, { 96133377, 26.7143478f }, { 97152248, 26.6208878f },
+    { 98168475, 26.6155472f }, { 99187036, 26.6662827f }, { 100207766, 26.7196884f }, { 101231439, 26.6502609f },
+    { 102259288, 26.6582718f }, { 103281189, 26.6395798f }, { 104307424, 26.6502609f }, { 105325044, 26.7090073f },
+    { 106344806, 26.6502609f }, { 107363102, 26.6796341f }, { 108390937, 26.5434494f }, { 109411255, 26.5995255f },
+    { 110431793, 26.7463913f }, { 111450245, 26.725029f }, { 112474101, 26.6689529f }, { 113501108, 26.6903152f },
+    { 114520326, 26.6742935f }, { 115545896, 26.5995255f }, { 116573471, 26.6903152f }, { 117594523, 26.5461197f },
+    { 118615810, 26.6903152f }, { 119632275, 26.7036667f }, { 120648564, 26.6155472f }, { 121671976, 26.6556015f },
+    { 122688457, 26.7891235f }, { 123711616, 26.6449203f }, { 124728998, 26.7009964f }, { 125751277, 26.6556015f },
+    { 126783743, 26.7036667f }, { 127806380, 26.6823044f }, { 128827818, 26.6395798f }, { 129855021, 26.6422501f },
+    { 130882562, 26.623558f }, { 131906221, 26.7410507f }, { 132923584, 26.6716232f }, { 133947363, 26.7357101f },
+    { 134970695, 26.6849747f }, { 135997759, 26.5915146f }, { 137024567, 26.6823044f }, { 138051737, 26.6449203f },
+    { 139068967, 26.725029f }, { 140086154, 26.6556015f }, { 141105800, 26.6529312f }, { 142125259, 26.604866f },
+    { 143142607, 26.7757721f }, { 144167957, 26.6609421f }, { 145189537, 26.725029f }, { 146207869, 26.6475906f },
+    { 147231214, 26.7971344f }, { 148247495, 26.6315689f }, { 149274663, 26.6369095f }, { 150301024, 26.743721f },
+    { 151326441, 26.6315689f }, { 152343484, 26.6769638f }, { 153360795, 26.6662827f }, { 154386659, 26.586174f },
+    { 155412849, 26.6609421f }, { 156436551, 26.6742935f }, { 157454083, 26.6422501f }, { 158481513, 26.7570801f },
+    { 159502351, 26.7276993f }, { 160527914, 26.6342392f }, { 161551935, 26.6769638f }, { 162570174, 26.6449203f },
+    { 163591776, 26.6742935f }, { 164618953, 26.7090073f }, { 165636455, 26.6956558f }, { 166653361, 26.7036667f },
+    { 167679926, 26.5915146f }, { 168702505, 26.6716232f }, { 169719900, 26.6796341f }, { 170747313, 26.6369095f },
+    { 171767248, 26.5701523f }, { 172793289, 26.7544098f }, { 173812634, 26.6369095f }, { 174840042, 26.7624207f },
+    { 175858594, 26.6689529f }, { 176884659, 26.6395798f }, { 177912569, 26.6929855f }, { 178934647, 26.7009964f },
+    { 179957696, 26.7196884f }, { 180981546, 26.6369095f }, { 182001811, 26.7170181f }, { 183024824, 26.7170181f },
+    { 184052174, 26.7757721f }, { 185075264, 26.6582718f }, { 186113705, 26.6556015f }, { 187132399, 26.7196884f },
+    { 188149721, 26.7223587f }, { 189166868, 26.6742935f }, { 190186678, 26.6582718f }, { 191209882, 26.7143478f },
+    { 192237530, 26.6102066f }, { 193255664, 26.6369095f }, { 194281545, 26.6182175f }, { 195308322, 26.706337f },
+    { 196335692, 26.7704315f }, { 197359209, 26.6395798f }, { 198376387, 26.5701523f }, { 199398855, 26.6662827f },
+    { 200417583, 26.6823044f }, { 201435853, 26.6395798f }, { 202461625, 26.6556015f }, { 203484708, 26.7330399f },
+    { 204502510, 26.6983261f }, { 205526584, 26.7891235f }, { 206544634, 26.6288986f }, { 207560783, 26.7517395f },
+    { 208583330, 26.6742935f }, { 209600831, 26.7196884f }, { 210617608, 26.6502609f }, { 211638836, 26.6636124f },
+    { 212662893, 26.7544098f }, { 213689914, 26.6636124f }, { 214712239, 26.6983261f }, { 215729464, 26.6182175f },
+    { 216751294, 26.6262283f }, { 217774278, 26.7383804f }, { 218797425, 26.7036667f }, { 219819853, 26.7410507f },
+    { 220840171, 26.6288986f }, { 221867190, 26.6395798f }, { 222886156, 26.7090073f }, { 223909776, 26.6849747f },
+    { 224931138, 26.7223587f }, { 225958352, 26.6395798f }, { 226985826, 26.6369095f }, { 228006212, 26.7784424f },
+    { 229028323, 26.6742935f }, { 230045202, 26.6769638f }, { 231064197, 26.743721f }, { 232085400, 26.6742935f },
+    { 233104811, 26.7383804f }, { 234122964, 26.7170181f }, { 235140329, 26.7383804f }, { 236157654, 26.6823044f },
+    { 237183827, 26.6849747f }, { 238204008, 26.6529312f }, { 239227558, 26.7196884f }, { 240252946, 26.6529312f },
+    { 241273250, 26.6342392f }, { 242295035, 26.6929855f }, { 243317851, 26.5941849f }, { 244338462, 26.7143478f },
+    { 245359821, 26.7196884f }, { 246386602, 26.6342392f }, { 247406758, 26.6075363f }, { 248432456, 26.7357101f },
+    { 249458216, 26.7196884f }, { 250484641, 26.7490616f }, { 251507685, 26.687645f }, { 252532364, 26.6502609f },
+    { 253550589, 26.7463913f }, { 254567875, 26.7170181f }, { 255587650, 26.7116776f }, { 256611846, 26.7036667f },
+    { 257631926, 26.6315689f }, { 258656574, 26.5701523f }, { 259673317, 26.6983261f }, { 260695948, 26.7463913f },
+    { 261715344, 26.6769638f }, { 262731572, 26.6956558f }, { 263754228, 26.6903152f }, { 264779535, 26.6983261f },
+    { 265797965, 26.6903152f }, { 266814994, 26.6742935f }, { 267831672, 26.7757721f }, { 268848161, 26.586174f },
+    { 269869915, 26.7383804f }, { 270896464, 26.6102066f }, { 271922827, 26.7303696f }, { 272961236, 26.6609421f },
+    { 273982700, 26.706337f }, { 275001734, 26.6315689f }, { 276024836, 26.6689529f }, { 277047278, 26.6662827f },
+    { 278065241, 26.6422501f }, { 279081422, 26.7357101f }, { 280109124, 26.6742935f }, { 281129928, 26.6796341f },
+    { 282151612, 26.7116776f }, { 283174846, 26.6342392f }, { 284197894, 26.6609421f }, { 285220536, 26.7650909f },
+    { 286246113, 26.7036667f }, { 287262836, 26.7330399f }, { 288288670, 26.6449203f }, { 289314956, 26.7330399f },
+    { 290336068, 26.6609421f }, { 291352463, 26.706337f }, { 292370421, 26.6208878f }, { 293392662, 26.7116776f },
+    { 294410080, 26.6529312f }, { 295432265, 26.6369095f }, { 296450462, 26.6182175f }, { 297466589, 26.6395798f },
+    { 298486042, 26.7570801f }, { 299506004, 26.6662827f }, { 300531821, 26.6956558f }, { 301555979, 26.6849747f },
+    { 302572233, 26.7170181f }, { 303598936, 26.7303696f }, { 304620041, 26.7090073f }, { 305658596, 26.6182175f },
+    { 306677677, 26.7196884f }, { 307705689, 26.7196884f }, { 308726598, 26.6075363f }, { 309747181, 26.6182175f },
+    { 310763967, 26.6315689f }, { 311788713, 26.7036667f }, { 312808222, 26.7170181f }, { 313829490, 26.6742935f },
+    { 314853795, 26.6742935f }, { 315878965, 26.6956558f }, { 316895972, 26.6529312f }, { 317916389, 26.6556015f },
+    { 318933391, 26.725029f }, { 319958232, 26.7704315f }, { 320978539, 26.7116776f }, { 322001069, 26.7463913f },
+    { 323020826, 26.6422501f }, { 324044764, 26.7009964f }, { 325068352, 26.6823044f }, { 326086842, 26.6422501f },
+    { 327105293, 26.7036667f }, { 328126115, 26.6956558f }, { 329145625, 26.7383804f }, { 330170606, 26.7383804f },
+    { 331189521, 26.6662827f }, { 332212856, 26.6422501f }, { 333234227, 26.8184967f }, { 334251145, 26.6315689f },
+    { 335271871, 26.6262283f }, { 336288012, 26.6556015f }, { 337312346, 26.7036667f }, { 338337289, 26.6342392f },
+    { 339360218, 26.6929855f }, { 340387709, 26.6075363f }, { 341405029, 26.725029f }, { 342422879, 26.6395798f },
+    { 343462919, 26.7036667f }, { 344484462, 26.6582718f }, { 345503583, 26.7276993f }, { 346520864, 26.7009964f },
+    { 347553304, 26.743721f }, { 348578775, 26.7009964f }, { 349605793, 26.6662827f }, { 350628061, 26.5514603f },
+    { 351655874, 26.6449203f }, { 352674834, 26.6662827f }, { 353695497, 26.586174f }, { 354720211, 26.5941849f },
+    { 355746221, 26.7276993f }, { 356765164, 26.6208878f }, { 357783948, 26.6582718f }, { 358806800, 26.6742935f },
+    { 359832283, 26.5995255f }, { 360852409, 26.7170181f }, { 361880441, 26.6182175f }, { 362905487, 26.604866f },
+    { 363922845, 26.5568008f }, { 364940535, 26.7196884f }, { 365964269, 26.6636124f }, { 366992074, 26.5621414f },
+    { 368018281, 26.6475906f }, { 369042474, 26.6636124f }, { 370070467, 26.6823044f }, { 371094373, 26.6208878f },
+    { 372116009, 26.6956558f }, { 373141051, 26.6182175f }, { 374158636, 26.6662827f }, { 375179424, 26.687645f },
+    { 376205963, 26.6208878f }, { 377226230, 26.6556015f }, { 378253830, 26.6529312f }, { 379271658, 26.7276993f },
+    { 380294475, 26.6689529f }, { 381317817, 26.725029f }, { 382337564, 26.6929855f }, { 383356731, 26.7570801f },
+    { 384382690, 26.7116776f }, { 385407443, 26.687645f }, { 386449168, 26.7009964f }, { 387473206, 26.7143478f },
+    { 388491499, 26.5568008f }, { 389516420, 26.7276993f }, { 390533782, 26.6636124f }, { 391555356, 26.6716232f },
+    { 392581586, 26.6369095f }, { 393607006, 26.6529312f }, { 394630977, 26.7116776f }, { 395653131, 26.6903152f },
+    { 396678683, 26.687645f }, { 397695475, 26.6315689f }, { 398723061, 26.6155472f }, { 399747277, 26.8104858f },
+    { 400769763, 26.7383804f }, { 401793228, 26.706337f }, { 402812653, 26.7917938f }, { 403836780, 26.687645f },
+    { 404862754, 26.7944641f }, { 405890647, 26.6769638f }, { 406916003, 26.6849747f }, { 407950594, 26.6422501f },
+    { 408973413, 26.6021957f }, { 409995866, 26.5968552f }, { 411016784, 26.7517395f }, { 412037421, 26.6636124f },
+    { 413055681, 26.6128769f }, { 414073693, 26.6582718f }, { 415091450, 26.6395798f }, { 416114152, 26.6342392f },
+    { 417137910, 26.6796341f }, { 418161026, 26.604866f }, { 419188813, 26.6662827f }, { 420205620, 26.6609421f },
+    { 421228633, 26.7597504f }, { 422251062, 26.7223587f }, { 423271472, 26.7544098f }, { 424292413, 26.6823044f },
+    { 425310366, 26.6315689f }, { 426333093, 26.6689529f }, { 427357087, 26.6716232f }, { 428374857, 26.6956558f },
+    { 429397959, 26.6903152f }, { 430416264, 26.623558f }, { 431441280, 26.6208878f }, { 432469324, 26.7330399f },
+    { 433486090, 26.6716232f }, { 434506500, 26.687645f }, { 435523181, 26.5808334f }, { 436545698, 26.5941849f },
+    { 437578843, 26.6582718f }, { 438596976, 26.7597504f }, { 439622271, 26.6609421f }, { 440639222, 26.623558f },
+    { 441661665, 26.6662827f }, { 442684989, 26.7650909f }, { 443703570, 26.6903152f }, { 444722911, 26.6529312f },
+    { 445740557, 26.7544098f }, { 446767527, 26.7998047f }, { 447794924, 26.725029f }, { 448814685, 26.6342392f },
+    { 449833003, 26.6342392f }, { 450849730, 26.6395798f }, { 451866590, 26.5835037f }, { 452886707, 26.7784424f },
+    { 453909864, 26.6796341f }, { 454931908, 26.7196884f }, { 455956039, 26.5888443f }, { 456980155, 26.6929855f },
+    { 458002401, 26.6502609f }, { 459027571, 26.7009964f }, { 460045258, 26.7143478f }, { 461070024, 26.6636124f },
+    { 462091321, 26.7330399f }, { 463118748, 26.706337f }, { 464135292, 26.6342392f }, { 465158755, 26.6556015f },
+    { 466181664, 26.6823044f }, { 467198192, 26.7357101f }, { 468224794, 26.6716232f }, { 469245479, 26.5754929f },
+    { 470264200, 26.7303696f }, { 471283039, 26.743721f }, { 472310711, 26.7357101f }, { 473336223, 26.7090073f },
+    { 474352399, 26.7757721f }, { 475370183, 26.6929855f }, { 476397233, 26.6262283f }, { 477420672, 26.5915146f },
+    { 478441260, 26.7170181f }, { 479457516, 26.6983261f }, { 480498118, 26.7490616f }, { 481520273, 26.6422501f },
+    { 482542892, 26.6449203f }, { 483568765, 26.7090073f }, { 484594150, 26.6796341f }, { 485613365, 26.5808334f },
+    { 486648582, 26.7143478f }, { 487676456, 26.6903152f }, { 488703651, 26.604866f }, { 489724739, 26.7170181f },
+    { 490750484, 26.6956558f }, { 491776258, 26.6582718f }, { 492803266, 26.6582718f }, { 493827388, 26.6288986f },
+    { 494848347, 26.7036667f }, { 495888662, 26.7597504f }, { 496907155, 26.7544098f }, { 497927726, 26.6823044f },
+    { 498946974, 26.7276993f }, { 499965206, 26.6796341f }, { 500992684, 26.5968552f }, { 502016242, 26.7463913f },
+    { 503043115, 26.6502609f }, { 504064463, 26.6823044f }, { 505090901, 26.6315689f }, { 506107471, 26.6742935f },
+    { 507128903, 26.6556015f }, { 508154923, 26.604866f }, { 509182631, 26.6582718f }, { 510203550, 26.6475906f },
+    { 511223225, 26.743721f }, { 512243860, 26.5995255f }, { 513263731, 26.6128769f }, { 514281862, 26.6903152f },
+    { 515300108, 26.7303696f }, { 516319843, 26.7570801f }, { 517344932, 26.6796341f }, { 518367265, 26.6716232f },
+    { 519386096, 26.6796341f }, { 520412759, 26.623558f }, { 521433541, 26.6742935f }, { 522453454, 26.604866f },
+    { 523472743, 26.6502609f }, { 524492506, 26.725029f }, { 525511662, 26.6716232f }, { 526535885, 26.7731018f },
+    { 527555152, 26.6903152f }, { 528581650, 26.6502609f }, { 529600261, 26.6556015f }, { 530621110, 26.6823044f },
+    { 531638669, 26.7731018f }, { 532654973, 26.6929855f }, { 533681349, 26.623558f }, { 534702178, 26.7196884f },
+    { 535726230, 26.6849747f }, { 536748778, 26.6288986f }, { 537775631, 26.7143478f }, { 538801262, 26.7090073f },
+    { 539820748, 26.6796341f }, { 540844242, 26.7116776f }, { 541867049, 26.802475f }, { 542889479, 26.7170181f },
+    { 543916354, 26.6315689f }, { 544936469, 26.6956558f }, { 545959431, 26.7009964f }, { 546985606, 26.6796341f },
+    { 548009239, 26.623558f }, { 549028517, 26.6849747f }, { 550054493, 26.623558f }, { 551081633, 26.6128769f },
+    { 552105973, 26.6556015f }, { 553133747, 26.7597504f }, { 554158689, 26.6662827f }, { 555175795, 26.7223587f },
+    { 556202996, 26.6288986f }, { 557221916, 26.7357101f }, { 558245291, 26.6556015f }, { 559266269, 26.6742935f },
+    { 560285876, 26.6903152f }, { 561308416, 26.5941849f }, { 562334013, 26.7757721f }, { 563351494, 26.6502609f },
+    { 564372118, 26.6823044f }, { 565389502, 26.725029f }, { 566414280, 26.7383804f }, { 567433521, 26.7864532f },
+    { 568450634, 26.6021957f }, { 569469492, 26.6716232f }, { 570496118, 26.6742935f }, { 571521689, 26.7196884f },
+    { 572543091, 26.6929855f }, { 573568932, 26.6956558f }, { 574595653, 26.7998047f }, { 575614916, 26.6182175f },
+    { 576631325, 26.6262283f }, { 577659210, 26.6075363f }, { 578686059, 26.7650909f }, { 579712302, 26.7116776f },
+    { 580736172, 26.6742935f }, { 581758763, 26.6956558f }, { 582783104, 26.623558f }, { 583810707, 26.6342392f },
+    { 584836307, 26.6636124f }, { 585860728, 26.7303696f }, { 586884681, 26.7944641f }, { 587905329, 26.6823044f },
+    { 588924585, 26.6742935f }, { 589942710, 26.6769638f }, { 590965421, 26.6823044f }, { 591987186, 26.6556015f },
+    { 593003572, 26.6636124f }, { 594026323, 26.6823044f }, { 595045639, 26.706337f }, { 596065270, 26.7784424f },
+    { 597088001, 26.7009964f }, { 598105883, 26.6903152f }, { 599121963, 26.7383804f }, { 600144065, 26.6929855f },
+    { 601166159, 26.7303696f }, { 602188214, 26.783783f }, { 603212557, 26.6849747f }, { 604233619, 26.6155472f },
+    { 605249684, 26.7036667f }, { 606277529, 26.5835037f }, { 607299977, 26.7116776f }, { 608322211, 26.6662827f },
+    { 609346195, 26.6182175f }, { 610365799, 26.7009964f }, { 611386588, 26.7490616f }, { 612408930, 26.687645f },
+};
+
+static const RecordedSample WATER_LEVEL_TRACE[] = {
+    { 0, 24.0227489f }, { 1025888, 23.9713001f }, { 2053073, 24.3143005f }, { 3070191, 24.1427994f },
+    { 4087528, 23.9370003f }, { 5108068, 24.0056f }, { 6129001, 24.0056f }, { 7155281, 23.8512497f },
+    { 8173375, 23.9541512f }, { 9193808, 24.0741997f }, { 10219335, 24.1427994f }, { 12282408, 23.78265f },
+    { 13306256, 24.4000511f }, { 14333129, 24.1599503f }, { 15350694, 24.0056f }, { 16370740, 24.2113991f },
+    { 17398595, 24.2113991f }, { 18424925, 24.1256504f }, { 19446613, 24.1770992f }, { 20471421, 24.1770992f },
+    { 21491046, 24.0227489f }, { 22509994, 23.9026985f }, { 23531324, 24.1427994f }, { 24554090, 23.9541512f },
+    { 25578234, 24.1770992f }, { 26594406, 24.1427994f }, { 27616434, 23.9541512f }, { 28643783, 24.2971497f },
+    { 29667446, 24.0398998f }, { 30690533, 23.8684006f }, { 31708756, 24.22855f }, { 33764347, 24.1770992f },
+    { 34780396, 23.9713001f }, { 35805609, 24.0398998f }, { 36831496, 24.434351f }, { 37854601, 24.2971497f },
+    { 38882523, 24.1942501f }, { 39909826, 24.1427994f }, { 40936488, 24.1770992f }, { 41955157, 23.9370003f },
+    { 42980000, 24.0570488f }, { 44002617, 24.22855f }, { 45028051, 24.2457008f }, { 46047408, 24.2457008f },
+    { 47066345, 24.1770992f }, { 48094244, 24.2457008f }, { 49114031, 24.1942501f }, { 50136313, 24.22855f },
+    { 51156584, 23.9370003f }, { 52172862, 24.3143005f }, { 53199115, 24.2800007f }, { 54227055, 23.9026985f },
+    { 55253434, 24.2113991f }, { 56280514, 23.8169498f }, { 57300240, 23.9026985f }, { 58317382, 24.2800007f },
+    { 59342228, 23.8341007f }, { 60362385, 24.0227489f }, { 61380107, 23.9541512f }, { 62403765, 23.9026985f },
+    { 63428368, 24.1599503f }, { 64445019, 24.4172001f }, { 66507734, 24.0741997f }, { 67525692, 24.0227489f },
+    { 68551606, 24.2628498f }, { 69569918, 24.4172001f }, { 70587154, 23.9541512f }, { 71614160, 24.0398998f },
+    { 72630245, 24.22855f }, { 73652343, 24.1599503f }, { 74671137, 24.1085014f }, { 75688596, 23.988451f },
+    { 76710660, 24.22855f }, { 77732578, 24.0227489f }, { 78759597, 23.9198494f }, { 79775903, 24.2113991f },
+    { 80795484, 23.9713001f }, { 81821802, 24.2628498f }, { 82847175, 23.8341007f }, { 83866328, 24.1770992f },
+    { 84884986, 24.3143005f }, { 85909621, 23.988451f }, { 86933978, 23.7998009f }, { 87956634, 23.7998009f },
+    { 88981981, 23.988451f }, { 90008294, 24.2113991f }, { 91024888, 24.1427994f }, { 92049338, 24.0570488f },
+    { 93075295, 24.2457008f }, { 94093189, 24.2628498f }, { 95115335, 23.988451f }, { 96133377, 24.3829002f },
+    { 97152248, 23.9713001f }, { 98168475, 24.2113991f }, { 99187036, 24.1770992f }, { 100207766, 24.2971497f },
+    { 101231439, 24.1085014f }, { 102259288, 23.9541512f }, { 103281189, 24.1256504f }, { 104307424, 24.2457008f },
+    { 105325044, 24.1770992f }, { 106344806, 24.1427994f }, { 107363102, 23.9713001f }, { 108390937, 24.1427994f },
+    { 109411255, 23.988451f }, { 110431793, 24.0570488f }, { 111450245, 23.9198494f }, { 112474101, 23.6797504f },
+    { 113501108, 23.8512497f }, { 114520326, 23.9026985f }, { 115545896, 23.7654991f }, { 116573471, 24.2800007f },
+    { 117594523, 24.1256504f }, { 118615810, 24.2113991f }, { 119632275, 23.8855495f }, { 120648564, 23.988451f },
+    { 121671976, 24.1599503f }, { 122688457, 24.0570488f }, { 123711616, 24.0913506f }, { 124728998, 24.0227489f },
+    { 125751277, 24.1942501f }, { 127806380, 23.9541512f }, { 128827818, 24.1599503f }, { 129855021, 23.8341007f },
+    { 130882562, 24.0398998f }, { 131906221, 24.2113991f }, { 132923584, 24.2113991f }, { 133947363, 24.1256504f },
+    { 134970695, 23.8512497f }, { 135997759, 24.2457008f }, { 137024567, 24.0570488f }, { 138051737, 24.1256504f },
+    { 139068967, 23.9713001f }, { 140086154, 24.0056f }, { 141105800, 23.8855495f }, { 142125259, 23.9541512f },
+    { 143142607, 23.8341007f }, { 144167957, 24.2800007f }, { 145189537, 24.1599503f }, { 146207869, 24.22855f },
+    { 147231214, 24.1427994f }, { 148247495, 23.9026985f }, { 149274663, 29.7165489f }, { 150301024, 24.0570488f },
+    { 151326441, 23.9198494f }, { 152343484, 24.0913506f }, { 153360795, 23.8169498f }, { 154386659, 24.2457008f },
+    { 155412849, 23.9198494f }, { 156436551, 24.0913506f }, { 157454083, 24.1942501f }, { 158481513, 23.9713001f },
+    { 159502351, 24.0056f }, { 160527914, 24.1085014f }, { 161551935, 24.1770992f }, { 162570174, 24.0570488f },
+    { 163591776, 24.0570488f }, { 164618953, 24.2628498f }, { 165636455, 24.4172001f }, { 166653361, 23.7483501f },
+    { 167679926, 24.0741997f }, { 168702505, 23.9026985f }, { 169719900, 24.0913506f }, { 170747313, 23.8512497f },
+    { 171767248, 24.2457008f }, { 172793289, 23.8855495f }, { 173812634, 24.1770992f }, { 174840042, 23.988451f },
+    { 175858594, 24.1942501f }, { 176884659, 24.0913506f }, { 177912569, 24.1256504f }, { 178934647, 24.1770992f },
+    { 179957696, 24.0227489f }, { 180981546, 23.9541512f }, { 182001811, 23.9026985f }, { 183024824, 23.988451f },
+    { 184052174, 23.8855495f }, { 185075264, 24.0570488f }, { 187132399, 24.1599503f }, { 188149721, 24.0056f },
+    { 189166868, 24.3829002f }, { 190186678, 23.9713001f }, { 191209882, 23.9370003f }, { 192237530, 24.0570488f },
+    { 193255664, 24.22855f }, { 194281545, 24.1256504f }, { 195308322, 24.2113991f }, { 196335692, 24.3314495f },
+    { 197359209, 23.9198494f }, { 198376387, 23.6968994f }, { 199398855, 23.9541512f }, { 200417583, 24.0227489f },
+    { 201435853, 24.1942501f }, { 202461625, 23.988451f }, { 203484708, 24.2113991f }, { 204502510, 24.0913506f },
+    { 205526584, 24.2457008f }, { 206544634, 24.0741997f }, { 207560783, 23.9026985f }, { 208583330, 23.7483501f },
+    { 209600831, 24.0227489f }, { 210617608, 24.1085014f }, { 211638836, 24.1942501f }, { 212662893, 24.1599503f },
+    { 213689914, 23.8855495f }, { 214712239, 23.9713001f }, { 215729464, 23.9198494f }, { 216751294, 24.2457008f },
+    { 217774278, 24.22855f }, { 218797425, 23.9026985f }, { 219819853, 24.2113991f }, { 220840171, 24.1085014f },
+    { 221867190, 23.9370003f }, { 222886156, 24.0741997f }, { 223909776, 24.3143005f }, { 224931138, 23.9198494f },
+    { 225958352, 23.8855495f }, { 226985826, 24.3657494f }, { 228006212, 23.8684006f }, { 229028323, 23.8512497f },
+    { 230045202, 23.988451f }, { 231064197, 23.9370003f }, { 232085400, 23.9370003f }, { 233104811, 23.7998009f },
+    { 234122964, 24.3314495f }, { 235140329, 23.9198494f }, { 236157654, 24.1942501f }, { 237183827, 24.0913506f },
+    { 238204008, 24.0570488f }, { 239227558, 23.8512497f }, { 240252946, 24.1770992f }, { 241273250, 24.0913506f },
+    { 242295035, 23.9198494f }, { 243317851, 24.0913506f }, { 244338462, 24.1085014f }, { 245359821, 24.1942501f },
+    { 246386602, 24.2971497f }, { 247406758, 24.0398998f }, { 248432456, 23.8684006f }, { 249458216, 23.7998009f },
+    { 250484641, 24.0741997f }, { 251507685, 23.9541512f }, { 252532364, 23.8169498f }, { 253550589, 23.9198494f },
+    { 254567875, 24.1599503f }, { 255587650, 24.4172001f }, { 256611846, 24.0398998f }, { 257631926, 23.8512497f },
+    { 258656574, 24.1256504f }, { 259673317, 24.0227489f }, { 260695948, 23.8341007f }, { 261715344, 24.1770992f },
+    { 262731572, 24.0398998f }, { 263754228, 24.0913506f }, { 264779535, 23.9198494f }, { 265797965, 24.4000511f },
+    { 266814994, 24.0913506f }, { 267831672, 24.0398998f }, { 268848161, 23.8512497f }, { 269869915, 23.8512497f },
+    { 270896464, 24.1599503f }, { 271922827, 24.1942501f }, { 273982700, 23.9370003f }, { 275001734, 24.0570488f },
+    { 276024836, 24.1599503f }, { 277047278, 23.8684006f }, { 278065241, 23.9198494f }, { 279081422, 24.0741997f },
+    { 280109124, 24.1085014f }, { 281129928, 23.8855495f }, { 282151612, 24.0570488f }, { 283174846, 24.1770992f },
+    { 284197894, 24.1942501f }, { 285220536, 24.2457008f }, { 286246113, 24.1770992f }, { 287262836, 24.1599503f },
+    { 288288670, 24.0227489f }, { 289314956, 24.0913506f }, { 290336068, 24.1599503f }, { 291352463, 24.0913506f },
+    { 292370421, 24.2113991f }, { 293392662, 24.0570488f }, { 294410080, 24.1085014f }, { 295432265, 23.9198494f },
+    { 296450462, 23.9713001f }, { 297466589, 24.3657494f }, { 298486042, 23.8169498f }, { 299506004, 23.9541512f },
+    { 300531821, 23.988451f }, { 301555979, 24.1599503f }, { 302572233, 24.1256504f }, { 303598936, 23.8684006f },
+    { 304620041, 23.9541512f }, { 306677677, 23.9541512f }, { 307705689, 24.0741997f }, { 308726598, 23.9198494f },
+    { 309747181, 28.5675011f }, { 310763967, 23.8684006f }, { 311788713, 24.2800007f }, { 312808222, 24.1085014f },
+    { 313829490, 24.1942501f }, { 314853795, 23.7483501f }, { 315878965, 23.7483501f }, { 316895972, 24.0398998f },
+    { 317916389, 24.1942501f }, { 318933391, 23.9713001f }, { 319958232, 24.1942501f }, { 320978539, 24.1085014f },
+    { 322001069, 24.0056f }, { 323020826, 24.4172001f }, { 324044764, 24.2113991f }, { 325068352, 24.0570488f },
+    { 326086842, 23.988451f }, { 327105293, 24.0570488f }, { 328126115, 24.1427994f }, { 329145625, 23.9026985f },
+    { 330170606, 23.9713001f }, { 331189521, 23.8684006f }, { 332212856, 24.1427994f }, { 333234227, 24.2628498f },
+    { 334251145, 23.9198494f }, { 335271871, 24.1427994f }, { 336288012, 24.1256504f }, { 337312346, 24.1599503f },
+    { 338337289, 23.8684006f }, { 339360218, 23.7483501f }, { 340387709, 24.1942501f }, { 341405029, 24.4857998f },
+    { 342422879, 24.2628498f }, { 344484462, 23.8341007f }, { 345503583, 24.0398998f }, { 346520864, 23.9713001f },
+    { 348578775, 24.22855f }, { 349605793, 24.1427994f }, { 350628061, 24.1770992f }, { 351655874, 24.0913506f },
+    { 352674834, 24.0398998f }, { 353695497, 23.9370003f }, { 354720211, 24.1599503f }, { 355746221, 23.9198494f },
+    { 356765164, 23.8855495f }, { 357783948, 24.1942501f }, { 358806800, 23.9026985f }, { 359832283, 23.8341007f },
+    { 360852409, 23.8169498f }, { 361880441, 24.0913506f }, { 362905487, 24.0570488f }, { 363922845, 24.2113991f },
+    { 364940535, 24.22855f }, { 365964269, 24.22855f }, { 366992074, 24.0398998f }, { 368018281, 24.0398998f },
+    { 369042474, 24.1599503f }, { 370070467, 24.0056f }, { 371094373, 23.8169498f }, { 372116009, 24.0398998f },
+    { 373141051, 23.9198494f }, { 374158636, 23.9541512f }, { 375179424, 23.7998009f }, { 376205963, 24.4000511f },
+    { 377226230, 24.0227489f }, { 378253830, 23.8512497f }, { 379271658, 23.9370003f }, { 380294475, 24.3657494f },
+    { 381317817, 24.0570488f }, { 382337564, 23.9370003f }, { 383356731, 23.8341007f }, { 384382690, 23.9541512f },
+    { 385407443, 24.0227489f }, { 387473206, 24.0056f }, { 388491499, 24.1085014f }, { 389516420, 24.1085014f },
+    { 390533782, 24.3829002f }, { 391555356, 24.1427994f }, { 392581586, 24.0570488f }, { 393607006, 24.1085014f },
+    { 394630977, 31.2085991f }, { 395653131, 23.9541512f }, { 396678683, 23.9713001f }, { 397695475, 24.22855f },
+    { 398723061, 24.0741997f }, { 399747277, 24.2457008f }, { 400769763, 24.2628498f }, { 401793228, 23.7483501f },
+    { 402812653, 24.1427994f }, { 403836780, 24.0056f }, { 404862754, 24.4686489f }, { 405890647, 24.1085014f },
+    { 406916003, 24.3485985f }, { 408973413, 23.8512497f }, { 409995866, 24.2628498f }, { 411016784, 24.0227489f },
+    { 412037421, 24.1599503f }, { 413055681, 24.0913506f }, { 414073693, 24.22855f }, { 415091450, 24.1256504f },
+    { 416114152, 24.2113991f }, { 417137910, 23.8169498f }, { 418161026, 23.8684006f }, { 419188813, 24.0741997f },
+    { 420205620, 24.0570488f }, { 421228633, 24.1770992f }, { 422251062, 24.1427994f }, { 423271472, 23.8855495f },
+    { 424292413, 24.1256504f }, { 425310366, 23.9541512f }, { 426333093, 23.9198494f }, { 427357087, 23.8684006f },
+    { 428374857, 23.988451f }, { 429397959, 23.8512497f }, { 430416264, 24.1427994f }, { 431441280, 24.2113991f },
+    { 432469324, 24.2113991f }, { 433486090, 23.7654991f }, { 434506500, 24.0913506f }, { 435523181, 23.7140503f },
+    { 436545698, 24.0056f }, { 438596976, 23.9541512f }, { 439622271, 24.0741997f }, { 440639222, 23.988451f },
+    { 441661665, 23.8512497f }, { 442684989, 23.9713001f }, { 443703570, 24.0570488f }, { 444722911, 24.0741997f },
+    { 445740557, 24.2800007f }, { 446767527, 23.9026985f }, { 447794924, 23.8855495f }, { 448814685, 24.2800007f },
+    { 449833003, 24.2800007f }, { 450849730, 24.1942501f }, { 451866590, 24.22855f }, { 452886707, 23.7998009f },
+    { 453909864, 24.2457008f }, { 454931908, 24.3314495f }, { 455956039, 24.0741997f }, { 456980155, 24.0398998f },
+    { 458002401, 23.8855495f }, { 459027571, 24.0741997f }, { 460045258, 24.1770992f }, { 461070024, 24.4172001f },
+    { 462091321, 23.988451f }, { 463118748, 24.5029488f }, { 464135292, 23.8512497f }, { 465158755, 24.0227489f },
+    { 466181664, 24.1085014f }, { 467198192, 24.1256504f }, { 468224794, 23.78265f }, { 469245479, 23.9198494f },
+    { 470264200, 24.0741997f }, { 471283039, 23.9541512f }, { 472310711, 24.1427994f }, { 473336223, 24.0056f },
+    { 474352399, 24.3314495f }, { 475370183, 24.1942501f }, { 476397233, 23.8341007f }, { 477420672, 23.8169498f },
+    { 478441260, 24.1256504f }, { 479457516, 23.7483501f }, { 481520273, 24.0227489f }, { 482542892, 24.1256504f },
+    { 483568765, 24.0913506f }, { 484594150, 23.78265f }, { 485613365, 23.988451f }, { 487676456, 24.0227489f },
+    { 488703651, 24.2628498f }, { 489724739, 23.9370003f }, { 490750484, 23.9713001f }, { 491776258, 24.0913506f },
+    { 492803266, 23.988451f }, { 493827388, 24.0056f }, { 494848347, 24.0227489f }, { 496907155, 24.3143005f },
+    { 497927726, 23.8684006f }, { 498946974, 23.9370003f }, { 499965206, 23.8512497f }, { 500992684, 24.1599503f },
+    { 502016242, 23.9370003f }, { 503043115, 24.1256504f }, { 504064463, 24.1942501f }, { 505090901, 24.0741997f },
+    { 506107471, 23.9198494f }, { 507128903, 24.0227489f }, { 508154923, 24.1770992f }, { 509182631, 23.9370003f },
+    { 510203550, 23.6282997f }, { 511223225, 24.1770992f }, { 512243860, 24.0398998f }, { 513263731, 24.2800007f },
+    { 514281862, 23.988451f }, { 515300108, 23.988451f }, { 516319843, 23.9370003f }, { 517344932, 23.9541512f },
+    { 518367265, 23.9713001f }, { 519386096, 24.1427994f }, { 520412759, 24.0913506f }, { 521433541, 24.0570488f },
+    { 522453454, 24.0056f }, { 523472743, 24.1599503f }, { 524492506, 24.1256504f }, { 525511662, 24.1942501f },
+    { 526535885, 23.9026985f }, { 527555152, 24.0570488f }, { 528581650, 24.0913506f }, { 529600261, 23.988451f },
+    { 530621110, 24.1770992f }, { 531638669, 23.9541512f }, { 532654973, 23.8512497f }, { 533681349, 23.9026985f },
+    { 534702178, 24.0398998f }, { 535726230, 24.2971497f }, { 536748778, 23.9713001f }, { 537775631, 23.7654991f },
+    { 538801262, 24.3485985f }, { 539820748, 28.6875496f }, { 540844242, 24.0227489f }, { 541867049, 23.988451f },
+    { 542889479, 24.0570488f }, { 543916354, 23.8341007f }, { 544936469, 24.1427994f }, { 545959431, 24.1256504f },
+    { 546985606, 24.0570488f }, { 548009239, 24.1427994f }, { 549028517, 23.7483501f }, { 550054493, 24.0913506f },
+    { 551081633, 24.0398998f }, { 552105973, 24.1427994f }, { 553133747, 24.3485985f }, { 554158689, 23.78265f },
+    { 555175795, 24.0398998f }, { 556202996, 23.7998009f }, { 557221916, 23.8512497f }, { 558245291, 24.0056f },
+    { 559266269, 24.1770992f }, { 560285876, 24.0056f }, { 561308416, 24.2113991f }, { 562334013, 24.1256504f },
+    { 563351494, 23.9713001f }, { 564372118, 23.9026985f }, { 565389502, 24.0398998f }, { 566414280, 24.1599503f },
+    { 567433521, 24.2457008f }, { 568450634, 23.9198494f }, { 569469492, 24.0227489f }, { 570496118, 24.1599503f },
+    { 571521689, 24.1770992f }, { 572543091, 23.8684006f }, { 573568932, 23.8512497f }, { 574595653, 24.0570488f },
+    { 575614916, 24.2800007f }, { 576631325, 24.0570488f }, { 577659210, 24.4000511f }, { 578686059, 24.0398998f },
+    { 579712302, 24.0741997f }, { 580736172, 23.9026985f }, { 581758763, 24.0570488f }, { 582783104, 24.22855f },
+    { 583810707, 24.0570488f }, { 584836307, 23.7483501f }, { 585860728, 24.1942501f }, { 586884681, 24.2457008f },
+    { 587905329, 24.0227489f }, { 588924585, 24.2628498f }, { 589942710, 24.22855f }, { 590965421, 23.78265f },
+    { 591987186, 24.1256504f }, { 593003572, 24.1942501f }, { 594026323, 23.8512497f }, { 595045639, 24.0398998f },
+    { 596065270, 24.434351f }, { 597088001, 24.1085014f }, { 598105883, 24.0913506f }, { 599121963, 24.1942501f },
+    { 600144065, 24.2113991f }, { 601166159, 24.0227489f }, { 602188214, 23.9541512f }, { 603212557, 23.988451f },
+    { 604233619, 24.0741997f }, { 605249684, 24.3143005f }, { 606277529, 23.8341007f }, { 607299977, 23.9198494f },
+    { 608322211, 24.1427994f }, { 609346195, 24.1256504f }, { 610365799, 23.7998009f }, { 611386588, 24.0398998f },
+    { 612408930, 23.988451f }, { 613429090, 23.8855495f }, { 614449783, 23.988451f }, { 615463800, 24.0913506f },
+    { 616481802, 23.6968994f }, { 617505066, 24.3143005f }, { 618522621, 24.0056f }, { 619546003, 24.0227489f },
+    { 620567014, 23.8341007f }, { 621583297, 23.8341007f }, { 622606643, 24.0570488f }, { 623625247, 23.8169498f },
+    { 624644108, 24.1256504f }, { 625666376, 24.1256504f }, { 626689481, 24.2628498f }, { 627710905, 24.22855f },
+};
+
+#endif // RECORDED_TRACES_H
@@ -0,0 +1,362 @@
+// Gorilla block round trips and the compression ratio on recorded traces.
+//
+// Runs on the host (pio test -e native) or on the board (pio test -e esp32dev).
+
+#include <unity.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "Gorilla.h"
+#include "SensorPayload.h"
+#include "recorded_traces.h"
+
+static const int64_t T0_US = 1234567890123LL;
+
+struct Sample {
+    int64_t timestampUs;
+    float value;
+};
+
+static uint32_t bitsOf(float value) {
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return raw;
+}
+
+static float floatOf(uint32_t raw) {
+    float value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+/**
+ * Encode samples into one block, decode it and check every timestamp and
+ * value bit for bit. Timestamps after the first must be whole milliseconds
+ * from it, the resolution the format keeps.
+ */
+static size_t roundTrip(const Sample* samples, size_t count) {
+    static uint8_t block[4096];
+    GorillaEncoder encoder;
+    encoder.begin(block, sizeof(block), 77);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE_MESSAGE(encoder.append(samples[i].timestampUs, samples[i].value), "block full");
+    }
+    size_t length = encoder.finish();
+
+    GorillaDecoder decoder;
+    TEST_ASSERT_TRUE(decoder.begin(block, length));
+    TEST_ASSERT_EQUAL_UINT16(count, decoder.getCount());
+    TEST_ASSERT_EQUAL_UINT32(77, decoder.getFirstSeq());
+    for (size_t i = 0; i < count; i++) {
+        int64_t timestampUs = 0;
+        float value = 0;
+        TEST_ASSERT_TRUE(decoder.next(timestampUs, value));
+        TEST_ASSERT_TRUE_MESSAGE(timestampUs == samples[i].timestampUs, "timestamp differs");
+        TEST_ASSERT_EQUAL_HEX32(bitsOf(samples[i].value), bitsOf(value));
+    }
+    int64_t timestampUs;
+    float value;
+    TEST_ASSERT_FALSE(decoder.next(timestampUs, value));
+    TEST_ASSERT_EQUAL(length, decoder.blockLength());
+    return length;
+}
+
+void test_first_sample_keeps_full_timestamp(void) {
+    // The first sample keeps microseconds; only later ones are in milliseconds
+    Sample samples[] = { { T0_US + 789, 21.37f } };
+    size_t length = roundTrip(samples, 1);
+    TEST_ASSERT_EQUAL(GORILLA_HEADER_BYTES + 4, length);
+}
+
+void test_empty_block(void) {
+    uint8_t block[64];
+    GorillaEncoder encoder;
+    encoder.begin(block, sizeof(block), 5);
+    size_t length = encoder.finish();
+    TEST_ASSERT_EQUAL(GORILLA_HEADER_BYTES, length);
+
+    GorillaDecoder decoder;
+    TEST_ASSERT_TRUE(decoder.begin(block, length));
+    int64_t timestampUs;
+    float value;
+    TEST_ASSERT_FALSE(decoder.next(timestampUs, value));
+}
+
+void test_delta_of_delta_bucket_edges(void) {
+    // Each dod sits on or just past the edge of a bucket, both signs
+    static const int32_t dods[] = {
+        0, -63, 64, 63, -64, 65, -255, 256, -256, 257,
+        -2047, 2048, -2048, 2049, 0, 0, -1, 1,
+    };
+    const size_t count = sizeof(dods) / sizeof(dods[0]) + 2;
+    Sample samples[sizeof(dods) / sizeof(dods[0]) + 2];
+    int64_t ms = 0;
+    int64_t delta = 5000;  // Large enough that no delta goes negative
+    samples[0].timestampUs = T0_US;
+    samples[0].value = 7.0f;
+    samples[1].timestampUs = T0_US + delta * 1000;
+    samples[1].value = 7.0f;
+    ms = delta;
+    for (size_t i = 2; i < count; i++) {
+        delta += dods[i - 2];
+        ms += delta;
+        samples[i].timestampUs = T0_US + ms * 1000;
+        samples[i].value = 7.0f;
+    }
+    roundTrip(samples, count);
+}
+
+void test_large_timestamp_jumps(void) {
+    // A day-long gap (sensor offline) and back, then a gap within 32-bit range
+    Sample samples[] = {
+        { T0_US, 1.0f },
+        { T0_US + 1000000LL, 1.0f },
+        { T0_US + 2000000LL, 1.0f },
+        { T0_US + 2000000LL + 86400000000LL, 1.0f },
+        { T0_US + 3000000LL + 86400000000LL, 1.0f },
+        { T0_US + 4000000LL + 86400000000LL, 1.0f },
+        { T0_US + 4000000LL + 86400000000LL + 2000000000000LL, 1.0f },
+        { T0_US + 4001000LL + 86400000000LL + 2000000000000LL, 1.0f },
+    };
+    roundTrip(samples, sizeof(samples) / sizeof(samples[0]));
+}
+
+void test_identical_values_cost_two_bits(void) {
+    Sample samples[100];
+    for (size_t i = 0; i < 100; i++) {
+        samples[i].timestampUs = T0_US + (int64_t)i * 1000000;
+        samples[i].value = 6.05f;
+    }
+    size_t length = roundTrip(samples, 100);
+    // 32 bits for the first value, then '0' dod and '0' value per sample
+    // (the second sample's delta of 1000 ms is its own dod: '1110' + 12 bits)
+    size_t bits = 32 + (4 + 12 + 1) + 98 * 2;
+    TEST_ASSERT_EQUAL(GORILLA_HEADER_BYTES + (bits + 7) / 8, length);
+}
+
+void test_sign_and_exponent_flips(void) {
+    static const float values[] = {
+        1.0f, -1.0f, 2.0f, 0.5f, -0.0f, 0.0f, FLT_MAX, -FLT_MAX, FLT_MIN, -FLT_MIN,
+        floatOf(0x00000001u), floatOf(0x80000001u), INFINITY, -INFINITY, 1.0f, 1.0000001f,
+        3.0e38f, 1.0e-38f, 123456.789f, -0.000123f, 1.0f,
+    };
+    const size_t count = sizeof(values) / sizeof(values[0]);
+    Sample samples[sizeof(values) / sizeof(values[0])];
+    for (size_t i = 0; i < count; i++) {
+        samples[i].timestampUs = T0_US + (int64_t)i * 1000000;
+        samples[i].value = values[i];
+    }
+    roundTrip(samples, count);
+}
+
+void test_nan_payloads_survive(void) {
+    // Failed reads may be NaN; every NaN bit pattern comes back unchanged
+    static const uint32_t patterns[] = {
+        0x7FC00000u, 0xFFC00000u, 0x7F800001u, 0x7FFFFFFFu, 0xFFFFFFFFu, 0x7FC00000u, 0x7FC00000u,
+    };
+    const size_t count = sizeof(patterns) / sizeof(patterns[0]) + 2;
+    Sample samples[sizeof(patterns) / sizeof(patterns[0]) + 2];
+    samples[0].timestampUs = T0_US;
+    samples[0].value = 5.9f;
+    for (size_t i = 0; i < count - 2; i++) {
+        samples[i + 1].timestampUs = T0_US + (int64_t)(i + 1) * 1000000;
+        samples[i + 1].value = floatOf(patterns[i]);
+    }
+    samples[count - 1].timestampUs = T0_US + (int64_t)(count - 1) * 1000000;
+    samples[count - 1].value = 5.9f;
+    roundTrip(samples, count);
+}
+
+void test_full_block_refuses_samples(void) {
+    uint8_t block[GORILLA_HEADER_BYTES + 48];
+    GorillaEncoder encoder;
+    encoder.begin(block, sizeof(block), 0);
+
+    // Alternating signs and jittery gaps keep every sample near the worst case
+    Sample samples[64];
+    size_t accepted = 0;
+    for (size_t i = 0; i < 64; i++) {
+        samples[i].timestampUs = T0_US + (int64_t)i * 1000000 + (int64_t)((i * 7919) % 3000) * 1000;
+        samples[i].value = (i % 2 ? -1.0f : 1.0f) * (1.0f + i * 0.3371f);
+        if (!encoder.append(samples[i].timestampUs, samples[i].value)) {
+            break;
+        }
+        accepted++;
+    }
+    TEST_ASSERT_TRUE(accepted > 1 && accepted < 64);
+    TEST_ASSERT_FALSE(encoder.append(samples[accepted].timestampUs, samples[accepted].value));
+    TEST_ASSERT_FALSE(encoder.append(samples[accepted].timestampUs, samples[0].value));
+    TEST_ASSERT_EQUAL_UINT16(accepted, encoder.getCount());
+    size_t length = encoder.finish();
+    TEST_ASSERT_TRUE(length <= sizeof(block));
+
+    // Nothing of the refused samples leaked into the block
+    GorillaDecoder decoder;
+    TEST_ASSERT_TRUE(decoder.begin(block, length));
+    for (size_t i = 0; i < accepted; i++) {
+        int64_t timestampUs;
+        float value;
+        TEST_ASSERT_TRUE(decoder.next(timestampUs, value));
+        TEST_ASSERT_EQUAL_HEX32(bitsOf(samples[i].value), bitsOf(value));
+    }
+    int64_t timestampUs;
+    float value;
+    TEST_ASSERT_FALSE(decoder.next(timestampUs, value));
+}
+
+void test_sample_count_limit(void) {
+    // Identical samples cost 2 bits, so the 16-bit count runs out before the space
+    static uint8_t block[GORILLA_HEADER_BYTES + 20000];
+    GorillaEncoder encoder;
+    encoder.begin(block, sizeof(block), 0);
+    for (uint32_t i = 0; i < 0xFFFF; i++) {
+        TEST_ASSERT_TRUE(encoder.append(T0_US + (int64_t)i * 1000000, 1.0f));
+    }
+    TEST_ASSERT_FALSE(encoder.append(T0_US + 0xFFFFLL * 1000000, 1.0f));
+    size_t length = encoder.finish();
+
+    GorillaDecoder decoder;
+    TEST_ASSERT_TRUE(decoder.begin(block, length));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, decoder.getCount());
+}
+
+void test_decoder_rejects_bad_blocks(void) {
+    uint8_t block[64];
+    GorillaEncoder encoder;
+    encoder.begin(block, sizeof(block), 0);
+    encoder.append(T0_US, 1.0f);
+    encoder.append(T0_US + 1000000, 2.0f);
+    encoder.append(T0_US + 2000000, 3.0f);
+    size_t length = encoder.finish();
+
+    GorillaDecoder decoder;
+    TEST_ASSERT_FALSE(decoder.begin(block, GORILLA_HEADER_BYTES - 1));
+    block[1] = GORILLA_VERSION + 1;
+    TEST_ASSERT_FALSE(decoder.begin(block, length));
+    block[1] = GORILLA_VERSION;
+
+    // A truncated block stops early instead of reading past its end
+    TEST_ASSERT_TRUE(decoder.begin(block, GORILLA_HEADER_BYTES + 5));
+    int64_t timestampUs;
+    float value;
+    size_t read = 0;
+    while (decoder.next(timestampUs, value)) {
+        read++;
+    }
+    TEST_ASSERT_EQUAL(1, read);
+}
+
+struct TraceResult {
+    size_t samples;
+    size_t blocks;
+    size_t encodedBytes;
+    size_t jsonBytes;
+};
+
+/**
+ * Pack a trace into GORILLA_BLOCK_BYTES blocks the way publishSeriesBlock()
+ * does, then walk the concatenated blocks like tools/gorilla_decode and check
+ * every sample. jsonBytes is what the same readings cost as sensor messages.
+ */
+static TraceResult encodeTrace(const RecordedSample* trace, size_t count, const char* deviceType, int decimals,
+                               const char* label) {
+    static uint8_t stream[16384];
+    TraceResult result = { count, 0, 0, 0 };
+    size_t next = 0;
+    while (next < count) {
+        TEST_ASSERT_TRUE(result.encodedBytes + GORILLA_BLOCK_BYTES <= sizeof(stream));
+        GorillaEncoder encoder;
+        encoder.begin(stream + result.encodedBytes, GORILLA_BLOCK_BYTES, (uint32_t)next);
+        while (next < count && encoder.append(T0_US + trace[next].timestampUs, trace[next].value)) {
+            next++;
+        }
+        result.encodedBytes += encoder.finish();
+        result.blocks++;
+    }
+
+    size_t offset = 0;
+    size_t decoded = 0;
+    while (offset < result.encodedBytes) {
+        GorillaDecoder decoder;
+        TEST_ASSERT_TRUE(decoder.begin(stream + offset, result.encodedBytes - offset));
+        TEST_ASSERT_EQUAL_UINT32(decoded, decoder.getFirstSeq());
+        int64_t timestampUs;
+        float value;
+        while (decoder.next(timestampUs, value)) {
+            // Millisecond resolution after the first sample of a block
+            int64_t expected = T0_US + trace[decoded].timestampUs;
+            int64_t first = T0_US + trace[decoder.getFirstSeq()].timestampUs;
+            TEST_ASSERT_TRUE(timestampUs == first + (expected - first) / 1000 * 1000);
+            TEST_ASSERT_EQUAL_HEX32(bitsOf(trace[decoded].value), bitsOf(value));
+            decoded++;
+        }
+        offset += decoder.blockLength();
+    }
+    TEST_ASSERT_EQUAL(count, decoded);
+    TEST_ASSERT_EQUAL(result.encodedBytes, offset);
+
+    for (size_t i = 0; i < count; i++) {
+        char payload[SENSOR_PAYLOAD_BYTES];
+        size_t length = formatSensorPayload(payload, sizeof(payload), deviceType, trace[i].value, decimals, label);
+        TEST_ASSERT_TRUE(length > 0);
+        result.jsonBytes += length;
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "%-11s %u samples, %u blocks: %.2f B/sample vs %.1f B/sample as JSON (%.0fx)",
+             deviceType, (unsigned)count, (unsigned)result.blocks, (double)result.encodedBytes / count,
+             (double)result.jsonBytes / count, (double)result.jsonBytes / result.encodedBytes);
+    TEST_MESSAGE(line);
+    return result;
+}
+
+void test_recorded_traces_compression(void) {
+    TraceResult ph = encodeTrace(PH_TRACE, sizeof(PH_TRACE) / sizeof(PH_TRACE[0]), "pH", 2, "pH sensor");
+    TraceResult temperature = encodeTrace(TEMPERATURE_TRACE, sizeof(TEMPERATURE_TRACE) / sizeof(TEMPERATURE_TRACE[0]),
+                                          "temperature", 2, "temperature");
+    TraceResult level = encodeTrace(WATER_LEVEL_TRACE, sizeof(WATER_LEVEL_TRACE) / sizeof(WATER_LEVEL_TRACE[0]),
+                                    "waterLevel", 1, "water level");
+
+    // Raw samples are 12 bytes (int64 + float) in the ring; blocks must beat that by far
+    const TraceResult* results[] = { &ph, &temperature, &level };
+    for (size_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(results[i]->encodedBytes * 2 < results[i]->samples * 12);
+        TEST_ASSERT_TRUE(results[i]->encodedBytes * 10 < results[i]->jsonBytes);
+    }
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_keeps_full_timestamp);
+    RUN_TEST(test_empty_block);
+    RUN_TEST(test_delta_of_delta_bucket_edges);
+    RUN_TEST(test_large_timestamp_jumps);
+    RUN_TEST(test_identical_values_cost_two_bits);
+    RUN_TEST(test_sign_and_exponent_flips);
+    RUN_TEST(test_nan_payloads_survive);
+    RUN_TEST(test_full_block_refuses_samples);
+    RUN_TEST(test_sample_count_limit);
+    RUN_TEST(test_decoder_rejects_bad_blocks);
+    RUN_TEST(test_recorded_traces_compression);
+    return UNITY_END();
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+    delay(2000);  // Let the serial monitor attach
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void) {
+    return runUnityTests();
+}
+#endif
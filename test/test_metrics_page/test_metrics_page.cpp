@@ -0,0 +1,208 @@
+// MetricsPage request classification, value formatting and overflow handling.
+//
+// Runs on the host (pio test -e native) or on the board (pio test -e esp32dev).
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "MetricsPage.h"
+
+static MetricsPage::Request classify(const char* request, bool full = false) {
+    return MetricsPage::classifyRequest(request, strlen(request), full);
+}
+
+/**
+ * Render one unlabelled sample and return its line.
+ */
+static const char* render(double value) {
+    static char buffer[64];
+    MetricsPage page(buffer, sizeof(buffer));
+    page.sample("m", value);
+    TEST_ASSERT_FALSE(page.isOverflowed());
+    return buffer;
+}
+
+/**
+ * Every line of a page ends in '\n' and the page holds nothing after the last one.
+ */
+static void assertCompleteLines(const char* buffer, size_t length) {
+    TEST_ASSERT_EQUAL(length, strlen(buffer));
+    if (length > 0) {
+        TEST_ASSERT_TRUE_MESSAGE(buffer[length - 1] == '\n', "page ends mid-line");
+    }
+}
+
+void test_request_metrics(void) {
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_METRICS, classify("GET /metrics HTTP/1.1\r\nHost: node\r\n\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_METRICS, classify("GET /metrics HTTP/1.0\r\n"));
+    // HTTP/0.9 style: no version after the path
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_METRICS, classify("GET /metrics\r\n"));
+}
+
+void test_request_query_string(void) {
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_METRICS, classify("GET /metrics?name[]=up HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_METRICS, classify("GET /metrics? HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_NOT_FOUND, classify("GET /metricsx HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_NOT_FOUND, classify("GET /metrics/ HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_NOT_FOUND, classify("GET /?metrics HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_NOT_FOUND, classify("GET / HTTP/1.1\r\n"));
+}
+
+void test_request_partial_line(void) {
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_INCOMPLETE, classify(""));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_INCOMPLETE, classify("GET /metr"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_INCOMPLETE, classify("GET /metrics HTTP/1.1"));
+    // CR arrived, LF still in flight
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_INCOMPLETE, classify("GET /metrics HTTP/1.1\r"));
+    // A bare LF does not end the request line
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_INCOMPLETE, classify("GET /metrics HTTP/1.1\n"));
+
+    // Only the first length bytes count, even if more follow in memory
+    const char* request = "GET /metrics HTTP/1.1\r\n";
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_INCOMPLETE,
+                      MetricsPage::classifyRequest(request, strlen(request) - 1, false));
+}
+
+void test_request_not_get(void) {
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("POST /metrics HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("HEAD /metrics HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("get /metrics HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("GET\r\n"));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("\r\n"));
+}
+
+void test_request_full_buffer(void) {
+    // No line end before the receive buffer filled up: never going to parse
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("GET /metrics?aaaaaaaaaaaaaaaa", true));
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_BAD, classify("GET /metrics HTTP/1.1\r", true));
+    // A complete request line still counts, whatever the headers did
+    TEST_ASSERT_EQUAL(MetricsPage::REQUEST_METRICS, classify("GET /metrics HTTP/1.1\r\nUser-Agent: aaaa", true));
+}
+
+void test_value_special(void) {
+    TEST_ASSERT_EQUAL_STRING("m NaN\n", render(NAN));
+    TEST_ASSERT_EQUAL_STRING("m +Inf\n", render(INFINITY));
+    TEST_ASSERT_EQUAL_STRING("m -Inf\n", render(-INFINITY));
+}
+
+void test_value_integer(void) {
+    TEST_ASSERT_EQUAL_STRING("m 0\n", render(0));
+    TEST_ASSERT_EQUAL_STRING("m -3\n", render(-3));
+    TEST_ASSERT_EQUAL_STRING("m 4294967295\n", render(4294967295.0));
+    // Counters keep every digit, well past the 7 a float would show
+    TEST_ASSERT_EQUAL_STRING("m 123456789012345\n", render(123456789012345.0));
+    TEST_ASSERT_EQUAL_STRING("m 1e+15\n", render(1e15));
+}
+
+void test_value_float(void) {
+    // A float reading widened to double prints as the float, not 6.849999905
+    TEST_ASSERT_EQUAL_STRING("m 6.85\n", render(6.85f));
+    TEST_ASSERT_EQUAL_STRING("m -0.5\n", render(-0.5));
+    TEST_ASSERT_EQUAL_STRING("m 0.001\n", render(0.001));
+}
+
+void test_labelled_sample(void) {
+    char buffer[128];
+    MetricsPage page(buffer, sizeof(buffer));
+    page.family("grow_reading", "gauge", "Latest reading");
+    page.sample("grow_reading", "channel", "pH", 6.85f);
+    TEST_ASSERT_EQUAL_STRING("# HELP grow_reading Latest reading\n"
+                             "# TYPE grow_reading gauge\n"
+                             "grow_reading{channel=\"pH\"} 6.85\n", buffer);
+    TEST_ASSERT_EQUAL(strlen(buffer), page.getLength());
+}
+
+void test_overflow_keeps_complete_lines(void) {
+    // Room for the family and the first sample, not the second
+    const char* expected = "# HELP g Help\n# TYPE g gauge\ng{c=\"a\"} 1\n";
+    char buffer[64];
+    memset(buffer, 'x', sizeof(buffer));
+    MetricsPage page(buffer, strlen(expected) + 8);
+    page.family("g", "gauge", "Help");
+    page.sample("g", "c", "a", 1);
+    TEST_ASSERT_FALSE(page.isOverflowed());
+    page.sample("g", "c", "bbbb", 2);
+    TEST_ASSERT_TRUE(page.isOverflowed());
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    assertCompleteLines(buffer, page.getLength());
+
+    // Nothing is appended once overflowed, even a line that would fit
+    page.sample("g", 3);
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    TEST_ASSERT_EQUAL(strlen(expected), page.getLength());
+}
+
+void test_overflow_sweep(void) {
+    // Every capacity: the page is a prefix of the full page cut at a line end
+    char full[512];
+    MetricsPage reference(full, sizeof(full));
+    reference.family("grow_channel_quality", "gauge", "Fault detector score 0-100");
+    reference.sample("grow_channel_quality", "channel", "temperature", 100);
+    reference.sample("grow_channel_quality", "channel", "humidity", 97.5);
+    reference.family("grow_uptime_seconds", "counter", "Seconds since boot");
+    reference.sample("grow_uptime_seconds", 86400);
+    TEST_ASSERT_FALSE(reference.isOverflowed());
+
+    for (size_t capacity = 0; capacity <= reference.getLength(); capacity++) {
+        char buffer[512];
+        MetricsPage page(buffer, capacity);
+        page.family("grow_channel_quality", "gauge", "Fault detector score 0-100");
+        page.sample("grow_channel_quality", "channel", "temperature", 100);
+        page.sample("grow_channel_quality", "channel", "humidity", 97.5);
+        page.family("grow_uptime_seconds", "counter", "Seconds since boot");
+        page.sample("grow_uptime_seconds", 86400);
+
+        // The terminator needs a byte too, so only a strictly larger buffer holds it all
+        TEST_ASSERT_TRUE(page.isOverflowed());
+        TEST_ASSERT_TRUE(page.getLength() < capacity || capacity == 0);
+        if (capacity > 0) {
+            assertCompleteLines(buffer, page.getLength());
+            TEST_ASSERT_TRUE(memcmp(buffer, full, page.getLength()) == 0);
+        }
+    }
+}
+
+void test_zero_capacity(void) {
+    char buffer[1] = { 'x' };
+    MetricsPage page(buffer, 0);
+    TEST_ASSERT_TRUE(page.isOverflowed());
+    page.sample("m", 1);
+    TEST_ASSERT_EQUAL(0, page.getLength());
+    TEST_ASSERT_TRUE(buffer[0] == 'x');
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_request_metrics);
+    RUN_TEST(test_request_query_string);
+    RUN_TEST(test_request_partial_line);
+    RUN_TEST(test_request_not_get);
+    RUN_TEST(test_request_full_buffer);
+    RUN_TEST(test_value_special);
+    RUN_TEST(test_value_integer);
+    RUN_TEST(test_value_float);
+    RUN_TEST(test_labelled_sample);
+    RUN_TEST(test_overflow_keeps_complete_lines);
+    RUN_TEST(test_overflow_sweep);
+    RUN_TEST(test_zero_capacity);
+    return UNITY_END();
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+    delay(2000);  // Let the serial monitor attach
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void) {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,1672 @@
+// MQTT collector: sensor and health messages from the fleet into a columnar store.
+//
+// Build:  g++ -std=c++11 -O2 -I../include collector.cpp -o collector
+// Usage:  collector --store DIR [--broker HOST[:PORT]] [--topic FILTER ...] [--batch ROWS]
+//                   [--flush-ms MS] [--segment-mb MB] [--report S] [--duration S]
+//         collector --store DIR --bench N [--nodes N]
+//         collector --store DIR --dump CHANNEL
+//
+// Subscribes (QoS 0) to grow/+/sensor and grow/+/device, the topics of
+// publishSensorData() and publishHealthMessage(). PUBLISH packets are parsed
+// where they sit in the receive buffer, and so are their JSON payloads (one
+// pass over the top-level members, nothing copied or allocated per message).
+// The node name is the topic level before the last one.
+//
+// Rows are batched per channel: one channel per sensor deviceType
+// ("temperature", "waterLevel", ...) plus "health". A batch is written when it
+// holds --batch rows or its oldest row is --flush-ms old. Each channel is a
+// directory of fixed-size segment files (--segment-mb). A segment is a header
+// page followed by one region per column, memory-mapped and filled by memcpy.
+// The header's row count is stored after the column data, so a reader mapping
+// the same file only sees complete rows. Full segments are synced and closed,
+// and a restarted collector continues the last segment of each channel.
+//
+//   sensor channels   ts_us (i64), node (u32), value (f32)
+//   health            ts_us, node, uptime_s, free_heap, rssi (i32), broker_rtt_ms, alarms
+//
+// ts_us is the collector's receive time (the payloads carry no timestamp).
+// Node ids index DIR/nodes.txt, one "<id>\t<name>" line per node.
+//
+// Every --report seconds it prints msgs/s, KB/s, rows written and CPU load;
+// the summary gives messages per CPU-second, i.e. what one core keeps up
+// with. --bench N feeds N messages from an in-memory stream of encoded
+// PUBLISH packets (payloads from SensorPayload.h, like fleet_sim) through
+// the same path without a broker. --dump prints a channel as CSV.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "SensorPayload.h"
+
+static const size_t SEGMENT_HEADER_BYTES = 4096;
+static const size_t COLUMN_ALIGN = 64;
+static const size_t MAX_COLUMNS = 8;
+static const size_t MAX_CHANNELS = 64;
+static const size_t MAX_NAME_LENGTH = 32;       // Channel and node names
+static const size_t RECEIVE_BUFFER_BYTES = 256 * 1024;
+static const int KEEP_ALIVE_S = 30;
+static const int64_t RECONNECT_MAX_DELAY_US = 30000000;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static int64_t monotonicUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t realtimeUs() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t processCpuUs() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// ==================== Payload Parsing ====================
+/**
+ * @brief Bytes inside a message buffer (not terminated, not owned)
+ */
+struct Slice {
+    const char* data;
+    size_t length;
+
+    bool equals(const char* text) const {
+        size_t n = strlen(text);
+        return n == length && memcmp(data, text, n) == 0;
+    }
+};
+
+static const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+// p at the opening quote; returns the closing quote, or nullptr
+static const char* findStringEnd(const char* p, const char* end) {
+    for (p++; p < end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+// End of the value starting at p (objects and arrays skipped whole), or nullptr
+static const char* skipValue(const char* p, const char* end) {
+    if (p >= end) {
+        return nullptr;
+    }
+    if (*p == '"') {
+        const char* close = findStringEnd(p, end);
+        return close != nullptr ? close + 1 : nullptr;
+    }
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        for (; p < end; p++) {
+            if (*p == '"') {
+                p = findStringEnd(p, end);
+                if (p == nullptr) {
+                    return nullptr;
+                }
+            } else if (*p == '{' || *p == '[') {
+                depth++;
+            } else if (*p == '}' || *p == ']') {
+                if (--depth == 0) {
+                    return p + 1;
+                }
+            }
+        }
+        return nullptr;
+    }
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Walks the top-level members of a JSON object in place
+ *
+ * Keys and string values come back without their quotes and with escapes
+ * left as they are; other values (numbers, nested objects) as their raw text.
+ */
+class JsonMembers {
+private:
+    const char* cur;
+    const char* end;
+    bool failed;
+
+public:
+    JsonMembers(const char* data, size_t length) : cur(data), end(data + length), failed(false) {
+        cur = skipSpace(cur, end);
+        if (cur >= end || *cur != '{') {
+            failed = true;
+        } else {
+            cur++;
+        }
+    }
+
+    /**
+     * @return false at the end of the object or on malformed input (see failed())
+     */
+    bool next(Slice& key, Slice& value) {
+        if (failed) {
+            return false;
+        }
+        cur = skipSpace(cur, end);
+        if (cur < end && *cur == ',') {
+            cur = skipSpace(cur + 1, end);
+        }
+        if (cur < end && *cur == '}') {
+            cur = end;
+            return false;
+        }
+        const char* close = cur < end && *cur == '"' ? findStringEnd(cur, end) : nullptr;
+        if (close == nullptr) {
+            failed = true;
+            return false;
+        }
+        key.data = cur + 1;
+        key.length = close - cur - 1;
+        cur = skipSpace(close + 1, end);
+        if (cur >= end || *cur != ':') {
+            failed = true;
+            return false;
+        }
+        cur = skipSpace(cur + 1, end);
+        const char* valueEnd = skipValue(cur, end);
+        if (valueEnd == nullptr || valueEnd == cur) {
+            failed = true;
+            return false;
+        }
+        bool quoted = *cur == '"';
+        value.data = quoted ? cur + 1 : cur;
+        value.length = quoted ? valueEnd - cur - 2 : valueEnd - cur;
+        cur = valueEnd;
+        return true;
+    }
+
+    bool hasFailed() const {
+        return failed;
+    }
+};
+
+/**
+ * @brief Parse a decimal number such as "-12.34" (exponents go through strtod)
+ */
+static bool parseNumber(const Slice& text, double& out) {
+    static const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    const char* p = text.data;
+    const char* end = text.data + text.length;
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int decimals = -1;
+    for (; p < end; p++) {
+        if (*p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits++;
+            if (decimals >= 0) {
+                decimals++;
+            }
+        } else if (*p == '.' && decimals < 0) {
+            decimals = 0;
+        } else {
+            break;
+        }
+    }
+    if (p < end || digits == 0 || digits > 18 || decimals > 9) {
+        // Exponent, stray characters or too many digits: take the slow path
+        char buffer[64];
+        if (text.length == 0 || text.length >= sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer, text.data, text.length);
+        buffer[text.length] = '\0';
+        char* parsed;
+        out = strtod(buffer, &parsed);
+        return parsed == buffer + text.length;
+    }
+    out = (double)mantissa / POW10[decimals > 0 ? decimals : 0];
+    if (negative) {
+        out = -out;
+    }
+    return true;
+}
+
+// Letters, digits, '_' and '-' only: channel and node names become paths and CSV fields
+static bool isSafeName(const Slice& name) {
+    if (name.length == 0 || name.length > MAX_NAME_LENGTH) {
+        return false;
+    }
+    for (size_t i = 0; i < name.length; i++) {
+        char c = name.data[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==================== Column Store ====================
+enum ColumnType : uint8_t {
+    COLUMN_I64,
+    COLUMN_U32,
+    COLUMN_I32,
+    COLUMN_F32
+};
+
+static size_t columnWidth(ColumnType type) {
+    return type == COLUMN_I64 ? 8 : 4;
+}
+
+struct Schema {
+    size_t count;
+    const char* names[MAX_COLUMNS];
+    ColumnType types[MAX_COLUMNS];
+};
+
+static const Schema SENSOR_SCHEMA = {
+    3,
+    { "ts_us", "node", "value" },
+    { COLUMN_I64, COLUMN_U32, COLUMN_F32 },
+};
+
+static const Schema HEALTH_SCHEMA = {
+    7,
+    { "ts_us", "node", "uptime_s", "free_heap", "rssi", "broker_rtt_ms", "alarms" },
+    { COLUMN_I64, COLUMN_U32, COLUMN_U32, COLUMN_U32, COLUMN_I32, COLUMN_U32, COLUMN_U32 },
+};
+
+struct ColumnDesc {
+    char name[23];
+    uint8_t type;
+    uint64_t offset;        // From the start of the file
+};
+
+/**
+ * @brief First page of a segment file
+ */
+struct SegmentHeader {
+    char magic[8];          // "GROWCOL1"
+    uint32_t version;
+    uint32_t columnCount;
+    uint64_t capacity;      // Rows the column regions hold
+    uint64_t rows;          // Committed rows, stored after their column data
+    int64_t firstUs;        // ts_us of the first and last committed row
+    int64_t lastUs;
+    ColumnDesc columns[MAX_COLUMNS];
+};
+
+static_assert(sizeof(SegmentHeader) <= SEGMENT_HEADER_BYTES, "segment header must fit its page");
+
+static const char SEGMENT_MAGIC[8] = { 'G', 'R', 'O', 'W', 'C', 'O', 'L', '1' };
+static const uint32_t SEGMENT_VERSION = 1;
+
+/**
+ * @brief One memory-mapped segment file
+ */
+class Segment {
+private:
+    uint8_t* base;
+    size_t bytes;
+    SegmentHeader* header;
+
+public:
+    Segment() : base(nullptr), bytes(0), header(nullptr) {}
+
+    ~Segment() {
+        close();
+    }
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    const SegmentHeader& getHeader() const {
+        return *header;
+    }
+
+    uint64_t committedRows() const {
+        return __atomic_load_n(&header->rows, __ATOMIC_ACQUIRE);
+    }
+
+    uint64_t freeRows() const {
+        return header->capacity - header->rows;
+    }
+
+    const uint8_t* column(size_t c) const {
+        return base + header->columns[c].offset;
+    }
+
+    /**
+     * @brief Create a new, empty segment of the given size
+     */
+    bool create(const char* path, const Schema& schema, size_t fileBytes) {
+        size_t rowBytes = 0;
+        for (size_t c = 0; c < schema.count; c++) {
+            rowBytes += columnWidth(schema.types[c]);
+        }
+        size_t usable = fileBytes - SEGMENT_HEADER_BYTES - schema.count * COLUMN_ALIGN;
+        uint64_t capacity = usable / rowBytes;
+        if (fileBytes <= SEGMENT_HEADER_BYTES + schema.count * COLUMN_ALIGN || capacity == 0) {
+            return false;
+        }
+        int fd = ::open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, (off_t)fileBytes) != 0 || !map(fd, fileBytes, true)) {
+            ::close(fd);
+            unlink(path);
+            return false;
+        }
+        ::close(fd);
+        memcpy(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+        header->version = SEGMENT_VERSION;
+        header->columnCount = (uint32_t)schema.count;
+        header->capacity = capacity;
+        uint64_t offset = SEGMENT_HEADER_BYTES;
+        for (size_t c = 0; c < schema.count; c++) {
+            ColumnDesc& desc = header->columns[c];
+            strncpy(desc.name, schema.names[c], sizeof(desc.name) - 1);
+            desc.type = schema.types[c];
+            desc.offset = offset;
+            offset += (capacity * columnWidth(schema.types[c]) + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+        }
+        __atomic_store_n(&header->rows, (uint64_t)0, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief Map an existing segment; with a schema, it must have exactly those columns
+     */
+    bool open(const char* path, const Schema* schema, bool writable) {
+        int fd = ::open(path, writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0 && (size_t)st.st_size >= SEGMENT_HEADER_BYTES &&
+                  map(fd, (size_t)st.st_size, writable);
+        ::close(fd);
+        if (!ok) {
+            return false;
+        }
+        if (memcmp(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 || header->version != SEGMENT_VERSION ||
+            header->columnCount == 0 || header->columnCount > MAX_COLUMNS || header->rows > header->capacity) {
+            close();
+            return false;
+        }
+        for (size_t c = 0; c < header->columnCount; c++) {
+            const ColumnDesc& desc = header->columns[c];
+            if (desc.type > COLUMN_F32 ||
+                desc.offset + header->capacity * columnWidth((ColumnType)desc.type) > bytes) {
+                close();
+                return false;
+            }
+        }
+        if (schema != nullptr) {
+            bool same = schema->count == header->columnCount;
+            for (size_t c = 0; same && c < schema->count; c++) {
+                same = header->columns[c].type == schema->types[c] &&
+                       strncmp(header->columns[c].name, schema->names[c], sizeof(header->columns[c].name)) == 0;
+            }
+            if (!same) {
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Copy rows [from, from + count) of the column buffers in and commit them
+     */
+    void append(const std::vector<uint8_t>* columns, size_t from, size_t count, int64_t firstUs, int64_t lastUs) {
+        uint64_t rows = header->rows;
+        for (size_t c = 0; c < header->columnCount; c++) {
+            size_t width = columnWidth((ColumnType)header->columns[c].type);
+            memcpy(base + header->columns[c].offset + rows * width, columns[c].data() + from * width, count * width);
+        }
+        if (rows == 0) {
+            header->firstUs = firstUs;
+        }
+        header->lastUs = lastUs;
+        __atomic_store_n(&header->rows, rows + count, __ATOMIC_RELEASE);
+    }
+
+    void close() {
+        if (base != nullptr) {
+            msync(base, bytes, MS_ASYNC);
+            munmap(base, bytes);
+            base = nullptr;
+            header = nullptr;
+        }
+    }
+
+private:
+    bool map(int fd, size_t fileBytes, bool writable) {
+        void* p = mmap(nullptr, fileBytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        base = (uint8_t*)p;
+        bytes = fileBytes;
+        header = (SegmentHeader*)base;
+        return true;
+    }
+};
+
+// Segment files of a channel directory, in order
+static std::vector<uint32_t> listSegments(const std::string& dir) {
+    std::vector<uint32_t> sequence;
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return sequence;
+    }
+    while (dirent* entry = readdir(d)) {
+        unsigned number;
+        char tail;
+        if (sscanf(entry->d_name, "%u.se%c", &number, &tail) == 2 && tail == 'g' && strlen(entry->d_name) == 10) {
+            sequence.push_back(number);
+        }
+    }
+    closedir(d);
+    std::sort(sequence.begin(), sequence.end());
+    return sequence;
+}
+
+static std::string segmentPath(const std::string& dir, uint32_t number) {
+    char name[16];
+    snprintf(name, sizeof(name), "/%06u.seg", number);
+    return dir + name;
+}
+
+/**
+ * @brief Column values of one row (integers and floats share the slot)
+ */
+union CellValue {
+    int64_t i;
+    double f;
+};
+
+/**
+ * @brief A channel: its pending batch and the segment being filled
+ */
+class Channel {
+private:
+    std::string name;
+    std::string dir;
+    const Schema& schema;
+    size_t segmentBytes;
+    std::vector<uint8_t> batch[MAX_COLUMNS];
+    size_t batchRows;
+    size_t pending;
+    int64_t oldestUs;           // Receive time of the first pending row (monotonic)
+    int64_t firstTs;
+    int64_t lastTs;
+    Segment segment;
+    uint32_t segmentNumber;
+
+    bool openNextSegment() {
+        segment.close();
+        segmentNumber++;
+        if (!segment.create(segmentPath(dir, segmentNumber).c_str(), schema, segmentBytes)) {
+            fprintf(stderr, "[STORE] ✗ Cannot create %s: %s\n", segmentPath(dir, segmentNumber).c_str(),
+                    strerror(errno));
+            return false;
+        }
+        segmentsCreated++;
+        return true;
+    }
+
+public:
+    uint64_t rowsWritten;
+    uint64_t rowsLost;          // Batches that could not be stored
+    uint32_t segmentsCreated;
+
+    Channel(const char* channelName, const std::string& storeDir, const Schema& columns, size_t fileBytes,
+            size_t rowsPerBatch)
+        : name(channelName), dir(storeDir + "/" + channelName), schema(columns), segmentBytes(fileBytes),
+          batchRows(rowsPerBatch), pending(0), oldestUs(0), firstTs(0), lastTs(0), segmentNumber(0),
+          rowsWritten(0), rowsLost(0), segmentsCreated(0) {
+        for (size_t c = 0; c < schema.count; c++) {
+            batch[c].resize(batchRows * columnWidth(schema.types[c]));
+        }
+    }
+
+    const std::string& getName() const {
+        return name;
+    }
+
+    /**
+     * @brief Continue the last segment of the channel, or start one
+     */
+    bool open() {
+        mkdir(dir.c_str(), 0755);
+        std::vector<uint32_t> existing = listSegments(dir);
+        if (!existing.empty()) {
+            segmentNumber = existing.back();
+            if (segment.open(segmentPath(dir, segmentNumber).c_str(), &schema, true) && segment.freeRows() > 0) {
+                return true;
+            }
+            segment.close();  // Full, or another layout: leave it and start the next one
+        }
+        return openNextSegment();
+    }
+
+    /**
+     * @brief Add a row; the batch is written once full
+     */
+    void add(const CellValue* values, int64_t receivedUs) {
+        size_t row = pending;
+        for (size_t c = 0; c < schema.count; c++) {
+            uint8_t* cell = batch[c].data() + row * columnWidth(schema.types[c]);
+            switch (schema.types[c]) {
+                case COLUMN_I64: memcpy(cell, &values[c].i, 8); break;
+                case COLUMN_U32: { uint32_t v = (uint32_t)values[c].i; memcpy(cell, &v, 4); break; }
+                case COLUMN_I32: { int32_t v = (int32_t)values[c].i; memcpy(cell, &v, 4); break; }
+                case COLUMN_F32: { float v = (float)values[c].f; memcpy(cell, &v, 4); break; }
+            }
+        }
+        if (pending == 0) {
+            oldestUs = receivedUs;
+            firstTs = values[0].i;
+        }
+        lastTs = values[0].i;
+        if (++pending == batchRows) {
+            flush();
+        }
+    }
+
+    bool isFlushDue(int64_t nowUs, int64_t maxAgeUs) const {
+        return pending > 0 && nowUs - oldestUs >= maxAgeUs;
+    }
+
+    /**
+     * @brief Write the pending rows, across segment boundaries as needed
+     */
+    void flush() {
+        size_t done = 0;
+        while (done < pending) {
+            if (!segment.isOpen() || segment.freeRows() == 0) {
+                if (!openNextSegment()) {
+                    rowsLost += pending - done;
+                    break;
+                }
+            }
+            size_t count = std::min((size_t)segment.freeRows(), pending - done);
+            segment.append(batch, done, count, firstTs, lastTs);
+            done += count;
+            rowsWritten += count;
+        }
+        pending = 0;
+    }
+
+    void close() {
+        flush();
+        segment.close();
+    }
+};
+
+/**
+ * @brief Node names to dense ids, persisted in DIR/nodes.txt
+ */
+class NodeDictionary {
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t id;        // ~0 = empty
+    };
+
+    std::vector<Entry> table;       // Open addressing, power-of-two size
+    std::vector<char> names;        // Every name, NUL-terminated
+    std::vector<uint32_t> offsets;  // id -> offset in names
+    int fd;
+
+    static uint32_t hashOf(const char* data, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    void grow() {
+        std::vector<Entry> old;
+        old.swap(table);
+        table.assign(old.empty() ? 1024 : old.size() * 2, Entry{0, ~0u});
+        for (size_t i = 0; i < old.size(); i++) {
+            if (old[i].id != ~0u) {
+                place(old[i]);
+            }
+        }
+    }
+
+    void place(const Entry& entry) {
+        size_t mask = table.size() - 1;
+        size_t slot = entry.hash & mask;
+        while (table[slot].id != ~0u) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = entry;
+    }
+
+    uint32_t insert(const char* data, size_t length, uint32_t hash) {
+        if ((offsets.size() + 1) * 2 > table.size()) {
+            grow();
+        }
+        uint32_t id = (uint32_t)offsets.size();
+        offsets.push_back((uint32_t)names.size());
+        names.insert(names.end(), data, data + length);
+        names.push_back('\0');
+        place(Entry{hash, id});
+        return id;
+    }
+
+public:
+    NodeDictionary() : fd(-1) {
+        grow();
+    }
+
+    ~NodeDictionary() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    /**
+     * @brief Load DIR/nodes.txt and keep it open for new names
+     */
+    bool open(const std::string& storeDir, bool writable) {
+        std::string path = storeDir + "/nodes.txt";
+        FILE* f = fopen(path.c_str(), "r");
+        if (f != nullptr) {
+            char line[128];
+            while (fgets(line, sizeof(line), f) != nullptr) {
+                char* tab = strchr(line, '\t');
+                if (tab == nullptr) {
+                    continue;
+                }
+                size_t length = strcspn(tab + 1, "\r\n");
+                if ((uint32_t)atol(line) != offsets.size()) {
+                    break;  // Ids are written in order; stop at a torn or foreign line
+                }
+                insert(tab + 1, length, hashOf(tab + 1, length));
+            }
+            fclose(f);
+        }
+        if (writable) {
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            return fd >= 0;
+        }
+        return true;
+    }
+
+    uint32_t lookup(const Slice& name) {
+        uint32_t hash = hashOf(name.data, name.length);
+        size_t mask = table.size() - 1;
+        for (size_t slot = hash & mask; table[slot].id != ~0u; slot = (slot + 1) & mask) {
+            const Entry& entry = table[slot];
+            if (entry.hash == hash) {
+                const char* known = &names[offsets[entry.id]];
+                if (strncmp(known, name.data, name.length) == 0 && known[name.length] == '\0') {
+                    return entry.id;
+                }
+            }
+        }
+        uint32_t id = insert(name.data, name.length, hash);
+        if (fd >= 0) {
+            char line[MAX_NAME_LENGTH + 16];
+            int n = snprintf(line, sizeof(line), "%u\t%.*s\n", id, (int)name.length, name.data);
+            if (write(fd, line, (size_t)n) != n) {
+                fprintf(stderr, "[STORE] ⚠ Could not record node %.*s\n", (int)name.length, name.data);
+            }
+        }
+        return id;
+    }
+
+    const char* nameOf(uint32_t id) const {
+        return id < offsets.size() ? &names[offsets[id]] : "?";
+    }
+
+    size_t size() const {
+        return offsets.size();
+    }
+};
+
+// ==================== Collector ====================
+struct Options {
+    std::string store;
+    std::vector<std::string> topics;
+    size_t batchRows = 4096;
+    int64_t flushUs = 1000000;
+    size_t segmentBytes = 16 << 20;
+    double reportS = 5.0;
+    double durationS = 0;       // 0 = until interrupted
+    uint64_t benchMessages = 0;
+    size_t benchNodes = 1000;
+    const char* dump = nullptr;
+    sockaddr_storage broker;
+    socklen_t brokerLength = 0;
+};
+
+struct CollectorStats {
+    uint64_t messages;
+    uint64_t bytes;             // Payload bytes
+    uint64_t sensorRows;
+    uint64_t healthRows;
+    uint64_t malformed;         // Payloads that did not parse
+    uint64_t ignored;           // Other topics, unsafe names, too many channels
+};
+
+/**
+ * @brief Turns PUBLISH payloads into channel rows
+ */
+class Collector {
+private:
+    const Options& options;
+    NodeDictionary nodes;
+    std::vector<Channel*> channels;
+    Channel* health;
+
+    Channel* findChannel(const Slice& deviceType) {
+        for (size_t i = 0; i < channels.size(); i++) {
+            if (channels[i] != health && deviceType.equals(channels[i]->getName().c_str())) {
+                return channels[i];
+            }
+        }
+        if (channels.size() >= MAX_CHANNELS || !isSafeName(deviceType) || deviceType.equals("health")) {
+            return nullptr;
+        }
+        std::string name(deviceType.data, deviceType.length);
+        Channel* channel = new Channel(name.c_str(), options.store, SENSOR_SCHEMA, options.segmentBytes,
+                                       options.batchRows);
+        if (!channel->open()) {
+            delete channel;
+            return nullptr;
+        }
+        channels.push_back(channel);
+        return channel;
+    }
+
+    void onSensor(uint32_t node, const Slice& payload, int64_t tsUs, int64_t nowUs) {
+        JsonMembers members(payload.data, payload.length);
+        Slice key, value, deviceType = { nullptr, 0 };
+        double reading = 0;
+        bool haveValue = false;
+        while (members.next(key, value)) {
+            if (key.equals("deviceType")) {
+                deviceType = value;
+            } else if (key.equals("value")) {
+                haveValue = parseNumber(value, reading);
+            }
+        }
+        if (members.hasFailed() || deviceType.data == nullptr || !haveValue) {
+            stats.malformed++;
+            return;
+        }
+        Channel* channel = findChannel(deviceType);
+        if (channel == nullptr) {
+            stats.ignored++;
+            return;
+        }
+        CellValue row[3];
+        row[0].i = tsUs;
+        row[1].i = node;
+        row[2].f = reading;
+        channel->add(row, nowUs);
+        stats.sensorRows++;
+    }
+
+    void onHealth(uint32_t node, const Slice& payload, int64_t tsUs, int64_t nowUs) {
+        static const char* const FIELDS[] = { "uptime", "freeHeap", "rssi", "brokerRtt", "alarms" };
+        CellValue row[7];
+        row[0].i = tsUs;
+        row[1].i = node;
+        for (size_t f = 0; f < 5; f++) {
+            row[2 + f].i = 0;  // Absent fields are stored as 0
+        }
+        JsonMembers members(payload.data, payload.length);
+        Slice key, value;
+        while (members.next(key, value)) {
+            for (size_t f = 0; f < 5; f++) {
+                double number;
+                if (key.equals(FIELDS[f]) && parseNumber(value, number)) {
+                    row[2 + f].i = (int64_t)number;
+                    break;
+                }
+            }
+        }
+        if (members.hasFailed()) {
+            stats.malformed++;
+            return;
+        }
+        health->add(row, nowUs);
+        stats.healthRows++;
+    }
+
+public:
+    CollectorStats stats;
+
+    explicit Collector(const Options& opts) : options(opts), health(nullptr) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    ~Collector() {
+        for (size_t i = 0; i < channels.size(); i++) {
+            delete channels[i];
+        }
+    }
+
+    bool open() {
+        mkdir(options.store.c_str(), 0755);
+        if (!nodes.open(options.store, true)) {
+            fprintf(stderr, "[STORE] ✗ Cannot open %s/nodes.txt: %s\n", options.store.c_str(), strerror(errno));
+            return false;
+        }
+        health = new Channel("health", options.store, HEALTH_SCHEMA, options.segmentBytes, options.batchRows);
+        if (!health->open()) {
+            delete health;
+            health = nullptr;
+            return false;
+        }
+        channels.push_back(health);
+        return true;
+    }
+
+    /**
+     * @brief One message from grow/<node>/sensor or grow/<node>/device
+     */
+    void onPublish(const Slice& topic, const Slice& payload, int64_t nowUs) {
+        stats.messages++;
+        stats.bytes += payload.length;
+        const char* end = topic.data + topic.length;
+        const char* last = (const char*)memrchr(topic.data, '/', topic.length);
+        const char* previous = last != nullptr ? (const char*)memrchr(topic.data, '/', last - topic.data) : nullptr;
+        if (previous == nullptr) {
+            stats.ignored++;
+            return;
+        }
+        Slice kind = { last + 1, (size_t)(end - last - 1) };
+        Slice nodeName = { previous + 1, (size_t)(last - previous - 1) };
+        bool sensor = kind.equals("sensor");
+        if ((!sensor && !kind.equals("device")) || !isSafeName(nodeName)) {
+            stats.ignored++;
+            return;
+        }
+        uint32_t node = nodes.lookup(nodeName);
+        int64_t tsUs = realtimeUs();
+        if (sensor) {
+            onSensor(node, payload, tsUs, nowUs);
+        } else {
+            onHealth(node, payload, tsUs, nowUs);
+        }
+    }
+
+    /**
+     * @brief Write batches whose oldest row is older than --flush-ms
+     */
+    void flushDue(int64_t nowUs) {
+        for (size_t i = 0; i < channels.size(); i++) {
+            if (channels[i]->isFlushDue(nowUs, options.flushUs)) {
+                channels[i]->flush();
+            }
+        }
+    }
+
+    void close() {
+        for (size_t i = 0; i < channels.size(); i++) {
+            channels[i]->close();
+        }
+    }
+
+    uint64_t rowsWritten() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < channels.size(); i++) {
+            total += channels[i]->rowsWritten;
+        }
+        return total;
+    }
+
+    uint64_t rowsLost() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < channels.size(); i++) {
+            total += channels[i]->rowsLost;
+        }
+        return total;
+    }
+
+    uint32_t segmentsCreated() const {
+        uint32_t total = 0;
+        for (size_t i = 0; i < channels.size(); i++) {
+            total += channels[i]->segmentsCreated;
+        }
+        return total;
+    }
+
+    size_t nodeCount() const {
+        return nodes.size();
+    }
+
+    size_t channelCount() const {
+        return channels.size();
+    }
+};
+
+// ==================== MQTT ====================
+static void putLength(std::string& out, size_t length) {
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        out.push_back((char)(length > 0 ? digit | 0x80 : digit));
+    } while (length > 0);
+}
+
+static void putString(std::string& out, const char* text, size_t length) {
+    out.push_back((char)(length >> 8));
+    out.push_back((char)length);
+    out.append(text, length);
+}
+
+// CONNECT, MQTT 3.1.1, clean session
+static void encodeConnect(std::string& out, const char* clientId) {
+    std::string body;
+    putString(body, "MQTT", 4);
+    body.push_back(4);
+    body.push_back(0x02);
+    body.push_back((char)(KEEP_ALIVE_S >> 8));
+    body.push_back((char)KEEP_ALIVE_S);
+    putString(body, clientId, strlen(clientId));
+    out.push_back(0x10);
+    putLength(out, body.size());
+    out += body;
+}
+
+static void encodeSubscribe(std::string& out, const std::vector<std::string>& filters) {
+    std::string body;
+    body.push_back(0);
+    body.push_back(1);      // Packet id
+    for (size_t i = 0; i < filters.size(); i++) {
+        putString(body, filters[i].data(), filters[i].size());
+        body.push_back(0);  // QoS 0
+    }
+    out.push_back((char)0x82);
+    putLength(out, body.size());
+    out += body;
+}
+
+static void encodePublish(std::string& out, const char* topic, const char* payload, size_t length) {
+    size_t topicLength = strlen(topic);
+    out.push_back(0x30);
+    putLength(out, 2 + topicLength + length);
+    putString(out, topic, topicLength);
+    out.append(payload, length);
+}
+
+/**
+ * @brief Receive buffer that hands out complete MQTT packets in place
+ */
+class PacketReader {
+private:
+    std::vector<uint8_t> buffer;
+    size_t filled;
+    size_t consumed;
+
+public:
+    PacketReader() : buffer(RECEIVE_BUFFER_BYTES), filled(0), consumed(0) {}
+
+    void reset() {
+        filled = 0;
+        consumed = 0;
+    }
+
+    /**
+     * @brief Room for the next read (earlier packets moved out of the way first)
+     */
+    uint8_t* space(size_t& length) {
+        if (consumed > 0) {
+            memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+            filled -= consumed;
+            consumed = 0;
+        }
+        if (filled == buffer.size()) {
+            buffer.resize(buffer.size() * 2);  // A packet larger than the buffer
+        }
+        length = buffer.size() - filled;
+        return buffer.data() + filled;
+    }
+
+    void commit(size_t length) {
+        filled += length;
+    }
+
+    /**
+     * @brief Next complete packet: first byte, and body (after the remaining length)
+     * @return false if no complete packet is buffered
+     */
+    bool next(uint8_t& header, const uint8_t*& body, size_t& length) {
+        const uint8_t* p = buffer.data() + consumed;
+        size_t available = filled - consumed;
+        if (available < 2) {
+            return false;
+        }
+        size_t remaining = 0;
+        size_t used = 1;
+        int shift = 0;
+        while (true) {
+            if (used >= available || used > 4) {
+                return false;  // Length incomplete (a 5th length byte is a protocol error the broker never sends)
+            }
+            uint8_t digit = p[used++];
+            remaining |= (size_t)(digit & 0x7F) << shift;
+            shift += 7;
+            if ((digit & 0x80) == 0) {
+                break;
+            }
+        }
+        if (available - used < remaining) {
+            if (used + remaining > buffer.size()) {
+                buffer.resize(used + remaining);
+            }
+            return false;
+        }
+        header = p[0];
+        body = p + used;
+        length = remaining;
+        consumed += used + remaining;
+        return true;
+    }
+};
+
+/**
+ * @brief Split a PUBLISH body into topic and payload (and the packet id for QoS 1/2)
+ */
+static bool parsePublish(uint8_t header, const uint8_t* body, size_t length, Slice& topic, Slice& payload,
+                         uint16_t& packetId) {
+    if (length < 2) {
+        return false;
+    }
+    size_t topicLength = (size_t)body[0] << 8 | body[1];
+    size_t offset = 2 + topicLength;
+    uint8_t qos = (header >> 1) & 0x03;
+    if (qos > 0) {
+        if (offset + 2 > length) {
+            return false;
+        }
+        packetId = (uint16_t)(body[offset] << 8 | body[offset + 1]);
+        offset += 2;
+    }
+    if (offset > length) {
+        return false;
+    }
+    topic.data = (const char*)body + 2;
+    topic.length = topicLength;
+    payload.data = (const char*)body + offset;
+    payload.length = length - offset;
+    return true;
+}
+
+/**
+ * @brief Subscription to the broker: connect, subscribe, read, keep alive
+ */
+class Subscriber {
+private:
+    const Options& options;
+    Collector& collector;
+    PacketReader reader;
+    int fd;
+    bool subscribed;
+    int64_t lastPingUs;
+    bool pingOutstanding;
+    char clientId[32];
+
+    bool sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            sent += (size_t)n;
+        }
+        return true;
+    }
+
+    bool handle(uint8_t header, const uint8_t* body, size_t length, int64_t nowUs) {
+        switch (header >> 4) {
+            case 2:  // CONNACK
+                if (length < 2 || body[1] != 0) {
+                    fprintf(stderr, "[MQTT] ✗ Connection refused, code %d\n", length >= 2 ? body[1] : -1);
+                    return false;
+                }
+                return true;
+            case 3: {  // PUBLISH
+                Slice topic, payload;
+                uint16_t packetId = 0;
+                if (!parsePublish(header, body, length, topic, payload, packetId)) {
+                    return false;
+                }
+                collector.onPublish(topic, payload, nowUs);
+                if (((header >> 1) & 0x03) == 1) {
+                    std::string puback;
+                    puback.push_back(0x40);
+                    puback.push_back(2);
+                    puback.push_back((char)(packetId >> 8));
+                    puback.push_back((char)packetId);
+                    return sendAll(puback);
+                }
+                return true;
+            }
+            case 9:  // SUBACK
+                for (size_t i = 2; i < length; i++) {
+                    if (body[i] == 0x80) {
+                        fprintf(stderr, "[MQTT] ✗ Subscription to %s refused\n", options.topics[i - 2].c_str());
+                        return false;
+                    }
+                }
+                subscribed = true;
+                fprintf(stderr, "[MQTT] ✓ Subscribed to %zu topic filter(s)\n", options.topics.size());
+                return true;
+            case 13:  // PINGRESP
+                pingOutstanding = false;
+                return true;
+            default:
+                return true;
+        }
+    }
+
+public:
+    Subscriber(const Options& opts, Collector& sink) : options(opts), collector(sink), fd(-1), subscribed(false),
+                                                       lastPingUs(0), pingOutstanding(false) {
+        snprintf(clientId, sizeof(clientId), "grow-collector-%d", (int)getpid());
+    }
+
+    ~Subscriber() {
+        disconnect();
+    }
+
+    bool isConnected() const {
+        return fd >= 0;
+    }
+
+    bool connect() {
+        fd = socket(options.broker.ss_family, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int size = 4 << 20;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        if (::connect(fd, (const sockaddr*)&options.broker, options.brokerLength) != 0) {
+            disconnect();
+            return false;
+        }
+        std::string out;
+        encodeConnect(out, clientId);
+        encodeSubscribe(out, options.topics);
+        if (!sendAll(out)) {
+            disconnect();
+            return false;
+        }
+        reader.reset();
+        subscribed = false;
+        pingOutstanding = false;
+        lastPingUs = monotonicUs();
+        return true;
+    }
+
+    void disconnect() {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    /**
+     * @brief Wait up to timeoutMs for data and handle every complete packet
+     * @return false if the connection is gone
+     */
+    bool service(int timeoutMs) {
+        int64_t nowUs = monotonicUs();
+        if (nowUs - lastPingUs >= (int64_t)KEEP_ALIVE_S * 500000) {
+            if (pingOutstanding) {
+                fprintf(stderr, "[MQTT] ✗ No PINGRESP from the broker\n");
+                return false;
+            }
+            static const std::string PINGREQ("\xC0\x00", 2);
+            if (!sendAll(PINGREQ)) {
+                return false;
+            }
+            lastPingUs = nowUs;
+            pingOutstanding = true;
+        }
+        pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready < 0) {
+            return errno == EINTR;
+        }
+        if (ready == 0) {
+            return true;
+        }
+        size_t room;
+        uint8_t* space = reader.space(room);
+        ssize_t n = recv(fd, space, room, 0);
+        if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+            fprintf(stderr, "[MQTT] ✗ Connection closed by the broker\n");
+            return false;
+        }
+        if (n < 0) {
+            return true;
+        }
+        reader.commit((size_t)n);
+        nowUs = monotonicUs();
+        uint8_t header;
+        const uint8_t* body;
+        size_t length;
+        while (reader.next(header, body, length)) {
+            if (!handle(header, body, length, nowUs)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// ==================== Benchmark ====================
+// A publishHealthMessage() payload with every section the firmware can send, in
+// the order it adds them (see src/main.cpp, MemoryTelemetry::report() and
+// StallMonitor::report()), with typical values: ArduinoJson's compact output,
+// all four channels, MEMORY_COUNT_ALLOCATIONS, PSRAM, MEMORY_WATCHED_TASKS and a
+// nested stall trail. Node-specific numbers vary so payloads differ per node.
+static size_t formatHealthPayload(char* buffer, size_t size, const char* node, unsigned long uptimeS,
+                                  unsigned freeHeap, int rssi) {
+    int n = snprintf(buffer, size,
+                     "{\"deviceId\":\"%s\",\"status\":\"online\",\"uptime\":%lu,\"firmwareVersion\":\"%s\","
+                     "\"freeHeap\":%u,\"rssi\":%d,\"broker\":\"broker.local\",\"brokerRtt\":12,\"alarms\":0,"
+                     // sensors: state, quality, fault per channel
+                     "\"sensors\":{\"temperature\":{\"state\":\"ok\",\"quality\":98,\"fault\":\"none\"},"
+                     "\"humidity\":{\"state\":\"ok\",\"quality\":97,\"fault\":\"none\"},"
+                     "\"waterLevel\":{\"state\":\"degraded\",\"quality\":24,\"fault\":\"stuck\"},"
+                     "\"pH\":{\"state\":\"ok\",\"quality\":99,\"fault\":\"none\"}},"
+                     // recovery: per supervised sensor
+                     "\"recovery\":{\"SHT30\":{\"n\":0,\"ms\":0},\"HC-SR04\":{\"n\":1,\"ms\":2100},"
+                     "\"pH\":{\"n\":0,\"ms\":0}},"
+                     "\"acquisition\":{\"trigger\":410,\"wait\":15200,\"collect\":830,\"total\":16440,"
+                     "\"serial\":31800},"
+                     "\"outbound\":{\"depth\":[0,1,4,0],\"dropped\":[0,0,0,0],\"latency\":[3,8,20,0]},"
+                     "\"transport\":{\"packets\":21,\"writes\":6,\"bytes\":3312},"
+                     "\"outliersRejected\":{\"waterLevel\":%u},"
+                     // MemoryTelemetry::report()
+                     "\"memory\":{\"free\":%u,\"minFree\":151220,\"largest\":110580,\"minLargest\":94196,"
+                     "\"frag\":39,\"allocDelta\":148,\"blocksDelta\":1,\"allocsPerMin\":2210,"
+                     "\"allocKBPerMin\":96,\"psramFree\":3921416,\"psramMinFree\":3915228,"
+                     "\"stacks\":{\"loopTask\":4380,\"ota\":5120,\"tiT\":1768,\"wifi\":2096}},"
+                     // StallMonitor::report(): STALL_TRAIL_DEPTH nested stages
+                     "\"stall\":{\"n\":2,\"ms\":3120,\"at\":%lu,\"reset\":false,"
+                     "\"trail\":\"sensors@400d2f14>wait:SHT30@400d3a08>mqttLoop@400e1b40>outbound:alarm@400e2c88\"}}",
+                     node, uptimeS, FIRMWARE_VERSION, freeHeap, rssi, (unsigned)(uptimeS / 600), freeHeap,
+                     uptimeS - 240);
+    return n > 0 && (size_t)n < size ? (size_t)n : 0;
+}
+
+/**
+ * @brief Feed messages from memory through the receive path and time it
+ *
+ * One round is a publish interval of every node: four sensor messages each,
+ * and a health message every fourth round (SENSOR_PUBLISH_INTERVAL against
+ * HEALTH_MSG_INTERVAL). Rounds are encoded once and replayed.
+ */
+static int runBench(const Options& options, Collector& collector) {
+    static const struct {
+        const char* deviceType;
+        const char* label;
+        int decimals;
+        float base;
+    } CHANNELS[] = {
+        { "temperature", "temperature", 2, 21.5f },
+        { "humidity", "humidity", 2, 58.0f },
+        { "waterLevel", "water level", 1, 27.3f },
+        { "pH", "pH sensor", 2, 6.05f },
+    };
+    std::string stream;
+    uint64_t perPass = 0;
+    size_t healthBytes = 0;
+    for (int round = 0; round < 4; round++) {
+        for (size_t n = 0; n < options.benchNodes; n++) {
+            char topic[64];
+            char node[24];
+            char payload[OUTBOUND_SLOT_BYTES];  // The firmware's limit for the health message
+            snprintf(node, sizeof(node), "sim%zu", n);
+            snprintf(topic, sizeof(topic), "grow/%s/sensor", node);
+            for (size_t c = 0; c < 4; c++) {
+                float value = CHANNELS[c].base + 0.01f * (float)((n * 7 + round * 3 + c) % 50);
+                size_t length = formatSensorPayload(payload, sizeof(payload), CHANNELS[c].deviceType, value,
+                                                    CHANNELS[c].decimals, CHANNELS[c].label);
+                encodePublish(stream, topic, payload, length);
+                perPass++;
+            }
+            if (round == 0) {
+                snprintf(topic, sizeof(topic), "grow/%s/device", node);
+                size_t length = formatHealthPayload(payload, sizeof(payload), node, 3600 + n, 210000 - (unsigned)n,
+                                                    -60 - (int)(n % 20));
+                if (length == 0) {
+                    fprintf(stderr, "bench: health payload exceeds OUTBOUND_SLOT_BYTES (%d)\n", OUTBOUND_SLOT_BYTES);
+                    return 1;
+                }
+                healthBytes = std::max(healthBytes, length);
+                encodePublish(stream, topic, payload, length);
+                perPass++;
+            }
+        }
+    }
+    fprintf(stderr, "bench: %zu nodes, %llu messages (%.1f MB) per pass, %llu messages, health payload %zu bytes\n",
+            options.benchNodes, (unsigned long long)perPass, stream.size() / 1048576.0,
+            (unsigned long long)options.benchMessages, healthBytes);
+
+    // Same reader as the socket path, filled in recv()-sized chunks
+    PacketReader reader;
+    int64_t wallStart = monotonicUs();
+    int64_t cpuStart = processCpuUs();
+    size_t offset = 0;
+    while (collector.stats.messages < options.benchMessages) {
+        size_t room;
+        uint8_t* space = reader.space(room);
+        size_t n = std::min(room, std::min((size_t)65536, stream.size() - offset));
+        memcpy(space, stream.data() + offset, n);
+        reader.commit(n);
+        offset = (offset + n) % stream.size();
+        int64_t nowUs = monotonicUs();
+        uint8_t header;
+        const uint8_t* body;
+        size_t length;
+        while (collector.stats.messages < options.benchMessages && reader.next(header, body, length)) {
+            Slice topic, payload;
+            uint16_t packetId;
+            if (parsePublish(header, body, length, topic, payload, packetId)) {
+                collector.onPublish(topic, payload, nowUs);
+            }
+        }
+        collector.flushDue(nowUs);
+    }
+    collector.close();
+    double wallS = (monotonicUs() - wallStart) / 1e6;
+    double cpuS = (processCpuUs() - cpuStart) / 1e6;
+    const CollectorStats& stats = collector.stats;
+    printf("%llu messages (%.1f MB of payload) in %.2f s, %.2f CPU-s\n", (unsigned long long)stats.messages,
+           stats.bytes / 1048576.0, wallS, cpuS);
+    printf("%.0f msgs per CPU-second (one core), %.0f ns per message, %.1f MB/s of payload\n",
+           stats.messages / cpuS, cpuS * 1e9 / stats.messages, stats.bytes / 1048576.0 / cpuS);
+    printf("%llu sensor rows, %llu health rows written, %llu malformed, %u segment(s) created, %zu nodes\n",
+           (unsigned long long)stats.sensorRows, (unsigned long long)stats.healthRows,
+           (unsigned long long)stats.malformed, collector.segmentsCreated(), collector.nodeCount());
+    return stats.malformed == 0 && collector.rowsLost() == 0 ? 0 : 1;
+}
+
+// ==================== Dump ====================
+static int runDump(const Options& options) {
+    NodeDictionary nodes;
+    nodes.open(options.store, false);
+    std::string dir = options.store + "/" + options.dump;
+    std::vector<uint32_t> sequence = listSegments(dir);
+    if (sequence.empty()) {
+        fprintf(stderr, "no segments in %s\n", dir.c_str());
+        return 1;
+    }
+    uint64_t total = 0;
+    size_t fileBytes = 0;
+    for (size_t s = 0; s < sequence.size(); s++) {
+        std::string path = segmentPath(dir, sequence[s]);
+        Segment segment;
+        if (!segment.open(path.c_str(), nullptr, false)) {
+            fprintf(stderr, "skipping %s: not a segment\n", path.c_str());
+            continue;
+        }
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) {
+            fileBytes += (size_t)st.st_size;
+        }
+        const SegmentHeader& header = segment.getHeader();
+        if (s == 0) {
+            for (size_t c = 0; c < header.columnCount; c++) {
+                printf("%s%s", c > 0 ? "," : "", header.columns[c].name);
+            }
+            printf("\n");
+        }
+        uint64_t rows = segment.committedRows();
+        for (uint64_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < header.columnCount; c++) {
+                const uint8_t* cell = segment.column(c) + r * columnWidth((ColumnType)header.columns[c].type);
+                const char* separator = c > 0 ? "," : "";
+                bool isNode = strcmp(header.columns[c].name, "node") == 0;
+                switch (header.columns[c].type) {
+                    case COLUMN_I64: { int64_t v; memcpy(&v, cell, 8); printf("%s%lld", separator, (long long)v); break; }
+                    case COLUMN_U32: {
+                        uint32_t v;
+                        memcpy(&v, cell, 4);
+                        if (isNode) {
+                            printf("%s%s", separator, nodes.nameOf(v));
+                        } else {
+                            printf("%s%u", separator, v);
+                        }
+                        break;
+                    }
+                    case COLUMN_I32: { int32_t v; memcpy(&v, cell, 4); printf("%s%d", separator, v); break; }
+                    case COLUMN_F32: { float v; memcpy(&v, cell, 4); printf("%s%g", separator, v); break; }
+                }
+            }
+            printf("\n");
+        }
+        total += rows;
+    }
+    fprintf(stderr, "%llu rows in %zu segment(s), %.1f MB on disk\n", (unsigned long long)total, sequence.size(),
+            fileBytes / 1048576.0);
+    return 0;
+}
+
+// ==================== Main ====================
+static bool resolveBroker(const char* spec, Options& options) {
+    std::string host = spec;
+    std::string port = "1883";
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        fprintf(stderr, "cannot resolve broker %s\n", spec);
+        return false;
+    }
+    memcpy(&options.broker, result->ai_addr, result->ai_addrlen);
+    options.brokerLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s --store DIR [--broker HOST[:PORT]] [--topic FILTER ...] [--batch ROWS]\n"
+            "          [--flush-ms MS] [--segment-mb MB] [--report S] [--duration S]\n"
+            "       %s --store DIR --bench N [--nodes N]\n"
+            "       %s --store DIR --dump CHANNEL\n", name, name, name);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    const char* broker = "localhost:1883";
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--store") == 0 && hasValue) {
+            options.store = argv[++i];
+        } else if (strcmp(arg, "--broker") == 0 && hasValue) {
+            broker = argv[++i];
+        } else if (strcmp(arg, "--topic") == 0 && hasValue) {
+            options.topics.push_back(argv[++i]);
+        } else if (strcmp(arg, "--batch") == 0 && hasValue) {
+            options.batchRows = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--flush-ms") == 0 && hasValue) {
+            options.flushUs = (int64_t)strtoul(argv[++i], nullptr, 10) * 1000;
+        } else if (strcmp(arg, "--segment-mb") == 0 && hasValue) {
+            options.segmentBytes = (size_t)(atof(argv[++i]) * 1048576);
+        } else if (strcmp(arg, "--report") == 0 && hasValue) {
+            options.reportS = atof(argv[++i]);
+        } else if (strcmp(arg, "--duration") == 0 && hasValue) {
+            options.durationS = atof(argv[++i]);
+        } else if (strcmp(arg, "--bench") == 0 && hasValue) {
+            options.benchMessages = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--nodes") == 0 && hasValue) {
+            options.benchNodes = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--dump") == 0 && hasValue) {
+            options.dump = argv[++i];
+        } else {
+            usage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 1;
+        }
+    }
+    if (options.store.empty() || options.batchRows == 0 || options.reportS <= 0 || options.benchNodes == 0 ||
+        options.segmentBytes < SEGMENT_HEADER_BYTES * 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (options.dump != nullptr) {
+        return runDump(options);
+    }
+    if (options.topics.empty()) {
+        options.topics.push_back("grow/+/sensor");
+        options.topics.push_back("grow/+/device");
+    }
+
+    Collector collector(options);
+    if (!collector.open()) {
+        return 1;
+    }
+    if (options.benchMessages > 0) {
+        return runBench(options, collector);
+    }
+    if (!resolveBroker(broker, options)) {
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    Subscriber subscriber(options, collector);
+    int64_t origin = monotonicUs();
+    int64_t end = options.durationS > 0 ? origin + (int64_t)(options.durationS * 1e6) : INT64_MAX;
+    int64_t reconnectAt = origin;
+    int64_t reconnectDelay = 1000000;
+    int64_t lastReport = origin;
+    int64_t lastCpu = processCpuUs();
+    int64_t cpuStart = lastCpu;
+    CollectorStats last = collector.stats;
+    uint64_t lastRows = 0;
+    fprintf(stderr, "collecting into %s from %s, batches of %zu rows or %lld ms, %.0f MB segments\n",
+            options.store.c_str(), broker, options.batchRows, (long long)(options.flushUs / 1000),
+            options.segmentBytes / 1048576.0);
+
+    while (!stopRequested && monotonicUs() < end) {
+        int64_t now = monotonicUs();
+        if (!subscriber.isConnected()) {
+            if (now >= reconnectAt) {
+                if (subscriber.connect()) {
+                    fprintf(stderr, "[MQTT] ✓ Connected to %s\n", broker);
+                    reconnectDelay = 1000000;
+                } else {
+                    fprintf(stderr, "[MQTT] ✗ Cannot connect to %s, retrying in %lld s\n", broker,
+                            (long long)(reconnectDelay / 1000000));
+                    reconnectAt = now + reconnectDelay;
+                    reconnectDelay = std::min(reconnectDelay * 2, RECONNECT_MAX_DELAY_US);
+                }
+            }
+            collector.flushDue(now);
+            if (!subscriber.isConnected()) {
+                usleep(100000);
+                continue;
+            }
+        }
+        // Wake up for the next flush deadline at the latest
+        int timeoutMs = (int)std::max<int64_t>(1, std::min<int64_t>(options.flushUs / 4000, 250));
+        if (!subscriber.service(timeoutMs)) {
+            subscriber.disconnect();
+            reconnectAt = monotonicUs() + reconnectDelay;
+        }
+        now = monotonicUs();
+        collector.flushDue(now);
+
+        if (now - lastReport >= (int64_t)(options.reportS * 1e6)) {
+            double seconds = (now - lastReport) / 1e6;
+            int64_t cpu = processCpuUs();
+            const CollectorStats& stats = collector.stats;
+            uint64_t rows = collector.rowsWritten();
+            printf("[%6.0f s] %7.0f msgs/s %8.1f KB/s | %7.0f rows/s written | CPU %5.1f%% | "
+                   "%zu nodes, %zu channels | malformed %llu, ignored %llu\n",
+                   (now - origin) / 1e6, (stats.messages - last.messages) / seconds,
+                   (stats.bytes - last.bytes) / seconds / 1024.0, (rows - lastRows) / seconds,
+                   100.0 * (cpu - lastCpu) / (now - lastReport), collector.nodeCount(), collector.channelCount(),
+                   (unsigned long long)stats.malformed, (unsigned long long)stats.ignored);
+            fflush(stdout);
+            last = stats;
+            lastRows = rows;
+            lastCpu = cpu;
+            lastReport = now;
+        }
+    }
+    collector.close();
+
+    double wallS = (monotonicUs() - origin) / 1e6;
+    double cpuS = (processCpuUs() - cpuStart) / 1e6;
+    const CollectorStats& stats = collector.stats;
+    printf("\n%llu messages in %.1f s (%.0f msgs/s), %llu sensor and %llu health rows written, %llu lost\n",
+           (unsigned long long)stats.messages, wallS, stats.messages / wallS, (unsigned long long)stats.sensorRows,
+           (unsigned long long)stats.healthRows, (unsigned long long)collector.rowsLost());
+    if (cpuS > 0 && stats.messages > 0) {
+        printf("CPU %.2f s: %.0f msgs per CPU-second (one core), %.0f ns per message\n", cpuS,
+               stats.messages / cpuS, cpuS * 1e9 / stats.messages);
+    }
+    return 0;
+}
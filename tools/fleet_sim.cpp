@@ -0,0 +1,662 @@
+// Fleet simulator: many virtual sensor nodes publishing to an MQTT broker.
+//
+// Build:  g++ -std=c++11 -O2 -pthread -Isim -I../include fleet_sim.cpp -o fleet_sim
+// Usage:  fleet_sim [--nodes N] [--threads N] [--speed X] [--duration S] [--report S]
+//                   [--broker HOST[:PORT] | --dry-run] [--prefix NAME] [--seed N] [--log]
+//
+// Every node runs the firmware's own SHT30Sensor, HC_SR04Sensor and PHSensor
+// (filter pipelines, moving averages) on the host shim in sim/, against
+// synthetic signals: a diurnal temperature/humidity cycle, a slowly draining
+// reservoir and drifting pH, with NACKs, lost echoes and multipath spikes.
+// Each node has its own virtual clock; reads follow the loop() cadence
+// (SENSOR_READ_INTERVAL / SENSOR_PUBLISH_INTERVAL) and --speed scales node
+// time against wall time. Sensor messages are formatted by SensorPayload.h
+// and published with QoS 0 on grow/<prefix><n>/sensor, one MQTT connection
+// per node (raise `ulimit -n` for large fleets).
+//
+// Nodes are spread over --threads workers, each an epoll event loop with a
+// timer heap. Every --report seconds it prints msgs/s, the CPU cost of a
+// node's work (sensor cycle, publish), worker load and scheduling lag, and at
+// the end how many nodes one core keeps up with in real time.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "config.h"
+#include "RuntimeSettings.h"
+#include "TraceRecorder.h"
+#include "SHT30Sensor.h"
+#include "HC_SR04Sensor.h"
+#include "PHSensor.h"
+#include "SensorPayload.h"
+#include "SimNode.h"
+
+// Globals the drivers expect from main.cpp (shared read-only by every node)
+SimSerial Serial;
+TwoWire Wire;
+TraceRecorder traceRecorder;
+RuntimeSettings runtimeSettings = RuntimeSettings::defaults();
+
+// Stand-in for servicing MQTT while conversions run (readSensors() phase 2)
+static const int64_t WAIT_STEP_US = 250;
+
+// Unsent bytes per connection before messages are dropped (broker not keeping up)
+static const size_t MAX_BACKLOG_BYTES = 64 * 1024;
+
+static const int64_t RECONNECT_DELAY_NS = 1000000000LL;
+
+static int64_t wallNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ==================== MQTT ====================
+static void putLength(std::string& out, size_t length) {
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        out.push_back((char)(length > 0 ? digit | 0x80 : digit));
+    } while (length > 0);
+}
+
+static void putString(std::string& out, const char* text, size_t length) {
+    out.push_back((char)(length >> 8));
+    out.push_back((char)length);
+    out.append(text, length);
+}
+
+// CONNECT, MQTT 3.1.1, clean session, keep alive off (the simulator never pings)
+static void encodeConnect(std::string& out, const char* clientId) {
+    std::string body;
+    putString(body, "MQTT", 4);
+    body.push_back(4);
+    body.push_back(0x02);
+    body.push_back(0);
+    body.push_back(0);
+    putString(body, clientId, strlen(clientId));
+    out.push_back(0x10);
+    putLength(out, body.size());
+    out += body;
+}
+
+static void encodePublish(std::string& out, const char* topic, const char* payload, size_t length) {
+    size_t topicLength = strlen(topic);
+    out.push_back(0x30);
+    putLength(out, 2 + topicLength + length);
+    putString(out, topic, topicLength);
+    out.append(payload, length);
+}
+
+// ==================== Nodes ====================
+struct Node {
+    NodeHardware hardware;
+    SHT30Sensor sht30;
+    HC_SR04Sensor waterLevel;
+    PHSensor ph;
+    char clientId[32];
+    char topic[64];
+
+    int fd;
+    bool connecting;
+    bool writable;          // EPOLLOUT registered
+    std::string out;
+    size_t outSent;
+
+    int64_t nextReadUs;     // Virtual time of the next read / publish
+    int64_t nextPublishUs;
+    int64_t virtualOriginUs;
+
+    Node(uint64_t seed)
+        : hardware(seed), waterLevel(HC_SR04_TRIG_PIN, HC_SR04_ECHO_PIN), ph(PH_SENSOR_PIN), fd(-1),
+          connecting(false), writable(false), outSent(0), nextReadUs(0), nextPublishUs(0), virtualOriginUs(0) {}
+};
+
+struct Options {
+    size_t nodes = 100;
+    size_t threads = 1;
+    double speed = 1.0;
+    double durationS = 60.0;
+    double reportS = 5.0;
+    bool dryRun = false;
+    bool log = false;
+    uint64_t seed = 1;
+    std::string prefix = "sim";
+    sockaddr_storage broker;
+    socklen_t brokerLength = 0;
+};
+
+/**
+ * @brief Counters shared with the reporting thread
+ */
+struct WorkerStats {
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> readCpuNs{0};
+    std::atomic<uint64_t> publishes{0};
+    std::atomic<uint64_t> publishCpuNs{0};
+    std::atomic<uint64_t> nodeUs{0};        // Virtual node time covered (node-microseconds)
+    std::atomic<uint64_t> maxLagNs{0};      // Since the last report
+    std::atomic<uint64_t> connected{0};
+    std::atomic<uint64_t> connectFailures{0};
+};
+
+/**
+ * @brief Event loop for a share of the fleet
+ */
+class Worker {
+private:
+    enum EventKind { EVENT_ACTION, EVENT_RECONNECT };
+
+    struct Event {
+        int64_t wallNs;
+        size_t node;
+        EventKind kind;
+        bool operator>(const Event& other) const {
+            return wallNs > other.wallNs;
+        }
+    };
+
+    const Options& options;
+    std::vector<std::unique_ptr<Node> > nodes;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > timers;
+    int epollFd;
+    int64_t wallOriginNs;
+
+    int64_t toWall(const Node& node, int64_t virtualUs) const {
+        return wallOriginNs + (int64_t)((virtualUs - node.virtualOriginUs) * 1000.0 / options.speed);
+    }
+
+    void scheduleAction(size_t index) {
+        Node& node = *nodes[index];
+        int64_t next = std::min(node.nextReadUs, node.nextPublishUs);
+        timers.push(Event{toWall(node, next), index, EVENT_ACTION});
+    }
+
+    void closeConnection(size_t index, bool retry) {
+        Node& node = *nodes[index];
+        if (node.fd < 0) {
+            return;
+        }
+        if (!node.connecting) {
+            stats.connected--;
+        }
+        close(node.fd);
+        node.fd = -1;
+        node.out.clear();
+        node.outSent = 0;
+        if (retry) {
+            stats.connectFailures++;
+            timers.push(Event{wallNs() + RECONNECT_DELAY_NS, index, EVENT_RECONNECT});
+        }
+    }
+
+    void updateInterest(size_t index, bool wantWrite) {
+        Node& node = *nodes[index];
+        if (node.writable == wantWrite) {
+            return;
+        }
+        epoll_event ev;
+        ev.events = EPOLLIN | (wantWrite ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.u64 = index;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, node.fd, &ev);
+        node.writable = wantWrite;
+    }
+
+    void connectNode(size_t index) {
+        Node& node = *nodes[index];
+        int fd = socket(options.broker.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            stats.connectFailures++;
+            timers.push(Event{wallNs() + RECONNECT_DELAY_NS, index, EVENT_RECONNECT});
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fd, (const sockaddr*)&options.broker, options.brokerLength) != 0 && errno != EINPROGRESS) {
+            close(fd);
+            stats.connectFailures++;
+            timers.push(Event{wallNs() + RECONNECT_DELAY_NS, index, EVENT_RECONNECT});
+            return;
+        }
+        node.fd = fd;
+        node.connecting = true;
+        node.writable = true;
+        node.out.clear();
+        node.outSent = 0;
+        encodeConnect(node.out, node.clientId);
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u64 = index;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void flush(size_t index) {
+        Node& node = *nodes[index];
+        while (node.outSent < node.out.size()) {
+            ssize_t n = send(node.fd, node.out.data() + node.outSent, node.out.size() - node.outSent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                closeConnection(index, true);
+                return;
+            }
+            node.outSent += (size_t)n;
+        }
+        if (node.outSent == node.out.size()) {
+            node.out.clear();
+            node.outSent = 0;
+        }
+        updateInterest(index, !node.out.empty());
+    }
+
+    void onSocket(size_t index, uint32_t events) {
+        Node& node = *nodes[index];
+        if (node.fd < 0) {
+            return;
+        }
+        if (node.connecting && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(node.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0) {
+                node.connecting = false;
+                stats.connected++;  // Balanced by closeConnection()
+                closeConnection(index, true);
+                return;
+            }
+            node.connecting = false;
+            stats.connected++;
+        }
+        if (events & EPOLLIN) {
+            // Only CONNACK arrives (no subscriptions); a refusal or EOF ends the connection
+            uint8_t buffer[256];
+            ssize_t n = recv(node.fd, buffer, sizeof(buffer), 0);
+            if (n == 0 || (n < 0 && errno != EAGAIN) || (n >= 4 && buffer[0] == 0x20 && buffer[3] != 0)) {
+                closeConnection(index, true);
+                return;
+            }
+        }
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeConnection(index, true);
+            return;
+        }
+        flush(index);
+    }
+
+    // readSensors() phases 1-3 on the node's own clock
+    void readSensors(Node& node) {
+        SensorBase* cycle[3] = { &node.sht30, &node.waterLevel, &node.ph };
+        bool ready[3] = { false, false, false };
+        for (size_t i = 0; i < 3; i++) {
+            ready[i] = !cycle[i]->isInitialized() || !cycle[i]->trigger();
+        }
+        const int64_t deadline = node.hardware.now() + (int64_t)ACQUISITION_TIMEOUT_MS * 1000;
+        bool waiting = true;
+        while (waiting && node.hardware.now() < deadline) {
+            waiting = false;
+            for (size_t i = 0; i < 3; i++) {
+                if (ready[i]) {
+                    continue;
+                }
+                cycle[i]->poll();
+                ready[i] = cycle[i]->isReady();
+                waiting = waiting || !ready[i];
+            }
+            if (waiting) {
+                node.hardware.advance(node.hardware.now() + WAIT_STEP_US);
+            }
+        }
+        for (size_t i = 0; i < 3; i++) {
+            if (cycle[i]->isInitialized()) {
+                cycle[i]->collect();
+            }
+        }
+    }
+
+    void publish(size_t index, const char* deviceType, float value, int decimals, const char* label) {
+        Node& node = *nodes[index];
+        char buffer[SENSOR_PAYLOAD_BYTES];
+        size_t length = formatSensorPayload(buffer, sizeof(buffer), deviceType, value, decimals, label);
+        if (length == 0) {
+            return;
+        }
+        if (!options.dryRun) {
+            if (node.fd < 0 || node.out.size() - node.outSent > MAX_BACKLOG_BYTES) {
+                stats.dropped++;
+                return;
+            }
+            encodePublish(node.out, node.topic, buffer, length);
+        }
+        stats.messages++;
+        stats.bytes += length;
+    }
+
+    // publishSensorData(): channels with a valid majority in their window
+    void publishSensorData(size_t index) {
+        Node& node = *nodes[index];
+        if (node.sht30.isInitialized() && node.sht30.hasValidTemperatureMajority()) {
+            publish(index, "temperature", node.sht30.getTemperature(), 2, "temperature");
+        }
+        if (node.sht30.isInitialized() && node.sht30.hasValidHumidityMajority()) {
+            publish(index, "humidity", node.sht30.getHumidity(), 2, "humidity");
+        }
+        if (node.waterLevel.isInitialized() && node.waterLevel.hasValidMajority()) {
+            publish(index, "waterLevel", node.waterLevel.getWaterLevel(), 1, "water level");
+        }
+        if (node.ph.isInitialized() && node.ph.hasValidMajority()) {
+            publish(index, "pH", node.ph.getPH(), 2, "pH sensor");
+        }
+        if (!options.dryRun && node.fd >= 0 && !node.connecting) {
+            flush(index);
+        }
+    }
+
+    void runActions(size_t index, int64_t lagNs) {
+        Node& node = *nodes[index];
+        SimContext context(node.hardware);
+        int64_t start = node.hardware.now();
+        int64_t due = std::min(node.nextReadUs, node.nextPublishUs);
+        node.hardware.advance(due);
+
+        // Same order as loop(): read, then publish
+        if (node.nextReadUs <= due) {
+            int64_t cpu = threadCpuNs();
+            readSensors(node);
+            stats.readCpuNs += threadCpuNs() - cpu;
+            stats.reads++;
+            node.nextReadUs += runtimeSettings.sensorReadInterval * 1000LL;
+        }
+        if (node.nextPublishUs <= due) {
+            int64_t cpu = threadCpuNs();
+            publishSensorData(index);
+            stats.publishCpuNs += threadCpuNs() - cpu;
+            stats.publishes++;
+            node.nextPublishUs += runtimeSettings.sensorPublishInterval * 1000LL;
+        }
+        stats.nodeUs += (uint64_t)(node.hardware.now() - start);
+
+        uint64_t lag = (uint64_t)std::max<int64_t>(0, lagNs);
+        uint64_t seen = stats.maxLagNs.load();
+        while (lag > seen && !stats.maxLagNs.compare_exchange_weak(seen, lag)) {
+        }
+        scheduleAction(index);
+    }
+
+public:
+    WorkerStats stats;
+
+    explicit Worker(const Options& opts) : options(opts), epollFd(-1), wallOriginNs(0) {}
+
+    ~Worker() {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (nodes[i]->fd >= 0) {
+                close(nodes[i]->fd);
+            }
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+    }
+
+    /**
+     * @brief Create and boot a node (sensor begin() runs on its own clock)
+     */
+    void addNode(size_t id) {
+        Random random(options.seed * 1000003ULL + id);
+        std::unique_ptr<Node> node(new Node(random.next()));
+        snprintf(node->clientId, sizeof(node->clientId), "%s%04zu", options.prefix.c_str(), id);
+        snprintf(node->topic, sizeof(node->topic), "grow/%s/sensor", node->clientId);
+        {
+            SimContext context(node->hardware);
+            node->sht30.begin();
+            node->waterLevel.begin();
+            node->ph.begin();
+        }
+        // Nodes boot at different times: spread reads and publishes over their intervals
+        int64_t readOffset = (int64_t)(random.uniform() * runtimeSettings.sensorReadInterval * 1000.0);
+        int64_t publishOffset = (int64_t)(random.uniform() * runtimeSettings.sensorPublishInterval * 1000.0);
+        node->virtualOriginUs = node->hardware.now();
+        node->nextReadUs = node->virtualOriginUs + readOffset;
+        node->nextPublishUs = node->nextReadUs + publishOffset;
+        nodes.push_back(std::move(node));
+    }
+
+    size_t getNodeCount() const {
+        return nodes.size();
+    }
+
+    void run(const std::atomic<bool>& stop, int64_t originNs) {
+        wallOriginNs = originNs;
+        epollFd = epoll_create1(0);
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (!options.dryRun) {
+                connectNode(i);
+            }
+            scheduleAction(i);
+        }
+
+        epoll_event events[64];
+        while (!stop.load(std::memory_order_relaxed)) {
+            int64_t now = wallNs();
+            while (!timers.empty() && timers.top().wallNs <= now) {
+                Event event = timers.top();
+                timers.pop();
+                if (event.kind == EVENT_ACTION) {
+                    runActions(event.node, now - event.wallNs);
+                } else if (nodes[event.node]->fd < 0) {
+                    connectNode(event.node);
+                }
+            }
+            int timeoutMs = 100;
+            if (!timers.empty()) {
+                int64_t wait = (timers.top().wallNs - wallNs() + 999999) / 1000000;
+                timeoutMs = (int)std::max<int64_t>(0, std::min<int64_t>(timeoutMs, wait));
+            }
+            int n = epoll_wait(epollFd, events, 64, timeoutMs);
+            for (int i = 0; i < n; i++) {
+                onSocket((size_t)events[i].data.u64, events[i].events);
+            }
+        }
+    }
+};
+
+// ==================== Main ====================
+static bool resolveBroker(const char* spec, Options& options) {
+    std::string host = spec;
+    std::string port = "1883";
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        fprintf(stderr, "cannot resolve broker %s\n", spec);
+        return false;
+    }
+    memcpy(&options.broker, result->ai_addr, result->ai_addrlen);
+    options.brokerLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [--nodes N] [--threads N] [--speed X] [--duration S] [--report S]\n"
+            "          [--broker HOST[:PORT] | --dry-run] [--prefix NAME] [--seed N] [--log]\n", name);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    const char* broker = "localhost:1883";
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--nodes") == 0 && hasValue) {
+            options.nodes = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            options.threads = std::max(1UL, strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--speed") == 0 && hasValue) {
+            options.speed = atof(argv[++i]);
+        } else if (strcmp(arg, "--duration") == 0 && hasValue) {
+            options.durationS = atof(argv[++i]);
+        } else if (strcmp(arg, "--report") == 0 && hasValue) {
+            options.reportS = atof(argv[++i]);
+        } else if (strcmp(arg, "--broker") == 0 && hasValue) {
+            broker = argv[++i];
+        } else if (strcmp(arg, "--prefix") == 0 && hasValue) {
+            options.prefix = argv[++i];
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--dry-run") == 0) {
+            options.dryRun = true;
+        } else if (strcmp(arg, "--log") == 0) {
+            options.log = true;
+        } else {
+            usage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 1;
+        }
+    }
+    if (options.nodes == 0 || options.speed <= 0 || options.reportS <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!options.dryRun && !resolveBroker(broker, options)) {
+        return 1;
+    }
+    Serial.setEnabled(options.log);
+
+    // Boot the fleet (round robin over the workers)
+    std::vector<std::unique_ptr<Worker> > workers;
+    for (size_t t = 0; t < options.threads; t++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker(options)));
+    }
+    int64_t bootStart = wallNs();
+    for (size_t id = 0; id < options.nodes; id++) {
+        workers[id % options.threads]->addNode(id);
+    }
+    fprintf(stderr, "%zu nodes booted in %.1f ms (%zu bytes each), %zu worker thread(s), speed x%g, %s\n",
+            options.nodes, (wallNs() - bootStart) / 1e6, sizeof(Node), options.threads, options.speed,
+            options.dryRun ? "dry run" : broker);
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    int64_t origin = wallNs();
+    for (size_t t = 0; t < workers.size(); t++) {
+        Worker* worker = workers[t].get();
+        threads.push_back(std::thread([worker, &stop, origin]() { worker->run(stop, origin); }));
+    }
+    std::vector<clockid_t> cpuClocks(threads.size());
+    for (size_t t = 0; t < threads.size(); t++) {
+        pthread_getcpuclockid(threads[t].native_handle(), &cpuClocks[t]);
+    }
+    auto workerCpuNs = [&]() {
+        int64_t total = 0;
+        for (size_t t = 0; t < cpuClocks.size(); t++) {
+            timespec ts;
+            clock_gettime(cpuClocks[t], &ts);
+            total += (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+        }
+        return total;
+    };
+    auto sum = [&](std::atomic<uint64_t> WorkerStats::*field) {
+        uint64_t total = 0;
+        for (size_t t = 0; t < workers.size(); t++) {
+            total += (workers[t]->stats.*field).load();
+        }
+        return total;
+    };
+
+    uint64_t lastMessages = 0, lastBytes = 0, lastReads = 0, lastReadCpu = 0, lastPublishes = 0, lastPublishCpu = 0;
+    int64_t lastCpu = 0;
+    int64_t lastWall = origin;
+    int64_t end = origin + (int64_t)(options.durationS * 1e9);
+    while (wallNs() < end) {
+        int64_t next = std::min(end, lastWall + (int64_t)(options.reportS * 1e9));
+        std::this_thread::sleep_for(std::chrono::nanoseconds(std::max<int64_t>(0, next - wallNs())));
+        int64_t now = wallNs();
+        double seconds = (now - lastWall) / 1e9;
+        uint64_t messages = sum(&WorkerStats::messages);
+        uint64_t bytes = sum(&WorkerStats::bytes);
+        uint64_t reads = sum(&WorkerStats::reads);
+        uint64_t readCpu = sum(&WorkerStats::readCpuNs);
+        uint64_t publishes = sum(&WorkerStats::publishes);
+        uint64_t publishCpu = sum(&WorkerStats::publishCpuNs);
+        int64_t cpu = workerCpuNs();
+        uint64_t maxLag = 0;
+        for (size_t t = 0; t < workers.size(); t++) {
+            maxLag = std::max<uint64_t>(maxLag, workers[t]->stats.maxLagNs.exchange(0));
+        }
+        printf("[%6.0f s] %7.0f msgs/s %8.1f KB/s | read %6.1f us, publish %5.1f us per node | "
+               "workers %5.1f%% busy | lag max %7.1f ms | connected %llu, dropped %llu\n",
+               (now - origin) / 1e9, (messages - lastMessages) / seconds, (bytes - lastBytes) / seconds / 1024.0,
+               reads > lastReads ? (readCpu - lastReadCpu) / 1e3 / (reads - lastReads) : 0.0,
+               publishes > lastPublishes ? (publishCpu - lastPublishCpu) / 1e3 / (publishes - lastPublishes) : 0.0,
+               100.0 * (cpu - lastCpu) / (now - lastWall) / workers.size(), maxLag / 1e6,
+               (unsigned long long)sum(&WorkerStats::connected), (unsigned long long)sum(&WorkerStats::dropped));
+        fflush(stdout);
+        lastMessages = messages;
+        lastBytes = bytes;
+        lastReads = reads;
+        lastReadCpu = readCpu;
+        lastPublishes = publishes;
+        lastPublishCpu = publishCpu;
+        lastCpu = cpu;
+        lastWall = now;
+    }
+    stop = true;
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    // Scaling: worker CPU (node work + event loop + sockets) per second of node time
+    double wallS = (wallNs() - origin) / 1e9;
+    double nodeSeconds = sum(&WorkerStats::nodeUs) / 1e6;
+    double cpuS = lastCpu / 1e9;
+    uint64_t messages = sum(&WorkerStats::messages);
+    printf("\n%llu messages in %.1f s (%.0f msgs/s), %llu dropped, %llu connect failures\n",
+           (unsigned long long)messages, wallS, messages / wallS, (unsigned long long)sum(&WorkerStats::dropped),
+           (unsigned long long)sum(&WorkerStats::connectFailures));
+    if (nodeSeconds > 0 && cpuS > 0) {
+        double cpuPerNodeSecondUs = cpuS * 1e6 / nodeSeconds;
+        printf("Worker CPU %.2f s for %.0f node-seconds: %.1f us per node-second, %.0f msgs per CPU-second\n",
+               cpuS, nodeSeconds, cpuPerNodeSecondUs, messages / cpuS);
+        printf("One core keeps up with ~%.0f nodes in real time (read every %lu ms, publish every %lu ms)\n",
+               1e6 / cpuPerNodeSecondUs, (unsigned long)runtimeSettings.sensorReadInterval,
+               (unsigned long)runtimeSettings.sensorPublishInterval);
+    }
+    return 0;
+}
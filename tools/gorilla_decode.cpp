@@ -0,0 +1,119 @@
+// Decode Gorilla time-series blocks published with TIMESERIES_GORILLA.
+//
+// Build:  g++ -std=c++11 -O2 -I../include gorilla_decode.cpp -o gorilla_decode
+// Usage:  gorilla_decode [--stats] [--channel NAME] [FILE...]
+//
+// Each FILE (or stdin) holds one or more blocks back to back, e.g. captured with
+//   mosquitto_sub -t 'grow/esp32_1/timeseries/pH' -N > ph.bin
+// Samples are written to stdout as CSV: seq,timestamp_us,value
+// --stats prints the encoded size per sample next to what the same readings
+// cost as individual publishSensorData() JSON messages.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Gorilla.h"
+
+struct Totals {
+    size_t blocks = 0;
+    size_t samples = 0;
+    size_t encodedBytes = 0;
+    size_t jsonBytes = 0;
+};
+
+// Size of one reading in the per-sensor JSON format published by the node
+static size_t jsonReadingSize(const std::string& channel, float value) {
+    char buf[256];
+    return (size_t)snprintf(buf, sizeof(buf),
+                            "{\"deviceType\":\"%s\",\"deviceID\":\"1\",\"location\":\"tent\","
+                            "\"value\":\"%.2f\",\"description\":\"ESP32 sensor node - %s\"}",
+                            channel.c_str(), value, channel.c_str());
+}
+
+static bool readAll(FILE* f, std::vector<uint8_t>& data) {
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    return !ferror(f);
+}
+
+static bool decodeStream(const std::vector<uint8_t>& data, const std::string& channel, Totals& totals) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        GorillaDecoder decoder;
+        if (!decoder.begin(&data[offset], data.size() - offset)) {
+            fprintf(stderr, "bad block header at offset %zu\n", offset);
+            return false;
+        }
+        uint32_t seq = decoder.getFirstSeq();
+        int64_t timestampUs;
+        float value;
+        uint16_t read = 0;
+        while (decoder.next(timestampUs, value)) {
+            printf("%u,%lld,%.6g\n", seq++, (long long)timestampUs, value);
+            totals.jsonBytes += jsonReadingSize(channel, value);
+            read++;
+        }
+        if (read != decoder.getCount()) {
+            fprintf(stderr, "truncated block at offset %zu (%u of %u samples)\n",
+                    offset, (unsigned)read, (unsigned)decoder.getCount());
+            return false;
+        }
+        totals.blocks++;
+        totals.samples += read;
+        totals.encodedBytes += decoder.blockLength();
+        offset += decoder.blockLength();
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool stats = false;
+    std::string channel = "pH";
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "--channel") == 0 && i + 1 < argc) {
+            channel = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            fprintf(stderr, "usage: %s [--stats] [--channel NAME] [FILE...]\n", argv[0]);
+            return 0;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    Totals totals;
+    bool ok = true;
+    printf("seq,timestamp_us,value\n");
+
+    if (files.empty()) {
+        std::vector<uint8_t> data;
+        ok = readAll(stdin, data) && decodeStream(data, channel, totals);
+    }
+    for (size_t i = 0; i < files.size() && ok; i++) {
+        FILE* f = fopen(files[i], "rb");
+        if (f == nullptr) {
+            perror(files[i]);
+            return 1;
+        }
+        std::vector<uint8_t> data;
+        ok = readAll(f, data) && decodeStream(data, channel, totals);
+        fclose(f);
+    }
+
+    if (stats && totals.samples > 0) {
+        fprintf(stderr, "%zu blocks, %zu samples\n", totals.blocks, totals.samples);
+        fprintf(stderr, "gorilla: %zu bytes (%.2f B/sample)\n",
+                totals.encodedBytes, (double)totals.encodedBytes / totals.samples);
+        fprintf(stderr, "json:    %zu bytes (%.2f B/sample)\n",
+                totals.jsonBytes, (double)totals.jsonBytes / totals.samples);
+        fprintf(stderr, "ratio:   %.1fx\n", (double)totals.jsonBytes / totals.encodedBytes);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,593 @@
+// Replay a hardware capture (halRecord command) through the sensor drivers.
+//
+// Build:  g++ -std=c++11 -O2 -ffp-contract=off -DHAL_REPLAY -Isim -I../include hal_replay.cpp -o hal_replay
+// Usage:  hal_replay [--capture ID] [--csv] [--dump] [--bench N] [--verbose] [FILE...]
+//
+// Each FILE (or stdin) holds capture chunks back to back, e.g. captured with
+//   mosquitto_sub -t 'grow/esp32_1/haltrace' -N > capture.bin
+// The newest capture is replayed unless --capture (hex id from the "halTrace"
+// event) picks another. The firmware's own SHT30Sensor, HC_SR04Sensor and
+// PHSensor run on the host shim in sim/ with every hal:: read answered from
+// the capture (sim/HalReplay.h), and each channel average is compared bit for
+// bit with the one the device computed. Exit status: 0 all outputs match,
+// 2 mismatch or divergence (the drivers no longer read what the device read),
+// 1 bad input.
+//
+//   --csv      time, channel, captured and replayed value per output on stdout
+//   --dump     decode the records instead of replaying them
+//   --bench N  replay N times and report the time per collect() and records/s
+//   --verbose  driver log output and every mismatch (default: the first 10)
+//
+// Replays need the firmware sources the capture was recorded with: the
+// RuntimeSettings layout is checked, driver behaviour is what is under test.
+// Captures started mid-run restore the averaging windows but not the Hampel
+// filter state, so the first outputs after the start may differ on nodes with
+// the outlier filter enabled; a capture with "boot": true replays from begin().
+// Build without FMA contraction: the device has none, so fused multiply-adds
+// would change the last bit of the averages.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "config.h"
+#include "RuntimeSettings.h"
+#include "TraceRecorder.h"
+#include "Hal.h"
+#include "SHT30Sensor.h"
+#include "HC_SR04Sensor.h"
+#include "PHSensor.h"
+
+// Globals the drivers expect from main.cpp
+SimSerial Serial;
+TwoWire Wire;
+TraceRecorder traceRecorder;
+RuntimeSettings runtimeSettings = RuntimeSettings::defaults();
+
+static const size_t MISMATCHES_SHOWN = 10;
+
+/**
+ * @brief A driver whose initialized flag can be set from the capture header
+ */
+template <class S>
+struct Replayed : S {
+    using S::S;
+
+    void setInitialized(bool on) {
+        this->initialized = on;
+    }
+};
+
+// ==================== Capture Input ====================
+struct Chunk {
+    HalChunkHeader header;
+    const uint8_t* payload;
+};
+
+static bool readAll(FILE* f, std::vector<uint8_t>& data) {
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    return !ferror(f);
+}
+
+static bool parseStream(const std::vector<uint8_t>& data, std::vector<Chunk>& chunks) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        Chunk chunk;
+        size_t size = halDecodeChunkHeader(&data[offset], data.size() - offset, chunk.header);
+        if (size == 0) {
+            fprintf(stderr, "bad or truncated chunk at offset %zu\n", offset);
+            return false;
+        }
+        chunk.payload = &data[offset + HAL_CHUNK_HEADER_BYTES];
+        chunks.push_back(chunk);
+        offset += size;
+    }
+    return true;
+}
+
+/**
+ * @brief Put one capture's chunks back together, up to the first one missing
+ */
+static void assemble(const std::vector<Chunk>& chunks, uint32_t captureId, std::vector<uint8_t>& out) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            const Chunk& c = chunks[i];
+            if (c.header.captureId == captureId && c.header.offset == out.size() && c.header.length > 0) {
+                out.insert(out.end(), c.payload, c.payload + c.header.length);
+                progress = true;
+            }
+        }
+    }
+}
+
+// ==================== Capture Header ====================
+struct CaptureSensor {
+    char name[HAL_TRACE_NAME_BYTES];
+    bool initialized;
+};
+
+struct CaptureChannel {
+    char name[HAL_TRACE_NAME_BYTES];
+    uint8_t sensor;
+    std::vector<float> values;
+    std::vector<bool> valid;
+    float sum;
+};
+
+struct CaptureHeader {
+    uint32_t captureId;
+    int64_t startUs;
+    uint8_t flags;
+    std::vector<CaptureSensor> sensors;
+    std::vector<CaptureChannel> channels;
+    RuntimeSettings settings;
+};
+
+static bool readSettings(const uint8_t* bytes, size_t size, RuntimeSettings& settings) {
+    if (bytes == nullptr || size != sizeof(RuntimeSettings)) {
+        return false;
+    }
+    memcpy(&settings, bytes, sizeof(settings));
+    return settings.version == RUNTIME_SETTINGS_VERSION;
+}
+
+static bool parseHeader(HalTraceReader& reader, CaptureHeader& header) {
+    if (!reader.beginCapture(header.captureId, header.startUs, header.flags)) {
+        fprintf(stderr, "not a version %d hardware capture\n", HAL_TRACE_VERSION);
+        return false;
+    }
+    header.sensors.resize(reader.getByte());
+    for (size_t i = 0; i < header.sensors.size(); i++) {
+        reader.getString(header.sensors[i].name, sizeof(header.sensors[i].name));
+        header.sensors[i].initialized = reader.getByte() != 0;
+    }
+    header.channels.resize(reader.getByte());
+    for (size_t c = 0; c < header.channels.size(); c++) {
+        CaptureChannel& channel = header.channels[c];
+        reader.getString(channel.name, sizeof(channel.name));
+        channel.sensor = reader.getByte();
+        size_t count = reader.getByte();
+        uint64_t validMask = reader.getVarint();
+        for (size_t i = 0; i < count; i++) {
+            channel.values.push_back(reader.getFloat());
+            channel.valid.push_back((validMask >> i & 1) != 0);
+        }
+        channel.sum = reader.getFloat();
+    }
+    size_t size = (size_t)reader.getVarint();
+    if (reader.isFailed()) {
+        fprintf(stderr, "capture header truncated\n");
+        return false;
+    }
+    if (!readSettings(reader.getBytes(size), size, header.settings)) {
+        fprintf(stderr, "runtime settings do not match this build (recorded by other firmware?)\n");
+        return false;
+    }
+    return true;
+}
+
+// ==================== Drivers ====================
+/**
+ * @brief The firmware's drivers, looked up by the names in the capture
+ */
+struct Drivers {
+    Replayed<SHT30Sensor> sht30;
+    Replayed<HC_SR04Sensor> waterLevel;
+    Replayed<PHSensor> ph;
+
+    Drivers() : waterLevel(HC_SR04_TRIG_PIN, HC_SR04_ECHO_PIN), ph(PH_SENSOR_PIN) {}
+
+    SensorBase* sensor(const char* name) {
+        SensorBase* all[] = { &sht30, &waterLevel, &ph };
+        for (size_t i = 0; i < 3; i++) {
+            if (strcmp(all[i]->getName(), name) == 0) {
+                return all[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void setInitialized(SensorBase* sensor, bool on) {
+        if (sensor == &sht30) {
+            sht30.setInitialized(on);
+        } else if (sensor == &waterLevel) {
+            waterLevel.setInitialized(on);
+        } else if (sensor == &ph) {
+            ph.setInitialized(on);
+        }
+    }
+
+    // Same mapping as sensorChannels[] in main.cpp
+    MovingAverage<float, MAX_AVERAGE_WINDOW>* average(const char* channel) {
+        if (strcmp(channel, "temperature") == 0) return &sht30.getTemperatureAverage();
+        if (strcmp(channel, "humidity") == 0) return &sht30.getHumidityAverage();
+        if (strcmp(channel, "waterLevel") == 0) return waterLevel.getMovingAverage();
+        if (strcmp(channel, "pH") == 0) return ph.getMovingAverage();
+        return nullptr;
+    }
+
+    // Same as applyRuntimeSettings() in main.cpp
+    void applySettings() {
+        sht30.setAverageWindow(runtimeSettings.tempHumidityWindow);
+        waterLevel.setAverageWindow(runtimeSettings.waterLevelWindow);
+        ph.setAverageWindow(runtimeSettings.phWindow);
+    }
+};
+
+// ==================== Replay ====================
+struct Options {
+    bool haveCapture = false;
+    uint32_t captureId = 0;
+    bool csv = false;
+    bool dump = false;
+    bool verbose = false;
+    size_t bench = 0;
+};
+
+struct Outcome {
+    size_t calls = 0;
+    size_t collects = 0;
+    size_t outputs = 0;
+    size_t mismatches = 0;
+    size_t resultMismatches = 0;
+    size_t records = 0;
+    bool diverged = false;
+    bool ended = false;
+    uint8_t endReason = HAL_END_STOPPED;
+    char message[192] = "";
+};
+
+static bool loadPHTable(HalTraceReader& reader, Drivers& drivers) {
+    float mid = reader.getFloat();
+    float low = reader.getFloat();
+    float high = reader.getFloat();
+    int16_t table[PHLookupTable::ADC_CODES];
+    int16_t value = 0;
+    for (size_t i = 0; i < PHLookupTable::ADC_CODES; i++) {
+        value = (int16_t)(value + reader.getZigzag());
+        table[i] = value;
+    }
+    if (reader.isFailed()) {
+        return false;
+    }
+    drivers.ph.setCalibration(mid, low, high);
+    drivers.ph.getLookupTable().load(table);
+    return true;
+}
+
+/**
+ * @brief Run the drivers through one capture
+ * @param report Print outputs and mismatches (off for the benchmark repeats)
+ */
+static void replayCapture(const std::vector<uint8_t>& data, bool truncated, const Options& options, bool report,
+                          Outcome& out) {
+    HalTraceReader reader(data.data(), data.size());
+    CaptureHeader header;
+    parseHeader(reader, header);
+    runtimeSettings = header.settings;
+
+    std::unique_ptr<Drivers> drivers(new Drivers());
+    HalReplay replay(reader);
+    HalReplay::current() = &replay;
+
+    std::vector<SensorBase*> sensors;
+    for (size_t i = 0; i < header.sensors.size(); i++) {
+        sensors.push_back(drivers->sensor(header.sensors[i].name));
+    }
+    std::vector<MovingAverage<float, MAX_AVERAGE_WINDOW>*> averages;
+    for (size_t c = 0; c < header.channels.size(); c++) {
+        averages.push_back(drivers->average(header.channels[c].name));
+    }
+
+    // Mid-run capture: bring the drivers to where the device was (begin() reads nothing here)
+    if ((header.flags & HAL_FLAG_FROM_BOOT) == 0) {
+        for (size_t i = 0; i < sensors.size(); i++) {
+            if (sensors[i] != nullptr) {
+                sensors[i]->begin();
+                drivers->setInitialized(sensors[i], header.sensors[i].initialized);
+            }
+        }
+    }
+    drivers->applySettings();
+    for (size_t c = 0; c < header.channels.size(); c++) {
+        const CaptureChannel& channel = header.channels[c];
+        if (averages[c] == nullptr || channel.values.empty()) {
+            continue;
+        }
+        averages[c]->reset();
+        for (size_t i = 0; i < channel.values.size(); i++) {
+            averages[c]->addReading(channel.values[i], channel.valid[i]);
+        }
+        averages[c]->restoreSum(channel.sum);
+        if (channel.sensor < sensors.size() && sensors[channel.sensor] != nullptr) {
+            sensors[channel.sensor]->refreshFromAverage();
+        }
+    }
+
+    bool lastCollect[HAL_TRACE_MAX_SENSORS] = {};
+    HalRecord r;
+    while (!replay.isDiverged() && !replay.isEnded() && replay.next(r)) {
+        SensorBase* sensor = (r.value >= 0 && (size_t)r.value < sensors.size()) ? sensors[r.value] : nullptr;
+        switch (r.type) {
+            case HAL_REC_CALL: {
+                if (sensor == nullptr) {
+                    replay.fail("call for a sensor this build does not have");
+                    break;
+                }
+                out.calls++;
+                replay.setLive(true);
+                switch (r.aux) {
+                    case HAL_CALL_BEGIN:   sensor->begin(); break;
+                    case HAL_CALL_RECOVER: sensor->recover(); break;
+                    case HAL_CALL_TRIGGER: sensor->trigger(); break;
+                    case HAL_CALL_POLL:    sensor->poll(); break;
+                    case HAL_CALL_COLLECT:
+                        lastCollect[r.value] = sensor->collect();
+                        out.collects++;
+                        break;
+                    default:
+                        replay.fail("unknown call kind");
+                        break;
+                }
+                replay.setLive(false);
+                break;
+            }
+            case HAL_REC_ISR:
+                replay.runIsr((uint8_t)r.value);
+                break;
+            case HAL_REC_RESULT:
+                if (sensor != nullptr && lastCollect[r.value] != (r.aux != 0)) {
+                    out.resultMismatches++;
+                    if (report && (options.verbose || out.resultMismatches <= MISMATCHES_SHOWN)) {
+                        fprintf(stderr, "%10.3f s  %s collect() returned %d, device %d\n",
+                                (replay.getTime() - header.startUs) / 1e6, sensor->getName(),
+                                lastCollect[r.value] ? 1 : 0, r.aux);
+                    }
+                }
+                break;
+            case HAL_REC_OUTPUT: {
+                if ((size_t)r.value >= averages.size() || averages[r.value] == nullptr) {
+                    replay.fail("output for a channel this build does not have");
+                    break;
+                }
+                float replayed = averages[r.value]->getAverage();
+                bool match = memcmp(&replayed, &r.output, sizeof(float)) == 0;
+                double t = (replay.getTime() - header.startUs) / 1e6;
+                out.outputs++;
+                if (!match) {
+                    out.mismatches++;
+                }
+                if (report && options.csv) {
+                    printf("%.6f,%s,%.9g,%.9g,%d\n", t, header.channels[r.value].name, r.output, replayed, match ? 1 : 0);
+                } else if (report && !match && (options.verbose || out.mismatches <= MISMATCHES_SHOWN)) {
+                    fprintf(stderr, "%10.3f s  %s: device %.9g, replay %.9g\n", t, header.channels[r.value].name,
+                            r.output, replayed);
+                }
+                break;
+            }
+            case HAL_REC_PH_TABLE:
+                if (!loadPHTable(reader, *drivers)) {
+                    replay.fail("pH table record truncated");
+                }
+                break;
+            case HAL_REC_SETTINGS:
+                if (!readSettings(r.bytes, r.count, runtimeSettings)) {
+                    replay.fail("settings record does not match this build");
+                    break;
+                }
+                drivers->applySettings();
+                break;
+            case HAL_REC_RESET:
+                if (sensor != nullptr) {
+                    sensor->resetAverage();
+                }
+                break;
+            case HAL_REC_END:
+                replay.markEnded(r.aux);
+                break;
+            default: {
+                // A read left over after the call returned: the driver read less than the device did
+                char text[96];
+                snprintf(text, sizeof(text), "%s left unread at byte %zu", halRecordName(r.type), reader.getPosition());
+                replay.fail(text);
+                break;
+            }
+        }
+    }
+
+    if (!replay.isDiverged() && reader.isFailed() && !truncated) {
+        replay.fail("capture truncated inside a record");
+    }
+    out.ended = replay.hasEndRecord(out.endReason);
+    out.diverged = replay.isDiverged();
+    snprintf(out.message, sizeof(out.message), "%s", replay.getMessage());
+    out.records = replay.getRecordCount();
+    HalReplay::current() = nullptr;
+}
+
+// ==================== Dump ====================
+static int dumpCapture(const std::vector<uint8_t>& data) {
+    HalTraceReader reader(data.data(), data.size());
+    CaptureHeader header;
+    if (!parseHeader(reader, header)) {
+        return 1;
+    }
+    printf("capture %08x, start %.6f s%s\n", header.captureId, header.startUs / 1e6,
+           (header.flags & HAL_FLAG_FROM_BOOT) ? ", from boot" : "");
+    for (size_t i = 0; i < header.sensors.size(); i++) {
+        printf("sensor %zu: %s%s\n", i, header.sensors[i].name, header.sensors[i].initialized ? "" : " (not initialized)");
+    }
+    for (size_t c = 0; c < header.channels.size(); c++) {
+        printf("channel %zu: %s, sensor %u, %zu readings in window\n", c, header.channels[c].name,
+               header.channels[c].sensor, header.channels[c].values.size());
+    }
+
+    HalRecord r;
+    while (reader.next(r)) {
+        double t = (reader.getTime() - header.startUs) / 1e6;
+        printf("%10.6f  %-9s", t, halRecordName(r.type));
+        switch (r.type) {
+            case HAL_REC_CALL:
+                printf(" %s %s", halCallName(r.aux), r.value < (int64_t)header.sensors.size() ? header.sensors[r.value].name : "?");
+                break;
+            case HAL_REC_I2C_READ:
+                for (size_t i = 0; i < r.count; i++) {
+                    printf(" %02x", r.bytes[i]);
+                }
+                break;
+            case HAL_REC_OUTPUT:
+                printf(" %s %.9g", r.value < (int64_t)header.channels.size() ? header.channels[r.value].name : "?", r.output);
+                break;
+            case HAL_REC_RESULT:
+                printf(" %s %s", r.value < (int64_t)header.sensors.size() ? header.sensors[r.value].name : "?", r.aux ? "ok" : "failed");
+                break;
+            case HAL_REC_PH_TABLE: {
+                float mid = reader.getFloat();
+                float low = reader.getFloat();
+                float high = reader.getFloat();
+                for (size_t i = 0; i < PHLookupTable::ADC_CODES; i++) {
+                    reader.getZigzag();
+                }
+                printf(" mid %.1f low %.1f high %.1f mV", mid, low, high);
+                break;
+            }
+            case HAL_REC_SETTINGS:
+                printf(" %zu bytes", r.count);
+                break;
+            case HAL_REC_END:
+                printf(" %s", halEndReasonName(r.aux));
+                break;
+            default:
+                printf(" %lld", (long long)r.value);
+                break;
+        }
+        printf("\n");
+    }
+    if (reader.isFailed()) {
+        fprintf(stderr, "capture truncated inside a record at byte %zu\n", reader.getPosition());
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            options.captureId = (uint32_t)strtoul(argv[++i], nullptr, 16);
+            options.haveCapture = true;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            options.csv = true;
+        } else if (strcmp(argv[i], "--dump") == 0) {
+            options.dump = true;
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            options.bench = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            options.verbose = true;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            fprintf(stderr, "usage: %s [--capture ID] [--csv] [--dump] [--bench N] [--verbose] [FILE...]\n", argv[0]);
+            return 0;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    Serial.setEnabled(options.verbose);
+
+    std::vector<std::vector<uint8_t> > inputs;
+    std::vector<Chunk> chunks;
+    bool ok = true;
+    if (files.empty()) {
+        inputs.push_back(std::vector<uint8_t>());
+        ok = readAll(stdin, inputs.back()) && parseStream(inputs.back(), chunks);
+    }
+    for (size_t i = 0; i < files.size() && ok; i++) {
+        FILE* f = fopen(files[i], "rb");
+        if (f == nullptr) {
+            perror(files[i]);
+            return 1;
+        }
+        inputs.push_back(std::vector<uint8_t>());
+        ok = readAll(f, inputs.back()) && parseStream(inputs.back(), chunks);
+        fclose(f);
+    }
+    if (!ok || chunks.empty()) {
+        fprintf(stderr, "%s\n", ok ? "no capture chunks in input" : "input rejected");
+        return 1;
+    }
+
+    // Newest capture by default (the last one in the input)
+    uint32_t captureId = options.haveCapture ? options.captureId : chunks.back().header.captureId;
+    std::vector<uint8_t> data;
+    assemble(chunks, captureId, data);
+    if (data.empty()) {
+        fprintf(stderr, "capture %08x not found (or its first chunk is missing)\n", captureId);
+        return 1;
+    }
+    uint32_t expected = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const HalChunkHeader& h = chunks[i].header;
+        if (h.captureId == captureId && h.offset + h.length > expected) {
+            expected = h.offset + h.length;
+        }
+    }
+    bool truncated = expected > data.size();
+    if (truncated) {
+        fprintf(stderr, "chunk at byte %zu missing: replaying the first %zu of %u bytes\n", data.size(), data.size(), expected);
+    }
+
+    if (options.dump) {
+        return dumpCapture(data);
+    }
+
+    HalTraceReader probe(data.data(), data.size());
+    CaptureHeader header;
+    if (!parseHeader(probe, header)) {
+        return 1;
+    }
+
+    Outcome out;
+    replayCapture(data, truncated, options, true, out);
+
+    FILE* summary = options.csv ? stderr : stdout;
+    fprintf(summary, "capture %08x: %zu bytes, %s, %s\n", captureId, data.size(),
+            (header.flags & HAL_FLAG_FROM_BOOT) ? "from boot" : "mid-run",
+            out.ended ? halEndReasonName(out.endReason) : "no end record");
+    fprintf(summary, "replayed %zu calls (%zu collects), %zu records\n", out.calls, out.collects, out.records);
+    fprintf(summary, "outputs: %zu compared, %zu mismatched; collect results: %zu mismatched\n",
+            out.outputs, out.mismatches, out.resultMismatches);
+    if (out.diverged) {
+        fprintf(summary, "DIVERGED: %s\n", out.message);
+    }
+
+    if (options.bench > 0 && !out.diverged) {
+        double best = 0;
+        for (size_t i = 0; i < options.bench; i++) {
+            Outcome run;
+            auto start = std::chrono::steady_clock::now();
+            replayCapture(data, truncated, options, false, run);
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (i == 0 || s < best) {
+                best = s;
+            }
+        }
+        fprintf(summary, "bench: best of %zu: %.3f ms, %.0f ns per collect, %.2f M records/s\n", options.bench,
+                best * 1e3, out.collects > 0 ? best * 1e9 / out.collects : 0.0, out.records / best / 1e6);
+    }
+
+    bool match = !out.diverged && out.mismatches == 0 && out.resultMismatches == 0;
+    fprintf(summary, "%s\n", match ? "MATCH" : "MISMATCH");
+    return match ? 0 : 2;
+}
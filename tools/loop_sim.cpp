@@ -0,0 +1,734 @@
+// Loop simulator: months of one node's firmware time in seconds.
+//
+// Build:  g++ -std=gnu++11 -O2 -Isim -I../include -I$LIBDEPS/ArduinoJson/src -I$LIBDEPS/PubSubClient/src
+//             -DMEMORY_COUNT_ALLOCATIONS -static-libstdc++ -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+//             loop_sim.cpp $LIBDEPS/PubSubClient/src/PubSubClient.cpp -o loop_sim
+//         (LIBDEPS=../.pio/libdeps/esp32dev after `pio run`; -static-libstdc++ so operator new is
+//         counted too; add -m32 for the ESP32's 32-bit unsigned long, without it millis() does
+//         not wrap at 49.7 days)
+// Usage:  loop_sim [--days N] [--step MS] [--report DAYS] [--seed N] [--log]
+//                  [--no-outages | --outage wifi|broker|blackhole@DAY+MINUTES ...]
+//
+// Runs the unmodified src/main.cpp - setup(), then loop() for --days of node
+// time - on the host shim in sim/ with the simulated sensors of fleet_sim and
+// an in-process WiFi link and MQTT broker (sim/SimNetwork.h) that the real
+// PubSubClient talks to. millis(), delay() and esp_timer run on a virtual
+// clock: after each loop() pass the clock jumps, in whole delay(10) steps, to
+// just before the next deadline the firmware is waiting for (sensor read,
+// publish, health message, status log, MQTT backoff, WiFi retry, a network
+// change), at most --step apart. Every pass still runs, so the cadence is the
+// one the device would have; only the idle passes in between are skipped.
+//
+// Default outages (those within --days): broker down 10 min at day 2.5, WiFi
+// gone 3 min at day 9.25, broker unreachable 8 min at day 20.75 and broker
+// down 5 min at day 49.8, just after the 32-bit millis() rollover.
+//
+// Checked, with a ✓ / ✗ / ⊘ line each (exit status 1 if any check fails):
+// - read / publish / health cadence: no interval short of the configured one,
+//   none later than it by STALL_THRESHOLD_MS outside outages, drift of the
+//   average interval within MAX_DRIFT_PERCENT
+// - sensor freshness after every read: getTimeSinceLastSuccess() within the
+//   60 s window of isDataFresh(), and isDataFresh() agreeing with it
+// - internal heap in use at the end against the end of day 1, and the low-water mark
+// - watchdog: longest time between esp_task_wdt_reset() calls
+// - stalls (StallMonitor) only during outages
+// - MQTT backoff: the node runs with three broker endpoints (SIM_BROKER_LIST;
+//   the simulated network routes them all to its one broker, so an outage
+//   takes every endpoint down). Within a round the next endpoint is tried on
+//   the next pass with the delay unchanged; each failed round doubles the
+//   delay (capped at MQTT_RECONNECT_MAX_DELAY) and the next round waits it.
+//   RTT probes are told apart and only excuse the attempt they delay. The
+//   session is back within a bound after each outage and the delay is reset
+//   to MQTT_RECONNECT_INITIAL_DELAY
+// OTA, HTTP downloads, the metrics server and other tasks are not run.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "WiFi.h"
+#include "ArduinoOTA.h"
+#include "Update.h"
+#include "esp_task_wdt.h"
+#include "SimNetwork.h"
+#include "SimNode.h"
+
+// Globals the Arduino core defines on the device
+SimSerial Serial;
+TwoWire Wire;
+WiFiClass WiFi;
+EspClass ESP;
+ArduinoOTAClass ArduinoOTA;
+UpdateClass Update;
+
+// Several endpoints, so failover rounds and RTT probing run (config.h lists one)
+#include "config.h"
+#define SIM_BROKER_LIST { { MQTT_BROKER, MQTT_PORT }, { "192.168.1.101", MQTT_PORT }, { "broker2.local", MQTT_PORT } }
+#undef MQTT_BROKER_LIST
+#define MQTT_BROKER_LIST SIM_BROKER_LIST
+
+// The firmware, unmodified
+#include "../src/main.cpp"
+
+// Average interval may exceed the configured one by this much (loop() pass time and delay(10) add up)
+static const double MAX_DRIFT_PERCENT = 2.0;
+
+// Internal heap the node may gain between the end of day 1 and the end of the run
+static const int64_t MAX_HEAP_GROWTH_BYTES = 4096;
+
+// Allowance on top of computed bounds (a loop() pass, a sensor read cycle, DNS)
+static const int64_t SLACK_US = 1000000;
+
+static const int64_t DAY_US = 86400LL * 1000000;
+static const int64_t PASS_US = 10000;  // The delay(10) at the end of loop()
+
+static double wallS() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int64_t nodeUs() {
+    return simHardware().now();
+}
+
+// ==================== Options ====================
+struct OutageSpec {
+    SimOutageKind kind;
+    double day;
+    double minutes;
+};
+
+struct Options {
+    double days = 60.0;
+    unsigned long stepMs = 1000;
+    double reportDays = 5.0;
+    uint64_t seed = 1;
+    bool log = false;
+    bool defaultOutages = true;
+    std::vector<OutageSpec> outages;
+};
+
+static const char* outageName(SimOutageKind kind) {
+    switch (kind) {
+        case OUTAGE_WIFI: return "wifi";
+        case OUTAGE_BROKER: return "broker";
+        case OUTAGE_BLACKHOLE: return "blackhole";
+    }
+    return "?";
+}
+
+// KIND@DAY+MINUTES, e.g. broker@2.5+10
+static bool parseOutage(const char* text, OutageSpec& spec) {
+    const char* at = strchr(text, '@');
+    const char* plus = at != nullptr ? strchr(at, '+') : nullptr;
+    if (plus == nullptr) {
+        return false;
+    }
+    size_t length = at - text;
+    if (length == 4 && strncmp(text, "wifi", 4) == 0) {
+        spec.kind = OUTAGE_WIFI;
+    } else if (length == 6 && strncmp(text, "broker", 6) == 0) {
+        spec.kind = OUTAGE_BROKER;
+    } else if (length == 9 && strncmp(text, "blackhole", 9) == 0) {
+        spec.kind = OUTAGE_BLACKHOLE;
+    } else {
+        return false;
+    }
+    spec.day = atof(at + 1);
+    spec.minutes = atof(plus + 1);
+    return spec.day >= 0 && spec.minutes > 0;
+}
+
+// ==================== Checks ====================
+/**
+ * @brief Intervals of one periodic loop() task, seen through its lastX variable
+ */
+struct Cadence {
+    const char* name;
+    const unsigned long* last;
+    unsigned long intervalMs;
+    unsigned long seen;             // Previous value of *last
+    uint64_t count;
+    uint64_t totalMs;               // Sum of the intervals (modular, so millis() wraps are harmless)
+    unsigned long minMs;
+    unsigned long maxMs;
+    int64_t maxAtUs;
+    uint64_t early;
+    uint64_t late;                  // Later than intervalMs + STALL_THRESHOLD_MS outside outages
+    uint64_t lateInOutage;
+};
+
+/**
+ * @brief MQTT reconnects, fed by the simulated network
+ */
+struct Backoff {
+    uint64_t attempts;
+    uint64_t failures;              // Attempts whose TCP connect failed
+    uint32_t streak;                // Consecutive failures before the current attempt
+    bool havePrevious;
+    int64_t previousUs;
+    int64_t previousCostUs;         // How long the previous attempt blocked
+    uint64_t probes;                // RTT probe connects (not reconnect attempts)
+    int64_t probeCostUs;            // Time probes blocked since the previous attempt
+    uint64_t failovers;             // Retries of the next endpoint within a round
+    uint64_t checked;               // Retries whose spacing was checked
+    uint64_t wrongDelay;            // mqttReconnectDelay not min(INITIAL * 2^failed rounds, MAX)
+    uint64_t early;
+    uint64_t late;
+    int64_t worstLateUs;
+    uint64_t sessions;
+    std::vector<int64_t> sessionUs; // Reserved up front: no allocation while the node runs
+    uint64_t resetsChecked;
+    uint64_t notReset;              // Connected with the delay still grown
+};
+
+struct Run {
+    Options options;
+    Cadence reads;
+    Cadence publishes;
+    Cadence health;
+    Backoff backoff;
+    std::vector<SimOutage> outages;
+
+    uint64_t passes;
+    uint64_t freshChecks;
+    uint64_t staleSensors;          // Initialized, but no good read within 60 s
+    uint64_t freshMismatch;         // isDataFresh() disagreeing with getTimeSinceLastSuccess()
+    int64_t worstAgeMs;
+
+    unsigned long lastMillis;
+    uint32_t millisWraps;
+    int64_t firstWrapUs;
+
+    size_t heapDay1;
+    bool heapDay1Taken;
+    size_t heapPeak;
+
+    uint32_t lastStalls;
+    uint32_t stallsInOutage;
+    uint32_t stallsOutside;
+    int64_t firstStrayStallUs;
+
+    #ifdef MEMORY_COUNT_ALLOCATIONS
+    uint32_t lastAllocCalls;
+    uint32_t lastAllocBytes;
+    uint64_t allocCalls;
+    uint64_t allocBytes;
+    #endif
+
+    uint64_t sensorMessages;        // Received by the broker, per topic
+    uint64_t healthMessages;
+    uint64_t otherMessages;
+};
+
+static Run run;
+
+static void initCadence(Cadence& c, const char* name, const unsigned long* last, unsigned long intervalMs) {
+    memset(&c, 0, sizeof(c));
+    c.name = name;
+    c.last = last;
+    c.intervalMs = intervalMs;
+    c.seen = *last;
+    c.minMs = ~0UL;
+}
+
+/**
+ * @brief Time the network needs after an outage before the node must be back
+ */
+static int64_t recoveryBoundUs(SimOutageKind kind) {
+    if (kind == OUTAGE_WIFI) {
+        // Next association restart, association, then an immediate connect (onWiFiConnected())
+        return (int64_t)WIFI_RECONNECT_INTERVAL * 1000 + SimNetwork::ASSOCIATE_US + SLACK_US;
+    }
+    // The backoff delay running when it ended, plus an attempt already under way and a probe round
+    return (int64_t)MQTT_RECONNECT_MAX_DELAY * 1000 + (int64_t)SimNetwork::DEFAULT_CONNECT_TIMEOUT_MS * 1000 +
+           (int64_t)brokerPool.getEndpointCount() * MQTT_BROKER_PROBE_TIMEOUT * 1000 + SLACK_US;
+}
+
+// An outage, or the recovery after it, covers this time
+static bool inOutage(int64_t atUs) {
+    for (size_t i = 0; i < run.outages.size(); i++) {
+        const SimOutage& o = run.outages[i];
+        if (atUs >= o.startUs && atUs <= o.endUs + recoveryBoundUs(o.kind)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void observeCadence(Cadence& c) {
+    unsigned long value = *c.last;
+    if (value == c.seen) {
+        return;
+    }
+    unsigned long gapMs = value - c.seen;
+    c.seen = value;
+    c.count++;
+    if (c.count == 1) {
+        return;  // First run after boot: no interval yet
+    }
+    c.totalMs += gapMs;
+    if (gapMs < c.minMs) {
+        c.minMs = gapMs;
+    }
+    if (gapMs > c.maxMs) {
+        c.maxMs = gapMs;
+        c.maxAtUs = nodeUs();
+    }
+    if (gapMs < c.intervalMs) {
+        c.early++;
+    } else if (gapMs > c.intervalMs + STALL_THRESHOLD_MS) {
+        if (inOutage(nodeUs())) {
+            c.lateInOutage++;
+        } else {
+            c.late++;
+        }
+    }
+}
+
+static void checkFreshness() {
+    for (size_t i = 0; i < HAL_SENSOR_COUNT; i++) {
+        const SensorBase* sensor = halSensors[i];
+        if (!sensor->isInitialized()) {
+            continue;  // Supervisor is re-probing it
+        }
+        unsigned long ageMs = sensor->getTimeSinceLastSuccess();
+        if (ageMs == 0 && !sensor->isDataFresh(1)) {
+            continue;  // No good read yet
+        }
+        run.freshChecks++;
+        if ((int64_t)ageMs > run.worstAgeMs) {
+            run.worstAgeMs = ageMs;
+        }
+        if (ageMs > 60000) {
+            run.staleSensors++;
+        }
+        // A millisecond of slack for the clock reads in between
+        if (!sensor->isDataFresh(ageMs + 2) || (ageMs >= 1 && sensor->isDataFresh(ageMs - 1))) {
+            run.freshMismatch++;
+        }
+    }
+}
+
+static void onConnectAttempt(int64_t atUs, bool ok) {
+    Backoff& b = run.backoff;
+    if (brokerPool.isProbing()) {
+        // Not a reconnect attempt, but it holds back the one that is due
+        b.probes++;
+        b.probeCostUs += nodeUs() - atUs;
+        return;
+    }
+    b.attempts++;
+    // reconnectMQTT() doubles the delay after every failed round of all endpoints
+    uint32_t endpoints = (uint32_t)brokerPool.getEndpointCount();
+    uint32_t failedRounds = b.streak / endpoints;
+    bool failover = b.streak % endpoints != 0;
+    unsigned long expectedMs = MQTT_RECONNECT_INITIAL_DELAY;
+    for (uint32_t i = 0; i < failedRounds && expectedMs < MQTT_RECONNECT_MAX_DELAY; i++) {
+        expectedMs *= 2;
+    }
+    if (expectedMs > MQTT_RECONNECT_MAX_DELAY) {
+        expectedMs = MQTT_RECONNECT_MAX_DELAY;
+    }
+    if (b.havePrevious && b.streak > 0) {
+        b.checked++;
+        if (mqttReconnectDelay != expectedMs) {
+            b.wrongDelay++;
+        }
+        int64_t gapUs = atUs - b.previousUs;
+        // The next endpoint of a round goes on the next pass, a new round waits the delay
+        int64_t waitUs = failover ? 0 : (int64_t)mqttReconnectDelay * 1000;
+        if (failover) {
+            b.failovers++;
+        }
+        // Attempts are timed from millis(), and the previous one may have spent a DNS lookup first
+        if (!failover && gapUs < waitUs - 1000 - SimNetwork::DNS_US) {
+            b.early++;
+        } else if (gapUs > waitUs + b.previousCostUs + b.probeCostUs + SLACK_US) {
+            b.late++;
+            if (gapUs - waitUs > b.worstLateUs) {
+                b.worstLateUs = gapUs - waitUs;
+            }
+        }
+    }
+    b.probeCostUs = 0;
+    b.havePrevious = true;
+    b.previousUs = atUs;
+    b.previousCostUs = nodeUs() - atUs;
+    if (ok) {
+        b.streak = 0;
+    } else {
+        b.failures++;
+        b.streak++;
+    }
+}
+
+static void onSession(int64_t atUs, const char* /*clientId*/) {
+    Backoff& b = run.backoff;
+    b.sessions++;
+    if (b.sessionUs.size() < b.sessionUs.capacity()) {
+        b.sessionUs.push_back(atUs);
+    }
+}
+
+static void onPublish(int64_t /*atUs*/, const char* topic, size_t /*bytes*/) {
+    if (strcmp(topic, MQTT_TOPIC_SENSOR) == 0) {
+        run.sensorMessages++;
+    } else if (strcmp(topic, MQTT_TOPIC_HEALTH) == 0) {
+        run.healthMessages++;
+    } else {
+        run.otherMessages++;
+    }
+}
+
+/**
+ * @brief Everything checked after a loop() pass
+ */
+static void observe() {
+    run.passes++;
+    uint64_t readsBefore = run.reads.count;
+    observeCadence(run.reads);
+    observeCadence(run.publishes);
+    observeCadence(run.health);
+    if (run.reads.count != readsBefore) {
+        checkFreshness();
+    }
+
+    unsigned long now = millis();
+    if (now < run.lastMillis) {
+        if (run.millisWraps == 0) {
+            run.firstWrapUs = nodeUs();
+        }
+        run.millisWraps++;
+    }
+    run.lastMillis = now;
+
+    size_t heap = SimHeap::get().internalUsed();
+    if (heap > run.heapPeak) {
+        run.heapPeak = heap;
+    }
+    if (!run.heapDay1Taken && nodeUs() >= DAY_US) {
+        run.heapDay1 = heap;
+        run.heapDay1Taken = true;
+    }
+
+    uint32_t stalls = stallMonitor.getTotalStalls();
+    if (stalls != run.lastStalls) {
+        if (inOutage(nodeUs())) {
+            run.stallsInOutage += stalls - run.lastStalls;
+        } else {
+            if (run.stallsOutside == 0) {
+                run.firstStrayStallUs = nodeUs();
+            }
+            run.stallsOutside += stalls - run.lastStalls;
+        }
+        run.lastStalls = stalls;
+    }
+
+    // reconnectMQTT() resets the backoff once connected
+    Backoff& b = run.backoff;
+    if (b.resetsChecked < b.sessions && mqttClient.connected()) {
+        b.resetsChecked = b.sessions;
+        if (mqttReconnectDelay != MQTT_RECONNECT_INITIAL_DELAY) {
+            b.notReset++;
+        }
+    }
+
+    #ifdef MEMORY_COUNT_ALLOCATIONS
+    uint32_t calls = memoryAllocCalls;
+    uint32_t bytes = memoryAllocBytes;
+    run.allocCalls += (uint32_t)(calls - run.lastAllocCalls);
+    run.allocBytes += (uint32_t)(bytes - run.lastAllocBytes);
+    run.lastAllocCalls = calls;
+    run.lastAllocBytes = bytes;
+    #endif
+}
+
+// ==================== Virtual Clock ====================
+static unsigned long untilDue(unsigned long last, unsigned long intervalMs, unsigned long now) {
+    unsigned long elapsed = now - last;
+    return elapsed >= intervalMs ? 0 : intervalMs - elapsed;
+}
+
+/**
+ * @brief How far the clock may jump before the next loop() pass would do anything
+ *
+ * Whole delay(10) steps only, so the pass that acts lands where it would on
+ * the device; no jump while the outbound queue still holds messages.
+ */
+static int64_t idleUs(unsigned long stepMs) {
+    if (outbound.getDepth() > 0) {
+        return 0;
+    }
+    unsigned long now = millis();
+    unsigned long waitMs = stepMs;
+    waitMs = std::min(waitMs, untilDue(lastSensorRead, runtimeSettings.sensorReadInterval, now));
+    waitMs = std::min(waitMs, untilDue(lastSensorPublish, runtimeSettings.sensorPublishInterval, now));
+    waitMs = std::min(waitMs, untilDue(lastHealthMsg, runtimeSettings.healthMsgInterval, now));
+    waitMs = std::min(waitMs, untilDue(lastStatusLog, STATUS_LOG_INTERVAL, now));
+    bool wifiUp = WiFi.status() == WL_CONNECTED;
+    if (!wifiUp) {
+        unsigned long timeout = wifiEverConnected ? WIFI_RECONNECT_INTERVAL : WIFI_CONNECTION_TIMEOUT;
+        waitMs = std::min(waitMs, untilDue(lastWiFiAttempt, timeout, now));
+    } else if (!mqttClient.connected()) {
+        waitMs = std::min(waitMs, untilDue(lastMQTTAttempt, mqttReconnectDelay, now));
+    }
+    int64_t waitUs = (int64_t)waitMs * 1000;
+    int64_t changeUs = simNetwork().nextChangeUs() - nodeUs();
+    if (changeUs < waitUs) {
+        waitUs = changeUs;
+    }
+    return waitUs / PASS_US * PASS_US;
+}
+
+// ==================== Report ====================
+static int failures = 0;
+
+static void verdict(bool ok, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void verdict(bool ok, const char* format, ...) {
+    if (!ok) {
+        failures++;
+    }
+    printf("%s ", ok ? "✓" : "✗");
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+static void reportCadence(const Cadence& c) {
+    if (c.count < 2) {
+        verdict(false, "%-8s %llu run(s), no interval to check", c.name, (unsigned long long)c.count);
+        return;
+    }
+    uint64_t intervals = c.count - 1;
+    double meanMs = (double)c.totalMs / intervals;
+    double driftPercent = 100.0 * (meanMs - c.intervalMs) / c.intervalMs;
+    printf("  %-8s %llu runs every %lu ms: min %lu, mean %.2f, max %lu ms (day %.2f), %llu late during outages\n",
+           c.name, (unsigned long long)c.count, c.intervalMs, c.minMs, meanMs, c.maxMs, c.maxAtUs / (double)DAY_US,
+           (unsigned long long)c.lateInOutage);
+    verdict(c.early == 0 && c.late == 0, "%-8s %llu early, %llu more than %d ms late outside outages",
+            c.name, (unsigned long long)c.early, (unsigned long long)c.late, STALL_THRESHOLD_MS);
+    verdict(driftPercent <= MAX_DRIFT_PERCENT, "%-8s drift %+.3f%% (%.1f s over the run, limit %.1f%%)",
+            c.name, driftPercent, (c.totalMs - (double)intervals * c.intervalMs) / 1000.0, MAX_DRIFT_PERCENT);
+}
+
+static void reportOutages() {
+    const Backoff& b = run.backoff;
+    for (size_t i = 0; i < run.outages.size(); i++) {
+        const SimOutage& o = run.outages[i];
+        int64_t backUs = -1;
+        for (size_t s = 0; s < b.sessionUs.size(); s++) {
+            if (b.sessionUs[s] >= o.endUs) {
+                backUs = b.sessionUs[s];
+                break;
+            }
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%s outage at day %.2f (%.0f min)", outageName(o.kind),
+                 o.startUs / (double)DAY_US, (o.endUs - o.startUs) / 60e6);
+        if (backUs < 0) {
+            verdict(false, "%s: no MQTT session afterwards", label);
+            continue;
+        }
+        int64_t boundUs = recoveryBoundUs(o.kind);
+        verdict(backUs - o.endUs <= boundUs, "%s: MQTT back %.1f s after it ended (limit %.1f s)",
+                label, (backUs - o.endUs) / 1e6, boundUs / 1e6);
+    }
+}
+
+static void report(double wall) {
+    const Options& options = run.options;
+    int64_t endUs = nodeUs();
+    printf("\n%.2f days of node time in %.1f s (%.0fx), %llu loop() passes\n\n", endUs / (double)DAY_US, wall,
+           endUs / 1e6 / wall, (unsigned long long)run.passes);
+
+    reportCadence(run.reads);
+    reportCadence(run.publishes);
+    reportCadence(run.health);
+
+    verdict(run.staleSensors == 0 && run.freshMismatch == 0,
+            "freshness: %llu checks, oldest good read %lld ms, %llu stale, %llu isDataFresh() mismatches",
+            (unsigned long long)run.freshChecks, (long long)run.worstAgeMs, (unsigned long long)run.staleSensors,
+            (unsigned long long)run.freshMismatch);
+
+    if (sizeof(unsigned long) > 4) {
+        printf("⊘ millis() rollover not exercised: unsigned long is %zu bytes (build with -m32)\n",
+               sizeof(unsigned long));
+    } else if (run.millisWraps == 0) {
+        printf("⊘ millis() rollover not reached (day 49.71, ran %.2f days)\n", endUs / (double)DAY_US);
+    } else {
+        printf("✓ millis() wrapped %u time(s), first at day %.2f; checks above span it\n", run.millisWraps,
+               run.firstWrapUs / (double)DAY_US);
+    }
+
+    size_t heapEnd = SimHeap::get().internalUsed();
+    if (run.heapDay1Taken) {
+        int64_t growth = (int64_t)heapEnd - (int64_t)run.heapDay1;
+        verdict(growth <= MAX_HEAP_GROWTH_BYTES,
+                "heap: %zu bytes in use after day 1, %zu at the end (%+lld, limit %lld), peak %zu, min free %u",
+                run.heapDay1, heapEnd, (long long)growth, (long long)MAX_HEAP_GROWTH_BYTES, run.heapPeak,
+                ESP.getMinFreeHeap());
+    } else {
+        printf("⊘ heap growth needs more than a day (%zu bytes in use, peak %zu)\n", heapEnd, run.heapPeak);
+    }
+    #ifdef MEMORY_COUNT_ALLOCATIONS
+    double days = endUs / (double)DAY_US;
+    printf("  allocations: %llu calls, %.1f MB (%.0f calls, %.1f KB per day of node time, libraries and shim included)\n",
+           (unsigned long long)run.allocCalls, run.allocBytes / 1048576.0, run.allocCalls / days,
+           run.allocBytes / 1024.0 / days);
+    #endif
+
+    SimWatchdog& watchdog = SimWatchdog::get();
+    verdict(watchdog.expired == 0, "watchdog: longest gap between resets %.2f s (day %.2f), timeout %d s",
+            watchdog.maxGapUs / 1e6, watchdog.maxGapAtUs / (double)DAY_US, WATCHDOG_TIMEOUT);
+    if (run.stallsOutside > 0) {
+        verdict(false, "stalls: %u during outages, %u outside them (first at day %.4f)", run.stallsInOutage,
+                run.stallsOutside, run.firstStrayStallUs / (double)DAY_US);
+    } else {
+        verdict(true, "stalls: %u, all during outages", run.stallsInOutage);
+    }
+
+    const Backoff& b = run.backoff;
+    verdict(b.wrongDelay == 0 && b.early == 0 && b.late == 0,
+            "MQTT backoff: %llu attempts, %llu failed, %llu retries checked (%llu failovers within a round, "
+            "%zu endpoints, %llu probes): %llu with the wrong delay, %llu early, %llu late (worst +%.1f s)",
+            (unsigned long long)b.attempts, (unsigned long long)b.failures, (unsigned long long)b.checked,
+            (unsigned long long)b.failovers, brokerPool.getEndpointCount(), (unsigned long long)b.probes,
+            (unsigned long long)b.wrongDelay, (unsigned long long)b.early, (unsigned long long)b.late,
+            b.worstLateUs / 1e6);
+    verdict(b.notReset == 0, "MQTT backoff reset on %llu of %llu sessions",
+            (unsigned long long)(b.resetsChecked - b.notReset), (unsigned long long)b.resetsChecked);
+    reportOutages();
+
+    const SimBrokerStats& broker = simNetwork().getStats();
+    printf("  broker: %u sessions, %u publishes (%llu sensor, %llu health, %llu other), %.1f MB, %u pings, "
+           "%u refused, %u timed out, %u connections dropped\n",
+           broker.sessions, broker.publishes, (unsigned long long)run.sensorMessages,
+           (unsigned long long)run.healthMessages, (unsigned long long)run.otherMessages,
+           broker.publishBytes / 1048576.0, broker.pings, broker.refused, broker.timeouts, broker.dropped);
+    if (options.defaultOutages && run.outages.empty()) {
+        printf("⊘ no default outage falls within %.2f days\n", options.days);
+    }
+    printf("\n%s\n", failures == 0 ? "PASS" : "FAIL");
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [--days N] [--step MS] [--report DAYS] [--seed N] [--log]\n"
+            "          [--no-outages | --outage wifi|broker|blackhole@DAY+MINUTES ...]\n", name);
+}
+
+int main(int argc, char** argv) {
+    Options& options = run.options;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--days") == 0 && hasValue) {
+            options.days = atof(argv[++i]);
+        } else if (strcmp(arg, "--step") == 0 && hasValue) {
+            options.stepMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--report") == 0 && hasValue) {
+            options.reportDays = atof(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--log") == 0) {
+            options.log = true;
+        } else if (strcmp(arg, "--no-outages") == 0) {
+            options.defaultOutages = false;
+        } else if (strcmp(arg, "--outage") == 0 && hasValue) {
+            OutageSpec spec;
+            if (!parseOutage(argv[++i], spec)) {
+                usage(argv[0]);
+                return 1;
+            }
+            options.defaultOutages = false;
+            options.outages.push_back(spec);
+        } else {
+            usage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 1;
+        }
+    }
+    if (options.days <= 0 || options.stepMs < 10 || options.reportDays <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (options.defaultOutages) {
+        const OutageSpec defaults[] = {
+            { OUTAGE_BROKER, 2.5, 10 },
+            { OUTAGE_WIFI, 9.25, 3 },
+            { OUTAGE_BLACKHOLE, 20.75, 8 },
+            { OUTAGE_BROKER, 49.8, 5 },
+        };
+        options.outages.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+    }
+    Serial.setEnabled(options.log);
+
+    NodeHardware hardware(options.seed);
+    SimContext context(hardware);
+
+    int64_t endUs = (int64_t)(options.days * DAY_US);
+    SimNetwork& network = simNetwork();
+    for (size_t i = 0; i < options.outages.size(); i++) {
+        const OutageSpec& spec = options.outages[i];
+        int64_t startUs = (int64_t)(spec.day * DAY_US);
+        if (startUs < endUs) {
+            network.addOutage(spec.kind, startUs, (int64_t)(spec.minutes * 60e6));
+        }
+    }
+    run.outages = network.getOutages();
+    printf("%.2f days of node time, seed %llu, jumps of at most %lu ms, %zu outage(s)\n", options.days,
+           (unsigned long long)options.seed, options.stepMs, run.outages.size());
+    for (size_t i = 0; i < run.outages.size(); i++) {
+        const SimOutage& o = run.outages[i];
+        printf("  %s at day %.2f for %.0f min\n", outageName(o.kind), o.startUs / (double)DAY_US,
+               (o.endUs - o.startUs) / 60e6);
+    }
+    fflush(stdout);
+    run.backoff.sessionUs.reserve(4096);
+    network.onConnectAttempt = onConnectAttempt;
+    network.onSession = onSession;
+    network.onPublish = onPublish;
+    SimHeap::get().internalUsed();  // Baseline: what the host holds before the firmware starts
+
+    double wallStart = wallS();
+    setup();
+    initCadence(run.reads, "reads", &lastSensorRead, runtimeSettings.sensorReadInterval);
+    initCadence(run.publishes, "publish", &lastSensorPublish, runtimeSettings.sensorPublishInterval);
+    initCadence(run.health, "health", &lastHealthMsg, runtimeSettings.healthMsgInterval);
+    run.lastMillis = millis();
+    run.lastStalls = stallMonitor.getTotalStalls();
+    #ifdef MEMORY_COUNT_ALLOCATIONS
+    run.lastAllocCalls = memoryAllocCalls;
+    run.lastAllocBytes = memoryAllocBytes;
+    #endif
+
+    int64_t nextReportUs = (int64_t)(options.reportDays * DAY_US);
+    while (nodeUs() < endUs) {
+        loop();
+        observe();
+        int64_t jumpUs = idleUs(options.stepMs);
+        if (jumpUs > 0) {
+            hardware.advance(std::min(nodeUs() + jumpUs, endUs));
+        }
+        if (nodeUs() >= nextReportUs) {
+            nextReportUs += (int64_t)(options.reportDays * DAY_US);
+            printf("[day %6.2f] %llu reads, %llu sensor / %llu health messages at the broker, "
+                   "%llu MQTT sessions, heap %zu bytes in use, %.1f s\n",
+                   nodeUs() / (double)DAY_US, (unsigned long long)run.reads.count,
+                   (unsigned long long)run.sensorMessages, (unsigned long long)run.healthMessages,
+                   (unsigned long long)run.backoff.sessions, SimHeap::get().internalUsed(), wallS() - wallStart);
+            fflush(stdout);
+        }
+    }
+    report(wallS() - wallStart);
+    return failures == 0 ? 0 : 1;
+}
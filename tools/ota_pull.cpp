@@ -0,0 +1,276 @@
+// Host run of the node's HTTP OTA download path against ota_server.py.
+//
+// Build:  g++ -std=c++11 -O2 -pthread -I../include ota_pull.cpp -o ota_pull
+// Usage:  ota_pull [--interval-ms N] [--flash-us-per-kb N] [--out FILE] [--verify FILE] URL
+//
+// Downloads URL over HTTP/1.0 in OTA_READ_CHUNK_BYTES reads, inflates gzip
+// images with the firmware's GzipInflater, and writes the image to --out.
+// Meanwhile a sampler thread "reads sensors" every --interval-ms, as loop()
+// does while the OTA task runs. --flash-us-per-kb stalls the sampler for that
+// long per KB written, like the cache-disabled flash writes on the ESP32.
+// Prints transfer size/time and the longest gap between samples.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "GzipInflater.h"
+
+#ifndef OTA_READ_CHUNK_BYTES
+#define OTA_READ_CHUNK_BYTES 1024   // Same as config.h
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Held while "flash" is written; the sampler waits on it like a stalled core
+static std::mutex flashLock;
+
+struct Download {
+    int socket = -1;
+    uint8_t buffer[OTA_READ_CHUNK_BYTES];
+    size_t length = 0;
+    size_t position = 0;
+    long remaining = -1;
+    size_t received = 0;
+};
+
+struct Image {
+    FILE* out = nullptr;
+    std::vector<uint8_t> data;
+    unsigned flashUsPerKb = 0;
+};
+
+static bool fill(Download& d) {
+    if (d.remaining == 0) {
+        return false;
+    }
+    size_t want = sizeof(d.buffer);
+    if (d.remaining > 0 && (size_t)d.remaining < want) {
+        want = (size_t)d.remaining;
+    }
+    ssize_t n = recv(d.socket, d.buffer, want, 0);
+    if (n <= 0) {
+        return false;
+    }
+    d.length = (size_t)n;
+    d.position = 0;
+    d.received += n;
+    if (d.remaining > 0) {
+        d.remaining -= n;
+    }
+    return true;
+}
+
+static int readByte(void* context) {
+    Download& d = *static_cast<Download*>(context);
+    if (d.position == d.length && !fill(d)) {
+        return -1;
+    }
+    return d.buffer[d.position++];
+}
+
+static bool writeImage(void* context, const uint8_t* data, size_t length) {
+    Image& image = *static_cast<Image*>(context);
+    if (image.flashUsPerKb > 0) {
+        std::lock_guard<std::mutex> stall(flashLock);
+        std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)image.flashUsPerKb * length / 1024));
+    }
+    image.data.insert(image.data.end(), data, data + length);
+    return image.out == nullptr || fwrite(data, 1, length, image.out) == length;
+}
+
+static bool parseUrl(const std::string& url, std::string& host, std::string& port, std::string& path) {
+    if (url.compare(0, 7, "http://") != 0) {
+        return false;
+    }
+    size_t hostStart = 7;
+    size_t pathStart = url.find('/', hostStart);
+    std::string authority = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+    size_t colon = authority.find(':');
+    host = authority.substr(0, colon);
+    port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+    return !host.empty();
+}
+
+// Connect, send the request and consume the response header
+static bool openDownload(const std::string& url, Download& d) {
+    std::string host, port, path;
+    if (!parseUrl(url, host, port, path)) {
+        fprintf(stderr, "only http://host[:port]/path URLs are supported\n");
+        return false;
+    }
+    addrinfo hints = {};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        fprintf(stderr, "cannot resolve %s\n", host.c_str());
+        return false;
+    }
+    for (addrinfo* a = addresses; a != nullptr && d.socket < 0; a = a->ai_next) {
+        d.socket = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (d.socket >= 0 && connect(d.socket, a->ai_addr, a->ai_addrlen) != 0) {
+            close(d.socket);
+            d.socket = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (d.socket < 0) {
+        fprintf(stderr, "cannot connect to %s:%s\n", host.c_str(), port.c_str());
+        return false;
+    }
+
+    std::string request = "GET " + path + " HTTP/1.0\r\nHost: " + host + "\r\n\r\n";
+    if (send(d.socket, request.data(), request.size(), 0) != (ssize_t)request.size()) {
+        return false;
+    }
+
+    std::string header;
+    char c;
+    while (header.size() < 4 || header.compare(header.size() - 4, 4, "\r\n\r\n") != 0) {
+        if (recv(d.socket, &c, 1, 0) != 1 || header.size() > 8192) {
+            fprintf(stderr, "bad response header\n");
+            return false;
+        }
+        header += c;
+    }
+    int status = 0;
+    sscanf(header.c_str(), "HTTP/%*d.%*d %d", &status);
+    if (status != 200) {
+        fprintf(stderr, "HTTP %d\n", status);
+        return false;
+    }
+    const char* length = strcasestr(header.c_str(), "\r\nContent-Length:");
+    if (length != nullptr) {
+        d.remaining = strtol(length + 17, nullptr, 10);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    unsigned intervalMs = 1000;
+    unsigned flashUsPerKb = 0;
+    const char* outPath = nullptr;
+    const char* verifyPath = nullptr;
+    const char* url = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            intervalMs = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--flash-us-per-kb") == 0 && i + 1 < argc) {
+            flashUsPerKb = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--verify") == 0 && i + 1 < argc) {
+            verifyPath = argv[++i];
+        } else if (argv[i][0] != '-') {
+            url = argv[i];
+        } else {
+            url = nullptr;
+            break;
+        }
+    }
+    if (url == nullptr) {
+        fprintf(stderr, "usage: %s [--interval-ms N] [--flash-us-per-kb N] [--out FILE] [--verify FILE] URL\n", argv[0]);
+        return 2;
+    }
+
+    Image image;
+    image.flashUsPerKb = flashUsPerKb;
+    if (outPath != nullptr && (image.out = fopen(outPath, "wb")) == nullptr) {
+        perror(outPath);
+        return 1;
+    }
+
+    // Sampler standing in for loop(): one read per interval, blocked while flash is written
+    std::atomic<bool> running(true);
+    size_t samples = 0;
+    double maxGapMs = 0;
+    std::thread sampler([&]() {
+        Clock::time_point last = Clock::now();
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+            std::lock_guard<std::mutex> sample(flashLock);
+            double gap = msSince(last);
+            if (gap > maxGapMs) {
+                maxGapMs = gap;
+            }
+            last = Clock::now();
+            samples++;
+        }
+    });
+
+    Clock::time_point start = Clock::now();
+    Download download;
+    bool ok = openDownload(url, download);
+    const char* error = ok ? nullptr : "request failed";
+    if (ok && !fill(download)) {
+        ok = false;
+        error = "no data";
+    }
+    bool compressed = false;
+    if (ok) {
+        compressed = GzipInflater::isGzip(download.buffer, download.length);
+        if (compressed) {
+            static uint8_t window[GzipInflater::WINDOW_SIZE];
+            GzipInflater inflater(window);
+            GzipInflater::Result result = inflater.inflate(readByte, &download, writeImage, &image);
+            ok = result == GzipInflater::GZIP_OK;
+            error = GzipInflater::resultName(result);
+        } else {
+            do {
+                ok = writeImage(&image, download.buffer, download.length);
+            } while (ok && fill(download));
+            ok = ok && download.remaining <= 0;
+            error = ok ? nullptr : "connection lost";
+        }
+    }
+    double transferMs = msSince(start);
+    running = false;
+    sampler.join();
+    if (download.socket >= 0) {
+        close(download.socket);
+    }
+    if (image.out != nullptr) {
+        fclose(image.out);
+    }
+
+    if (ok && verifyPath != nullptr) {
+        FILE* f = fopen(verifyPath, "rb");
+        std::vector<uint8_t> expected;
+        int c;
+        while (f != nullptr && (c = fgetc(f)) != EOF) {
+            expected.push_back((uint8_t)c);
+        }
+        if (f != nullptr) {
+            fclose(f);
+        }
+        if (expected != image.data) {
+            ok = false;
+            error = "image differs from --verify file";
+        }
+    }
+
+    fprintf(stderr, "%s: %zu bytes%s -> %zu byte image (%.1f%%)\n", ok ? "ok" : "FAILED",
+            download.received, compressed ? " gzip" : "", image.data.size(),
+            image.data.empty() ? 0.0 : 100.0 * download.received / image.data.size());
+    if (!ok) {
+        fprintf(stderr, "error:    %s\n", error);
+    }
+    fprintf(stderr, "transfer: %.0f ms (%.1f KB/s on the wire)\n", transferMs,
+            transferMs > 0 ? download.received / 1.024 / transferMs : 0.0);
+    fprintf(stderr, "sampling: %zu reads every %u ms, longest gap %.0f ms\n", samples, intervalMs, maxGapMs);
+    return ok ? 0 : 1;
+}
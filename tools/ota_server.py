@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Local stand-in for an OTA image server.
+
+Serves firmware images over plain HTTP/1.0 with a Content-Length, the way the
+node's otaUpdate command downloads them. Asking for <name>.gz when only <name>
+exists compresses it on the fly (gzip -9, cached), so the same build can be
+fetched raw or compressed. --rate throttles the response to mimic a WiFi link.
+Each transfer is logged with its size and duration.
+
+The node only accepts an otaUpdate command carrying the image's MD5 and an
+"auth" field, the MD5 of "<OTA_PASSWORD>:<md5>". With --password the server
+prints a ready-to-publish command for every *.bin in DIR.
+
+Usage:
+  python3 ota_server.py [--port 8000] [--rate KBPS] [--password PW] [DIR]
+
+  # on the node (MQTT_TOPIC_CONFIG):
+  {"command": "otaUpdate", "url": "http://<host>:8000/firmware.bin.gz",
+   "md5": "<md5 of firmware.bin>", "auth": "<md5 of PW:md5>"}
+  # or on the host:
+  ./ota_pull http://localhost:8000/firmware.bin.gz
+"""
+
+import argparse
+import gzip
+import hashlib
+import http.server
+import json
+import os
+import sys
+import time
+
+
+class OtaHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"
+    root = "."
+    rate = 0  # bytes per second, 0 = unlimited
+    cache = {}
+
+    def load(self, name):
+        path = os.path.join(self.root, os.path.basename(name))
+        if os.path.isfile(path):
+            with open(path, "rb") as f:
+                return f.read()
+        if name.endswith(".gz"):
+            raw = self.load(name[:-3])
+            if raw is not None:
+                if name not in self.cache:
+                    self.cache[name] = gzip.compress(raw, compresslevel=9, mtime=0)
+                return self.cache[name]
+        return None
+
+    def do_GET(self):
+        body = self.load(self.path.lstrip("/"))
+        if body is None:
+            self.send_error(404)
+            return
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+
+        start = time.monotonic()
+        chunk = 1460
+        for offset in range(0, len(body), chunk):
+            self.wfile.write(body[offset:offset + chunk])
+            if self.rate:
+                due = start + (offset + chunk) / self.rate
+                delay = due - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+        elapsed = time.monotonic() - start
+        self.log_message("sent %s: %d bytes in %.2f s (%.1f KB/s)", self.path, len(body),
+                         elapsed, len(body) / 1024 / elapsed if elapsed > 0 else 0)
+
+
+def print_commands(root, port, password):
+    """Print an otaUpdate command for each image (md5 is of the uncompressed image)."""
+    for name in sorted(os.listdir(root)):
+        if not name.endswith(".bin"):
+            continue
+        with open(os.path.join(root, name), "rb") as f:
+            md5 = hashlib.md5(f.read()).hexdigest()
+        auth = hashlib.md5(f"{password}:{md5}".encode()).hexdigest()
+        command = {"command": "otaUpdate", "url": f"http://<host>:{port}/{name}.gz",
+                   "md5": md5, "auth": auth}
+        print(json.dumps(command), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dir", nargs="?", default=".", help="directory with firmware images")
+    parser.add_argument("--port", type=int, default=8000)
+    parser.add_argument("--rate", type=float, default=0, help="throttle to KB/s (0 = unlimited)")
+    parser.add_argument("--password", help="OTA_PASSWORD: print otaUpdate commands for DIR/*.bin")
+    args = parser.parse_args()
+
+    if args.password is not None:
+        print_commands(args.dir, args.port, args.password)
+
+    OtaHandler.root = args.dir
+    OtaHandler.rate = args.rate * 1024
+    server = http.server.ThreadingHTTPServer(("", args.port), OtaHandler)
+    print(f"serving {os.path.abspath(args.dir)} on port {args.port}", file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,21 @@
+#ifndef SIM_ADAFRUIT_SHT31_H
+#define SIM_ADAFRUIT_SHT31_H
+
+#include "Wire.h"
+
+/**
+ * @brief Adafruit_SHT31 subset: begin() probes the address with a soft reset
+ */
+class Adafruit_SHT31 {
+public:
+    bool begin(uint8_t address = 0x44) {
+        const uint8_t softReset[2] = { 0x30, 0xA2 };
+        if (simHardware().i2cWrite(address, softReset, sizeof(softReset)) != 0) {
+            return false;
+        }
+        delay(10);
+        return true;
+    }
+};
+
+#endif // SIM_ADAFRUIT_SHT31_H
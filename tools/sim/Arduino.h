@@ -0,0 +1,191 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// Arduino core subset used by the drivers, backed by SimHardware
+
+#include <math.h>
+#include <algorithm>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SimHardware.h"
+#include "WString.h"
+#include "esp_heap_caps.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+using std::min;
+using std::max;
+
+enum adc_attenuation_t { ADC_0db, ADC_2_5db, ADC_6db, ADC_11db };
+
+inline unsigned long millis() {
+    return (unsigned long)(simHardware().now() / 1000);
+}
+
+inline unsigned long micros() {
+    return (unsigned long)simHardware().now();
+}
+
+inline void delay(uint32_t ms) {
+    SimHardware& hw = simHardware();
+    hw.advance(hw.now() + (int64_t)ms * 1000);
+}
+
+inline void delayMicroseconds(uint32_t us) {
+    SimHardware& hw = simHardware();
+    hw.advance(hw.now() + us);
+}
+
+inline void yield() {}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    simHardware().pinMode(pin, mode);
+}
+
+inline int digitalRead(uint8_t pin) {
+    return simHardware().digitalRead(pin);
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+    simHardware().digitalWrite(pin, level);
+}
+
+inline uint16_t analogRead(uint8_t pin) {
+    return simHardware().analogRead(pin);
+}
+
+inline void analogSetAttenuation(adc_attenuation_t) {}
+inline void analogSetWidth(uint8_t) {}
+
+inline unsigned long pulseIn(uint8_t pin, uint8_t level, unsigned long timeoutUs = 1000000) {
+    return simHardware().pulseIn(pin, level, timeoutUs);
+}
+
+#define digitalPinToInterrupt(p) (p)
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int) {
+    simHardware().attachInterrupt(pin, isr, arg);
+}
+
+inline void detachInterrupt(uint8_t pin) {
+    simHardware().detachInterrupt(pin);
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size > 0) {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return length;
+}
+#endif
+
+inline bool psramFound() {
+    return true;
+}
+
+/**
+ * @brief ESP object: heap figures from esp_heap_caps.h
+ */
+class EspClass {
+public:
+    uint32_t getHeapSize() {
+        return (uint32_t)heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
+    }
+
+    uint32_t getFreeHeap() {
+        return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    }
+
+    uint32_t getMinFreeHeap() {
+        return (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    }
+
+    uint32_t getMaxAllocHeap() {
+        return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    }
+
+    /**
+     * @brief A restart ends the simulated run (nothing reboots the node)
+     */
+    void restart() {
+        fflush(stdout);
+        fprintf(stderr, "ESP.restart() at %.3f s of node time\n", simHardware().now() / 1e6);
+        exit(3);
+    }
+};
+
+extern EspClass ESP;
+
+/**
+ * @brief Serial sink: discarded unless enabled (the drivers log every read)
+ */
+class SimSerial {
+private:
+    bool enabled;
+
+public:
+    SimSerial() : enabled(false) {}
+
+    void setEnabled(bool on) {
+        enabled = on;
+    }
+
+    void begin(unsigned long) {}
+
+    __attribute__((format(printf, 2, 3))) int printf(const char* format, ...) {
+        if (!enabled) {
+            return 0;
+        }
+        va_list args;
+        va_start(args, format);
+        int n = vprintf(format, args);
+        va_end(args);
+        return n;
+    }
+
+    size_t print(const char* text) {
+        return enabled ? (size_t)fputs(text, stdout) : 0;
+    }
+
+    size_t println(const char* text = "") {
+        return enabled ? (size_t)::printf("%s\n", text) : 0;
+    }
+
+    size_t print(const String& text) {
+        return print(text.c_str());
+    }
+
+    size_t println(const String& text) {
+        return println(text.c_str());
+    }
+
+    size_t println(int value) {
+        return enabled ? (size_t)::printf("%d\n", value) : 0;
+    }
+};
+
+extern SimSerial Serial;
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,68 @@
+#ifndef SIM_ARDUINO_OTA_H
+#define SIM_ARDUINO_OTA_H
+
+// ArduinoOTA that never receives an upload (the callbacks are kept, not called)
+
+#include <functional>
+#include "Arduino.h"
+
+#define U_FLASH 0
+#define U_SPIFFS 100
+
+typedef enum {
+    OTA_AUTH_ERROR,
+    OTA_BEGIN_ERROR,
+    OTA_CONNECT_ERROR,
+    OTA_RECEIVE_ERROR,
+    OTA_END_ERROR
+} ota_error_t;
+
+class ArduinoOTAClass {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+    typedef std::function<void(ota_error_t)> THandlerFunction_Error;
+    typedef std::function<void(unsigned int, unsigned int)> THandlerFunction_Progress;
+
+private:
+    THandlerFunction startCallback;
+    THandlerFunction endCallback;
+    THandlerFunction_Error errorCallback;
+    THandlerFunction_Progress progressCallback;
+
+public:
+    ArduinoOTAClass& setHostname(const char*) { return *this; }
+    ArduinoOTAClass& setPassword(const char*) { return *this; }
+    ArduinoOTAClass& setPort(uint16_t) { return *this; }
+    ArduinoOTAClass& setRebootOnSuccess(bool) { return *this; }
+
+    ArduinoOTAClass& onStart(THandlerFunction fn) {
+        startCallback = fn;
+        return *this;
+    }
+
+    ArduinoOTAClass& onEnd(THandlerFunction fn) {
+        endCallback = fn;
+        return *this;
+    }
+
+    ArduinoOTAClass& onError(THandlerFunction_Error fn) {
+        errorCallback = fn;
+        return *this;
+    }
+
+    ArduinoOTAClass& onProgress(THandlerFunction_Progress fn) {
+        progressCallback = fn;
+        return *this;
+    }
+
+    void begin() {}
+    void handle() {}
+
+    int getCommand() {
+        return U_FLASH;
+    }
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif // SIM_ARDUINO_OTA_H
@@ -0,0 +1,40 @@
+#ifndef SIM_HTTP_CLIENT_H
+#define SIM_HTTP_CLIENT_H
+
+// HTTP client whose requests all fail (no web server on the simulated network)
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTP_CODE_OK 200
+
+class HTTPClient {
+public:
+    bool begin(const char* /*url*/) {
+        return false;
+    }
+
+    bool begin(const String& /*url*/) {
+        return false;
+    }
+
+    void useHTTP10(bool) {}
+    void setTimeout(uint16_t) {}
+
+    int GET() {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    int getSize() {
+        return -1;
+    }
+
+    WiFiClient* getStreamPtr() {
+        return nullptr;
+    }
+
+    void end() {}
+};
+
+#endif // SIM_HTTP_CLIENT_H
@@ -0,0 +1,272 @@
+#ifndef SIM_HAL_REPLAY_H
+#define SIM_HAL_REPLAY_H
+
+// hal:: for -DHAL_REPLAY builds: the drivers' reads are answered from a
+// capture recorded on a device (HalTrace.h) instead of the hardware.
+
+#include <stdio.h>
+#include "Arduino.h"
+#include "HalTrace.h"
+
+/**
+ * @brief Feeds recorded hardware responses back to the drivers
+ *
+ * The replay tool walks the capture and calls the driver method each CALL
+ * marker names with setLive(true); every hal:: read made meanwhile must find
+ * a record of its own type next (interrupt handlers recorded in between are
+ * run first, as they ran on the device). Anything else is a divergence: the
+ * code under replay no longer makes the reads the device made. Outside live
+ * calls reads return neutral values and consume nothing.
+ */
+class HalReplay {
+public:
+    typedef void (*Isr)(void*);
+
+private:
+    static const uint8_t PIN_COUNT = 40;
+
+    HalTraceReader& reader;
+    Isr isrs[PIN_COUNT];
+    void* isrArgs[PIN_COUNT];
+    int64_t timeUs;
+    bool live;
+    bool ended;
+    bool endRecord;             // Ended by an END record (not by running out of data)
+    uint8_t endReason;
+    bool diverged;
+    size_t records;
+    char message[160];
+
+    void diverge(const char* wanted, const HalRecord& found) {
+        if (!diverged) {
+            diverged = true;
+            snprintf(message, sizeof(message), "read %s, capture has %s at byte %zu", wanted,
+                     halRecordName(found.type), reader.getPosition());
+        }
+    }
+
+    /**
+     * @brief Next record for a live read of the given type, running recorded interrupts first
+     * @return false if the read cannot be answered (the caller returns a neutral value)
+     */
+    bool take(uint8_t type, HalRecord& r) {
+        if (!live || ended || diverged) {
+            return false;
+        }
+        while (true) {
+            if (!next(r)) {
+                ended = true;  // Data ends here (chunks missing): nothing left to compare
+                return false;
+            }
+            if (r.type == HAL_REC_ISR) {
+                runIsr((uint8_t)r.value);
+                if (diverged || ended) {
+                    return false;
+                }
+                continue;
+            }
+            if (r.type == HAL_REC_END) {
+                markEnded(r.aux);  // Capture cut off inside the call: not a divergence
+                return false;
+            }
+            if (r.type != type) {
+                diverge(halRecordName(type), r);
+                return false;
+            }
+            return true;
+        }
+    }
+
+public:
+    explicit HalReplay(HalTraceReader& r)
+        : reader(r), timeUs(r.getTime()), live(false), ended(false), endRecord(false), endReason(0),
+          diverged(false), records(0) {
+        for (uint8_t i = 0; i < PIN_COUNT; i++) {
+            isrs[i] = nullptr;
+            isrArgs[i] = nullptr;
+        }
+        message[0] = '\0';
+    }
+
+    /**
+     * @brief Decode the next record (for the tool's own walk over the markers)
+     */
+    bool next(HalRecord& r) {
+        if (!reader.next(r)) {
+            return false;
+        }
+        records++;
+        if (r.type == HAL_REC_TIME) {
+            timeUs = r.value;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run the handler the firmware had attached to pin, with its reads live
+     */
+    void runIsr(uint8_t pin) {
+        if (pin >= PIN_COUNT || isrs[pin] == nullptr) {
+            if (!diverged) {
+                diverged = true;
+                snprintf(message, sizeof(message), "interrupt on pin %u with no handler attached", pin);
+            }
+            return;
+        }
+        bool wasLive = live;
+        live = true;
+        isrs[pin](isrArgs[pin]);
+        live = wasLive;
+    }
+
+    void setLive(bool on) {
+        live = on;
+    }
+
+    void markEnded(uint8_t reason) {
+        ended = true;
+        endRecord = true;
+        endReason = reason;
+    }
+
+    void fail(const char* text) {
+        if (!diverged) {
+            diverged = true;
+            snprintf(message, sizeof(message), "%s", text);
+        }
+    }
+
+    // ---- hal:: backends ----
+
+    int64_t now() {
+        HalRecord r;
+        if (take(HAL_REC_TIME, r)) {
+            timeUs = r.value;
+        }
+        return timeUs;
+    }
+
+    int64_t value(uint8_t type, int64_t neutral) {
+        HalRecord r;
+        if (!take(type, r)) {
+            return neutral;
+        }
+        return (type == HAL_REC_DIGITAL || type == HAL_REC_I2C_WRITE) ? r.aux : r.value;
+    }
+
+    size_t i2cRead(uint8_t* data, size_t length) {
+        HalRecord r;
+        if (!take(HAL_REC_I2C_READ, r)) {
+            return 0;
+        }
+        size_t n = r.count < length ? r.count : length;
+        memcpy(data, r.bytes, n);
+        return n;
+    }
+
+    void attach(uint8_t pin, Isr isr, void* arg) {
+        if (pin < PIN_COUNT) {
+            isrs[pin] = isr;
+            isrArgs[pin] = arg;
+        }
+    }
+
+    int64_t getTime() const {
+        return timeUs;
+    }
+
+    bool isEnded() const {
+        return ended;
+    }
+
+    /**
+     * @brief Whether the capture ended with an END record, and why (HalEndReason)
+     */
+    bool hasEndRecord(uint8_t& reason) const {
+        reason = endReason;
+        return endRecord;
+    }
+
+    bool isDiverged() const {
+        return diverged;
+    }
+
+    const char* getMessage() const {
+        return message;
+    }
+
+    size_t getRecordCount() const {
+        return records;
+    }
+
+    HalTraceReader& getReader() {
+        return reader;
+    }
+
+    /**
+     * @brief Replay the drivers on this thread currently read from
+     */
+    static HalReplay*& current() {
+        static thread_local HalReplay* replay = nullptr;
+        return replay;
+    }
+};
+
+namespace hal {
+
+inline int64_t now() {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? r->now() : 0;
+}
+
+inline int digitalRead(uint8_t /*pin*/) {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? (int)r->value(HAL_REC_DIGITAL, 0) : 0;
+}
+
+inline void digitalWrite(uint8_t /*pin*/, uint8_t /*level*/) {}
+inline void pinMode(uint8_t /*pin*/, uint8_t /*mode*/) {}
+
+inline uint16_t analogRead(uint8_t /*pin*/) {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? (uint16_t)r->value(HAL_REC_ADC, 0) : 0;
+}
+
+inline unsigned long pulseIn(uint8_t /*pin*/, uint8_t /*level*/, unsigned long /*timeoutUs*/) {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? (unsigned long)r->value(HAL_REC_PULSE, 0) : 0;
+}
+
+// Waiting is in the recorded clock already
+inline void delay(uint32_t /*ms*/) {}
+inline void delayMicroseconds(uint32_t /*us*/) {}
+
+inline uint8_t i2cWrite(uint8_t /*address*/, const uint8_t* /*data*/, size_t /*length*/) {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? (uint8_t)r->value(HAL_REC_I2C_WRITE, 0) : 0;
+}
+
+inline size_t i2cRead(uint8_t /*address*/, uint8_t* data, size_t length) {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? r->i2cRead(data, length) : 0;
+}
+
+inline int32_t outcome(int32_t result) {
+    HalReplay* r = HalReplay::current();
+    return r != nullptr ? (int32_t)r->value(HAL_REC_OUTCOME, result) : result;
+}
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int /*mode*/) {
+    HalReplay* r = HalReplay::current();
+    if (r != nullptr) {
+        r->attach(pin, isr, arg);
+    }
+}
+
+inline void detachInterrupt(uint8_t pin) {
+    attachInterruptArg(pin, nullptr, nullptr, 0);
+}
+
+}  // namespace hal
+
+#endif // SIM_HAL_REPLAY_H
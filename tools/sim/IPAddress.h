@@ -0,0 +1,76 @@
+#ifndef SIM_IPADDRESS_H
+#define SIM_IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "WString.h"
+
+/**
+ * @brief IPv4 address, as in the Arduino core
+ */
+class IPAddress {
+private:
+    uint8_t bytes[4];
+
+public:
+    IPAddress() : bytes{0, 0, 0, 0} {}
+
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+
+    // Network byte order in memory, like lwIP's u32_t addresses
+    IPAddress(uint32_t address) {
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = (uint8_t)(address >> (8 * i));
+        }
+    }
+
+    operator uint32_t() const {
+        return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 |
+               (uint32_t)bytes[3] << 24;
+    }
+
+    bool operator==(const IPAddress& other) const {
+        return (uint32_t)*this == (uint32_t)other;
+    }
+
+    bool operator!=(const IPAddress& other) const {
+        return !(*this == other);
+    }
+
+    uint8_t operator[](int index) const {
+        return bytes[index];
+    }
+
+    uint8_t& operator[](int index) {
+        return bytes[index];
+    }
+
+    /**
+     * @brief Parse a dotted quad
+     * @return false (address unchanged) if text is not one, e.g. a host name
+     */
+    bool fromString(const char* text) {
+        unsigned int parts[4];
+        char tail;
+        if (sscanf(text, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) {
+            return false;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (parts[i] > 255) {
+                return false;
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = (uint8_t)parts[i];
+        }
+        return true;
+    }
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        return String(text);
+    }
+};
+
+#endif // SIM_IPADDRESS_H
@@ -0,0 +1,20 @@
+#ifndef SIM_MD5_BUILDER_H
+#define SIM_MD5_BUILDER_H
+
+// Digest builder that never matches (no OTA in simulation, so every otaUpdate is refused)
+
+#include "Arduino.h"
+
+class MD5Builder {
+public:
+    void begin() {}
+    void add(const char* /*data*/) {}
+    void calculate() {}
+
+    void getChars(char* output) {
+        memset(output, '-', 32);  // Not hex: no auth string matches
+        output[32] = '\0';
+    }
+};
+
+#endif // SIM_MD5_BUILDER_H
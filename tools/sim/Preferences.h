@@ -0,0 +1,77 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+// NVS in memory: starts empty (a factory-fresh node), lives as long as the process
+
+#include <stddef.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+class Preferences {
+private:
+    typedef std::map<std::string, std::string> Namespace;
+
+    Namespace* open;
+    bool readOnly;
+
+    static std::map<std::string, Namespace>& storage() {
+        static std::map<std::string, Namespace> namespaces;
+        return namespaces;
+    }
+
+public:
+    Preferences() : open(nullptr), readOnly(true) {}
+
+    bool begin(const char* name, bool readOnlyMode = false) {
+        open = &storage()[name];
+        readOnly = readOnlyMode;
+        return true;
+    }
+
+    void end() {
+        open = nullptr;
+    }
+
+    size_t getBytesLength(const char* key) {
+        if (open == nullptr) {
+            return 0;
+        }
+        Namespace::const_iterator it = open->find(key);
+        return it != open->end() ? it->second.size() : 0;
+    }
+
+    size_t getBytes(const char* key, void* buffer, size_t length) {
+        if (open == nullptr) {
+            return 0;
+        }
+        Namespace::const_iterator it = open->find(key);
+        if (it == open->end() || it->second.size() > length) {
+            return 0;
+        }
+        memcpy(buffer, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    size_t putBytes(const char* key, const void* value, size_t length) {
+        if (open == nullptr || readOnly) {
+            return 0;
+        }
+        (*open)[key].assign((const char*)value, length);
+        return length;
+    }
+
+    bool remove(const char* key) {
+        return open != nullptr && !readOnly && open->erase(key) > 0;
+    }
+
+    bool clear() {
+        if (open == nullptr || readOnly) {
+            return false;
+        }
+        open->clear();
+        return true;
+    }
+};
+
+#endif // SIM_PREFERENCES_H
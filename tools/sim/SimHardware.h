@@ -0,0 +1,179 @@
+#ifndef SIM_HARDWARE_H
+#define SIM_HARDWARE_H
+
+// Host stand-in for the ESP32 under the unmodified drivers in include/. The
+// Arduino / ESP-IDF headers in this directory forward every call that touches
+// time or hardware to the SimHardware of the calling thread, so one process
+// can run many virtual nodes, each with its own clock, pins and I2C devices.
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Periodic timer of a node (esp_timer_start_periodic())
+ */
+struct SimTimer {
+    void (*callback)(void*);
+    void* arg;
+    int64_t periodUs;   // 0 = stopped
+    int64_t dueUs;
+};
+
+/**
+ * @brief Virtual clock, pins and buses of one simulated node
+ *
+ * Time only moves when the node's code waits (delay(), delayMicroseconds(),
+ * pulseIn()) or when the simulation calls advance(). Subclasses model the
+ * attached sensors; the defaults behave like an empty board.
+ */
+class SimHardware {
+public:
+    typedef void (*Isr)(void*);
+
+    static const uint8_t PIN_COUNT = 40;
+    static const uint8_t TIMER_COUNT = 8;
+
+protected:
+    int64_t nowUs;
+    Isr isrs[PIN_COUNT];
+    void* isrArgs[PIN_COUNT];
+    SimTimer* timers[TIMER_COUNT];
+
+    /**
+     * @brief Run the interrupt handler attached to pin (at the current time)
+     */
+    void fireInterrupt(uint8_t pin) {
+        if (pin < PIN_COUNT && isrs[pin] != nullptr) {
+            isrs[pin](isrArgs[pin]);
+        }
+    }
+
+public:
+    /**
+     * @brief Run the timers that came due, once each however many periods passed
+     *
+     * The simulation may skip ahead by seconds; a check timer only needs to
+     * see the clock once per step, not every period it slept through.
+     */
+    void runTimers() {
+        for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+            SimTimer* timer = timers[i];
+            if (timer == nullptr || timer->periodUs == 0 || timer->dueUs > nowUs) {
+                continue;
+            }
+            timer->dueUs += ((nowUs - timer->dueUs) / timer->periodUs + 1) * timer->periodUs;
+            timer->callback(timer->arg);
+        }
+    }
+
+public:
+    SimHardware() : nowUs(0) {
+        for (uint8_t i = 0; i < PIN_COUNT; i++) {
+            isrs[i] = nullptr;
+            isrArgs[i] = nullptr;
+        }
+        for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+            timers[i] = nullptr;
+        }
+    }
+
+    virtual ~SimHardware() {}
+
+    int64_t now() const {
+        return nowUs;
+    }
+
+    /**
+     * @brief Move the clock forward, delivering hardware events on the way
+     */
+    virtual void advance(int64_t untilUs) {
+        if (untilUs > nowUs) {
+            nowUs = untilUs;
+            runTimers();
+        }
+    }
+
+    virtual void pinMode(uint8_t /*pin*/, uint8_t /*mode*/) {}
+    virtual int digitalRead(uint8_t /*pin*/) { return 0; }
+    virtual void digitalWrite(uint8_t /*pin*/, uint8_t /*level*/) {}
+    virtual uint16_t analogRead(uint8_t /*pin*/) { return 0; }
+    virtual unsigned long pulseIn(uint8_t /*pin*/, uint8_t /*level*/, unsigned long timeoutUs) {
+        advance(nowUs + timeoutUs);
+        return 0;
+    }
+
+    /**
+     * @brief Write transaction (Wire.beginTransmission() ... endTransmission())
+     * @return Wire status: 0 = acknowledged, 2 = address NACK
+     */
+    virtual uint8_t i2cWrite(uint8_t /*address*/, const uint8_t* /*data*/, size_t /*length*/) { return 2; }
+
+    /**
+     * @brief Read transaction (Wire.requestFrom())
+     * @return Bytes received, 0 on NACK
+     */
+    virtual size_t i2cRead(uint8_t /*address*/, uint8_t* /*data*/, size_t /*length*/) { return 0; }
+
+    void attachInterrupt(uint8_t pin, Isr isr, void* arg) {
+        if (pin < PIN_COUNT) {
+            isrs[pin] = isr;
+            isrArgs[pin] = arg;
+        }
+    }
+
+    void detachInterrupt(uint8_t pin) {
+        attachInterrupt(pin, nullptr, nullptr);
+    }
+
+    bool addTimer(SimTimer* timer) {
+        for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+            if (timers[i] == nullptr) {
+                timers[i] = timer;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void removeTimer(SimTimer* timer) {
+        for (uint8_t i = 0; i < TIMER_COUNT; i++) {
+            if (timers[i] == timer) {
+                timers[i] = nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief Hardware the calling thread is currently running as
+     */
+    static SimHardware*& current() {
+        static thread_local SimHardware* hardware = nullptr;
+        return hardware;
+    }
+};
+
+/**
+ * @brief Run a node's code as that node: select its hardware for this thread
+ */
+class SimContext {
+private:
+    SimHardware* previous;
+
+public:
+    explicit SimContext(SimHardware& hardware) : previous(SimHardware::current()) {
+        SimHardware::current() = &hardware;
+    }
+
+    ~SimContext() {
+        SimHardware::current() = previous;
+    }
+};
+
+// A default board so code running outside any SimContext (static init) still works
+inline SimHardware& simHardware() {
+    static thread_local SimHardware idle;
+    SimHardware* hardware = SimHardware::current();
+    return hardware != nullptr ? *hardware : idle;
+}
+
+#endif // SIM_HARDWARE_H
@@ -0,0 +1,545 @@
+#ifndef SIM_NETWORK_H
+#define SIM_NETWORK_H
+
+// WiFi link and MQTT broker of a simulated node, on the node's virtual clock.
+// WiFiClient connections go to an in-process broker that speaks enough MQTT
+// 3.1.1 for PubSubClient (CONNECT, PUBLISH QoS 0/1, SUBSCRIBE, PINGREQ,
+// DISCONNECT). Every address and port reaches that one broker. Outages added
+// with addOutage() take the access point or the broker away for a while.
+// One node per process: the network is a singleton (see simNetwork()).
+
+#include <stdint.h>
+#include <string.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "IPAddress.h"
+#include "SimHardware.h"
+
+enum SimOutageKind {
+    OUTAGE_WIFI,        // Access point gone: association drops, open connections die
+    OUTAGE_BROKER,      // Broker process down: connections reset, connects refused after one RTT
+    OUTAGE_BLACKHOLE    // Broker host unreachable: connects time out, open connections go silent
+};
+
+struct SimOutage {
+    SimOutageKind kind;
+    int64_t startUs;
+    int64_t endUs;
+};
+
+/**
+ * @brief Broker side counters
+ */
+struct SimBrokerStats {
+    uint32_t tcpConnects;       // Accepted connections
+    uint32_t refused;           // Connects refused (broker down)
+    uint32_t timeouts;          // Connects that timed out (host unreachable)
+    uint32_t unreachable;       // Connects without WiFi
+    uint32_t sessions;          // MQTT CONNECTs accepted
+    uint32_t publishes;         // PUBLISH packets received
+    uint64_t publishBytes;      // Their payload bytes
+    uint32_t pings;
+    uint32_t dropped;           // Connections closed by an outage
+};
+
+class SimNetwork {
+public:
+    // Timing of the simulated network
+    static const int64_t ASSOCIATE_US = 2000000;       // WiFi.begin() / AP back -> WL_CONNECTED
+    static const int64_t RTT_US = 4000;                // TCP handshake, request -> response
+    static const int64_t DNS_US = 15000;
+    static const int64_t POLL_US = 1000;               // Checking an idle socket (keeps busy-waits moving)
+    static const int64_t CHECK_US = 250;               // WiFiClient::connected(): a non-blocking peek
+    static const int32_t DEFAULT_CONNECT_TIMEOUT_MS = 3000;
+
+    // Callbacks for the simulation's checks (times are node microseconds)
+    std::function<void(int64_t, bool)> onConnectAttempt;            // ok = TCP connection accepted
+    std::function<void(int64_t, const char*)> onSession;            // MQTT CONNECT accepted (client id)
+    std::function<void(int64_t, const char*, size_t)> onPublish;    // topic, payload bytes
+
+private:
+    struct Session {
+        bool open;
+        bool released;          // Client is done with it: the slot can be reused
+        bool mqtt;              // CONNECT accepted
+        int64_t openedUs;
+        std::string in;         // From the client, not yet parsed
+        std::string out;        // To the client
+        int64_t outReadyUs;     // When out becomes readable (one RTT after the request)
+        std::vector<std::string> subscriptions;
+    };
+
+    std::vector<SimOutage> outages;
+    std::vector<Session> sessions;
+    SimBrokerStats stats;
+    bool began;
+    int64_t beganUs;
+
+    static int64_t now() {
+        return simHardware().now();
+    }
+
+    const SimOutage* activeOutage(int64_t at, SimOutageKind kind) const {
+        for (size_t i = 0; i < outages.size(); i++) {
+            if (outages[i].kind == kind && outages[i].startUs <= at && at < outages[i].endUs) {
+                return &outages[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // End of the last WiFi outage before at (0 if none)
+    int64_t wifiBackSince(int64_t at) const {
+        int64_t since = 0;
+        for (size_t i = 0; i < outages.size(); i++) {
+            if (outages[i].kind == OUTAGE_WIFI && outages[i].endUs <= at && outages[i].endUs > since) {
+                since = outages[i].endUs;
+            }
+        }
+        return since;
+    }
+
+    /**
+     * @brief Whether an outage has ended the session by now
+     *
+     * WiFi and broker outages reset connections as they start; a blackhole
+     * leaves them hanging and the broker has dropped them by the time the
+     * host is reachable again.
+     */
+    bool cutByOutage(const Session& s, int64_t at) const {
+        for (size_t i = 0; i < outages.size(); i++) {
+            const SimOutage& o = outages[i];
+            if (o.startUs <= s.openedUs) {
+                continue;
+            }
+            int64_t cutAt = o.kind == OUTAGE_BLACKHOLE ? o.endUs : o.startUs;
+            if (cutAt <= at) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Session* live(int id) {
+        if (id < 0 || (size_t)id >= sessions.size()) {
+            return nullptr;
+        }
+        Session& s = sessions[id];
+        if (s.open && cutByOutage(s, now())) {
+            close(id);
+            stats.dropped++;
+        }
+        return s.open ? &s : nullptr;
+    }
+
+    bool silent() const {
+        return activeOutage(now(), OUTAGE_BLACKHOLE) != nullptr;
+    }
+
+    void respond(Session& s, const uint8_t* packet, size_t length) {
+        if (s.out.empty()) {
+            s.outReadyUs = now() + RTT_US;
+        }
+        s.out.append((const char*)packet, length);
+    }
+
+    static void putLength(std::string& out, size_t length) {
+        do {
+            uint8_t digit = length % 128;
+            length /= 128;
+            out.push_back((char)(length > 0 ? digit | 0x80 : digit));
+        } while (length > 0);
+    }
+
+    static std::string readString(const uint8_t*& p, const uint8_t* end) {
+        if (end - p < 2) {
+            p = end;
+            return std::string();
+        }
+        size_t length = (size_t)p[0] << 8 | p[1];
+        p += 2;
+        if ((size_t)(end - p) < length) {
+            length = end - p;
+        }
+        std::string text((const char*)p, length);
+        p += length;
+        return text;
+    }
+
+    static bool matches(const std::string& filter, const char* topic) {
+        if (filter.size() >= 1 && filter[filter.size() - 1] == '#') {
+            return strncmp(filter.c_str(), topic, filter.size() - 1) == 0;
+        }
+        return filter == topic;
+    }
+
+    /**
+     * @brief Handle one complete packet from the client
+     * @return false if the connection is to be closed
+     */
+    bool handle(Session& s, uint8_t header, const uint8_t* body, size_t length) {
+        const uint8_t* p = body;
+        const uint8_t* end = body + length;
+        uint8_t type = header >> 4;
+
+        if (!s.mqtt && type != 1) {
+            return false;  // First packet must be CONNECT
+        }
+
+        switch (type) {
+            case 1: {  // CONNECT
+                readString(p, end);             // "MQTT"
+                p += 4;                         // Level, flags, keep alive
+                std::string clientId = readString(p, end);
+                s.mqtt = true;
+                stats.sessions++;
+                static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+                respond(s, connack, sizeof(connack));
+                if (onSession) {
+                    onSession(now(), clientId.c_str());
+                }
+                return true;
+            }
+            case 3: {  // PUBLISH
+                // Topic copied to the stack: the simulation counts the node's allocations
+                uint8_t qos = (header >> 1) & 0x03;
+                char topic[128];
+                size_t topicLength = end - p >= 2 ? (size_t)p[0] << 8 | p[1] : 0;
+                p += end - p >= 2 ? 2 : end - p;
+                if ((size_t)(end - p) < topicLength) {
+                    topicLength = end - p;
+                }
+                size_t copied = topicLength < sizeof(topic) - 1 ? topicLength : sizeof(topic) - 1;
+                memcpy(topic, p, copied);
+                topic[copied] = '\0';
+                p += topicLength;
+                uint8_t id[2] = { 0, 0 };
+                if (qos > 0 && end - p >= 2) {
+                    id[0] = p[0];
+                    id[1] = p[1];
+                    p += 2;
+                }
+                stats.publishes++;
+                stats.publishBytes += end - p;
+                if (onPublish) {
+                    onPublish(now(), topic, end - p);
+                }
+                if (qos == 1) {
+                    uint8_t puback[] = { 0x40, 0x02, id[0], id[1] };
+                    respond(s, puback, sizeof(puback));
+                }
+                return true;
+            }
+            case 8: {  // SUBSCRIBE
+                if (end - p < 2) {
+                    return false;
+                }
+                std::string suback;
+                suback.push_back((char)p[0]);
+                suback.push_back((char)p[1]);
+                p += 2;
+                while (p < end) {
+                    s.subscriptions.push_back(readString(p, end));
+                    p++;                        // Requested QoS
+                    suback.push_back(0x00);     // Granted QoS 0
+                }
+                std::string packet(1, (char)0x90);
+                putLength(packet, suback.size());
+                packet += suback;
+                respond(s, (const uint8_t*)packet.data(), packet.size());
+                return true;
+            }
+            case 12: {  // PINGREQ
+                stats.pings++;
+                static const uint8_t pingresp[] = { 0xD0, 0x00 };
+                respond(s, pingresp, sizeof(pingresp));
+                return true;
+            }
+            case 14:  // DISCONNECT
+                return false;
+            default:
+                return true;  // PUBACK etc.: nothing to answer
+        }
+    }
+
+    // Parse every complete packet in the session's input
+    void process(int id) {
+        Session& s = sessions[id];
+        size_t pos = 0;
+        while (s.open && s.in.size() - pos >= 2) {
+            const uint8_t* data = (const uint8_t*)s.in.data() + pos;
+            size_t available = s.in.size() - pos;
+            size_t length = 0;
+            size_t used = 1;
+            int shift = 0;
+            bool complete = false;
+            while (used < available && used <= 4) {
+                uint8_t digit = data[used++];
+                length |= (size_t)(digit & 0x7F) << shift;
+                shift += 7;
+                if ((digit & 0x80) == 0) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete || available - used < length) {
+                break;
+            }
+            if (!handle(s, data[0], data + used, length)) {
+                close(id);
+                return;
+            }
+            pos += used + length;
+        }
+        s.in.erase(0, pos);
+    }
+
+public:
+    SimNetwork() : began(false), beganUs(0) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void addOutage(SimOutageKind kind, int64_t startUs, int64_t durationUs) {
+        SimOutage o = { kind, startUs, startUs + durationUs };
+        outages.push_back(o);
+    }
+
+    const std::vector<SimOutage>& getOutages() const {
+        return outages;
+    }
+
+    const SimBrokerStats& getStats() const {
+        return stats;
+    }
+
+    // ---- WiFi station ----
+
+    void begin() {
+        began = true;
+        beganUs = now();
+    }
+
+    void disconnect() {
+        began = false;
+    }
+
+    /**
+     * @brief Associated: begun, access point up, and ASSOCIATE_US since both
+     *
+     * The driver re-associates by itself when the access point comes back,
+     * like the ESP32's auto-reconnect.
+     */
+    bool associated() const {
+        int64_t t = now();
+        if (!began || activeOutage(t, OUTAGE_WIFI) != nullptr) {
+            return false;
+        }
+        int64_t since = beganUs > wifiBackSince(t) ? beganUs : wifiBackSince(t);
+        return t >= since + ASSOCIATE_US;
+    }
+
+    /**
+     * @brief Next time the link or the broker changes state on its own (INT64_MAX if never)
+     */
+    int64_t nextChangeUs() const {
+        int64_t t = now();
+        int64_t next = INT64_MAX;
+        for (size_t i = 0; i < outages.size(); i++) {
+            if (outages[i].startUs > t && outages[i].startUs < next) {
+                next = outages[i].startUs;
+            }
+            if (outages[i].endUs > t && outages[i].endUs < next) {
+                next = outages[i].endUs;
+            }
+        }
+        if (began && !associated()) {
+            int64_t since = beganUs > wifiBackSince(t) ? beganUs : wifiBackSince(t);
+            if (since + ASSOCIATE_US > t && since + ASSOCIATE_US < next) {
+                next = since + ASSOCIATE_US;
+            }
+        }
+        return next;
+    }
+
+    bool resolve(IPAddress& address) {
+        simHardware().advance(now() + DNS_US);
+        if (!associated()) {
+            return false;
+        }
+        address = IPAddress(192, 168, 1, 10);
+        return true;
+    }
+
+    // ---- TCP connections to the broker ----
+
+    /**
+     * @brief Open a connection, taking as long as the outcome would on the device
+     * @return Session id, or -1 if the connection failed
+     */
+    int connect(int32_t timeoutMs) {
+        int64_t start = now();
+        if (!associated()) {
+            stats.unreachable++;
+            if (onConnectAttempt) {
+                onConnectAttempt(start, false);
+            }
+            return -1;
+        }
+        if (activeOutage(start, OUTAGE_BLACKHOLE) != nullptr) {
+            simHardware().advance(start + (int64_t)timeoutMs * 1000);
+            stats.timeouts++;
+            if (onConnectAttempt) {
+                onConnectAttempt(start, false);
+            }
+            return -1;
+        }
+        simHardware().advance(start + RTT_US);
+        if (activeOutage(start, OUTAGE_BROKER) != nullptr) {
+            stats.refused++;
+            if (onConnectAttempt) {
+                onConnectAttempt(start, false);
+            }
+            return -1;
+        }
+        // Reuse released slots: a node that reconnects for months must not grow the table
+        size_t id = 0;
+        while (id < sessions.size() && !sessions[id].released) {
+            id++;
+        }
+        if (id == sessions.size()) {
+            sessions.push_back(Session());
+        }
+        Session& s = sessions[id];
+        s.open = true;
+        s.released = false;
+        s.mqtt = false;
+        s.openedUs = now();
+        s.outReadyUs = 0;
+        stats.tcpConnects++;
+        if (onConnectAttempt) {
+            onConnectAttempt(start, true);
+        }
+        return (int)id;
+    }
+
+    size_t write(int id, const uint8_t* data, size_t length) {
+        Session* s = live(id);
+        if (s == nullptr) {
+            return 0;
+        }
+        if (silent()) {
+            return length;  // Lost on the way
+        }
+        s->in.append((const char*)data, length);
+        process(id);
+        return length;
+    }
+
+    /**
+     * @brief Bytes readable now; an idle check lets POLL_US pass
+     */
+    int available(int id) {
+        Session* s = id >= 0 && (size_t)id < sessions.size() ? &sessions[id] : nullptr;
+        if (s != nullptr && !s->out.empty() && now() >= s->outReadyUs) {
+            return (int)s->out.size();  // Data that arrived before a reset is still read
+        }
+        if (s != nullptr && !s->out.empty()) {
+            simHardware().advance(s->outReadyUs);
+        } else {
+            simHardware().advance(now() + POLL_US);
+        }
+        live(id);
+        return s != nullptr && !s->out.empty() && now() >= s->outReadyUs ? (int)s->out.size() : 0;
+    }
+
+    int read(int id, uint8_t* buffer, size_t size) {
+        if (id < 0 || (size_t)id >= sessions.size()) {
+            return -1;
+        }
+        Session& s = sessions[id];
+        if (s.out.empty() || now() < s.outReadyUs) {
+            return -1;
+        }
+        size_t n = size < s.out.size() ? size : s.out.size();
+        memcpy(buffer, s.out.data(), n);
+        s.out.erase(0, n);
+        return (int)n;
+    }
+
+    int peek(int id) {
+        if (id < 0 || (size_t)id >= sessions.size()) {
+            return -1;
+        }
+        Session& s = sessions[id];
+        return s.out.empty() || now() < s.outReadyUs ? -1 : (uint8_t)s.out[0];
+    }
+
+    bool connected(int id) {
+        simHardware().advance(now() + CHECK_US);
+        if (live(id) != nullptr) {
+            return true;
+        }
+        return id >= 0 && (size_t)id < sessions.size() && !sessions[id].out.empty();
+    }
+
+    void close(int id) {
+        if (id < 0 || (size_t)id >= sessions.size()) {
+            return;
+        }
+        Session& s = sessions[id];
+        s.open = false;
+        s.in.clear();
+        s.subscriptions.clear();
+    }
+
+    /**
+     * @brief Release a connection the client is done with (its unread data too)
+     */
+    void release(int id) {
+        close(id);
+        if (id >= 0 && (size_t)id < sessions.size()) {
+            sessions[id].out.clear();
+            sessions[id].released = true;
+        }
+    }
+
+    /**
+     * @brief Publish to every connected client subscribed to topic (QoS 0)
+     * @return Number of clients it was sent to
+     */
+    size_t deliver(const char* topic, const char* payload) {
+        size_t topicLength = strlen(topic);
+        size_t payloadLength = strlen(payload);
+        std::string packet(1, (char)0x30);
+        putLength(packet, 2 + topicLength + payloadLength);
+        packet.push_back((char)(topicLength >> 8));
+        packet.push_back((char)topicLength);
+        packet.append(topic, topicLength);
+        packet.append(payload, payloadLength);
+
+        size_t sent = 0;
+        for (size_t id = 0; id < sessions.size(); id++) {
+            Session* s = live((int)id);
+            if (s == nullptr || !s->mqtt || silent()) {
+                continue;
+            }
+            for (size_t i = 0; i < s->subscriptions.size(); i++) {
+                if (matches(s->subscriptions[i], topic)) {
+                    respond(*s, (const uint8_t*)packet.data(), packet.size());
+                    sent++;
+                    break;
+                }
+            }
+        }
+        return sent;
+    }
+};
+
+// Never destroyed: WiFiClients with static storage still release their sessions at exit
+inline SimNetwork& simNetwork() {
+    static SimNetwork* network = new SimNetwork();
+    return *network;
+}
+
+#endif // SIM_NETWORK_H
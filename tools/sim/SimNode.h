@@ -0,0 +1,221 @@
+#ifndef SIM_NODE_H
+#define SIM_NODE_H
+
+// A simulated tent for the drivers in include/: SHT30 on I2C, HC-SR04 on two
+// pins and a pH probe on the ADC, following synthetic signals with faults.
+
+#include <math.h>
+#include <algorithm>
+#include "Arduino.h"
+#include "SimHardware.h"
+#include "config.h"
+
+// Fault rates of the simulated hardware
+static const double SHT30_NACK_RATE = 0.002;
+static const double ECHO_LOST_RATE = 0.02;
+static const double ECHO_MULTIPATH_RATE = 0.01;
+
+/**
+ * @brief xorshift64* generator, one per node
+ */
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Irwin-Hall approximation: cheap and good enough for sensor noise
+    double gaussian() {
+        return (uniform() + uniform() + uniform() + uniform() - 2.0) * 1.7320508;
+    }
+
+    bool chance(double p) {
+        return uniform() < p;
+    }
+};
+
+/**
+ * @brief One tent: SHT30 on I2C, HC-SR04 on two pins, pH probe on the ADC
+ */
+class NodeHardware : public SimHardware {
+private:
+    Random random;
+
+    // Signal parameters drawn per node
+    double tempMean, tempSwing, dayPhase;
+    double levelStartCm, drainCmPerDay;
+    double phMean, phDrift;
+
+    // SHT30 state
+    bool measuring;
+    int64_t measureStartUs;
+
+    // HC-SR04 state
+    bool trigHigh;
+    bool echoLevel;
+    bool echoPending;
+    int64_t echoRiseUs;
+    int64_t echoFallUs;
+
+    double days() const {
+        return nowUs / 86400e6;
+    }
+
+    double temperature() const {
+        return tempMean + tempSwing * sin(2 * M_PI * days() + dayPhase);
+    }
+
+    double humidity() const {
+        return 60.0 - 2.5 * (temperature() - tempMean);
+    }
+
+    // Drains, refilled to the start level whenever it drops 10 cm
+    double waterLevelCm() const {
+        return levelStartCm - fmod(drainCmPerDay * days(), 10.0);
+    }
+
+    double ph() const {
+        return phMean + phDrift * sin(2 * M_PI * days() / 7.0 + dayPhase);
+    }
+
+    static uint8_t crc8(const uint8_t* data) {
+        uint8_t crc = 0xFF;
+        for (size_t i = 0; i < 2; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++) {
+                crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    static void encodeWord(uint8_t* out, double value) {
+        uint16_t word = (uint16_t)std::max(0.0, std::min(65535.0, value + 0.5));
+        out[0] = (uint8_t)(word >> 8);
+        out[1] = (uint8_t)word;
+        out[2] = crc8(out);
+    }
+
+    // Falling edge of the trigger pulse: schedule the echo
+    void startEcho() {
+        echoPending = false;
+        if (random.chance(ECHO_LOST_RATE)) {
+            return;
+        }
+        double distanceMm = (CONTAINER_HEIGHT_CM - waterLevelCm()) * 10.0 + random.gaussian() * 1.5;
+        if (random.chance(ECHO_MULTIPATH_RATE)) {
+            distanceMm *= 0.4 + 0.4 * random.uniform();
+        }
+        echoRiseUs = nowUs + 450;
+        echoFallUs = echoRiseUs + (int64_t)(2.0 * distanceMm / 0.343);
+        echoPending = true;
+    }
+
+public:
+    explicit NodeHardware(uint64_t seed)
+        : random(seed), measuring(false), measureStartUs(0), trigHigh(false), echoLevel(false),
+          echoPending(false), echoRiseUs(0), echoFallUs(0) {
+        tempMean = 21.0 + 4.0 * random.uniform();
+        tempSwing = 1.5 + 2.0 * random.uniform();
+        dayPhase = 2 * M_PI * random.uniform();
+        levelStartCm = 24.0 + 8.0 * random.uniform();
+        drainCmPerDay = 1.0 + 3.0 * random.uniform();
+        phMean = 5.8 + 0.6 * random.uniform();
+        phDrift = 0.1 + 0.2 * random.uniform();
+    }
+
+    /**
+     * @brief Advance the clock, running the echo ISR at each edge on the way
+     */
+    void advance(int64_t untilUs) override {
+        while (echoPending) {
+            int64_t edge = echoLevel ? echoFallUs : echoRiseUs;
+            if (edge > untilUs) {
+                break;
+            }
+            nowUs = std::max(nowUs, edge);
+            echoLevel = !echoLevel;
+            if (!echoLevel) {
+                echoPending = false;
+            }
+            fireInterrupt(HC_SR04_ECHO_PIN);
+        }
+        SimHardware::advance(untilUs);
+    }
+
+    int digitalRead(uint8_t pin) override {
+        return pin == HC_SR04_ECHO_PIN && echoLevel ? HIGH : LOW;
+    }
+
+    void digitalWrite(uint8_t pin, uint8_t level) override {
+        if (pin == HC_SR04_TRIG_PIN) {
+            if (trigHigh && level == LOW) {
+                startEcho();
+            }
+            trigHigh = level == HIGH;
+        }
+    }
+
+    unsigned long pulseIn(uint8_t pin, uint8_t /*level*/, unsigned long timeoutUs) override {
+        int64_t start = nowUs;
+        if (pin != HC_SR04_ECHO_PIN || !echoPending || echoFallUs - start > (int64_t)timeoutUs) {
+            advance(start + timeoutUs);
+            return 0;
+        }
+        int64_t rise = echoRiseUs;
+        int64_t fall = echoFallUs;
+        advance(fall);
+        return (unsigned long)(fall - rise);
+    }
+
+    uint16_t analogRead(uint8_t pin) override {
+        SimHardware::advance(nowUs + 10);  // ~10 us per conversion
+        if (pin != PH_SENSOR_PIN) {
+            return 0;
+        }
+        // pH -> probe mV (3-point calibration) -> ADC code (PHLookupTable's linear formula)
+        double p = ph();
+        double mv = p <= 7.0 ? PH_CAL_MID + (7.0 - p) / 3.0 * (PH_CAL_LOW - PH_CAL_MID)
+                             : PH_CAL_MID - (p - 7.0) / 3.0 * (PH_CAL_MID - PH_CAL_HIGH);
+        double code = (mv - ESP32_ADC_OFFSET_MV) / 3300.0 * ADC_RESOLUTION + random.gaussian() * 4.0;
+        return (uint16_t)std::max(0.0, std::min(ADC_RESOLUTION, code + 0.5));
+    }
+
+    uint8_t i2cWrite(uint8_t address, const uint8_t* data, size_t length) override {
+        if (address != SHT30_I2C_ADDRESS || random.chance(SHT30_NACK_RATE)) {
+            return 2;
+        }
+        if (length == 2 && data[0] == 0x24) {
+            measuring = true;
+            measureStartUs = nowUs;
+        }
+        return 0;
+    }
+
+    size_t i2cRead(uint8_t address, uint8_t* data, size_t length) override {
+        // NACKs while converting (single shot, no clock stretching)
+        if (address != SHT30_I2C_ADDRESS || !measuring || nowUs - measureStartUs < 15500 || length < 6) {
+            return 0;
+        }
+        measuring = false;
+        double t = temperature() + random.gaussian() * 0.05;
+        double h = humidity() + random.gaussian() * 0.3;
+        encodeWord(data, (t + 45.0) / 175.0 * 65535.0);
+        encodeWord(data + 3, h / 100.0 * 65535.0);
+        return 6;
+    }
+};
+
+#endif // SIM_NODE_H
@@ -0,0 +1,37 @@
+#ifndef SIM_UPDATE_H
+#define SIM_UPDATE_H
+
+// Flash updater that refuses every image (no partition to write to)
+
+#include "Arduino.h"
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+class UpdateClass {
+public:
+    bool begin(size_t /*size*/) {
+        return false;
+    }
+
+    bool setMD5(const char* /*expectedMd5*/) {
+        return false;
+    }
+
+    size_t write(uint8_t* /*data*/, size_t /*length*/) {
+        return 0;
+    }
+
+    bool end(bool /*evenIfRemaining*/ = false) {
+        return false;
+    }
+
+    void abort() {}
+
+    const char* errorString() {
+        return "Not supported in simulation";
+    }
+};
+
+extern UpdateClass Update;
+
+#endif // SIM_UPDATE_H
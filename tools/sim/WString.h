@@ -0,0 +1,69 @@
+#ifndef SIM_WSTRING_H
+#define SIM_WSTRING_H
+
+// Arduino String subset (log lines and OTA callbacks build a few)
+
+#include <stdio.h>
+#include <string>
+
+class String {
+private:
+    std::string text;
+
+    template <typename T>
+    static std::string format(const char* spec, T value) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), spec, value);
+        return buffer;
+    }
+
+public:
+    String(const char* value = "") : text(value != nullptr ? value : "") {}
+    String(char value) : text(1, value) {}
+    String(int value) : text(format("%d", value)) {}
+    String(unsigned int value) : text(format("%u", value)) {}
+    String(long value) : text(format("%ld", value)) {}
+    String(unsigned long value) : text(format("%lu", value)) {}
+    String(double value, unsigned int decimals = 2) {
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        text = buffer;
+    }
+
+    const char* c_str() const {
+        return text.c_str();
+    }
+
+    unsigned int length() const {
+        return (unsigned int)text.size();
+    }
+
+    String& operator+=(const String& other) {
+        text += other.text;
+        return *this;
+    }
+
+    friend String operator+(const String& a, const String& b) {
+        String result(a);
+        result += b;
+        return result;
+    }
+
+    friend String operator+(const String& a, const char* b) {
+        return a + String(b);
+    }
+
+    friend String operator+(const char* a, const String& b) {
+        return String(a) + b;
+    }
+
+    bool operator==(const String& other) const {
+        return text == other.text;
+    }
+
+    bool operator==(const char* other) const {
+        return text == other;
+    }
+};
+
+#endif // SIM_WSTRING_H
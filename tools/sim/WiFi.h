@@ -0,0 +1,150 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+// WiFi station and TCP client on the simulated network (SimNetwork.h)
+
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+#include "SimNetwork.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t) {
+        return true;
+    }
+
+    wl_status_t begin(const char* /*ssid*/, const char* /*password*/ = nullptr) {
+        simNetwork().begin();
+        return status();
+    }
+
+    bool disconnect(bool /*wifiOff*/ = false) {
+        simNetwork().disconnect();
+        return true;
+    }
+
+    wl_status_t status() {
+        return simNetwork().associated() ? WL_CONNECTED : WL_DISCONNECTED;
+    }
+
+    IPAddress localIP() {
+        return simNetwork().associated() ? IPAddress(192, 168, 1, 50) : IPAddress();
+    }
+
+    int8_t RSSI() {
+        return simNetwork().associated() ? -61 : 0;
+    }
+
+    int hostByName(const char* /*host*/, IPAddress& address) {
+        return simNetwork().resolve(address) ? 1 : 0;
+    }
+};
+
+extern WiFiClass WiFi;
+
+/**
+ * @brief TCP connection to the simulated broker
+ */
+class WiFiClient : public Client {
+private:
+    int session;
+
+public:
+    WiFiClient() : session(-1) {}
+
+    ~WiFiClient() {
+        stop();
+    }
+
+    int connect(IPAddress /*ip*/, uint16_t /*port*/, int32_t timeoutMs) {
+        stop();
+        session = simNetwork().connect(timeoutMs);
+        return session >= 0 ? 1 : 0;
+    }
+
+    int connect(const char* /*host*/, uint16_t port, int32_t timeoutMs) {
+        IPAddress address;
+        if (!simNetwork().resolve(address)) {
+            return 0;
+        }
+        return connect(address, port, timeoutMs);
+    }
+
+    int connect(IPAddress ip, uint16_t port) override {
+        return connect(ip, port, SimNetwork::DEFAULT_CONNECT_TIMEOUT_MS);
+    }
+
+    int connect(const char* host, uint16_t port) override {
+        return connect(host, port, SimNetwork::DEFAULT_CONNECT_TIMEOUT_MS);
+    }
+
+    size_t write(uint8_t value) override {
+        return write(&value, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return simNetwork().write(session, buffer, size);
+    }
+
+    int available() override {
+        return session >= 0 ? simNetwork().available(session) : 0;
+    }
+
+    int read() override {
+        uint8_t value;
+        return read(&value, 1) == 1 ? value : -1;
+    }
+
+    int read(uint8_t* buffer, size_t size) override {
+        return simNetwork().read(session, buffer, size);
+    }
+
+    int peek() override {
+        return simNetwork().peek(session);
+    }
+
+    // Discards unread input, as on the ESP32
+    void flush() override {
+        uint8_t discard[64];
+        while (read(discard, sizeof(discard)) > 0) {
+        }
+    }
+
+    void stop() override {
+        if (session >= 0) {
+            simNetwork().release(session);
+            session = -1;
+        }
+    }
+
+    uint8_t connected() override {
+        return session >= 0 && simNetwork().connected(session) ? 1 : 0;
+    }
+
+    operator bool() override {
+        return connected();
+    }
+
+    int setNoDelay(bool) {
+        return 0;
+    }
+};
+
+#endif // SIM_WIFI_H
@@ -0,0 +1,72 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include "Arduino.h"
+
+/**
+ * @brief TwoWire subset: transactions go to the calling thread's SimHardware
+ */
+class TwoWire {
+private:
+    // Per thread, like the hardware: nodes on different threads never share a transfer
+    struct Transfer {
+        uint8_t address;
+        uint8_t data[32];
+        size_t length;
+        size_t position;
+    };
+
+    static Transfer& transfer() {
+        static thread_local Transfer t;
+        return t;
+    }
+
+public:
+    bool begin(int /*sda*/ = -1, int /*scl*/ = -1, uint32_t /*frequency*/ = 0) {
+        return true;
+    }
+
+    void end() {}
+
+    void beginTransmission(uint8_t address) {
+        Transfer& t = transfer();
+        t.address = address;
+        t.length = 0;
+    }
+
+    size_t write(uint8_t value) {
+        Transfer& t = transfer();
+        if (t.length >= sizeof(t.data)) {
+            return 0;
+        }
+        t.data[t.length++] = value;
+        return 1;
+    }
+
+    uint8_t endTransmission(bool /*stop*/ = true) {
+        Transfer& t = transfer();
+        return simHardware().i2cWrite(t.address, t.data, t.length);
+    }
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) {
+        Transfer& t = transfer();
+        size_t wanted = quantity < sizeof(t.data) ? quantity : sizeof(t.data);
+        t.length = simHardware().i2cRead(address, t.data, wanted);
+        t.position = 0;
+        return (uint8_t)t.length;
+    }
+
+    int available() {
+        Transfer& t = transfer();
+        return (int)(t.length - t.position);
+    }
+
+    int read() {
+        Transfer& t = transfer();
+        return t.position < t.length ? t.data[t.position++] : -1;
+    }
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
@@ -0,0 +1,176 @@
+#ifndef SIM_ESP_HEAP_CAPS_H
+#define SIM_ESP_HEAP_CAPS_H
+
+// Heap capabilities on the host allocator. Allocations never fail; the
+// heap_caps_get_* figures are for a node alone in its process (loop_sim):
+// internal RAM in use is what the host allocator holds beyond the baseline
+// taken by the first query, less the blocks allocated with MALLOC_CAP_SPIRAM.
+// Block counts and fragmentation are not modelled (the largest free block is
+// all free memory).
+
+#include <malloc.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+#define SIM_INTERNAL_HEAP_BYTES (300 * 1024)
+#define SIM_PSRAM_BYTES (4 * 1024 * 1024)
+#define SIM_PSRAM_BLOCKS 32
+
+typedef struct multi_heap_info_t {
+    size_t total_free_bytes;
+    size_t total_allocated_bytes;
+    size_t largest_free_block;
+    size_t minimum_free_bytes;
+    size_t allocated_blocks;
+    size_t free_blocks;
+    size_t total_blocks;
+} multi_heap_info_t;
+
+/**
+ * @brief Book-keeping behind the heap_caps_* figures
+ */
+struct SimHeap {
+    void* psramPtrs[SIM_PSRAM_BLOCKS];
+    size_t baselineBytes;       // Host bytes in use at the first query (not the firmware's)
+    bool started;
+    size_t psramBytes;
+    size_t psramBlocks;
+    size_t minInternalFree;
+    size_t minPsramFree;
+
+    static SimHeap& get() {
+        static SimHeap heap = { {}, 0, false, 0, 0, SIM_INTERNAL_HEAP_BYTES, SIM_PSRAM_BYTES };
+        return heap;
+    }
+
+    /**
+     * @brief Internal RAM in use (the first call takes the baseline: call it before setup())
+     */
+    size_t internalUsed() {
+        struct mallinfo2 info = mallinfo2();
+        size_t host = info.uordblks + info.hblkhd;
+        if (!started) {
+            started = true;
+            baselineBytes = host;
+        }
+        host = host > baselineBytes ? host - baselineBytes : 0;
+        return host > psramBytes ? host - psramBytes : 0;
+    }
+
+    size_t internalFree() {
+        size_t used = internalUsed();
+        size_t free = used < SIM_INTERNAL_HEAP_BYTES ? SIM_INTERNAL_HEAP_BYTES - used : 0;
+        if (free < minInternalFree) {
+            minInternalFree = free;
+        }
+        return free;
+    }
+
+    bool addPsram(void* ptr) {
+        for (size_t i = 0; i < SIM_PSRAM_BLOCKS; i++) {
+            if (psramPtrs[i] == nullptr) {
+                psramPtrs[i] = ptr;
+                psramBytes += malloc_usable_size(ptr);
+                psramBlocks++;
+                psramFree();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void removePsram(void* ptr) {
+        for (size_t i = 0; i < SIM_PSRAM_BLOCKS; i++) {
+            if (psramPtrs[i] == ptr) {
+                psramPtrs[i] = nullptr;
+                psramBytes -= malloc_usable_size(ptr);
+                psramBlocks--;
+                return;
+            }
+        }
+    }
+
+    size_t psramFree() {
+        size_t free = psramBytes < SIM_PSRAM_BYTES ? SIM_PSRAM_BYTES - psramBytes : 0;
+        if (free < minPsramFree) {
+            minPsramFree = free;
+        }
+        return free;
+    }
+};
+
+/**
+ * @brief Allocate (PSRAM blocks past the table are not counted, e.g. in a fleet)
+ */
+inline void* heap_caps_malloc(size_t size, uint32_t caps) {
+    void* ptr = malloc(size);
+    if (ptr != nullptr && (caps & MALLOC_CAP_SPIRAM)) {
+        SimHeap::get().addPsram(ptr);
+    }
+    return ptr;
+}
+
+inline void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    void* ptr = heap_caps_malloc(n * size, caps);
+    if (ptr != nullptr) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+/**
+ * @brief Free memory from heap_caps_malloc() (PSRAM blocks are recognised by address)
+ */
+inline void heap_caps_free(void* ptr) {
+    if (ptr != nullptr) {
+        SimHeap::get().removePsram(ptr);
+    }
+    free(ptr);
+}
+
+inline size_t heap_caps_get_total_size(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? SIM_PSRAM_BYTES : SIM_INTERNAL_HEAP_BYTES;
+}
+
+inline size_t heap_caps_get_free_size(uint32_t caps) {
+    SimHeap& heap = SimHeap::get();
+    return (caps & MALLOC_CAP_SPIRAM) ? heap.psramFree() : heap.internalFree();
+}
+
+inline size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    SimHeap& heap = SimHeap::get();
+    if (caps & MALLOC_CAP_SPIRAM) {
+        heap.psramFree();
+        return heap.minPsramFree;
+    }
+    heap.internalFree();
+    return heap.minInternalFree;
+}
+
+inline size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return heap_caps_get_free_size(caps);
+}
+
+inline void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+    SimHeap& heap = SimHeap::get();
+    memset(info, 0, sizeof(*info));
+    if (caps & MALLOC_CAP_SPIRAM) {
+        info->total_allocated_bytes = heap.psramBytes;
+        info->allocated_blocks = heap.psramBlocks;
+    } else {
+        info->total_allocated_bytes = heap.internalUsed();
+    }
+    info->total_free_bytes = heap_caps_get_free_size(caps);
+    info->largest_free_block = info->total_free_bytes;
+    info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+    info->free_blocks = 1;
+    info->total_blocks = info->allocated_blocks + 1;
+}
+
+#endif // SIM_ESP_HEAP_CAPS_H
@@ -0,0 +1,54 @@
+#ifndef SIM_ESP_TASK_WDT_H
+#define SIM_ESP_TASK_WDT_H
+
+// Task watchdog that measures instead of resetting: the simulation checks the
+// longest time between esp_task_wdt_reset() calls against the timeout.
+
+#include "SimHardware.h"
+#include "esp_err.h"
+
+struct SimWatchdog {
+    uint32_t timeoutS;
+    bool subscribed;
+    int64_t lastResetUs;
+    int64_t maxGapUs;           // Longest time between resets
+    int64_t maxGapAtUs;         // When it ended
+    uint32_t expired;           // Gaps longer than the timeout (the device would have reset)
+
+    static SimWatchdog& get() {
+        static SimWatchdog watchdog = { 0, false, 0, 0, 0, 0 };
+        return watchdog;
+    }
+};
+
+inline esp_err_t esp_task_wdt_init(uint32_t timeoutS, bool /*panic*/) {
+    SimWatchdog::get().timeoutS = timeoutS;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_add(void* /*task*/) {
+    SimWatchdog& w = SimWatchdog::get();
+    w.subscribed = true;
+    w.lastResetUs = simHardware().now();
+    return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_reset() {
+    SimWatchdog& w = SimWatchdog::get();
+    if (!w.subscribed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t now = simHardware().now();
+    int64_t gap = now - w.lastResetUs;
+    if (gap > w.maxGapUs) {
+        w.maxGapUs = gap;
+        w.maxGapAtUs = now;
+    }
+    if (w.timeoutS > 0 && gap > (int64_t)w.timeoutS * 1000000) {
+        w.expired++;
+    }
+    w.lastResetUs = now;
+    return ESP_OK;
+}
+
+#endif // SIM_ESP_TASK_WDT_H
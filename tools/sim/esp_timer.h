@@ -0,0 +1,72 @@
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+#include "SimHardware.h"
+#include "esp_err.h"
+
+// Reading the clock costs a microsecond, so code that busy-waits on it (the
+// acquisition loop in readSensors()) moves forward as it does on the device
+inline int64_t esp_timer_get_time() {
+    SimHardware& hw = simHardware();
+    hw.advance(hw.now() + 1);
+    return hw.now();
+}
+
+// Periodic timers run on the node's clock (SimHardware::runTimers()), not a task
+struct esp_timer : SimTimer {
+    SimHardware* hardware;
+};
+typedef esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    esp_timer* timer = new esp_timer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    timer->periodUs = 0;
+    timer->dueUs = 0;
+    timer->hardware = &simHardware();
+    if (!timer->hardware->addTimer(timer)) {
+        delete timer;
+        return ESP_FAIL;
+    }
+    *handle = timer;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (periodUs == 0) {
+        return ESP_FAIL;
+    }
+    timer->periodUs = (int64_t)periodUs;
+    timer->dueUs = timer->hardware->now() + (int64_t)periodUs;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer->periodUs == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->periodUs = 0;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    timer->hardware->removeTimer(timer);
+    delete timer;
+    return ESP_OK;
+}
+
+#endif // SIM_ESP_TIMER_H
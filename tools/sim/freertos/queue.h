@@ -0,0 +1,54 @@
+#ifndef SIM_FREERTOS_QUEUE_H
+#define SIM_FREERTOS_QUEUE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+
+/**
+ * @brief Fixed-size item queue; never blocks (nothing else runs to fill or drain it)
+ */
+struct SimQueue {
+    uint8_t* items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+typedef SimQueue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    SimQueue* q = (SimQueue*)calloc(1, sizeof(SimQueue));
+    if (q == nullptr) {
+        return nullptr;
+    }
+    q->items = (uint8_t*)calloc(length, itemSize);
+    if (q->items == nullptr) {
+        free(q);
+        return nullptr;
+    }
+    q->length = length;
+    q->itemSize = itemSize;
+    return q;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t /*wait*/) {
+    if (q->count == q->length) {
+        return pdFALSE;
+    }
+    memcpy(q->items + ((q->head + q->count) % q->length) * q->itemSize, item, q->itemSize);
+    q->count++;
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t /*wait*/) {
+    if (q->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item, q->items + q->head * q->itemSize, q->itemSize);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+#endif // SIM_FREERTOS_QUEUE_H
@@ -0,0 +1,34 @@
+#ifndef SIM_FREERTOS_TASK_H
+#define SIM_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef struct SimTask* TaskHandle_t;
+
+/**
+ * @brief Accept the task without running it (the simulation only runs loop())
+ */
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t /*entry*/, const char* /*name*/,
+                                          uint32_t /*stackBytes*/, void* /*arg*/, UBaseType_t /*priority*/,
+                                          TaskHandle_t* handle, BaseType_t /*core*/) {
+    if (handle != nullptr) {
+        *handle = nullptr;
+    }
+    return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetHandle(const char* /*name*/) {
+    return nullptr;
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t /*task*/) {
+    return 0;
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+    SimHardware& hw = simHardware();
+    hw.advance(hw.now() + (int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+#endif // SIM_FREERTOS_TASK_H
@@ -0,0 +1,235 @@
+// Convert trace batches published with the traceStart command to Chrome trace JSON.
+//
+// Build:  g++ -std=c++11 -O2 -I../include trace_to_json.cpp -o trace_to_json
+// Usage:  trace_to_json [--stats] [--capture ID] [FILE...] > trace.json
+//
+// Each FILE (or stdin) holds batches back to back, e.g. captured with
+//   mosquitto_sub -t 'grow/esp32_1/trace' -N > trace.bin
+// The newest capture is converted unless --capture (hex id from the "trace"
+// event) picks another. Open the output in chrome://tracing or
+// https://ui.perfetto.dev. Timestamps are microseconds since the first event.
+// --stats prints count, total and longest duration per probe to stderr.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "TraceFormat.h"
+
+struct Batch {
+    TraceBatchHeader header;
+    std::vector<TraceEvent> events;
+};
+
+struct ProbeStats {
+    size_t count = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+};
+
+// Inserted where a batch is missing: scopes still open there are closed
+static const uint16_t GAP_MARKER = 0xFFFF;
+
+struct OpenScope {
+    uint16_t probe;
+    uint64_t startUs;
+};
+
+static bool readAll(FILE* f, std::vector<uint8_t>& data) {
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    return !ferror(f);
+}
+
+static bool parseStream(const std::vector<uint8_t>& data, std::vector<Batch>& batches) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        Batch batch;
+        size_t size = traceDecodeHeader(&data[offset], data.size() - offset, batch.header);
+        if (size == 0) {
+            fprintf(stderr, "bad or truncated batch at offset %zu\n", offset);
+            return false;
+        }
+        for (uint16_t i = 0; i < batch.header.count; i++) {
+            batch.events.push_back(traceDecodeEvent(&data[offset], i));
+        }
+        batches.push_back(batch);
+        offset += size;
+    }
+    return true;
+}
+
+static void printEvent(bool& first, const char* name, char phase, double ts, const char* args) {
+    printf("%s\n    {\"name\":\"%s\",\"cat\":\"loop\",\"ph\":\"%c\",\"ts\":%.0f,\"pid\":1,\"tid\":1%s%s}",
+           first ? "" : ",", name, phase, ts, phase == 'i' ? ",\"s\":\"t\"" : "", args);
+    first = false;
+}
+
+int main(int argc, char** argv) {
+    bool stats = false;
+    bool haveCapture = false;
+    uint32_t captureId = 0;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            captureId = (uint32_t)strtoul(argv[++i], nullptr, 16);
+            haveCapture = true;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            fprintf(stderr, "usage: %s [--stats] [--capture ID] [FILE...]\n", argv[0]);
+            return 0;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    std::vector<Batch> batches;
+    bool ok = true;
+    if (files.empty()) {
+        std::vector<uint8_t> data;
+        ok = readAll(stdin, data) && parseStream(data, batches);
+    }
+    for (size_t i = 0; i < files.size() && ok; i++) {
+        FILE* f = fopen(files[i], "rb");
+        if (f == nullptr) {
+            perror(files[i]);
+            return 1;
+        }
+        std::vector<uint8_t> data;
+        ok = readAll(f, data) && parseStream(data, batches);
+        fclose(f);
+    }
+    if (!ok || batches.empty()) {
+        fprintf(stderr, "%s\n", ok ? "no trace batches in input" : "input rejected");
+        return 1;
+    }
+
+    // Newest capture by default (the last one in the input)
+    if (!haveCapture) {
+        captureId = batches.back().header.captureId;
+    }
+    std::vector<Batch> capture;
+    for (size_t i = 0; i < batches.size(); i++) {
+        if (batches[i].header.captureId == captureId) {
+            capture.push_back(batches[i]);
+        }
+    }
+    if (capture.empty()) {
+        fprintf(stderr, "capture %08x not found\n", captureId);
+        return 1;
+    }
+    std::stable_sort(capture.begin(), capture.end(), [](const Batch& a, const Batch& b) {
+        return a.header.firstSeq < b.header.firstSeq;
+    });
+
+    std::vector<TraceEvent> events;
+    uint32_t expectedSeq = capture.front().header.firstSeq;
+    if (expectedSeq > 0) {
+        fprintf(stderr, "ring wrapped: first %u events were overwritten on the node\n", expectedSeq);
+    }
+    for (size_t i = 0; i < capture.size(); i++) {
+        const TraceBatchHeader& header = capture[i].header;
+        if (header.firstSeq + header.count <= expectedSeq) {
+            continue;  // Duplicate
+        }
+        if (header.firstSeq > expectedSeq) {
+            fprintf(stderr, "missing events %u..%u (batch lost)\n", expectedSeq, header.firstSeq - 1);
+            TraceEvent gap = {capture[i].events.front().timestampUs, GAP_MARKER, 0, 0};
+            events.push_back(gap);
+        }
+        events.insert(events.end(), capture[i].events.begin(), capture[i].events.end());
+        expectedSeq = header.firstSeq + header.count;
+    }
+
+    // 32-bit timestamps wrap every ~71 minutes: accumulate deltas instead
+    std::map<uint16_t, ProbeStats> probeStats;
+    std::vector<OpenScope> open;
+    uint64_t nowUs = 0;
+    uint32_t previous = events.front().timestampUs;
+    bool first = true;
+    size_t unmatched = 0;
+    char args[32];
+
+    printf("{\"displayTimeUnit\":\"ms\",\"otherData\":{\"capture\":\"%08x\"},\"traceEvents\":[", captureId);
+    printf("\n    {\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"loopTask\"}}");
+    first = false;
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& e = events[i];
+        if (e.probe == GAP_MARKER) {
+            // Durations across the gap are unknown: end open scopes where the data stops
+            while (!open.empty()) {
+                printEvent(first, traceProbeName(open.back().probe), 'E', (double)nowUs, "");
+                open.pop_back();
+                unmatched++;
+            }
+            nowUs += (uint32_t)(e.timestampUs - previous);
+            previous = e.timestampUs;
+            continue;
+        }
+        nowUs += (uint32_t)(e.timestampUs - previous);
+        previous = e.timestampUs;
+        const char* name = traceProbeName(e.probe);
+        snprintf(args, sizeof(args), ",\"args\":{\"arg\":%u}", e.arg);
+
+        if (e.phase == TRACE_PHASE_BEGIN) {
+            open.push_back(OpenScope{e.probe, nowUs});
+            printEvent(first, name, 'B', (double)nowUs, "");
+        } else if (e.phase == TRACE_PHASE_END) {
+            // Close inner scopes left open (their end fell outside the capture)
+            size_t match = open.size();
+            while (match > 0 && open[match - 1].probe != e.probe) {
+                match--;
+            }
+            if (match == 0) {
+                unmatched++;  // Began before the capture started
+                continue;
+            }
+            while (open.size() >= match) {
+                const OpenScope& scope = open.back();
+                bool isMatch = open.size() == match;
+                printEvent(first, traceProbeName(scope.probe), 'E', (double)nowUs, isMatch ? args : "");
+                ProbeStats& s = probeStats[scope.probe];
+                s.count++;
+                s.totalUs += nowUs - scope.startUs;
+                s.maxUs = std::max(s.maxUs, nowUs - scope.startUs);
+                if (!isMatch) {
+                    unmatched++;
+                }
+                open.pop_back();
+            }
+        } else {
+            printEvent(first, name, 'i', (double)nowUs, args);
+            probeStats[e.probe].count++;
+        }
+    }
+    while (!open.empty()) {
+        printEvent(first, traceProbeName(open.back().probe), 'E', (double)nowUs, "");
+        open.pop_back();
+        unmatched++;
+    }
+    printf("\n]}\n");
+
+    fprintf(stderr, "capture %08x: %zu events in %zu batches over %.1f ms", captureId, events.size(),
+            capture.size(), nowUs / 1000.0);
+    if (unmatched > 0) {
+        fprintf(stderr, ", %zu scopes cut off at the capture edges or lost batches", unmatched);
+    }
+    fprintf(stderr, "\n");
+    if (stats) {
+        fprintf(stderr, "%-20s %8s %12s %10s %10s\n", "probe", "count", "total_us", "mean_us", "max_us");
+        for (std::map<uint16_t, ProbeStats>::const_iterator it = probeStats.begin(); it != probeStats.end(); ++it) {
+            const ProbeStats& s = it->second;
+            fprintf(stderr, "%-20s %8zu %12llu %10.1f %10llu\n", traceProbeName(it->first), s.count,
+                    (unsigned long long)s.totalUs, s.count > 0 ? (double)s.totalUs / s.count : 0.0,
+                    (unsigned long long)s.maxUs);
+        }
+    }
+    return 0;
+}